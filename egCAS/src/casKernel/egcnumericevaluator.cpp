@@ -0,0 +1,629 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <new>
+#include <QStringBuilder>
+#include "egcnumericevaluator.h"
+#include "egcnumericprogram.h"
+#include "egcnumericintegrator.h"
+#include "egcnodes.h"
+#include "entities/egcformulaentity.h"
+
+const long double EgcNumericEvaluator::s_maxExact = 9007199254740992.0L; // 2^53
+
+/**
+ * @brief getChild returns the child at index of the given container node
+ * @param node the container node
+ * @param index the index of the child
+ * @return the child or nullptr if there is no such child
+ */
+static EgcNode* getChild(EgcNode& node, quint32 index)
+{
+        if (!node.isContainer())
+                return nullptr;
+
+        return static_cast<EgcContainerNode&>(node).getChild(index);
+}
+
+/**
+ * @brief isDefiniteIntegral checks if the given node is a definite integral
+ * @param node the node to check
+ * @return true if the node is a definite integral (with bounds)
+ */
+static bool isDefiniteIntegral(EgcNode& node)
+{
+        return    node.getNodeType() == EgcNodeType::IntegralNode
+               && static_cast<EgcContainerNode&>(node).getNumberChildNodes() == 4;
+}
+
+/**
+ * @brief containsDefiniteIntegral checks if the given tree contains a definite integral
+ * @param node the root of the tree to check
+ * @return true if there is a definite integral in the tree
+ */
+static bool containsDefiniteIntegral(EgcNode& node)
+{
+        if (!node.isContainer())
+                return false;
+        if (isDefiniteIntegral(node))
+                return true;
+
+        EgcContainerNode& container = static_cast<EgcContainerNode&>(node);
+        for (quint32 i = 0; i < container.getNumberChildNodes(); i++) {
+                EgcNode* child = container.getChild(i);
+                if (child && containsDefiniteIntegral(*child))
+                        return true;
+        }
+
+        return false;
+}
+
+/**
+ * @brief exactRoot calculates the root of an exact value, if the root is exact too
+ * @param radicand the radicand of the root
+ * @param index the index of the root
+ * @param root the root if the root is exact
+ * @return true if the root is an exact integer, false otherwise
+ */
+static bool exactRoot(long double radicand, long double index, long double& root)
+{
+        if (radicand < 0.0L || !std::isfinite(radicand) || index < 1.0L || std::floor(index) != index)
+                return false;
+        if (radicand == 0.0L || radicand == 1.0L) {
+                root = radicand;
+                return true;
+        }
+
+        // only 0 and 1 have roots below 2. For all other candidates the power exceeds the radicand after a few steps,
+        // so the loop below is bounded by the size of the radicand and not by the (maybe huge) index.
+        long double candidate = std::round(std::pow(radicand, 1.0L / index));
+        if (candidate < 2.0L)
+                return false;
+        long double check = 1.0L;
+        for (long double i = 0.0L; i < index; i += 1.0L) {
+                check *= candidate;
+                if (check > radicand)
+                        return false;
+        }
+        if (check != radicand)
+                return false;
+
+        root = candidate;
+        return true;
+}
+
+EgcNumericEvaluator::EgcNumericEvaluator() : m_numeric{false}
+{
+}
+
+EgcNumericEvaluator::~EgcNumericEvaluator()
+{
+}
+
+bool EgcNumericEvaluator::calculate(EgcFormulaEntity& formula, QString& result)
+{
+        EgcNode* root = formula.getRootElement();
+        if (!root || root->getNodeType() != EgcNodeType::EqualNode)
+                return false;
+        EgcNode* lhs = getChild(*root, 0);
+        if (!lhs)
+                return false;
+
+        EgcNumericValue value;
+        if (!evaluate(*lhs, value))
+                return false;
+
+        // same format as the kernel returns it for result formulas
+        result = toKernelString(value);
+
+        return true;
+}
+
+bool EgcNumericEvaluator::define(EgcFormulaEntity& formula)
+{
+        EgcNode* root = formula.getRootElement();
+        if (!root || root->getNodeType() != EgcNodeType::DefinitionNode)
+                return false;
+        EgcNode* lhs = getChild(*root, 0);
+        EgcNode* rhs = getChild(*root, 1);
+        if (!lhs)
+                return false;
+
+        if (lhs->getNodeType() == EgcNodeType::VariableNode) {
+                QString symbol = static_cast<EgcVariableNode*>(lhs)->getStuffedValue();
+                EgcNumericValue value;
+                if (rhs && evaluate(*rhs, value)) {
+                        m_symbols.insert(symbol, value);
+                        return true;
+                }
+                m_symbols.remove(symbol);
+        } else if (lhs->getNodeType() == EgcNodeType::FunctionNode) {
+                QString name = static_cast<EgcFunctionNode*>(lhs)->getStuffedName();
+                m_userFunctions.insert(name);
+                if (defineFunction(formula, name))
+                        return true;
+                m_functions.remove(name);
+        }
+
+        return false;
+}
+
+bool EgcNumericEvaluator::getDefinitionCommand(EgcFormulaEntity& formula, QString& command) const
+{
+        EgcNode* root = formula.getRootElement();
+        if (!root || root->getNodeType() != EgcNodeType::DefinitionNode)
+                return false;
+        EgcNode* lhs = getChild(*root, 0);
+        EgcNode* rhs = getChild(*root, 1);
+        if (!lhs || !rhs || lhs->getNodeType() != EgcNodeType::VariableNode || !containsDefiniteIntegral(*rhs))
+                return false;
+
+        QString symbol = static_cast<EgcVariableNode*>(lhs)->getStuffedValue();
+        EgcNumericValue value;
+        if (!getSymbol(symbol, value))
+                return false;
+        command = symbol % QString(":") % toKernelString(value) % QString(";");
+
+        return true;
+}
+
+bool EgcNumericEvaluator::defineFunction(EgcFormulaEntity& formula, const QString& name)
+{
+        // the kernel command identifies the version of the function (name, parameters and body)
+        QString version = formula.getCASKernelCommand();
+
+        QSharedPointer<EgcNumericProgram> program;
+        if (m_programCache.contains(version)) {
+                program = m_programCache.value(version);
+        } else {
+                program = QSharedPointer<EgcNumericProgram>(new (std::nothrow) EgcNumericProgram());
+                if (program.isNull())
+                        return false;
+                EgcNode* root = formula.getRootElement();
+                if (!program->compile(*getChild(*root, 0), getChild(*root, 1)))
+                        program.clear();
+                if (m_programCache.size() >= s_maxCachedPrograms)
+                        m_programCache.clear();
+                // functions that cannot be compiled are cached too, so they are not compiled again and again
+                m_programCache.insert(version, program);
+        }
+
+        if (program.isNull())
+                return false;
+
+        m_functions.insert(name, program);
+
+        return true;
+}
+
+void EgcNumericEvaluator::undefine(const QString& symbol)
+{
+        m_symbols.remove(symbol);
+        m_userFunctions.remove(symbol);
+        m_functions.remove(symbol);
+}
+
+void EgcNumericEvaluator::clear(void)
+{
+        m_symbols.clear();
+        m_userFunctions.clear();
+        m_functions.clear();
+}
+
+void EgcNumericEvaluator::copySymbols(const EgcNumericEvaluator& other)
+{
+        // the containers are implicitly shared and the compiled programs are never changed, so this is cheap
+        m_symbols = other.m_symbols;
+        m_userFunctions = other.m_userFunctions;
+        m_functions = other.m_functions;
+}
+
+void EgcNumericEvaluator::setNumeric(bool numeric)
+{
+        m_numeric = numeric;
+}
+
+const EgcNumericProgram* EgcNumericEvaluator::getFunction(const QString& name) const
+{
+        QHash<QString, QSharedPointer<EgcNumericProgram> >::const_iterator i = m_functions.constFind(name);
+        if (i == m_functions.constEnd())
+                return nullptr;
+
+        return i.value().data();
+}
+
+bool EgcNumericEvaluator::getSymbol(const QString& symbol, EgcNumericValue& value) const
+{
+        QHash<QString, EgcNumericValue>::const_iterator i = m_symbols.constFind(symbol);
+        if (i == m_symbols.constEnd())
+                return false;
+        value = i.value();
+
+        return true;
+}
+
+bool EgcNumericEvaluator::callFunction(const QString& name, const QVector<EgcNumericValue>& args,
+                                       EgcNumericValue& result, int depth) const
+{
+        if (depth >= s_maxCallDepth)
+                return false;
+
+        QHash<QString, QSharedPointer<EgcNumericProgram> >::const_iterator i = m_functions.constFind(name);
+        if (i == m_functions.constEnd())
+                return false;
+
+        return i.value()->run(args, *this, result, depth + 1);
+}
+
+bool EgcNumericEvaluator::evaluate(EgcNode& node, EgcNumericValue& value) const
+{
+        EgcNodeType type = node.getNodeType();
+
+        switch (type) {
+        case EgcNodeType::NumberNode:
+                if (!parseNumber(static_cast<EgcNumberNode&>(node).getValue(), value))
+                        return false;
+                // all operations on floats are floats again, so rationals and roots are evaluated too
+                if (m_numeric)
+                        value.m_exact = false;
+                break;
+        case EgcNodeType::VariableNode:
+                if (!getSymbol(static_cast<EgcVariableNode&>(node).getStuffedValue(), value))
+                        return false;
+                if (m_numeric)
+                        value.m_exact = false;
+                break;
+        case EgcNodeType::ParenthesisNode: {
+                EgcNode* child = getChild(node, 0);
+                if (!child || !evaluate(*child, value))
+                        return false;
+                break;
+        }
+        case EgcNodeType::UnaryMinusNode:
+        case EgcNodeType::LogNode:
+        case EgcNodeType::NatLogNode: {
+                EgcNode* child = getChild(node, 0);
+                if (!child || !evaluate(*child, value))
+                        return false;
+                return applyUnary(type, value);
+        }
+        case EgcNodeType::PlusNode:
+        case EgcNodeType::MinusNode:
+        case EgcNodeType::MultiplicationNode:
+        case EgcNodeType::DivisionNode:
+        case EgcNodeType::ExponentNode:
+        case EgcNodeType::RootNode: {
+                EgcNode* lhsNode = getChild(node, 0);
+                EgcNode* rhsNode = getChild(node, 1);
+                if (!lhsNode || !rhsNode)
+                        return false;
+                EgcNumericValue lhs;
+                EgcNumericValue rhs;
+                // a root without index is a square root
+                if (type == EgcNodeType::RootNode && lhsNode->getNodeType() == EgcNodeType::EmptyNode)
+                        lhs = EgcNumericValue(2.0L, true);
+                else if (!evaluate(*lhsNode, lhs))
+                        return false;
+                if (!evaluate(*rhsNode, rhs))
+                        return false;
+                return applyBinary(type, lhs, rhs, value);
+        }
+        case EgcNodeType::FunctionNode:
+                if (!evaluateFunction(static_cast<EgcFunctionNode&>(node), value))
+                        return false;
+                break;
+        case EgcNodeType::IntegralNode:
+                if (!evaluateIntegral(node, value))
+                        return false;
+                break;
+        default:
+                return false;
+        }
+
+        return checkValue(value);
+}
+
+bool EgcNumericEvaluator::evaluateIntegral(EgcNode& integral, EgcNumericValue& value) const
+{
+        // indefinite integrals are symbolic
+        if (!isDefiniteIntegral(integral))
+                return false;
+
+        // the children are the lower and upper bound, the integrand and the integration variable
+        EgcNode* lowerNode = getChild(integral, 0);
+        EgcNode* upperNode = getChild(integral, 1);
+        EgcNode* integrand = getChild(integral, 2);
+        EgcNode* variable = getChild(integral, 3);
+        if (!lowerNode || !upperNode || !integrand || !variable
+            || variable->getNodeType() != EgcNodeType::VariableNode)
+                return false;
+
+        EgcNumericValue lower;
+        EgcNumericValue upper;
+        if (!evaluate(*lowerNode, lower) || !evaluate(*upperNode, upper))
+                return false;
+
+        QVector<QString> parameters;
+        parameters.append(static_cast<EgcVariableNode*>(variable)->getStuffedValue());
+        EgcNumericProgram program;
+        if (!program.compile(parameters, integrand))
+                return false;
+
+        EgcNumericIntegrator integrator;
+        double result;
+        if (!integrator.integrate(program, static_cast<double>(lower.m_value), static_cast<double>(upper.m_value),
+                                  *this, result))
+                return false;
+        // the kernel calculates definite integrals numerically as well
+        value = EgcNumericValue(result, false);
+
+        return true;
+}
+
+bool EgcNumericEvaluator::evaluateFunction(EgcFunctionNode& fnc, EgcNumericValue& value) const
+{
+        QString name = fnc.getStuffedName();
+        if (m_userFunctions.contains(name)) {
+                QVector<EgcNumericValue> args;
+                for (quint32 i = 0; i < fnc.getNumberChildNodes(); i++) {
+                        EgcNode* arg = fnc.getChild(i);
+                        EgcNumericValue argValue;
+                        if (!arg || !evaluate(*arg, argValue))
+                                return false;
+                        args.append(argValue);
+                }
+                return callFunction(name, args, value);
+        }
+
+        EgcNumericFunction builtin = lookupFunction(name);
+        if (builtin == EgcNumericFunction::Undefined || fnc.getNumberChildNodes() != 1)
+                return false;
+        EgcNode* arg = fnc.getChild(0);
+        if (!arg || !evaluate(*arg, value))
+                return false;
+
+        return applyFunction(builtin, value);
+}
+
+bool EgcNumericEvaluator::parseNumber(const QString& number, EgcNumericValue& value)
+{
+        // big floats are left to the kernel
+        if (number.isEmpty() || number.contains(QLatin1Char('b')))
+                return false;
+
+        bool ok;
+        value.m_value = number.toDouble(&ok);
+        value.m_exact =    !number.contains(QLatin1Char('.')) && !number.contains(QLatin1Char('e'))
+                        && !number.contains(QLatin1Char('E'));
+
+        return ok;
+}
+
+EgcNumericFunction EgcNumericEvaluator::lookupFunction(const QString& name)
+{
+        static const QHash<QString, EgcNumericFunction> functions = {
+                {QStringLiteral("abs"), EgcNumericFunction::Abs},
+                {QStringLiteral("sqrt"), EgcNumericFunction::Sqrt},
+                {QStringLiteral("exp"), EgcNumericFunction::Exp},
+                {QStringLiteral("sin"), EgcNumericFunction::Sin},
+                {QStringLiteral("cos"), EgcNumericFunction::Cos},
+                {QStringLiteral("tan"), EgcNumericFunction::Tan},
+                {QStringLiteral("asin"), EgcNumericFunction::Asin},
+                {QStringLiteral("acos"), EgcNumericFunction::Acos},
+                {QStringLiteral("atan"), EgcNumericFunction::Atan},
+                {QStringLiteral("sinh"), EgcNumericFunction::Sinh},
+                {QStringLiteral("cosh"), EgcNumericFunction::Cosh},
+                {QStringLiteral("tanh"), EgcNumericFunction::Tanh}
+        };
+
+        return functions.value(name, EgcNumericFunction::Undefined);
+}
+
+bool EgcNumericEvaluator::applyFunction(EgcNumericFunction fnc, EgcNumericValue& value)
+{
+        long double x = value.m_value;
+        if (fnc == EgcNumericFunction::Abs) {
+                value.m_value = std::fabs(x);
+                return checkValue(value);
+        }
+        if (fnc == EgcNumericFunction::Sqrt && value.m_exact)
+                return exactRoot(x, 2.0L, value.m_value);
+
+        // all other functions of exact values stay symbolic in the kernel (e.g. sin(1))
+        if (value.m_exact)
+                return false;
+
+        switch (fnc) {
+        case EgcNumericFunction::Sqrt:
+                if (x < 0.0L)
+                        return false;
+                value.m_value = std::sqrt(x);
+                break;
+        case EgcNumericFunction::Exp:
+                value.m_value = std::exp(x);
+                break;
+        case EgcNumericFunction::Sin:
+                value.m_value = std::sin(x);
+                break;
+        case EgcNumericFunction::Cos:
+                value.m_value = std::cos(x);
+                break;
+        case EgcNumericFunction::Tan:
+                value.m_value = std::tan(x);
+                break;
+        case EgcNumericFunction::Asin:
+                if (std::fabs(x) > 1.0L)
+                        return false;
+                value.m_value = std::asin(x);
+                break;
+        case EgcNumericFunction::Acos:
+                if (std::fabs(x) > 1.0L)
+                        return false;
+                value.m_value = std::acos(x);
+                break;
+        case EgcNumericFunction::Atan:
+                value.m_value = std::atan(x);
+                break;
+        case EgcNumericFunction::Sinh:
+                value.m_value = std::sinh(x);
+                break;
+        case EgcNumericFunction::Cosh:
+                value.m_value = std::cosh(x);
+                break;
+        case EgcNumericFunction::Tanh:
+                value.m_value = std::tanh(x);
+                break;
+        default:
+                return false;
+        }
+
+        return checkValue(value);
+}
+
+bool EgcNumericEvaluator::applyUnary(EgcNodeType type, EgcNumericValue& value)
+{
+        switch (type) {
+        case EgcNodeType::UnaryMinusNode:
+                value.m_value = -value.m_value;
+                break;
+        case EgcNodeType::LogNode:
+        case EgcNodeType::NatLogNode:
+                // the kernel keeps logarithms of exact values symbolic
+                if (value.m_exact || value.m_value <= 0.0L)
+                        return false;
+                if (type == EgcNodeType::LogNode)
+                        value.m_value = std::log10(value.m_value);
+                else
+                        value.m_value = std::log(value.m_value);
+                break;
+        default:
+                return false;
+        }
+
+        return checkValue(value);
+}
+
+bool EgcNumericEvaluator::applyBinary(EgcNodeType type, const EgcNumericValue& lhs, const EgcNumericValue& rhs,
+                                      EgcNumericValue& value)
+{
+        bool exact = lhs.m_exact && rhs.m_exact;
+        value.m_exact = exact;
+
+        switch (type) {
+        case EgcNodeType::PlusNode:
+                value.m_value = lhs.m_value + rhs.m_value;
+                break;
+        case EgcNodeType::MinusNode:
+                value.m_value = lhs.m_value - rhs.m_value;
+                break;
+        case EgcNodeType::MultiplicationNode:
+                value.m_value = lhs.m_value * rhs.m_value;
+                break;
+        case EgcNodeType::DivisionNode:
+                if (rhs.m_value == 0.0L)
+                        return false;
+                // the kernel would return a rational number
+                if (exact && std::fmod(lhs.m_value, rhs.m_value) != 0.0L)
+                        return false;
+                value.m_value = lhs.m_value / rhs.m_value;
+                break;
+        case EgcNodeType::ExponentNode:
+                if (exact) {
+                        if (rhs.m_value < 0.0L || (lhs.m_value == 0.0L && rhs.m_value == 0.0L))
+                                return false;
+                        if (lhs.m_value == 0.0L || lhs.m_value == 1.0L) {
+                                value.m_value = (rhs.m_value == 0.0L) ? 1.0L : lhs.m_value;
+                        } else if (lhs.m_value == -1.0L) {
+                                value.m_value = (std::fmod(rhs.m_value, 2.0L) == 0.0L) ? 1.0L : -1.0L;
+                        } else {
+                                value.m_value = 1.0L;
+                                for (long double i = 0.0L; i < rhs.m_value; i += 1.0L) {
+                                        value.m_value *= lhs.m_value;
+                                        if (std::fabs(value.m_value) > s_maxExact)
+                                                return false;
+                                }
+                        }
+                } else {
+                        // negative bases with a fractional exponent result in complex numbers
+                        if (lhs.m_value < 0.0L && std::floor(rhs.m_value) != rhs.m_value)
+                                return false;
+                        if (lhs.m_value == 0.0L && rhs.m_value <= 0.0L)
+                                return false;
+                        value.m_value = std::pow(lhs.m_value, rhs.m_value);
+                }
+                break;
+        case EgcNodeType::RootNode: // lhs is the index, rhs the radicand
+                if (lhs.m_value == 0.0L || rhs.m_value < 0.0L)
+                        return false;
+                if (exact) {
+                        // roots that are not integers stay symbolic in the kernel
+                        if (!exactRoot(rhs.m_value, lhs.m_value, value.m_value))
+                                return false;
+                } else {
+                        value.m_value = std::pow(rhs.m_value, 1.0L / lhs.m_value);
+                }
+                break;
+        default:
+                return false;
+        }
+
+        return checkValue(value);
+}
+
+bool EgcNumericEvaluator::checkValue(const EgcNumericValue& value)
+{
+        if (!std::isfinite(value.m_value))
+                return false;
+        if (value.m_exact && std::fabs(value.m_value) > s_maxExact)
+                return false;
+
+        return true;
+}
+
+QString EgcNumericEvaluator::toKernelString(const EgcNumericValue& value, bool numeric)
+{
+        double result = static_cast<double>(value.m_value);
+        if (value.m_exact && !numeric)
+                return QString::number(static_cast<qint64>(result));
+
+        QString str = QString::number(result, 'g', 16);
+        QString mantissa = str;
+        QString exponent;
+        int e = str.indexOf(QLatin1Char('e'));
+        if (e >= 0) {
+                mantissa = str.left(e);
+                int exp = str.mid(e + 1).toInt();
+                exponent = QString("e") % ((exp < 0) ? QString("-") : QString("+")) % QString::number(qAbs(exp));
+        }
+        if (!mantissa.contains(QLatin1Char('.')))
+                mantissa += QLatin1String(".0");
+
+        return mantissa + exponent;
+}
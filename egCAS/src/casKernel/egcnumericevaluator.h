@@ -0,0 +1,243 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCNUMERICEVALUATOR_H
+#define EGCNUMERICEVALUATOR_H
+
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QSharedPointer>
+
+class EgcNode;
+class EgcFormulaEntity;
+class EgcFunctionNode;
+class EgcNumericProgram;
+enum class EgcNodeType;
+
+/**
+ * @brief The EgcNumericValue class holds a value calculated by the numeric evaluator
+ */
+class EgcNumericValue
+{
+public:
+        EgcNumericValue() : m_value{0.0L}, m_exact{true} {}
+        EgcNumericValue(long double value, bool exact) : m_value{value}, m_exact{exact} {}
+
+        long double m_value;    ///< the value (calculated with extended precision if available)
+        bool m_exact;           ///< true if the value is an exact integer, false if it is a floating point number
+};
+
+/**
+ * @brief The EgcNumericFunction enum lists the builtin functions the numeric evaluator knows about
+ */
+enum class EgcNumericFunction : quint8
+{
+        Abs = 0, Sqrt, Exp, Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh, Undefined
+};
+
+/**
+ * @brief The EgcNumericEvaluator class evaluates purely numeric formulas without the CAS kernel. Only formulas where
+ * the result of the kernel would be a plain number are evaluated (floating point values or exact integers), everything
+ * else (symbolic expressions, rationals, irrational exact values like sqrt(2)) is left to the CAS kernel. In numeric
+ * mode (see setNumeric) rationals and irrational values are evaluated as floating point numbers as well.
+ */
+class EgcNumericEvaluator
+{
+public:
+        ///std constructor
+        EgcNumericEvaluator();
+        ///destructor
+        ~EgcNumericEvaluator();
+        /**
+         * @brief calculate calculates the result of the given result formula natively
+         * @param formula the formula to calculate (must be a result formula)
+         * @param result the result in the same format as the CAS kernel returns it
+         * @return true if the formula could be calculated, false if it must be calculated by the CAS kernel
+         */
+        bool calculate(EgcFormulaEntity& formula, QString& result);
+        /**
+         * @brief define records the value of the given definition, so that formulas using the symbol can be
+         * calculated natively. If the definition is not numeric, the symbol is removed from the known symbols.
+         * Function definitions are compiled into a numeric program (if possible).
+         * @param formula the definition to record
+         * @return true if the defined value is numeric or the defined function could be compiled, false otherwise
+         */
+        bool define(EgcFormulaEntity& formula);
+        /**
+         * @brief getDefinitionCommand returns a kernel command that defines the variable of the given definition with
+         * its natively calculated value. This is only done for definitions with definite integrals, since the kernel
+         * calculates them much slower (romberg).
+         * @param formula the definition (must have been recorded with define before)
+         * @param command the kernel command
+         * @return true if the command has been created, false if the kernel command of the formula must be used
+         */
+        bool getDefinitionCommand(EgcFormulaEntity& formula, QString& command) const;
+        /**
+         * @brief undefine removes the given symbol from the known symbols (e.g. if the definition has been deleted)
+         * @param symbol the symbol to remove
+         */
+        void undefine(const QString& symbol);
+        /**
+         * @brief clear removes all known symbols (e.g. if the kernel has been reset). Compiled functions stay in the
+         * cache, so that unchanged functions don't need to be compiled again.
+         */
+        void clear(void);
+        /**
+         * @brief copySymbols copies all known symbols and compiled functions of the given evaluator, e.g. to keep the
+         * definitions that are valid at a certain position of the document
+         * @param other the evaluator to copy the symbols from
+         */
+        void copySymbols(const EgcNumericEvaluator& other);
+        /**
+         * @brief setNumeric if set, all values are evaluated as floating point numbers (like float(...) of the kernel
+         * does), so rationals and irrational values like sqrt(2) can be evaluated too, e.g. for formatting results
+         * @param numeric true if exact values shall be treated as floating point numbers, false otherwise (default)
+         */
+        void setNumeric(bool numeric);
+        /**
+         * @brief evaluate evaluates the given tree
+         * @param node the root of the tree to evaluate
+         * @param value the value of the tree
+         * @return true if the tree could be evaluated, false otherwise
+         */
+        bool evaluate(EgcNode& node, EgcNumericValue& value) const;
+        /**
+         * @brief getSymbol returns the numeric value of the given variable
+         * @param symbol the variable to look up
+         * @param value the value of the variable
+         * @return true if the variable has a numeric value, false otherwise
+         */
+        bool getSymbol(const QString& symbol, EgcNumericValue& value) const;
+        /**
+         * @brief callFunction calls the compiled user function with the given arguments (e.g. for parameter sweeps)
+         * @param name the name of the function
+         * @param args the arguments of the function call
+         * @param result the result of the function call
+         * @param depth the current call depth (to stop recursive functions)
+         * @return true if the function could be evaluated, false otherwise
+         */
+        bool callFunction(const QString& name, const QVector<EgcNumericValue>& args, EgcNumericValue& result,
+                          int depth = 0) const;
+        /**
+         * @brief getFunction returns the compiled program of the given user function
+         * @param name the name of the function
+         * @return the compiled function, or a nullptr if there is no such compiled function
+         */
+        const EgcNumericProgram* getFunction(const QString& name) const;
+        /**
+         * @brief toKernelString converts the value into the format the CAS kernel uses for numbers
+         * @param value the value to convert
+         * @param numeric if true the value is always converted as floating point number (like float(...) does)
+         * @return the value as string
+         */
+        static QString toKernelString(const EgcNumericValue& value, bool numeric = false);
+        /**
+         * @brief parseNumber parses the given number (as it is saved in a number node)
+         * @param number the number to parse
+         * @param value the value of the number
+         * @return true if the number could be parsed, false otherwise (e.g. for big floats)
+         */
+        static bool parseNumber(const QString& number, EgcNumericValue& value);
+        /**
+         * @brief lookupFunction returns the builtin function with the given name
+         * @param name the (stuffed) name of the function
+         * @return the function or EgcNumericFunction::Undefined if there is no such builtin function
+         */
+        static EgcNumericFunction lookupFunction(const QString& name);
+        /**
+         * @brief applyFunction applies the builtin function to the value
+         * @param fnc the function to apply
+         * @param value the argument of the function, contains the result afterwards
+         * @return true if the function could be applied, false otherwise
+         */
+        static bool applyFunction(EgcNumericFunction fnc, EgcNumericValue& value);
+        /**
+         * @brief applyUnary applies the unary operation to the value (unary minus, log and natural log nodes)
+         * @param type the node type of the operation
+         * @param value the operand, contains the result afterwards
+         * @return true if the operation could be applied, false otherwise
+         */
+        static bool applyUnary(EgcNodeType type, EgcNumericValue& value);
+        /**
+         * @brief applyBinary applies the binary operation (plus, minus, multiplication, division, exponent and root
+         * nodes) to the operands
+         * @param type the node type of the operation
+         * @param lhs the left operand (the index for roots)
+         * @param rhs the right operand (the radicand for roots)
+         * @param value the result of the operation
+         * @return true if the operation could be applied, false otherwise
+         */
+        static bool applyBinary(EgcNodeType type, const EgcNumericValue& lhs, const EgcNumericValue& rhs,
+                                EgcNumericValue& value);
+        /**
+         * @brief checkValue checks that the value is finite and exact values are still representable as double
+         * @param value the value to check
+         * @return true if the value is valid, false otherwise
+         */
+        static bool checkValue(const EgcNumericValue& value);
+
+        static const int s_maxCallDepth = 64;           ///< maximum depth of nested user function calls
+
+private:
+        Q_DISABLE_COPY(EgcNumericEvaluator)
+        /**
+         * @brief evaluateFunction evaluates the function call given
+         * @param fnc the function node to evaluate
+         * @param value the value of the function
+         * @return true if the function could be evaluated, false otherwise
+         */
+        bool evaluateFunction(EgcFunctionNode& fnc, EgcNumericValue& value) const;
+        /**
+         * @brief evaluateIntegral evaluates a definite integral with the native integrator (integrand and bounds must
+         * be numeric, the result must reach the tolerance of the integrator)
+         * @param integral the integral node to evaluate
+         * @param value the value of the integral
+         * @return true if the integral could be evaluated, false otherwise
+         */
+        bool evaluateIntegral(EgcNode& integral, EgcNumericValue& value) const;
+        /**
+         * @brief defineFunction compiles the given function definition (or takes it from the cache)
+         * @param formula the function definition
+         * @param name the name of the function
+         * @return true if the function could be compiled, false otherwise
+         */
+        bool defineFunction(EgcFormulaEntity& formula, const QString& name);
+
+        QHash<QString, EgcNumericValue> m_symbols;      ///< the numeric values of all defined variables
+        bool m_numeric;                                 ///< true if all values are treated as floating point numbers
+        QSet<QString> m_userFunctions;                  ///< all user defined functions (these hide builtin functions)
+        QHash<QString, QSharedPointer<EgcNumericProgram> > m_functions; ///< compiled user functions
+        QHash<QString, QSharedPointer<EgcNumericProgram> > m_programCache; ///< compiled programs of all function versions
+        static const long double s_maxExact;            ///< maximum magnitude of an exact integer value
+        static const int s_maxCachedPrograms = 512;     ///< maximum number of cached function versions
+};
+
+#endif // EGCNUMERICEVALUATOR_H
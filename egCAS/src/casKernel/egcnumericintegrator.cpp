@@ -0,0 +1,194 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <algorithm>
+#include "egcnumericintegrator.h"
+#include "egcnumericprogram.h"
+#include "egcnumericevaluator.h"
+
+/// number of points of the Kronrod rule
+static const int s_points = 15;
+
+/// abscissae of the 15 point Kronrod rule (the odd ones are the abscissae of the 7 point Gauss rule)
+static const double s_xgk[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+
+/// weights of the 15 point Kronrod rule
+static const double s_wgk[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+
+/// weights of the 7 point Gauss rule
+static const double s_wg[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+EgcNumericIntegrator::EgcNumericIntegrator() : m_absTolerance{1e-12}, m_relTolerance{1e-10}, m_error{0.0},
+        m_evaluations{0}
+{
+}
+
+void EgcNumericIntegrator::setTolerance(double absolute, double relative)
+{
+        m_absTolerance = absolute;
+        m_relTolerance = relative;
+}
+
+double EgcNumericIntegrator::getErrorEstimate(void) const
+{
+        return m_error;
+}
+
+int EgcNumericIntegrator::getNumberOfEvaluations(void) const
+{
+        return m_evaluations;
+}
+
+bool EgcNumericIntegrator::evaluate(const EgcNumericProgram& integrand, const EgcNumericEvaluator& evaluator,
+                                    QVector<Interval>& intervals)
+{
+        int count = intervals.size() * s_points;
+        QVector<double> x(count);
+        QVector<double> y(count);
+
+        // the points of an interval: the lower points, the upper points and the center
+        for (int i = 0; i < intervals.size(); i++) {
+                const Interval& interval = intervals.at(i);
+                double center = 0.5 * (interval.m_lower + interval.m_upper);
+                double halfLength = 0.5 * (interval.m_upper - interval.m_lower);
+                double* points = x.data() + i * s_points;
+                for (int j = 0; j < 7; j++) {
+                        points[j] = center - halfLength * s_xgk[j];
+                        points[j + 7] = center + halfLength * s_xgk[j];
+                }
+                points[14] = center;
+        }
+
+        QVector<const double*> args;
+        args.append(x.constData());
+        m_evaluations += count;
+        if (!integrand.runBatch(args, count, evaluator, y.data()))
+                return false;
+
+        for (int i = 0; i < intervals.size(); i++) {
+                Interval& interval = intervals[i];
+                const double* values = y.constData() + i * s_points;
+                double kronrod = s_wgk[7] * values[14];
+                double gauss = s_wg[3] * values[14];
+                for (int j = 0; j < 7; j++) {
+                        double sum = values[j] + values[j + 7];
+                        kronrod += s_wgk[j] * sum;
+                        if (j % 2 == 1)
+                                gauss += s_wg[j / 2] * sum;
+                }
+                // NaN values are points where the integrand is not defined
+                if (!std::isfinite(kronrod))
+                        return false;
+                double halfLength = 0.5 * (interval.m_upper - interval.m_lower);
+                interval.m_integral = kronrod * halfLength;
+                interval.m_error = std::fabs((kronrod - gauss) * halfLength);
+        }
+
+        return true;
+}
+
+bool EgcNumericIntegrator::integrate(const EgcNumericProgram& integrand, double lower, double upper,
+                                     const EgcNumericEvaluator& evaluator, double& result)
+{
+        m_error = 0.0;
+        m_evaluations = 0;
+        if (!std::isfinite(lower) || !std::isfinite(upper) || integrand.getNumberOfArguments() != 1)
+                return false;
+        if (lower == upper) {
+                result = 0.0;
+                return true;
+        }
+
+        double sign = 1.0;
+        if (lower > upper) {
+                std::swap(lower, upper);
+                sign = -1.0;
+        }
+
+        QVector<Interval> intervals(1);
+        intervals[0].m_lower = lower;
+        intervals[0].m_upper = upper;
+        if (!evaluate(integrand, evaluator, intervals))
+                return false;
+
+        QVector<Interval> bisected;
+        while (true) {
+                double integral = 0.0;
+                double error = 0.0;
+                foreach (const Interval& interval, intervals) {
+                        integral += interval.m_integral;
+                        error += interval.m_error;
+                }
+                m_error = error;
+                if (error <= m_absTolerance || error <= m_relTolerance * std::fabs(integral)) {
+                        result = sign * integral;
+                        return true;
+                }
+                if (intervals.size() + s_batchIntervals > s_maxIntervals)
+                        return false;
+
+                // bisect the intervals with the biggest errors at once, so the integrand is evaluated in one batch
+                std::sort(intervals.begin(), intervals.end(), [](const Interval& a, const Interval& b) {
+                        return a.m_error > b.m_error;
+                });
+                int count = qMin(intervals.size(), static_cast<int>(s_batchIntervals));
+                bisected.resize(2 * count);
+                for (int i = 0; i < count; i++) {
+                        const Interval& interval = intervals.at(i);
+                        double center = 0.5 * (interval.m_lower + interval.m_upper);
+                        // the interval cannot be bisected any more (e.g. at a singularity)
+                        if (!(center > interval.m_lower && center < interval.m_upper))
+                                return false;
+                        bisected[2 * i].m_lower = interval.m_lower;
+                        bisected[2 * i].m_upper = center;
+                        bisected[2 * i + 1].m_lower = center;
+                        bisected[2 * i + 1].m_upper = interval.m_upper;
+                }
+                if (!evaluate(integrand, evaluator, bisected))
+                        return false;
+                for (int i = 0; i < count; i++) {
+                        intervals[i] = bisected.at(2 * i);
+                        intervals.append(bisected.at(2 * i + 1));
+                }
+        }
+}
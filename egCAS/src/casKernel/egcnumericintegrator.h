@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCNUMERICINTEGRATOR_H
+#define EGCNUMERICINTEGRATOR_H
+
+#include <QVector>
+
+class EgcNumericProgram;
+class EgcNumericEvaluator;
+
+/**
+ * @brief The EgcNumericIntegrator class calculates definite integrals natively with an adaptive Gauss-Kronrod rule
+ * (7 point Gauss, 15 point Kronrod). The intervals with the biggest error are bisected until the error estimate is
+ * below the tolerance. The integrand is evaluated with the batch interpreter of the numeric program, all points of
+ * several intervals at once.
+ */
+class EgcNumericIntegrator
+{
+public:
+        ///std constructor
+        EgcNumericIntegrator();
+        /**
+         * @brief setTolerance set the tolerance the integral must be calculated with
+         * @param absolute the absolute tolerance
+         * @param relative the tolerance relative to the value of the integral
+         */
+        void setTolerance(double absolute, double relative);
+        /**
+         * @brief integrate calculates the definite integral of the given integrand
+         * @param integrand the integrand compiled as function of the integration variable
+         * @param lower the lower bound of the integral
+         * @param upper the upper bound of the integral
+         * @param evaluator the evaluator used to look up global variables and user functions
+         * @param result the value of the integral
+         * @return true if the integral could be calculated with the requested tolerance, false otherwise (e.g. for
+         * singularities or integrands that need too many intervals)
+         */
+        bool integrate(const EgcNumericProgram& integrand, double lower, double upper,
+                       const EgcNumericEvaluator& evaluator, double& result);
+        /**
+         * @brief getErrorEstimate returns the estimated absolute error of the last integral calculated
+         * @return the error estimate
+         */
+        double getErrorEstimate(void) const;
+        /**
+         * @brief getNumberOfEvaluations returns the number of integrand evaluations of the last integral calculated
+         * @return the number of evaluations
+         */
+        int getNumberOfEvaluations(void) const;
+
+        static const int s_maxIntervals = 2000;         ///< maximum number of intervals of an integral
+        static const int s_batchIntervals = 8;          ///< number of intervals that are bisected at once
+
+private:
+        /**
+         * @brief The Interval struct is a part of the integration range with the integral and error over this part
+         */
+        struct Interval {
+                double m_lower;                         ///< lower bound of the interval
+                double m_upper;                         ///< upper bound of the interval
+                double m_integral;                      ///< Kronrod result of the interval
+                double m_error;                         ///< error estimate of the interval
+        };
+
+        /**
+         * @brief evaluate applies the Gauss-Kronrod rule to the given intervals
+         * @param integrand the integrand to integrate
+         * @param evaluator the evaluator used to look up global variables and user functions
+         * @param intervals the intervals to evaluate, the integrals and errors are set afterwards
+         * @return true if the integrand could be evaluated at all points, false otherwise
+         */
+        bool evaluate(const EgcNumericProgram& integrand, const EgcNumericEvaluator& evaluator,
+                      QVector<Interval>& intervals);
+
+        double m_absTolerance;                          ///< absolute tolerance
+        double m_relTolerance;                          ///< relative tolerance
+        double m_error;                                 ///< error estimate of the last integral
+        int m_evaluations;                              ///< number of integrand evaluations of the last integral
+};
+
+#endif // EGCNUMERICINTEGRATOR_H
@@ -0,0 +1,522 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <limits>
+#include <QVarLengthArray>
+#include "egcnumericprogram.h"
+#include "egcnodes.h"
+
+EgcNumericProgram::EgcNumericProgram() : m_maxStack{0}, m_stack{0}
+{
+}
+
+bool EgcNumericProgram::compile(EgcNode& function, EgcNode* body)
+{
+        if (function.getNodeType() != EgcNodeType::FunctionNode) {
+                m_code.clear();
+                return false;
+        }
+
+        QVector<QString> parameters;
+        EgcFunctionNode& fnc = static_cast<EgcFunctionNode&>(function);
+        for (quint32 i = 0; i < fnc.getNumberChildNodes(); i++) {
+                EgcNode* param = fnc.getChild(i);
+                if (!param || param->getNodeType() != EgcNodeType::VariableNode) {
+                        m_code.clear();
+                        return false;
+                }
+                parameters.append(static_cast<EgcVariableNode*>(param)->getStuffedValue());
+        }
+
+        return compile(parameters, body);
+}
+
+bool EgcNumericProgram::compile(const QVector<QString>& parameters, EgcNode* body)
+{
+        m_code.clear();
+        m_constants.clear();
+        m_symbols.clear();
+        m_parameters.clear();
+        m_maxStack = 0;
+        m_stack = 0;
+
+        if (!body)
+                return false;
+
+        foreach (QString name, parameters) {
+                if (name.isEmpty() || m_parameters.contains(name))
+                        return false;
+                m_parameters.append(name);
+        }
+
+        if (!compileNode(*body) || m_stack != 1) {
+                m_code.clear();
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcNumericProgram::compileNode(EgcNode& node)
+{
+        EgcNodeType type = node.getNodeType();
+
+        switch (type) {
+        case EgcNodeType::NumberNode: {
+                EgcNumericValue value;
+                if (!EgcNumericEvaluator::parseNumber(static_cast<EgcNumberNode&>(node).getValue(), value))
+                        return false;
+                if (!EgcNumericEvaluator::checkValue(value))
+                        return false;
+                return pushConstant(value);
+        }
+        case EgcNodeType::VariableNode: {
+                QString name = static_cast<EgcVariableNode&>(node).getStuffedValue();
+                int param = m_parameters.indexOf(name);
+                if (param >= 0)
+                        m_code.append(EgcNumericInstruction(EgcNumericOpCode::PushArgument, param));
+                else
+                        m_code.append(EgcNumericInstruction(EgcNumericOpCode::PushSymbol, addSymbol(name)));
+                m_stack++;
+                m_maxStack = qMax(m_maxStack, m_stack);
+                return true;
+        }
+        case EgcNodeType::ParenthesisNode: {
+                EgcNode* child = static_cast<EgcContainerNode&>(node).getChild(0);
+                return child && compileNode(*child);
+        }
+        case EgcNodeType::UnaryMinusNode:
+        case EgcNodeType::LogNode:
+        case EgcNodeType::NatLogNode: {
+                EgcNode* child = static_cast<EgcContainerNode&>(node).getChild(0);
+                int start = m_code.size();
+                if (!child || !compileNode(*child))
+                        return false;
+                if (m_code.size() == start + 1 && isConstant(start)) {
+                        EgcNumericValue value = m_constants.at(m_code.at(start).m_index);
+                        // a constant that cannot be calculated will fail at every call
+                        if (!EgcNumericEvaluator::applyUnary(type, value))
+                                return false;
+                        return fold(start, 1, value);
+                }
+                m_code.append(EgcNumericInstruction(EgcNumericOpCode::Unary, static_cast<quint16>(type)));
+                return true;
+        }
+        case EgcNodeType::PlusNode:
+        case EgcNodeType::MinusNode:
+        case EgcNodeType::MultiplicationNode:
+        case EgcNodeType::DivisionNode:
+        case EgcNodeType::ExponentNode:
+        case EgcNodeType::RootNode: {
+                EgcContainerNode& container = static_cast<EgcContainerNode&>(node);
+                EgcNode* lhs = container.getChild(0);
+                EgcNode* rhs = container.getChild(1);
+                if (!lhs || !rhs)
+                        return false;
+                int start = m_code.size();
+                // a root without index is a square root
+                if (type == EgcNodeType::RootNode && lhs->getNodeType() == EgcNodeType::EmptyNode) {
+                        if (!pushConstant(EgcNumericValue(2.0L, true)))
+                                return false;
+                } else if (!compileNode(*lhs)) {
+                        return false;
+                }
+                int mid = m_code.size();
+                if (!compileNode(*rhs))
+                        return false;
+                if (mid == start + 1 && m_code.size() == mid + 1 && isConstant(start) && isConstant(mid)) {
+                        EgcNumericValue value;
+                        if (!EgcNumericEvaluator::applyBinary(type, m_constants.at(m_code.at(start).m_index),
+                                                              m_constants.at(m_code.at(mid).m_index), value))
+                                return false;
+                        return fold(start, 2, value);
+                }
+                m_code.append(EgcNumericInstruction(EgcNumericOpCode::Binary, static_cast<quint16>(type)));
+                m_stack--;
+                return true;
+        }
+        case EgcNodeType::FunctionNode: {
+                EgcFunctionNode& fnc = static_cast<EgcFunctionNode&>(node);
+                QString name = fnc.getStuffedName();
+                quint32 nrArgs = fnc.getNumberChildNodes();
+                EgcNumericFunction builtin = EgcNumericEvaluator::lookupFunction(name);
+                int start = m_code.size();
+                for (quint32 i = 0; i < nrArgs; i++) {
+                        EgcNode* arg = fnc.getChild(i);
+                        if (!arg || !compileNode(*arg))
+                                return false;
+                }
+                if (builtin != EgcNumericFunction::Undefined && nrArgs == 1) {
+                        if (m_code.size() == start + 1 && isConstant(start)) {
+                                EgcNumericValue value = m_constants.at(m_code.at(start).m_index);
+                                if (!EgcNumericEvaluator::applyFunction(builtin, value))
+                                        return false;
+                                return fold(start, 1, value);
+                        }
+                        m_code.append(EgcNumericInstruction(EgcNumericOpCode::CallBuiltin,
+                                                            static_cast<quint16>(builtin)));
+                        return true;
+                }
+                // other user functions are looked up at runtime (like the kernel does)
+                if (nrArgs == 0 || nrArgs > 0xFF)
+                        return false;
+                m_code.append(EgcNumericInstruction(EgcNumericOpCode::CallUser, addSymbol(name),
+                                                    static_cast<quint8>(nrArgs)));
+                m_stack -= nrArgs - 1;
+                return true;
+        }
+        default:
+                return false;
+        }
+}
+
+bool EgcNumericProgram::pushConstant(const EgcNumericValue& value)
+{
+        if (m_constants.size() >= s_maxIndex)
+                return false;
+
+        m_code.append(EgcNumericInstruction(EgcNumericOpCode::PushConstant, m_constants.size()));
+        m_constants.append(value);
+        m_stack++;
+        m_maxStack = qMax(m_maxStack, m_stack);
+
+        return true;
+}
+
+bool EgcNumericProgram::isConstant(int pos) const
+{
+        return m_code.at(pos).m_op == EgcNumericOpCode::PushConstant;
+}
+
+bool EgcNumericProgram::fold(int start, int operands, const EgcNumericValue& value)
+{
+        // the constants of the folded instructions are the last ones in the constant table
+        m_constants.resize(m_code.at(start).m_index);
+        m_code.resize(start);
+        m_stack -= operands;
+
+        return pushConstant(value);
+}
+
+int EgcNumericProgram::addSymbol(const QString& symbol)
+{
+        int index = m_symbols.indexOf(symbol);
+        if (index >= 0)
+                return index;
+
+        m_symbols.append(symbol);
+
+        return m_symbols.size() - 1;
+}
+
+bool EgcNumericProgram::run(const QVector<EgcNumericValue>& args, const EgcNumericEvaluator& evaluator,
+                            EgcNumericValue& result, int depth) const
+{
+        if (args.size() != m_parameters.size() || m_code.isEmpty())
+                return false;
+
+        QVarLengthArray<EgcNumericValue, 32> stack(m_maxStack);
+        int sp = 0;
+        int size = m_code.size();
+        for (int pc = 0; pc < size; pc++) {
+                const EgcNumericInstruction& instr = m_code.at(pc);
+                switch (instr.m_op) {
+                case EgcNumericOpCode::PushConstant:
+                        stack[sp++] = m_constants.at(instr.m_index);
+                        break;
+                case EgcNumericOpCode::PushArgument:
+                        stack[sp++] = args.at(instr.m_index);
+                        break;
+                case EgcNumericOpCode::PushSymbol:
+                        if (!evaluator.getSymbol(m_symbols.at(instr.m_index), stack[sp]))
+                                return false;
+                        sp++;
+                        break;
+                case EgcNumericOpCode::Unary:
+                        if (!EgcNumericEvaluator::applyUnary(static_cast<EgcNodeType>(instr.m_index), stack[sp - 1]))
+                                return false;
+                        break;
+                case EgcNumericOpCode::Binary: {
+                        EgcNumericValue value;
+                        sp--;
+                        if (!EgcNumericEvaluator::applyBinary(static_cast<EgcNodeType>(instr.m_index), stack[sp - 1],
+                                                              stack[sp], value))
+                                return false;
+                        stack[sp - 1] = value;
+                        break;
+                }
+                case EgcNumericOpCode::CallBuiltin:
+                        if (!EgcNumericEvaluator::applyFunction(static_cast<EgcNumericFunction>(instr.m_index),
+                                                                stack[sp - 1]))
+                                return false;
+                        break;
+                case EgcNumericOpCode::CallUser: {
+                        QVector<EgcNumericValue> callArgs;
+                        callArgs.reserve(instr.m_nrArgs);
+                        sp -= instr.m_nrArgs;
+                        for (int i = 0; i < instr.m_nrArgs; i++)
+                                callArgs.append(stack[sp + i]);
+                        if (!evaluator.callFunction(m_symbols.at(instr.m_index), callArgs, stack[sp], depth))
+                                return false;
+                        sp++;
+                        break;
+                }
+                }
+        }
+
+        if (sp != 1)
+                return false;
+        result = stack[0];
+
+        return true;
+}
+
+bool EgcNumericProgram::runBatch(const QVector<const double*>& args, int count, const EgcNumericEvaluator& evaluator,
+                                 double* result, int depth) const
+{
+        if (args.size() != m_parameters.size() || m_code.isEmpty() || count < 0)
+                return false;
+
+        QVector<const double*> blockArgs(args.size());
+        for (int offset = 0; offset < count; offset += s_blockSize) {
+                int n = count - offset;
+                if (n > s_blockSize)
+                        n = s_blockSize;
+                for (int i = 0; i < args.size(); i++)
+                        blockArgs[i] = args.at(i) + offset;
+                if (!runBlock(blockArgs, n, evaluator, result + offset, depth))
+                        return false;
+        }
+
+        return true;
+}
+
+bool EgcNumericProgram::runBlock(const QVector<const double*>& args, int count, const EgcNumericEvaluator& evaluator,
+                                 double* result, int depth) const
+{
+        if (args.size() != m_parameters.size() || m_code.isEmpty() || count > s_blockSize)
+                return false;
+        if (depth >= EgcNumericEvaluator::s_maxCallDepth)
+                return false;
+
+        // every stack entry is a whole block of values
+        QVarLengthArray<double, 8 * s_blockSize> stack(m_maxStack * s_blockSize);
+        double* base = stack.data();
+        int sp = 0;
+        int size = m_code.size();
+        for (int pc = 0; pc < size; pc++) {
+                const EgcNumericInstruction& instr = m_code.at(pc);
+                double* top = base + sp * s_blockSize;
+                switch (instr.m_op) {
+                case EgcNumericOpCode::PushConstant: {
+                        double value = static_cast<double>(m_constants.at(instr.m_index).m_value);
+                        for (int i = 0; i < count; i++)
+                                top[i] = value;
+                        sp++;
+                        break;
+                }
+                case EgcNumericOpCode::PushArgument: {
+                        const double* arg = args.at(instr.m_index);
+                        for (int i = 0; i < count; i++)
+                                top[i] = arg[i];
+                        sp++;
+                        break;
+                }
+                case EgcNumericOpCode::PushSymbol: {
+                        EgcNumericValue symbol;
+                        if (!evaluator.getSymbol(m_symbols.at(instr.m_index), symbol))
+                                return false;
+                        double value = static_cast<double>(symbol.m_value);
+                        for (int i = 0; i < count; i++)
+                                top[i] = value;
+                        sp++;
+                        break;
+                }
+                case EgcNumericOpCode::Unary:
+                        if (!applyUnary(static_cast<EgcNodeType>(instr.m_index), top - s_blockSize, count))
+                                return false;
+                        break;
+                case EgcNumericOpCode::Binary:
+                        sp--;
+                        if (!applyBinary(static_cast<EgcNodeType>(instr.m_index), top - 2 * s_blockSize,
+                                         top - s_blockSize, count))
+                                return false;
+                        break;
+                case EgcNumericOpCode::CallBuiltin:
+                        if (!applyFunction(static_cast<EgcNumericFunction>(instr.m_index), top - s_blockSize, count))
+                                return false;
+                        break;
+                case EgcNumericOpCode::CallUser: {
+                        const EgcNumericProgram* function = evaluator.getFunction(m_symbols.at(instr.m_index));
+                        if (!function)
+                                return false;
+                        sp -= instr.m_nrArgs;
+                        QVector<const double*> callArgs(instr.m_nrArgs);
+                        for (int i = 0; i < instr.m_nrArgs; i++)
+                                callArgs[i] = base + (sp + i) * s_blockSize;
+                        QVarLengthArray<double, s_blockSize> values(count);
+                        if (!function->runBlock(callArgs, count, evaluator, values.data(), depth + 1))
+                                return false;
+                        double* target = base + sp * s_blockSize;
+                        for (int i = 0; i < count; i++)
+                                target[i] = values[i];
+                        sp++;
+                        break;
+                }
+                }
+        }
+
+        if (sp != 1)
+                return false;
+
+        // infinite values are gaps as well (e.g. division by zero)
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (int i = 0; i < count; i++)
+                result[i] = std::isfinite(base[i]) ? base[i] : nan;
+
+        return true;
+}
+
+bool EgcNumericProgram::applyUnary(EgcNodeType type, double* values, int count)
+{
+        switch (type) {
+        case EgcNodeType::UnaryMinusNode:
+                for (int i = 0; i < count; i++)
+                        values[i] = -values[i];
+                break;
+        case EgcNodeType::LogNode:
+                for (int i = 0; i < count; i++)
+                        values[i] = std::log10(values[i]);
+                break;
+        case EgcNodeType::NatLogNode:
+                for (int i = 0; i < count; i++)
+                        values[i] = std::log(values[i]);
+                break;
+        default:
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcNumericProgram::applyBinary(EgcNodeType type, double* lhs, const double* rhs, int count)
+{
+        switch (type) {
+        case EgcNodeType::PlusNode:
+                for (int i = 0; i < count; i++)
+                        lhs[i] += rhs[i];
+                break;
+        case EgcNodeType::MinusNode:
+                for (int i = 0; i < count; i++)
+                        lhs[i] -= rhs[i];
+                break;
+        case EgcNodeType::MultiplicationNode:
+                for (int i = 0; i < count; i++)
+                        lhs[i] *= rhs[i];
+                break;
+        case EgcNodeType::DivisionNode:
+                for (int i = 0; i < count; i++)
+                        lhs[i] /= rhs[i];
+                break;
+        case EgcNodeType::ExponentNode:
+                for (int i = 0; i < count; i++)
+                        lhs[i] = std::pow(lhs[i], rhs[i]);
+                break;
+        case EgcNodeType::RootNode: // lhs is the index, rhs the radicand
+                for (int i = 0; i < count; i++)
+                        lhs[i] = std::pow(rhs[i], 1.0 / lhs[i]);
+                break;
+        default:
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcNumericProgram::applyFunction(EgcNumericFunction fnc, double* values, int count)
+{
+        double (*function)(double);
+
+        switch (fnc) {
+        case EgcNumericFunction::Abs:
+                function = std::fabs;
+                break;
+        case EgcNumericFunction::Sqrt:
+                function = std::sqrt;
+                break;
+        case EgcNumericFunction::Exp:
+                function = std::exp;
+                break;
+        case EgcNumericFunction::Sin:
+                function = std::sin;
+                break;
+        case EgcNumericFunction::Cos:
+                function = std::cos;
+                break;
+        case EgcNumericFunction::Tan:
+                function = std::tan;
+                break;
+        case EgcNumericFunction::Asin:
+                function = std::asin;
+                break;
+        case EgcNumericFunction::Acos:
+                function = std::acos;
+                break;
+        case EgcNumericFunction::Atan:
+                function = std::atan;
+                break;
+        case EgcNumericFunction::Sinh:
+                function = std::sinh;
+                break;
+        case EgcNumericFunction::Cosh:
+                function = std::cosh;
+                break;
+        case EgcNumericFunction::Tanh:
+                function = std::tanh;
+                break;
+        default:
+                return false;
+        }
+
+        for (int i = 0; i < count; i++)
+                values[i] = function(values[i]);
+
+        return true;
+}
+
+int EgcNumericProgram::getNumberOfArguments(void) const
+{
+        return m_parameters.size();
+}
+
+int EgcNumericProgram::getSize(void) const
+{
+        return m_code.size();
+}
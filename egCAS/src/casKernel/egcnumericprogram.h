@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCNUMERICPROGRAM_H
+#define EGCNUMERICPROGRAM_H
+
+#include <QString>
+#include <QVector>
+#include "egcnumericevaluator.h"
+
+class EgcNode;
+
+/**
+ * @brief The EgcNumericOpCode enum defines the instructions of a numeric program
+ */
+enum class EgcNumericOpCode : quint8
+{
+        PushConstant = 0,       ///< push the constant with the given index
+        PushArgument,           ///< push the function argument with the given index
+        PushSymbol,             ///< push the value of the global variable with the given index (looked up at runtime)
+        Unary,                  ///< apply the unary operation of the given node type to the top of the stack
+        Binary,                 ///< apply the binary operation of the given node type to the two topmost values
+        CallBuiltin,            ///< apply the builtin function with the given index to the top of the stack
+        CallUser                ///< call the user function with the given symbol index (index of arguments in m_nrArgs)
+};
+
+/**
+ * @brief The EgcNumericInstruction class is a single instruction of a numeric program
+ */
+class EgcNumericInstruction
+{
+public:
+        EgcNumericInstruction() : m_op{EgcNumericOpCode::PushConstant}, m_nrArgs{0}, m_index{0} {}
+        EgcNumericInstruction(EgcNumericOpCode op, quint16 index, quint8 nrArgs = 0) : m_op{op}, m_nrArgs{nrArgs},
+                                                                                     m_index{index} {}
+
+        EgcNumericOpCode m_op;  ///< the operation to execute
+        quint8 m_nrArgs;        ///< number of arguments for user function calls
+        quint16 m_index;        ///< index of the constant, argument, symbol, function or node type of the operation
+};
+
+/**
+ * @brief The EgcNumericProgram class is a user function compiled into a flat postfix program. Constant sub
+ * expressions are folded during compilation, so a call only executes the parts that depend on the arguments or on
+ * global variables.
+ */
+class EgcNumericProgram
+{
+public:
+        ///std constructor
+        EgcNumericProgram();
+        /**
+         * @brief compile compiles the given function definition
+         * @param function the function node of the definition (contains the name and the parameters)
+         * @param body the body of the function
+         * @return true if the function could be compiled, false if it can only be calculated by the kernel
+         */
+        bool compile(EgcNode& function, EgcNode* body);
+        /**
+         * @brief compile compiles the given expression as function of the given parameters (e.g. for parameter sweeps)
+         * @param parameters the (stuffed) names of the parameters, in the order the arguments are given to run
+         * @param body the expression to compile
+         * @return true if the expression could be compiled, false if it can only be calculated by the kernel
+         */
+        bool compile(const QVector<QString>& parameters, EgcNode* body);
+        /**
+         * @brief run executes the program with the given arguments
+         * @param args the arguments of the function call
+         * @param evaluator the evaluator used to look up global variables and other user functions
+         * @param result the result of the function call
+         * @param depth the current call depth
+         * @return true if the program could be executed, false otherwise
+         */
+        bool run(const QVector<EgcNumericValue>& args, const EgcNumericEvaluator& evaluator, EgcNumericValue& result,
+                 int depth = 0) const;
+        /**
+         * @brief runBatch executes the program for many argument values at once (e.g. for sampling a plot). The
+         * program is executed block by block, every instruction processes the whole block, so the loops can be
+         * vectorized by the compiler. Samples that cannot be calculated (e.g. sqrt(-1)) are set to NaN.
+         * @param args one array of argument values per parameter, each with count values
+         * @param count the number of samples
+         * @param evaluator the evaluator used to look up global variables and other user functions
+         * @param result array for the count results
+         * @param depth the current call depth
+         * @return true if the program could be executed, false otherwise (e.g. undefined symbols)
+         */
+        bool runBatch(const QVector<const double*>& args, int count, const EgcNumericEvaluator& evaluator,
+                      double* result, int depth = 0) const;
+        /**
+         * @brief getNumberOfArguments returns the number of arguments the function takes
+         * @return the number of arguments
+         */
+        int getNumberOfArguments(void) const;
+        /**
+         * @brief getSize returns the number of instructions of the program
+         * @return the number of instructions
+         */
+        int getSize(void) const;
+
+private:
+        /**
+         * @brief compileNode emits the instructions for the given node
+         * @param node the node to compile
+         * @return true if the node could be compiled, false otherwise
+         */
+        bool compileNode(EgcNode& node);
+        /**
+         * @brief pushConstant emits an instruction that pushes the given constant
+         * @param value the constant to push
+         * @return true if the constant could be emitted
+         */
+        bool pushConstant(const EgcNumericValue& value);
+        /**
+         * @brief isConstant checks if the instruction at the given position pushes a constant
+         * @param pos the position of the instruction
+         * @return true if the instruction pushes a constant, false otherwise
+         */
+        bool isConstant(int pos) const;
+        /**
+         * @brief fold replaces the last instructions (pushing constants and applying an operation on them) with the
+         * constant result
+         * @param start the position of the first instruction to replace
+         * @param operands the number of constants the operation has consumed from the stack
+         * @param value the constant result of the instructions
+         * @return true if the constant could be emitted
+         */
+        bool fold(int start, int operands, const EgcNumericValue& value);
+        /**
+         * @brief runBlock executes the program for one block of samples (see runBatch)
+         * @param args one array of argument values per parameter, each with count values
+         * @param count the number of samples, must not be more than s_blockSize
+         * @param evaluator the evaluator used to look up global variables and other user functions
+         * @param result array for the count results
+         * @param depth the current call depth
+         * @return true if the program could be executed, false otherwise
+         */
+        bool runBlock(const QVector<const double*>& args, int count, const EgcNumericEvaluator& evaluator,
+                      double* result, int depth) const;
+        /**
+         * @brief applyUnary applies the unary operation to all values of a block
+         * @param type the node type of the operation
+         * @param values the operands, contain the results afterwards
+         * @param count number of values
+         * @return true if the operation is known, false otherwise
+         */
+        static bool applyUnary(EgcNodeType type, double* values, int count);
+        /**
+         * @brief applyBinary applies the binary operation to all values of a block
+         * @param type the node type of the operation
+         * @param lhs the left operands (the indexes for roots), contain the results afterwards
+         * @param rhs the right operands (the radicands for roots)
+         * @param count number of values
+         * @return true if the operation is known, false otherwise
+         */
+        static bool applyBinary(EgcNodeType type, double* lhs, const double* rhs, int count);
+        /**
+         * @brief applyFunction applies the builtin function to all values of a block
+         * @param fnc the function to apply
+         * @param values the arguments, contain the results afterwards
+         * @param count number of values
+         * @return true if the function is known, false otherwise
+         */
+        static bool applyFunction(EgcNumericFunction fnc, double* values, int count);
+        /**
+         * @brief addSymbol adds the symbol to the symbol table of the program
+         * @param symbol the symbol to add
+         * @return the index of the symbol
+         */
+        int addSymbol(const QString& symbol);
+
+        QVector<EgcNumericInstruction> m_code;  ///< the instructions of the program
+        QVector<EgcNumericValue> m_constants;   ///< the constants used in the program
+        QVector<QString> m_symbols;             ///< the global variables and user functions used in the program
+        QVector<QString> m_parameters;          ///< the parameter names of the function
+        int m_maxStack;                         ///< maximum stack size needed to run the program
+        int m_stack;                            ///< current stack size during compilation
+        static const int s_maxIndex = 0xFFFF;   ///< maximum number of constants or symbols
+        static const int s_blockSize = 256;     ///< number of samples processed by every instruction of runBatch
+};
+
+#endif // EGCNUMERICPROGRAM_H
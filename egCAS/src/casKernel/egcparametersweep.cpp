@@ -0,0 +1,328 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QRegularExpression>
+#include <QStringBuilder>
+#include "egcparametersweep.h"
+#include "egcnumericevaluator.h"
+#include "egcnumericprogram.h"
+#include "egcnodes.h"
+#include "casKernel/parser/egckernelparser.h"
+#include "entities/egcformulaentity.h"
+#include "visitor/egcmaximavisitor.h"
+
+double EgcSweepRange::value(quint32 step) const
+{
+        if (m_steps <= 1)
+                return m_from;
+
+        // calculate every value from the start, so that there are no rounding errors that add up
+        return m_from + (m_to - m_from) * static_cast<double>(step) / static_cast<double>(m_steps - 1);
+}
+
+bool EgcSweepRange::isValid(void) const
+{
+        static const QRegularExpression name("^[A-Za-z][A-Za-z0-9]*$");
+
+        if (m_steps == 0 || m_steps > EgcParameterSweep::s_maxPoints)
+                return false;
+
+        return name.match(m_name).hasMatch();
+}
+
+EgcParameterSweep::EgcParameterSweep()
+{
+}
+
+EgcParameterSweep::EgcParameterSweep(const EgcParameterSweep& orig) : m_expression{orig.m_expression},
+        m_errorMessage{orig.m_errorMessage}, m_values{orig.m_values}
+{
+        m_ranges[0] = orig.m_ranges[0];
+        m_ranges[1] = orig.m_ranges[1];
+        if (!orig.m_tree.isNull())
+                m_tree.reset(orig.m_tree->copy());
+}
+
+EgcParameterSweep::~EgcParameterSweep()
+{
+}
+
+bool EgcParameterSweep::setExpression(const QString& expression)
+{
+        m_expression = expression.trimmed();
+        m_tree.reset();
+        m_errorMessage.clear();
+        m_values.clear();
+
+        if (m_expression.isEmpty())
+                return false;
+
+        EgcKernelParser parser;
+        m_tree.reset(parser.parseKernelOutput(m_expression));
+        if (m_tree.isNull()) {
+                m_errorMessage = parser.getErrorMessage();
+                return false;
+        }
+
+        return true;
+}
+
+QString EgcParameterSweep::getExpression(void) const
+{
+        return m_expression;
+}
+
+QString EgcParameterSweep::getErrorMessage(void) const
+{
+        return m_errorMessage;
+}
+
+void EgcParameterSweep::setRange(int index, const EgcSweepRange& range)
+{
+        if (index < 0 || index > 1)
+                return;
+
+        m_ranges[index] = range;
+        m_values.clear();
+}
+
+const EgcSweepRange& EgcParameterSweep::getRange(int index) const
+{
+        if (index == 1)
+                return m_ranges[1];
+
+        return m_ranges[0];
+}
+
+int EgcParameterSweep::getDimension(void) const
+{
+        if (!m_ranges[0].isValid())
+                return 0;
+        if (m_ranges[1].m_name.isEmpty())
+                return 1;
+        if (!m_ranges[1].isValid() || m_ranges[1].m_name == m_ranges[0].m_name)
+                return 0;
+
+        return 2;
+}
+
+bool EgcParameterSweep::isValid(void) const
+{
+        if (m_tree.isNull() || getDimension() == 0)
+                return false;
+
+        return static_cast<quint64>(getRows()) * getColumns() <= s_maxPoints;
+}
+
+quint32 EgcParameterSweep::getRows(void) const
+{
+        return m_ranges[0].m_steps;
+}
+
+quint32 EgcParameterSweep::getColumns(void) const
+{
+        if (getDimension() == 2)
+                return m_ranges[1].m_steps;
+
+        return 1;
+}
+
+QString EgcParameterSweep::valueList(const EgcSweepRange& range)
+{
+        QStringList values;
+        values.reserve(static_cast<int>(range.m_steps));
+        for (quint32 i = 0; i < range.m_steps; i++)
+                values.append(EgcNumericEvaluator::toKernelString(EgcNumericValue(range.value(i), false), true));
+
+        return "[" % values.join(',') % "]";
+}
+
+QString EgcParameterSweep::getKernelCommand(void) const
+{
+        if (!isValid())
+                return QString();
+
+        // the command is generated from the parsed tree, so the kernel gets the same syntax as for formulas
+        EgcNode* tree = m_tree->copy();
+        if (!tree)
+                return QString();
+        EgcFormulaEntity formula(*tree);
+        EgcMaximaVisitor visitor(formula);
+        QString expression = visitor.getResult();
+        expression.chop(1);     // the visitor terminates the command
+
+        // makelist binds the parameters locally, so definitions of the same symbols in the document are not touched
+        QString cmd = "(" % expression % ")";
+        if (getDimension() == 2)
+                cmd = "makelist(" % cmd % "," % m_ranges[1].m_name % "," % valueList(m_ranges[1]) % ")";
+        cmd = "makelist(" % cmd % "," % m_ranges[0].m_name % "," % valueList(m_ranges[0]) % ")";
+
+        return "float(" % cmd % ");";
+}
+
+bool EgcParameterSweep::evaluate(const EgcNumericEvaluator& evaluator)
+{
+        m_values.clear();
+        if (!isValid())
+                return false;
+
+        QVector<QString> parameters;
+        parameters.append(m_ranges[0].m_name);
+        if (getDimension() == 2)
+                parameters.append(m_ranges[1].m_name);
+
+        // the expression is compiled once and then run for every point of the sweep
+        EgcNumericProgram program;
+        if (!program.compile(parameters, m_tree.data()))
+                return false;
+
+        quint32 rows = getRows();
+        quint32 columns = getColumns();
+        QStringList values;
+        values.reserve(static_cast<int>(rows * columns));
+        QVector<EgcNumericValue> args(parameters.size());
+        EgcNumericValue result;
+        for (quint32 row = 0; row < rows; row++) {
+                args[0] = EgcNumericValue(m_ranges[0].value(row), false);
+                for (quint32 column = 0; column < columns; column++) {
+                        if (parameters.size() == 2)
+                                args[1] = EgcNumericValue(m_ranges[1].value(column), false);
+                        if (!program.run(args, evaluator, result))
+                                return false;
+                        values.append(EgcNumericEvaluator::toKernelString(result, true));
+                }
+        }
+
+        m_values = values;
+
+        return true;
+}
+
+bool EgcParameterSweep::setKernelResult(const QString& result)
+{
+        m_values.clear();
+        if (!isValid())
+                return false;
+
+        QStringList rows;
+        if (!splitList(result, rows))
+                return false;
+        if (rows.size() != static_cast<int>(getRows()))
+                return false;
+
+        if (getDimension() == 1) {
+                m_values = rows;
+                return true;
+        }
+
+        QStringList values;
+        values.reserve(static_cast<int>(getRows() * getColumns()));
+        foreach (QString row, rows) {
+                QStringList columns;
+                if (!splitList(row, columns) || columns.size() != static_cast<int>(getColumns()))
+                        return false;
+                values.append(columns);
+        }
+        m_values = values;
+
+        return true;
+}
+
+bool EgcParameterSweep::hasValues(void) const
+{
+        return !m_values.isEmpty();
+}
+
+QString EgcParameterSweep::getValue(quint32 row, quint32 column) const
+{
+        quint32 columns = getColumns();
+        if (row >= getRows() || column >= columns)
+                return QString();
+
+        int index = static_cast<int>(row * columns + column);
+        if (index >= m_values.size())
+                return QString();
+
+        return m_values.at(index);
+}
+
+bool EgcParameterSweep::setValues(const QStringList& values)
+{
+        m_values.clear();
+        if (!isValid() || values.size() != static_cast<int>(getRows() * getColumns()))
+                return false;
+
+        m_values = values;
+
+        return true;
+}
+
+QStringList EgcParameterSweep::getValues(void) const
+{
+        return m_values;
+}
+
+void EgcParameterSweep::clearValues(void)
+{
+        m_values.clear();
+}
+
+bool EgcParameterSweep::splitList(const QString& list, QStringList& elements)
+{
+        elements.clear();
+
+        QString tmp = list.trimmed();
+        if (!tmp.startsWith('[') || !tmp.endsWith(']'))
+                return false;
+
+        int level = 0;
+        int start = 1;
+        int end = tmp.length() - 1;
+        for (int i = 1; i < end; i++) {
+                QChar c = tmp.at(i);
+                if (c == '[' || c == '(')
+                        level++;
+                else if (c == ']' || c == ')')
+                        level--;
+                else if (c == ',' && level == 0) {
+                        elements.append(tmp.mid(start, i - start).trimmed());
+                        start = i + 1;
+                }
+                if (level < 0)
+                        return false;
+        }
+        if (level != 0)
+                return false;
+
+        QString last = tmp.mid(start, end - start).trimmed();
+        if (!last.isEmpty() || !elements.isEmpty())
+                elements.append(last);
+
+        return true;
+}
@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCPARAMETERSWEEP_H
+#define EGCPARAMETERSWEEP_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QScopedPointer>
+
+class EgcNode;
+class EgcNumericEvaluator;
+
+/**
+ * @brief The EgcSweepRange class describes the values a parameter of a sweep runs through (equally spaced values
+ * from m_from to m_to)
+ */
+class EgcSweepRange
+{
+public:
+        EgcSweepRange() : m_from{0.0}, m_to{0.0}, m_steps{0} {}
+        EgcSweepRange(const QString& name, double from, double to, quint32 steps) : m_name{name}, m_from{from},
+                                                                                    m_to{to}, m_steps{steps} {}
+        /**
+         * @brief value returns the value of the parameter at the given step
+         * @param step the step to return the value for (0 ... m_steps - 1)
+         * @return the value of the parameter
+         */
+        double value(quint32 step) const;
+        /**
+         * @brief isValid checks if the range can be used for a sweep (valid parameter name and at least one step)
+         * @return true if the range is valid, false otherwise
+         */
+        bool isValid(void) const;
+
+        QString m_name;         ///< name of the parameter (as used in the kernel)
+        double m_from;          ///< first value of the parameter
+        double m_to;            ///< last value of the parameter
+        quint32 m_steps;        ///< number of values of the parameter
+};
+
+/**
+ * @brief The EgcParameterSweep class evaluates an expression over one or two parameter ranges. If the expression is
+ * purely numeric, all points are calculated natively with a compiled numeric program. Otherwise the whole sweep is
+ * sent to the CAS kernel as one command, so there is only one round trip for all points.
+ */
+class EgcParameterSweep
+{
+public:
+        ///std constructor
+        EgcParameterSweep();
+        ///copy constructor
+        EgcParameterSweep(const EgcParameterSweep& orig);
+        ///destructor
+        ~EgcParameterSweep();
+        /**
+         * @brief setExpression set the expression to evaluate (in the syntax of the CAS kernel)
+         * @param expression the expression to set
+         * @return true if the expression could be parsed, false otherwise (the expression is set anyway)
+         */
+        bool setExpression(const QString& expression);
+        /**
+         * @brief getExpression returns the expression to evaluate
+         * @return the expression
+         */
+        QString getExpression(void) const;
+        /**
+         * @brief getErrorMessage returns the error message if the expression could not be parsed
+         * @return the error message
+         */
+        QString getErrorMessage(void) const;
+        /**
+         * @brief setRange set the range of the first (index 0) or second (index 1) parameter. The second parameter is
+         * optional, set a range with an empty name to remove it.
+         * @param index the index of the parameter
+         * @param range the range to set
+         */
+        void setRange(int index, const EgcSweepRange& range);
+        /**
+         * @brief getRange returns the range of the first (index 0) or second (index 1) parameter
+         * @param index the index of the parameter
+         * @return the range of the parameter
+         */
+        const EgcSweepRange& getRange(int index) const;
+        /**
+         * @brief getDimension returns the number of parameters of the sweep
+         * @return 1 or 2 if the sweep is valid, 0 otherwise
+         */
+        int getDimension(void) const;
+        /**
+         * @brief isValid checks if the sweep can be evaluated
+         * @return true if the sweep is valid, false otherwise
+         */
+        bool isValid(void) const;
+        /**
+         * @brief getRows returns the number of rows of the result (the steps of the first parameter)
+         * @return the number of rows
+         */
+        quint32 getRows(void) const;
+        /**
+         * @brief getColumns returns the number of columns of the result (the steps of the second parameter, or 1)
+         * @return the number of columns
+         */
+        quint32 getColumns(void) const;
+        /**
+         * @brief getKernelCommand returns the command that evaluates all points of the sweep in the kernel at once.
+         * The expression is generated from the parsed tree with the maxima visitor.
+         * @return the kernel command, or an empty string if the sweep is not valid
+         */
+        QString getKernelCommand(void) const;
+        /**
+         * @brief evaluate evaluates all points of the sweep natively
+         * @param evaluator the evaluator that knows about the numeric definitions of the document
+         * @return true if all points could be calculated, false if the kernel must calculate the sweep
+         */
+        bool evaluate(const EgcNumericEvaluator& evaluator);
+        /**
+         * @brief setKernelResult sets the result of the kernel command
+         * @param result the result returned by the kernel
+         * @return true if the result has the expected shape, false otherwise
+         */
+        bool setKernelResult(const QString& result);
+        /**
+         * @brief hasValues checks if the sweep has been evaluated
+         * @return true if there are values, false otherwise
+         */
+        bool hasValues(void) const;
+        /**
+         * @brief getValue returns the value at the given point (in kernel format)
+         * @param row the step of the first parameter
+         * @param column the step of the second parameter
+         * @return the value at the point, or an empty string if there is no value
+         */
+        QString getValue(quint32 row, quint32 column) const;
+        /**
+         * @brief setValues sets all values of the sweep (e.g. when loading a document)
+         * @param values the values row by row, must be getRows() * getColumns() values
+         * @return true if the number of values fits, false otherwise
+         */
+        bool setValues(const QStringList& values);
+        /**
+         * @brief getValues returns all values row by row
+         * @return the values of the sweep
+         */
+        QStringList getValues(void) const;
+        /**
+         * @brief clearValues removes all calculated values
+         */
+        void clearValues(void);
+        /**
+         * @brief splitList splits a list as returned by the kernel ("[a,b,c]") into its elements
+         * @param list the list to split
+         * @param elements the elements of the list
+         * @return true if the string is a list, false otherwise
+         */
+        static bool splitList(const QString& list, QStringList& elements);
+
+        static const quint32 s_maxPoints = 100000;      ///< maximum number of points of a sweep
+
+private:
+        EgcParameterSweep& operator=(const EgcParameterSweep&) = delete;
+        /**
+         * @brief valueList returns all values of the given range in kernel format
+         * @param range the range to convert
+         * @return the values as kernel list
+         */
+        static QString valueList(const EgcSweepRange& range);
+
+        QString m_expression;                   ///< the expression to evaluate (kernel syntax)
+        QScopedPointer<EgcNode> m_tree;         ///< the parsed expression (for native evaluation)
+        QString m_errorMessage;                 ///< error message if the expression could not be parsed
+        EgcSweepRange m_ranges[2];              ///< ranges of the first and the (optional) second parameter
+        QStringList m_values;                   ///< the results row by row (kernel format)
+};
+
+#endif // EGCPARAMETERSWEEP_H
@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <QScopedPointer>
+#include <QCoreApplication>
+#include "egcplotsampler.h"
+#include "egcnumericevaluator.h"
+#include "egcnodes.h"
+#include "casKernel/parser/egckernelparser.h"
+
+EgcPlotSampler::EgcPlotSampler() : m_valid{false}, m_step{0.0}, m_first{0}, m_evaluations{0}
+{
+}
+
+bool EgcPlotSampler::setExpression(const QString& expression, const QString& variable)
+{
+        m_expression = expression.trimmed();
+        m_variable = variable.trimmed();
+        m_errorMessage.clear();
+        m_valid = false;
+        invalidate();
+
+        if (m_expression.isEmpty() || m_variable.isEmpty()) {
+                m_errorMessage = QCoreApplication::translate("EgcPlotSampler", "No expression or variable given");
+                return false;
+        }
+
+        EgcKernelParser parser;
+        QScopedPointer<EgcNode> tree(parser.parseKernelOutput(m_expression));
+        if (tree.isNull()) {
+                m_errorMessage = parser.getErrorMessage();
+                return false;
+        }
+
+        QVector<QString> parameters;
+        parameters.append(m_variable);
+        if (!m_program.compile(parameters, tree.data())) {
+                m_errorMessage = QCoreApplication::translate("EgcPlotSampler",
+                                                             "The expression cannot be evaluated numerically");
+                return false;
+        }
+        m_valid = true;
+
+        return true;
+}
+
+QString EgcPlotSampler::getExpression(void) const
+{
+        return m_expression;
+}
+
+QString EgcPlotSampler::getVariable(void) const
+{
+        return m_variable;
+}
+
+QString EgcPlotSampler::getErrorMessage(void) const
+{
+        return m_errorMessage;
+}
+
+bool EgcPlotSampler::isValid(void) const
+{
+        return m_valid;
+}
+
+void EgcPlotSampler::invalidate(void)
+{
+        m_step = 0.0;
+        m_first = 0;
+        m_x.clear();
+        m_y.clear();
+        m_evaluations = 0;
+}
+
+bool EgcPlotSampler::sample(double xMin, double xMax, int count, const EgcNumericEvaluator& evaluator)
+{
+        m_evaluations = 0;
+        if (!m_valid || count < 2 || !(xMax > xMin) || !std::isfinite(xMax - xMin))
+                return false;
+        if (count > s_maxSamples)
+                count = s_maxSamples;
+
+        // keep the step if the range has only been moved, so the cached samples can be reused
+        double step = (xMax - xMin) / (count - 1);
+        if (m_step > 0.0 && std::fabs(step - m_step) <= 1e-9 * m_step)
+                step = m_step;
+
+        qint64 first = static_cast<qint64>(std::floor(xMin / step));
+        qint64 last = static_cast<qint64>(std::ceil(xMax / step));
+        if (last - first + 1 > s_maxSamples)
+                last = first + s_maxSamples - 1;
+        int size = static_cast<int>(last - first + 1);
+
+        QVector<double> x(size);
+        QVector<double> y(size);
+        qint64 cachedLast = m_first + m_x.size() - 1;
+        qint64 overlapFirst = qMax(first, m_first);
+        qint64 overlapLast = qMin(last, cachedLast);
+        if (step != m_step || m_x.isEmpty() || overlapFirst > overlapLast) {
+                if (!evaluate(first, step, size, evaluator, x.data(), y.data()))
+                        return false;
+        } else {
+                // calculate the samples left and right of the cached ones only
+                int left = static_cast<int>(overlapFirst - first);
+                int overlap = static_cast<int>(overlapLast - overlapFirst + 1);
+                int right = size - left - overlap;
+                int cacheOffset = static_cast<int>(overlapFirst - m_first);
+                for (int i = 0; i < overlap; i++) {
+                        x[left + i] = m_x.at(cacheOffset + i);
+                        y[left + i] = m_y.at(cacheOffset + i);
+                }
+                if (!evaluate(first, step, left, evaluator, x.data(), y.data()))
+                        return false;
+                if (!evaluate(overlapLast + 1, step, right, evaluator, x.data() + left + overlap,
+                              y.data() + left + overlap))
+                        return false;
+        }
+
+        m_step = step;
+        m_first = first;
+        m_x = x;
+        m_y = y;
+
+        return true;
+}
+
+bool EgcPlotSampler::evaluate(qint64 first, double step, int count, const EgcNumericEvaluator& evaluator, double* x, double* y)
+{
+        if (count <= 0)
+                return true;
+
+        // the x values are calculated from the grid index, so the same sample has always the same value
+        for (int i = 0; i < count; i++)
+                x[i] = static_cast<double>(first + i) * step;
+
+        QVector<const double*> args;
+        args.append(x);
+        m_evaluations += count;
+
+        return m_program.runBatch(args, count, evaluator, y);
+}
+
+const QVector<double>& EgcPlotSampler::getX(void) const
+{
+        return m_x;
+}
+
+const QVector<double>& EgcPlotSampler::getY(void) const
+{
+        return m_y;
+}
+
+int EgcPlotSampler::getNumberOfEvaluations(void) const
+{
+        return m_evaluations;
+}
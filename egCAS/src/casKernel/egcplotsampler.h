@@ -0,0 +1,134 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCPLOTSAMPLER_H
+#define EGCPLOTSAMPLER_H
+
+#include <QString>
+#include <QVector>
+#include "egcnumericprogram.h"
+
+class EgcNumericEvaluator;
+
+/**
+ * @brief The EgcPlotSampler class samples an expression of one variable for plotting it. The expression is compiled
+ * into a numeric program and all samples are calculated with the batch interpreter of the program, without the CAS
+ * kernel. The samples lie on a grid (multiples of the sample step), so when the range is only moved (pan) the samples
+ * that are still visible are reused and only the new ones are calculated.
+ */
+class EgcPlotSampler
+{
+public:
+        ///std constructor
+        EgcPlotSampler();
+        /**
+         * @brief setExpression set the expression to sample (in the syntax of the CAS kernel)
+         * @param expression the expression to set
+         * @param variable the (stuffed) name of the variable the expression is sampled over
+         * @return true if the expression can be sampled natively, false otherwise (see getErrorMessage)
+         */
+        bool setExpression(const QString& expression, const QString& variable);
+        /**
+         * @brief getExpression returns the expression that is sampled
+         * @return the expression
+         */
+        QString getExpression(void) const;
+        /**
+         * @brief getVariable returns the variable the expression is sampled over
+         * @return the name of the variable
+         */
+        QString getVariable(void) const;
+        /**
+         * @brief getErrorMessage returns the error message if the expression cannot be sampled
+         * @return the error message
+         */
+        QString getErrorMessage(void) const;
+        /**
+         * @brief isValid checks if the expression could be compiled
+         * @return true if the expression can be sampled, false otherwise
+         */
+        bool isValid(void) const;
+        /**
+         * @brief sample samples the expression in the given range
+         * @param xMin the start of the range
+         * @param xMax the end of the range
+         * @param count the number of samples in the range (limited to s_maxSamples)
+         * @param evaluator the evaluator that knows about the numeric definitions used by the expression
+         * @return true if the expression could be sampled, false otherwise (e.g. undefined symbols)
+         */
+        bool sample(double xMin, double xMax, int count, const EgcNumericEvaluator& evaluator);
+        /**
+         * @brief invalidate removes all cached samples (e.g. if the definitions used by the expression have changed)
+         */
+        void invalidate(void);
+        /**
+         * @brief getX returns the x values of the samples
+         * @return the x values of the samples
+         */
+        const QVector<double>& getX(void) const;
+        /**
+         * @brief getY returns the y values of the samples (NaN if the expression is not defined at the sample)
+         * @return the y values of the samples
+         */
+        const QVector<double>& getY(void) const;
+        /**
+         * @brief getNumberOfEvaluations returns the number of samples that have been calculated by the last call of
+         * sample (the other samples have been reused)
+         * @return the number of samples calculated
+         */
+        int getNumberOfEvaluations(void) const;
+
+        static const int s_maxSamples = 100000;         ///< maximum number of samples of a range
+
+private:
+        /**
+         * @brief evaluate calculates the samples with the given grid indexes
+         * @param first the grid index of the first sample
+         * @param step the distance between two samples
+         * @param count the number of samples to calculate
+         * @param evaluator the evaluator that knows about the numeric definitions used by the expression
+         * @param x array for the x values
+         * @param y array for the y values
+         * @return true if the samples could be calculated, false otherwise
+         */
+        bool evaluate(qint64 first, double step, int count, const EgcNumericEvaluator& evaluator, double* x, double* y);
+
+        QString m_expression;           ///< the expression to sample (kernel syntax)
+        QString m_variable;             ///< the variable the expression is sampled over
+        QString m_errorMessage;         ///< error message if the expression cannot be sampled
+        EgcNumericProgram m_program;    ///< the compiled expression
+        bool m_valid;                   ///< true if the expression could be compiled
+        double m_step;                  ///< distance between two samples (0 if there are no cached samples)
+        qint64 m_first;                 ///< grid index of the first cached sample
+        QVector<double> m_x;            ///< x values of the samples
+        QVector<double> m_y;            ///< y values of the samples
+        int m_evaluations;              ///< number of samples calculated by the last call of sample
+};
+
+#endif // EGCPLOTSAMPLER_H
@@ -30,6 +30,7 @@ expr : <assoc=right> expr EXP expr              # Exponent
      | NAMES '(' explist ')'                    # Function
      | EMPTY '(' explist ')'                    # Function
      | LBRACKET_OP expr RBRACKET_OP             # BracketOp
+     | '[' (expr (',' expr)*)? ']'              # List
      ;
     
 explist: expr                                   # createArglist
@@ -290,6 +290,29 @@ antlrcpp::Any FormulaInterpreter::visitAddArgument(EgcParser::AddArgumentContext
         return node;
 }
 
+antlrcpp::Any FormulaInterpreter::visitList(EgcParser::ListContext *ctx)
+{
+        // the elements are appended one after another to the same argument list (no recursion over the list length)
+        std::vector<EgcParser::ExprContext*> elements = ctx->expr();
+        EgcNode* argList;
+        if (elements.empty())
+                argList = createArgList(addEmptyNode());
+        else
+                argList = createArgList(visit(elements.at(0)));
+
+        EgcArgumentsNode* args = static_cast<EgcArgumentsNode*>(argList);
+        for (size_t i = 1; i < elements.size(); i++) {
+                EgcNode* element = visit(elements.at(i));
+                setNotDangling(element);
+                if (element)
+                        args->setChild(static_cast<quint32>(i), *element);
+        }
+
+        EgcNode* node = changeFlexExpressionType(EgcNodeType::ListNode, argList);
+        refinePosition(ctx, node);
+        return node;
+}
+
 
 EgcNode* FormulaInterpreter::addBinaryExpression(EgcNodeType type, EgcNode* node0,
                                                     EgcNode* node1)
@@ -404,6 +427,12 @@ EgcNode* FormulaInterpreter::addFunction(const std::string& fncName, EgcNode* ar
 {
         EgcNode* builtinOp;
         EgcArgumentsNode* argL = static_cast<EgcArgumentsNode*>(argList);
+        if (argList && fncName == "matrix") {
+                builtinOp = addMatrix(argList);
+                if (builtinOp)
+                        return builtinOp;
+        }
+
         if (argList) {
                 if (argL->getNumberChildNodes() == 1) {
                         builtinOp = isBuiltinOperation(fncName, static_cast<EgcNode*>(argList));
@@ -422,6 +451,57 @@ EgcNode* FormulaInterpreter::addFunction(const std::string& fncName, EgcNode* ar
         return static_cast<EgcNode*> (argList);
 }
 
+EgcNode* FormulaInterpreter::addMatrix(EgcNode* argList)
+{
+        if (!argList)
+                return nullptr;
+
+        EgcArgumentsNode* rows = static_cast<EgcArgumentsNode*>(argList);
+        quint32 nrRows = rows->getNumberChildNodes();
+        quint32 nrColumns = 0;
+        quint32 i, j;
+
+        // all arguments must be lists of the same length
+        for (i = 0; i < nrRows; i++) {
+                EgcNode* row = rows->getChild(i);
+                if (!row)
+                        return nullptr;
+                if (row->getNodeType() != EgcNodeType::ListNode)
+                        return nullptr;
+                quint32 n = static_cast<EgcListNode*>(row)->getNumberChildNodes();
+                if (i == 0)
+                        nrColumns = n;
+                if (n != nrColumns || n == 0)
+                        return nullptr;
+        }
+
+        QScopedPointer<EgcMatrixNode> matrix(static_cast<EgcMatrixNode*>(EgcNodeCreator::create(EgcNodeType::MatrixNode)));
+        if (matrix.isNull())
+                throw std::runtime_error("Not enough memory to complete operation!");
+
+        // move the elements of all rows into the child vector of the matrix (row-major order)
+        quint32 index = 0;
+        for (i = 0; i < nrRows; i++) {
+                EgcListNode* row = static_cast<EgcListNode*>(rows->getChild(i));
+                for (j = 0; j < nrColumns; j++) {
+                        EgcNode* element = row->getChild(j);
+                        if (element) {
+                                (void) row->takeOwnership(*element);
+                                matrix->setChild(index, *element);
+                        }
+                        index++;
+                }
+        }
+        matrix->setDimension(nrRows, nrColumns);
+
+        delete argList;
+        setNotDangling(argList);
+        EgcMatrixNode* nodePtr = matrix.data();
+        addDanglingNode(matrix.take());
+
+        return nodePtr;
+}
+
 EgcNode* FormulaInterpreter::updateIterator(EgcNode* node0, int i)
 {
         if (i == 1)
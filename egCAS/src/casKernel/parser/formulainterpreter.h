@@ -108,6 +108,7 @@ private:
         virtual antlrcpp::Any visitIntegral(EgcParser::IntegralContext *ctx) override;
         virtual antlrcpp::Any visitCreateArglist(EgcParser::CreateArglistContext *ctx) override;
         virtual antlrcpp::Any visitAddArgument(EgcParser::AddArgumentContext *ctx) override;
+        virtual antlrcpp::Any visitList(EgcParser::ListContext *ctx) override;
 
     
         /**
@@ -136,6 +137,15 @@ private:
          * @return pointer to the function created
          */
         EgcNode* addFunction(const std::string& fncName, EgcNode* argList);
+        /**
+         * @brief addMatrix creates a matrix from the argument list given. This is used for the kernel function
+         * "matrix([..],[..])", where every argument must be a list with the same number of elements. The elements of
+         * all rows are moved into one matrix node (row-major order).
+         * @param argList the argument list with the rows (lists) of the matrix
+         * @return pointer to the matrix created or a nullptr if the arguments don't form a matrix (the argument list
+         * is left untouched in this case)
+         */
+        EgcNode* addMatrix(EgcNode* argList);
         /**
          * @brief isBuiltinOperation checks if a builtin operation of the maxima kernel was given which must be handled
          * separately
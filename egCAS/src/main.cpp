@@ -28,12 +28,44 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include "menu/mainwindow.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <iostream>
+#include "document/egcdocument.h"
+#include "document/egcsessionreplayer.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", QCoreApplication::translate("main",
+                                    "Record the user session into <file>."), "file");
+    QCommandLineOption replayOption("replay", QCoreApplication::translate("main",
+                                    "Replay the session recorded in <file> without user interface and print the time "
+                                    "needed (use together with \"-platform offscreen\" on machines without display)."),
+                                    "file");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.process(a);
+
+    if (parser.isSet(replayOption)) {
+        EgcDocument document(new EgcReplayKernelConn());
+        EgcSessionReplayer replayer(document);
+        if (!replayer.replay(parser.value(replayOption))) {
+            std::cerr << replayer.getErrorMessage().toStdString() << std::endl;
+            return 1;
+        }
+        std::cout << replayer.report().toStdString();
+        return 0;
+    }
+
     MainWindow w;
     w.show();
+    if (parser.isSet(recordOption)) {
+        if (!w.startSessionRecording(parser.value(recordOption)))
+            std::cerr << "unable to record the session into " << parser.value(recordOption).toStdString() << std::endl;
+    }
 
     return a.exec();
 }
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QScrollBar>
 #include <QTimer>
 #include "egcgraphicsview.h"
+#include "view/egcasscene.h"
 
 EgcGraphicsView::EgcGraphicsView(QWidget *parent) : QGraphicsView(parent), m_visibilityLocked{false}
 {
@@ -73,6 +74,22 @@ void EgcGraphicsView::wheelEvent(QWheelEvent *event)
         }
 }
 
+void EgcGraphicsView::paintEvent(QPaintEvent *event)
+{
+        materializeNearbyItems();
+        QGraphicsView::paintEvent(event);
+}
+
+void EgcGraphicsView::materializeNearbyItems(void)
+{
+        EgCasScene* scn = qobject_cast<EgCasScene*>(scene());
+        if (!scn)
+                return;
+
+        QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+        scn->materializeItems(visible.adjusted(-visible.width(), -visible.height(), visible.width(), visible.height()));
+}
+
 void EgcGraphicsView::unlockVisibility()
 {
         m_visibilityLocked = false;
@@ -52,12 +52,23 @@ protected:
          * @param event the wheel event
         */
         virtual void wheelEvent(QWheelEvent *event) override;
+        /**
+         * @brief paintEvent reimplements paint event to lay out the formulas near the viewport before painting
+         * @param event the paint event
+         */
+        virtual void paintEvent(QPaintEvent *event) override;
 private slots:
         /**
          * @brief unlockVisibility unlock ensuring visibility
          */
         void unlockVisibility(void);
 private:
+        /**
+         * @brief materializeNearbyItems lays out all formulas that are visible or will be visible after scrolling
+         * about one screen in any direction
+         */
+        void materializeNearbyItems(void);
+
         bool m_visibilityLocked;                ///< ensuring visibility is locked
 };
 
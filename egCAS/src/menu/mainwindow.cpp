@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "entities/egcformulaentity.h"
 #include "entities/egctextentity.h"
 #include "entities/egcpixmapentity.h"
+#include "entities/egctableentity.h"
+#include "entities/egcplotentity.h"
 #include "menu/egclicenseinfo.h"
 #include "menu/elementbar.h"
 #include "menu/precisionbox.h"
@@ -52,13 +54,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QFileInfo>
 #include <QCheckBox>
 #include <QFileIconProvider>
+#include <QProgressBar>
 
 #define MAP_COMBO_TO_PRECISION(prec)  ((prec == 0) ? 0 : (prec + 1))
 #define MAP_PRECISION_TO_COMBO(prec)  ((prec == 0) ? 0 : (prec - 1))
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    m_ui{new Ui::MainWindow}, m_document{new EgcDocument}, m_precision{nullptr}
+    m_ui{new Ui::MainWindow}, m_document{new EgcDocument}, m_precision{nullptr},
+    m_loadingProgress{nullptr}
 {
     m_ui->setupUi(this);
     m_ui->graphicsView->setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
@@ -83,6 +87,12 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+        m_document->stopSessionRecording();
+}
+
+bool MainWindow::startSessionRecording(const QString& logFile)
+{
+        return m_document->startSessionRecording(logFile);
 }
 
 void MainWindow::showLicense(void)
@@ -131,6 +141,11 @@ void MainWindow::autoCalculation(bool on)
                 calculate();
 }
 
+void MainWindow::externalImages(bool on)
+{
+        m_document->setExternalImages(on);
+}
+
 void MainWindow::newPage(void)
 {
 
@@ -141,15 +156,20 @@ void MainWindow::setupConnections(void)
         connect(m_ui->mnu_show_license, SIGNAL(triggered()), this, SLOT(showLicense()));
         connect(m_ui->mnu_show_info, SIGNAL(triggered()), this, SLOT(showInfo()));
         connect(m_ui->mnu_autoCalc, SIGNAL(triggered(bool)), this, SLOT(autoCalculation(bool)));
+        connect(m_ui->mnu_external_images, SIGNAL(triggered(bool)), this, SLOT(externalImages(bool)));
         connect(m_ui->mnu_CalculateDocument, SIGNAL(triggered()), this, SLOT(calculate()));
         connect(m_ui->mnu_new_page, SIGNAL(triggered()), this, SLOT(newPage()));
         connect(m_ui->mnu_insert_graphic, SIGNAL(triggered()), this, SLOT(insertGraphic()));
         connect(m_ui->mnu_insert_text, SIGNAL(triggered()), this, SLOT(insertText()));
         connect(m_ui->mnu_insert_html, SIGNAL(triggered()), this, SLOT(insertHtmlText()));
+        connect(m_ui->mnu_insert_table, SIGNAL(triggered()), this, SLOT(insertTable()));
+        connect(m_ui->mnu_insert_plot, SIGNAL(triggered()), this, SLOT(insertPlot()));
         connect(m_ui->mnu_saveFileAs, SIGNAL(triggered()), this, SLOT(saveFileAs()));
         connect(m_ui->mnu_load_file, SIGNAL(triggered()), this, SLOT(loadFile()));
         connect(m_ui->mnu_saveFile, SIGNAL(triggered()), this, SLOT(saveFile()));
         connect(m_ui->mnu_manual, SIGNAL(triggered()), this, SLOT(showManual()));
+        connect(m_document.data(), &EgcDocument::loadingProgress, this, &MainWindow::showLoadingProgress);
+        connect(m_document.data(), &EgcDocument::saveFinished, this, &MainWindow::documentSaved);
 }
 
 void MainWindow::setupToolbar()
@@ -168,8 +188,36 @@ void MainWindow::setupToolbar()
         m_resulttype = new ResultType(m_document.data(), m_ui->mathToolBar, this);
         m_mathFont = new MathFont(m_document.data(), m_ui->mathToolBar, this);
         m_textFont = new TextFont(m_document.data(), m_ui->mainToolBar, this);
+        //setup status bar
+        m_loadingProgress = new QProgressBar(this);
+        m_loadingProgress->setMaximumWidth(200);
+        m_loadingProgress->setFormat(tr("Loading formulas %p%"));
+        m_loadingProgress->hide();
+        m_ui->statusBar->addPermanentWidget(m_loadingProgress);
+}
+
+
+void MainWindow::showLoadingProgress(int loaded, int total)
+{
+        if (!m_loadingProgress)
+                return;
+
+        m_loadingProgress->setMaximum(total);
+        m_loadingProgress->setValue(loaded);
+        m_loadingProgress->setVisible(loaded < total);
 }
 
+void MainWindow::documentSaved(bool success, QString fileName, QString error)
+{
+        if (success) {
+                m_ui->statusBar->showMessage(tr("Document saved: %1").arg(fileName), 5000);
+                return;
+        }
+
+        m_ui->statusBar->clearMessage();
+        QMessageBox::warning(this, tr("Error while saving document"),
+                             tr("The document could not be saved to %1.\n%2").arg(fileName).arg(error));
+}
 
 void MainWindow::setupElementBar(void)
 {
@@ -206,6 +254,7 @@ void MainWindow::insertGraphic(void)
                 pixmap->setFilePath(fileName);
                 if (button == QMessageBox::Yes)
                         pixmap->setIsEmbedded();
+                m_document->entityChanged(pixmap);
         }
 }
 
@@ -227,9 +276,28 @@ void MainWindow::insertHtmlText(void)
         txt->setHtmlText(editor.exec(""));
 }
 
+void MainWindow::insertTable(void)
+{
+        QPointF lastPos = m_document->getLastCursorPosition();
+
+        EgcTableEntity* table = static_cast<EgcTableEntity*>(m_document->createEntity(EgcEntityType::Table, lastPos));
+        if (table)
+                table->itemChanged(EgcItemChangeType::itemEdited);
+}
+
+void MainWindow::insertPlot(void)
+{
+        QPointF lastPos = m_document->getLastCursorPosition();
+
+        EgcPlotEntity* plot = static_cast<EgcPlotEntity*>(m_document->createEntity(EgcEntityType::Plot, lastPos));
+        if (plot)
+                plot->itemChanged(EgcItemChangeType::itemEdited);
+}
+
 void MainWindow::saveFileAs(void)
 {
-        QString fileName = QFileDialog::getSaveFileName(this, tr("Save As"), ".", tr("EgCAS files (*.egc)"));
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save As"), ".",
+                                                        tr("EgCAS files (*.egc);;EgCAS binary files (*.egcb)"));
         if (fileName.isEmpty())
                 return;
         if (QFileInfo::exists(fileName)) {
@@ -243,7 +311,7 @@ void MainWindow::saveFileAs(void)
 
         m_currentFileName = fileName;
 
-        m_document->saveToFile(fileName);
+        saveDocument(fileName);
 }
 
 void MainWindow::saveFile(void)
@@ -251,17 +319,33 @@ void MainWindow::saveFile(void)
         if (m_currentFileName.isEmpty()) {
                 saveFileAs();
         } else {
-                m_document->saveToFile(m_currentFileName);
+                saveDocument(m_currentFileName);
         }
 }
 
+void MainWindow::saveDocument(const QString& fileName)
+{
+        // the document is written in the background, the result is reported by documentSaved
+        m_ui->statusBar->showMessage(tr("Saving document..."));
+        if (QFileInfo(fileName).suffix().compare(QLatin1String("egcb"), Qt::CaseInsensitive) == 0)
+                m_document->saveToFile(fileName, EgcDocument::FileFormat::Binary);
+        else
+                m_document->saveToFile(fileName);
+}
+
 void MainWindow::loadFile(void)
 {
-        QString fileName = QFileDialog::getOpenFileName(this, tr("Open"), ".", tr("EgCAS files (*.egc)"));
+        QString fileName = QFileDialog::getOpenFileName(this, tr("Open"), ".", tr("EgCAS files (*.egc *.egcb)"));
         if (fileName.isEmpty())
                 return;
         m_currentFileName = fileName;
 
         m_document->readFromFile(fileName);
+        if (m_document->canRecover()) {
+                QMessageBox::StandardButton button = QMessageBox::question(this, tr("recover unsaved changes?"),
+                                      tr("The document has been changed after it has been saved last time. Recover these changes?"),
+                                      QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+                m_document->recover(button == QMessageBox::Yes);
+        }
         calculate();
 }
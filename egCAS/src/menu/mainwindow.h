@@ -44,6 +44,7 @@ class PrecisionBox;
 class ResultType;
 class MathFont;
 class TextFont;
+class QProgressBar;
 
 class MainWindow : public QMainWindow
 {
@@ -52,6 +53,12 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
+        /**
+         * @brief startSessionRecording records the user session into the given file (for replaying it later on)
+         * @param logFile the file to record the session into
+         * @return true if recording has been started, false otherwise
+         */
+        bool startSessionRecording(const QString& logFile);
 
 public slots:
         void showLicense(void);
@@ -59,13 +66,29 @@ public slots:
         void showInfo(void);
         void calculate(void);
         void autoCalculation(bool on);
+        void externalImages(bool on);
         void newPage(void);
         void insertGraphic(void);
         void insertText(void);
         void insertHtmlText(void);
+        void insertTable(void);
+        void insertPlot(void);
         void saveFileAs(void);
         void saveFile(void);
         void loadFile(void);
+        /**
+         * @brief showLoadingProgress shows the progress of building the formulas of a document that has been loaded
+         * @param loaded the number of formulas already built
+         * @param total the number of formulas to build
+         */
+        void showLoadingProgress(int loaded, int total);
+        /**
+         * @brief documentSaved reports the result of saving the document
+         * @param success true if the document has been saved, false otherwise
+         * @param fileName the file the document has been saved into
+         * @param error a description of the error if saving failed
+         */
+        void documentSaved(bool success, QString fileName, QString error);
 private:
         /**
          * @brief setupConnections setup all connections to slots that are neccessary
@@ -79,6 +102,11 @@ private:
          * @brief setupElementBar setup the left bar with the math buttons
          */
         void setupElementBar(void);
+        /**
+         * @brief saveDocument saves the document, files with the suffix "egcb" are saved in the binary format
+         * @param fileName the file to save the document in
+         */
+        void saveDocument(const QString& fileName);
 
         QScopedPointer<Ui::MainWindow> m_ui;
         QScopedPointer<EgcDocument> m_document;
@@ -86,6 +114,7 @@ private:
         ResultType* m_resulttype;
         MathFont* m_mathFont;
         TextFont* m_textFont;
+        QProgressBar* m_loadingProgress;
         QString m_currentFileName;
 };
 
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include "ploteditor.h"
+#include "entities/egcplotentity.h"
+#include <QDialog>
+#include <QGridLayout>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <QRegularExpressionValidator>
+#include <cfloat>
+
+
+PlotEditor::PlotEditor(QWidget* parent) : QWidget(parent)
+{
+        m_dialog = new QDialog(this);
+        m_gl = new QGridLayout(m_dialog);
+        m_expression = new QLineEdit(m_dialog);
+        m_variable = new QLineEdit(m_dialog);
+        m_variable->setValidator(new QRegularExpressionValidator(QRegularExpression("[A-Za-z][A-Za-z0-9]*"),
+                                                                 m_variable));
+        m_xMin = new QDoubleSpinBox(m_dialog);
+        m_xMax = new QDoubleSpinBox(m_dialog);
+        m_yMin = new QDoubleSpinBox(m_dialog);
+        m_yMax = new QDoubleSpinBox(m_dialog);
+        QDoubleSpinBox* boxes[4] = {m_xMin, m_xMax, m_yMin, m_yMax};
+        for (QDoubleSpinBox* box : boxes) {
+                box->setRange(-DBL_MAX, DBL_MAX);
+                box->setDecimals(6);
+        }
+        m_autoScale = new QCheckBox(QObject::tr("Automatic"), m_dialog);
+        m_samples = new QSpinBox(m_dialog);
+        m_samples->setRange(2, EgcPlotSampler::s_maxSamples);
+
+        m_gl->addWidget(new QLabel(QObject::tr("Expression"), m_dialog), 0, 0);
+        m_gl->addWidget(m_expression, 0, 1, 1, 3);
+        m_gl->addWidget(new QLabel(QObject::tr("Variable"), m_dialog), 1, 0);
+        m_gl->addWidget(m_variable, 1, 1);
+        m_gl->addWidget(new QLabel(QObject::tr("From"), m_dialog), 2, 1);
+        m_gl->addWidget(new QLabel(QObject::tr("To"), m_dialog), 2, 2);
+        m_gl->addWidget(new QLabel(QObject::tr("x range"), m_dialog), 3, 0);
+        m_gl->addWidget(m_xMin, 3, 1);
+        m_gl->addWidget(m_xMax, 3, 2);
+        m_gl->addWidget(new QLabel(QObject::tr("y range"), m_dialog), 4, 0);
+        m_gl->addWidget(m_yMin, 4, 1);
+        m_gl->addWidget(m_yMax, 4, 2);
+        m_gl->addWidget(m_autoScale, 4, 3);
+        m_gl->addWidget(new QLabel(QObject::tr("Samples"), m_dialog), 5, 0);
+        m_gl->addWidget(m_samples, 5, 1);
+        m_error = new QLabel(m_dialog);
+        m_gl->addWidget(m_error, 6, 0, 1, 4);
+        m_ok_btn = new QPushButton(m_dialog);
+        m_ok_btn->setText(QObject::tr("Ok"));
+        m_cancel_btn = new QPushButton(m_dialog);
+        m_cancel_btn->setText(QObject::tr("Cancel"));
+        m_gl->addWidget(m_cancel_btn, 7, 2);
+        m_gl->addWidget(m_ok_btn, 7, 3);
+        m_dialog->setWindowTitle(QObject::tr("Plot editor"));
+        m_dialog->setMinimumWidth(500);
+        m_dialog->setModal(true);
+        connect(m_ok_btn, &QPushButton::clicked, this, &PlotEditor::ok_clicked);
+        connect(m_cancel_btn, &QPushButton::clicked, this, &PlotEditor::cancel_clicked);
+        connect(m_autoScale, &QCheckBox::toggled, m_yMin, &QDoubleSpinBox::setDisabled);
+        connect(m_autoScale, &QCheckBox::toggled, m_yMax, &QDoubleSpinBox::setDisabled);
+}
+
+PlotEditor::~PlotEditor()
+{
+}
+
+bool PlotEditor::exec(EgcPlotEntity& plot)
+{
+        m_expression->setText(plot.getExpression());
+        QString variable = plot.getVariable();
+        if (variable.isEmpty())
+                variable = QString("x");
+        m_variable->setText(variable);
+        m_xMin->setValue(plot.getXMin());
+        m_xMax->setValue(plot.getXMax());
+        m_yMin->setValue(plot.getYMin());
+        m_yMax->setValue(plot.getYMax());
+        m_autoScale->setChecked(plot.isAutoScale());
+        m_yMin->setDisabled(plot.isAutoScale());
+        m_yMax->setDisabled(plot.isAutoScale());
+        m_samples->setValue(plot.getNumberOfSamples());
+        m_error->setText(plot.getErrorMessage());
+
+        if (m_dialog->exec() != QDialog::Accepted)
+                return false;
+
+        plot.setXRange(m_xMin->value(), m_xMax->value());
+        plot.setYRange(m_yMin->value(), m_yMax->value(), m_autoScale->isChecked());
+        plot.setNumberOfSamples(m_samples->value());
+        plot.setExpression(m_expression->text(), m_variable->text());
+
+        return true;
+}
+
+void PlotEditor::ok_clicked()
+{
+        if (!(m_xMax->value() > m_xMin->value())) {
+                m_error->setText(QObject::tr("The end of the x range must be greater than its start."));
+                return;
+        }
+        if (!m_autoScale->isChecked() && !(m_yMax->value() > m_yMin->value())) {
+                m_error->setText(QObject::tr("The end of the y range must be greater than its start."));
+                return;
+        }
+
+        m_dialog->accept();
+}
+
+void PlotEditor::cancel_clicked()
+{
+        m_dialog->reject();
+}
@@ -0,0 +1,77 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef PLOTEDITOR_H
+#define PLOTEDITOR_H
+
+#include <QWidget>
+
+class QDialog;
+class QGridLayout;
+class QPushButton;
+class QLineEdit;
+class QDoubleSpinBox;
+class QSpinBox;
+class QCheckBox;
+class QLabel;
+class EgcPlotEntity;
+
+class PlotEditor : public QWidget
+{
+        Q_OBJECT
+public:
+        PlotEditor(QWidget* parent = nullptr);
+        virtual ~PlotEditor();
+        /**
+         * @brief exec executes the plot editor and sets the expression and ranges entered
+         * @param plot the plot to edit
+         * @return true if the user accepted the changes, false otherwise (the plot is unchanged then)
+         */
+        bool exec(EgcPlotEntity& plot);
+
+public slots:
+        void ok_clicked(void);
+        void cancel_clicked(void);
+private:
+        QDialog *m_dialog;
+        QGridLayout *m_gl;
+        QLineEdit *m_expression;
+        QLineEdit *m_variable;
+        QDoubleSpinBox *m_xMin;
+        QDoubleSpinBox *m_xMax;
+        QDoubleSpinBox *m_yMin;
+        QDoubleSpinBox *m_yMax;
+        QCheckBox *m_autoScale;
+        QSpinBox *m_samples;
+        QLabel *m_error;
+        QPushButton *m_ok_btn;
+        QPushButton *m_cancel_btn;
+};
+
+#endif // PLOTEDITOR_H
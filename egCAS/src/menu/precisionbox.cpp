@@ -86,10 +86,12 @@ void PrecisionBox::setPrecision(int prec)
         if (m_lastSelectedFormula) {
                 m_lastSelectedFormula->setNumberOfSignificantDigits(static_cast<quint8>(prec));
                 m_lastSelectedFormula->setSelected(static_cast<quint8>(false));
+                if (m_lastSelectedFormula->reformatResult())
+                        m_lastSelectedFormula->updateView();
         } else {
                 EgcFormulaEntity::setStdNrSignificantDigis(static_cast<quint8>(prec));
+                m_document->reformatResults();
         }
-        m_document->startCalulation();
 }
 
 void PrecisionBox::precBox(int prec)
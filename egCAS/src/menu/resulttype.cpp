@@ -68,7 +68,8 @@ void ResultType::setResultType(EgcNumberResultType result)
         if (m_lastSelectedFormula) {
                 m_lastSelectedFormula->setNumberResultType(result);
                 m_lastSelectedFormula->setSelected(false);
-                m_document->startCalulation();
+                if (m_lastSelectedFormula->reformatResult())
+                        m_lastSelectedFormula->updateView();
         }
 }
 
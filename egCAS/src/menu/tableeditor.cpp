@@ -0,0 +1,136 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+#include "tableeditor.h"
+#include "casKernel/egcparametersweep.h"
+#include <QDialog>
+#include <QGridLayout>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QRegularExpressionValidator>
+#include <cfloat>
+
+
+TableEditor::TableEditor(QWidget* parent) : QWidget(parent)
+{
+        m_dialog = new QDialog(this);
+        m_gl = new QGridLayout(m_dialog);
+        m_expression = new QLineEdit(m_dialog);
+        m_gl->addWidget(new QLabel(QObject::tr("Expression"), m_dialog), 0, 0);
+        m_gl->addWidget(m_expression, 0, 1, 1, 4);
+        m_gl->addWidget(new QLabel(QObject::tr("Name"), m_dialog), 1, 1);
+        m_gl->addWidget(new QLabel(QObject::tr("From"), m_dialog), 1, 2);
+        m_gl->addWidget(new QLabel(QObject::tr("To"), m_dialog), 1, 3);
+        m_gl->addWidget(new QLabel(QObject::tr("Steps"), m_dialog), 1, 4);
+        addRange(2, QObject::tr("Rows"), 0);
+        addRange(3, QObject::tr("Columns (optional)"), 1);
+        m_error = new QLabel(m_dialog);
+        m_gl->addWidget(m_error, 4, 0, 1, 5);
+        m_ok_btn = new QPushButton(m_dialog);
+        m_ok_btn->setText(QObject::tr("Ok"));
+        m_cancel_btn = new QPushButton(m_dialog);
+        m_cancel_btn->setText(QObject::tr("Cancel"));
+        m_gl->addWidget(m_cancel_btn, 5, 3);
+        m_gl->addWidget(m_ok_btn, 5, 4);
+        m_dialog->setWindowTitle(QObject::tr("Table editor"));
+        m_dialog->setMinimumWidth(500);
+        m_dialog->setModal(true);
+        connect(m_ok_btn, &QPushButton::clicked, this, &TableEditor::ok_clicked);
+        connect(m_cancel_btn, &QPushButton::clicked, this, &TableEditor::cancel_clicked);
+}
+
+TableEditor::~TableEditor()
+{
+}
+
+void TableEditor::addRange(int row, const QString& label, int index)
+{
+        m_name[index] = new QLineEdit(m_dialog);
+        m_name[index]->setValidator(new QRegularExpressionValidator(QRegularExpression("[A-Za-z][A-Za-z0-9]*"),
+                                                                    m_name[index]));
+        m_from[index] = new QDoubleSpinBox(m_dialog);
+        m_to[index] = new QDoubleSpinBox(m_dialog);
+        QDoubleSpinBox* boxes[2] = {m_from[index], m_to[index]};
+        for (QDoubleSpinBox* box : boxes) {
+                box->setRange(-DBL_MAX, DBL_MAX);
+                box->setDecimals(6);
+        }
+        m_steps[index] = new QSpinBox(m_dialog);
+        m_steps[index]->setRange(1, static_cast<int>(EgcParameterSweep::s_maxPoints));
+
+        m_gl->addWidget(new QLabel(label, m_dialog), row, 0);
+        m_gl->addWidget(m_name[index], row, 1);
+        m_gl->addWidget(m_from[index], row, 2);
+        m_gl->addWidget(m_to[index], row, 3);
+        m_gl->addWidget(m_steps[index], row, 4);
+}
+
+bool TableEditor::exec(EgcParameterSweep& sweep)
+{
+        m_expression->setText(sweep.getExpression());
+        m_error->setText(sweep.getErrorMessage());
+        for (int i = 0; i < 2; i++) {
+                const EgcSweepRange& range = sweep.getRange(i);
+                m_name[i]->setText(range.m_name);
+                m_from[i]->setValue(range.m_from);
+                m_to[i]->setValue(range.m_to);
+                m_steps[i]->setValue(qMax(range.m_steps, static_cast<quint32>(i == 0 ? 11 : 1)));
+        }
+
+        if (m_dialog->exec() != QDialog::Accepted)
+                return false;
+
+        for (int i = 0; i < 2; i++)
+                sweep.setRange(i, EgcSweepRange(m_name[i]->text(), m_from[i]->value(), m_to[i]->value(),
+                                                static_cast<quint32>(m_steps[i]->value())));
+        sweep.setExpression(m_expression->text());
+
+        return true;
+}
+
+void TableEditor::ok_clicked()
+{
+        // reject sweeps that would not fit into a single kernel command
+        quint64 points = static_cast<quint64>(m_steps[0]->value());
+        if (!m_name[1]->text().isEmpty())
+                points *= static_cast<quint64>(m_steps[1]->value());
+        if (points > EgcParameterSweep::s_maxPoints) {
+                m_error->setText(QObject::tr("Too many points (maximum %1).").arg(EgcParameterSweep::s_maxPoints));
+                return;
+        }
+
+        m_dialog->accept();
+}
+
+void TableEditor::cancel_clicked()
+{
+        m_dialog->reject();
+}
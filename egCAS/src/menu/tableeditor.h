@@ -0,0 +1,80 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+#ifndef TABLEEDITOR_H
+#define TABLEEDITOR_H
+
+#include <QWidget>
+
+class QDialog;
+class QGridLayout;
+class QPushButton;
+class QLineEdit;
+class QDoubleSpinBox;
+class QSpinBox;
+class QLabel;
+class EgcParameterSweep;
+
+class TableEditor : public QWidget
+{
+        Q_OBJECT
+public:
+        TableEditor(QWidget* parent = nullptr);
+        virtual ~TableEditor();
+        /**
+         * @brief exec executes the table editor and sets the expression and parameter ranges entered
+         * @param sweep the parameter sweep to edit
+         * @return true if the user accepted the changes, false otherwise (the sweep is unchanged then)
+         */
+        bool exec(EgcParameterSweep& sweep);
+
+public slots:
+        void ok_clicked(void);
+        void cancel_clicked(void);
+private:
+        /**
+         * @brief addRange adds the input fields for a parameter range to the dialog
+         * @param row the row in the layout where to add the fields
+         * @param label the label of the parameter
+         * @param index the index of the parameter
+         */
+        void addRange(int row, const QString& label, int index);
+
+        QDialog *m_dialog;
+        QGridLayout *m_gl;
+        QLineEdit *m_expression;
+        QLineEdit *m_name[2];
+        QDoubleSpinBox *m_from[2];
+        QDoubleSpinBox *m_to[2];
+        QSpinBox *m_steps[2];
+        QLabel *m_error;
+        QPushButton *m_ok_btn;
+        QPushButton *m_cancel_btn;
+};
+
+#endif // TABLEEDITOR_H
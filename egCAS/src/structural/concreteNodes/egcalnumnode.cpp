@@ -119,18 +119,17 @@ void EgcAlnumNode::optimizeRegexes()
         }
 }
 
-void EgcAlnumNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcAlnumNode::serializeAttributes(QXmlStreamAttributes& attr)
 {
-        stream.writeAttribute("value", m_value);
+        attr.append("value", m_value);
         if (m_firstCharMightBeNumber)
-                stream.writeAttribute("firstCharMightBeNumber", QString("true"));
+                attr.append("firstCharMightBeNumber", QString("true"));
         else
-                stream.writeAttribute("firstCharMightBeNumber", QString("false"));
+                attr.append("firstCharMightBeNumber", QString("false"));
 }
 
-void EgcAlnumNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcAlnumNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
 
         if (attr.hasAttribute("value"))
@@ -80,22 +80,21 @@ void EgcDifferentialNode::setDifferentialType(EgcDifferentialNode::DifferentialT
         m_differentialType = type;
 }
 
-void EgcDifferentialNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcDifferentialNode::serializeAttributes(QXmlStreamAttributes& attr)
 {
-        stream.writeAttribute("derivative", QString("%1").arg(m_derivative));
+        attr.append("derivative", QString("%1").arg(m_derivative));
         if (m_differentialType == DifferentialType::lagrange1)
-                stream.writeAttribute("differential_type", "lagrange1");
+                attr.append("differential_type", "lagrange1");
         if (m_differentialType == DifferentialType::lagrange2)
-                stream.writeAttribute("differential_type", "lagrange2");
+                attr.append("differential_type", "lagrange2");
         if (m_differentialType == DifferentialType::lagrange3)
-                stream.writeAttribute("differential_type", "lagrange3");
+                attr.append("differential_type", "lagrange3");
         if (m_differentialType == DifferentialType::leibnitz)
-                stream.writeAttribute("differential_type", "leibnitz");
+                attr.append("differential_type", "leibnitz");
 }
 
-void EgcDifferentialNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcDifferentialNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
 
         if (attr.hasAttribute("derivative"))
@@ -28,6 +28,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include "egcequalnode.h"
 #include "../egcnodecreator.h"
+#include "document/egcbinarydocument.h"
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -49,7 +50,9 @@ void EgcEqualNode::serialize(QXmlStreamWriter& stream, SerializerProperties& pro
         EgcNode* node;
         QLatin1String str = EgcNodeCreator::stringize(getNodeType());
         stream.writeStartElement(str);
-        serializeAttributes(stream);
+        QXmlStreamAttributes attr;
+        serializeAttributes(attr);
+        stream.writeAttributes(attr);
 
         node = getChild(0);
         if (node)
@@ -62,3 +65,21 @@ void EgcEqualNode::serialize(QXmlStreamWriter& stream, SerializerProperties& pro
         stream.writeEndElement();
 }
 
+void EgcEqualNode::serializeBinary(EgcBinaryDocument& document)
+{
+        EgcNode* node;
+        QXmlStreamAttributes attr;
+        serializeAttributes(attr);
+        document.writeStartElement(getNodeType(), attr);
+
+        node = getChild(0);
+        if (node)
+                node->serializeBinary(document);
+
+        //write empty element to file
+        document.writeStartElement(EgcNodeType::EmptyNode);
+        document.writeEndElement();
+
+        document.writeEndElement();
+}
+
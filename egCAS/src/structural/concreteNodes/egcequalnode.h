@@ -51,6 +51,11 @@ public:
          * @param stream the stream to use for serializing this class
          */
         virtual void serialize(QXmlStreamWriter& stream, SerializerProperties &properties) override;
+        /**
+         * @brief serializeBinary interface for serializing a class directly into a binary document
+         * @param document the binary document to write to
+         */
+        virtual void serializeBinary(EgcBinaryDocument& document) override;
 
 protected:
 };
@@ -77,14 +77,13 @@ QString EgcFunctionNode::getStuffedName()
         return EgcAlnumNode::encode(m_fncName);
 }
 
-void EgcFunctionNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcFunctionNode::serializeAttributes(QXmlStreamAttributes& attr)
 {
-        stream.writeAttribute("name", m_fncName);
+        attr.append("name", m_fncName);
 }
 
-void EgcFunctionNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcFunctionNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
 
         if (attr.hasAttribute("name"))
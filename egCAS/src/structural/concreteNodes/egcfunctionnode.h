@@ -80,17 +80,16 @@ public:
         virtual QString getStuffedName(void);
         /**
          * @brief interface for serializing the attributes of a formula operation
-         * @param stream the stream to use for serializing this class
+         * @param attr the attributes to add the attributes of this node to
          */
-        virtual void serializeAttributes(QXmlStreamWriter& stream) override;
+        virtual void serializeAttributes(QXmlStreamAttributes& attr) override;
 
         /**
          * @brief deserialize interface for deserializing the attributes of a formula operation
-         * @param stream the xml reader stream
          * @param version the version of the stream that is to be deserialized
          * @param attr the xml attributes provided by the parent
          */
-        virtual void deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr) override;
+        virtual void deserializeAttributes(quint32 version, QXmlStreamAttributes& attr) override;
 
 
 private:
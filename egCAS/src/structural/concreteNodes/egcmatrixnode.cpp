@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include "egcmatrixnode.h"
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+
+EgcMatrixNode::EgcMatrixNode() : m_rows{0}, m_columns{0}
+{
+
+}
+
+void EgcMatrixNode::setDimension(quint32 rows, quint32 columns)
+{
+        m_rows = rows;
+        m_columns = columns;
+}
+
+quint32 EgcMatrixNode::getRows(void) const
+{
+        return m_rows;
+}
+
+quint32 EgcMatrixNode::getColumns(void) const
+{
+        return m_columns;
+}
+
+EgcNode* EgcMatrixNode::getElement(quint32 row, quint32 column) const
+{
+        if (row >= m_rows || column >= m_columns)
+                return nullptr;
+
+        return getChild(row * m_columns + column);
+}
+
+bool EgcMatrixNode::valid(void)
+{
+        if (m_rows == 0 || m_columns == 0)
+                return false;
+
+        if (static_cast<quint64>(m_rows) * m_columns != static_cast<quint64>(m_childs.count()))
+                return false;
+
+        return EgcFlexNode::valid();
+}
+
+bool EgcMatrixNode::operator==(const EgcNode& node) const
+{
+        if (node.getNodeType() != EgcNodeType::MatrixNode)
+                return false;
+
+        const EgcMatrixNode& matrix = static_cast<const EgcMatrixNode&>(node);
+        if (matrix.m_rows != m_rows || matrix.m_columns != m_columns)
+                return false;
+
+        return EgcFlexNode::operator==(node);
+}
+
+void EgcMatrixNode::serializeAttributes(QXmlStreamAttributes& attr)
+{
+        attr.append("rows", QString::number(m_rows));
+        attr.append("columns", QString::number(m_columns));
+}
+
+void EgcMatrixNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
+{
+        (void) version;
+
+        if (attr.hasAttribute("rows") && attr.hasAttribute("columns"))
+                setDimension(attr.value("rows").toUInt(), attr.value("columns").toUInt());
+}
@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCMATRIXNODE_H
+#define EGCMATRIXNODE_H
+
+#include "egcfnccontainernode.h"
+
+
+/**
+ * @brief The EgcMatrixNode class represents a matrix. The elements are stored in row-major order as direct childs of
+ * the node (one contiguous child vector), so a 100x100 matrix is a single node with 10000 childs and not a tree of
+ * nested lists.
+ */
+class EgcMatrixNode : public EgcFncContainerNode
+{
+        //set the node type of this expression
+        EGC_SET_EXPRESSION_TYPE(EgcMatrixNode, EgcNodeType::MatrixNode);
+public:
+        EgcMatrixNode();
+        /**
+         * @brief setDimension set the dimension of the matrix. The number of childs must be rows * columns to get a
+         * valid matrix.
+         * @param rows the number of rows of the matrix
+         * @param columns the number of columns of the matrix
+         */
+        void setDimension(quint32 rows, quint32 columns);
+        /**
+         * @brief getRows returns the number of rows of the matrix
+         * @return the number of rows
+         */
+        quint32 getRows(void) const;
+        /**
+         * @brief getColumns returns the number of columns of the matrix
+         * @return the number of columns
+         */
+        quint32 getColumns(void) const;
+        /**
+         * @brief getElement returns the element at the given position
+         * @param row the row of the element (starts at 0)
+         * @param column the column of the element (starts at 0)
+         * @return a pointer to the element, or a nullptr if the position is outside of the matrix
+         */
+        EgcNode* getElement(quint32 row, quint32 column) const;
+        /**
+         * @brief valid checks if the matrix is valid. The number of childs must match the dimension of the matrix.
+         * @return returns true if the expression is valid, false otherwise.
+         */
+        virtual bool valid(void) override;
+        /**
+         * @brief operator== comparison operator overload
+         * @param node the node to compare against
+         * @return true if the trees (and the dimensions) are equal
+         */
+        virtual bool operator==(const EgcNode& node) const override;
+        /**
+         * @brief interface for serializing the attributes of a formula operation
+         * @param attr the attributes to add the attributes of this node to
+         */
+        virtual void serializeAttributes(QXmlStreamAttributes& attr) override;
+
+        /**
+         * @brief deserialize interface for deserializing the attributes of a formula operation
+         * @param version the version of the stream that is to be deserialized
+         * @param attr the xml attributes provided by the parent
+         */
+        virtual void deserializeAttributes(quint32 version, QXmlStreamAttributes& attr) override;
+
+protected:
+        quint32 m_rows;         ///< number of rows of the matrix
+        quint32 m_columns;      ///< number of columns of the matrix
+};
+
+#endif // EGCMATRIXNODE_H
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include "egcnumbernode.h"
+#include "document/egcbinarydocument.h"
 
 
 QRegularExpression EgcNumberNode::s_validator = QRegularExpression("[-+.0-9]+");
@@ -77,15 +78,14 @@ int EgcNumberNode::nrSubindexes(void) const
         return m_value.size();
 }
 
-void EgcNumberNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcNumberNode::serializeAttributes(QXmlStreamAttributes& attr)
 {
-        (void) stream;
+        (void) attr;
 }
 
-void EgcNumberNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcNumberNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
         (void) version;
-        (void) stream;
         (void) attr;
 }
 
@@ -106,6 +106,19 @@ void EgcNumberNode::deserialize(QXmlStreamReader& stream, SerializerProperties&
         setValue(stream.readElementText());
 }
 
+void EgcNumberNode::serializeBinary(EgcBinaryDocument& document)
+{
+        document.writeStartElement(getNodeType());
+        document.writeCharacters(m_value);
+        document.writeEndElement();
+}
+
+void EgcNumberNode::deserializeBinary(EgcBinaryReader& reader, quint32 version)
+{
+        (void) version;
+        setValue(reader.readElementText());
+}
+
 bool EgcNumberNode::insert(QChar character, int position)
 {
         bool retval = false;
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egcvariablenode.h"
 #include "structural/specialNodes/egcemptynode.h"
 #include "utils/egcutfcodepoint.h"
+#include "document/egcbinarydocument.h"
 
 
 //ATTENTION: as of now egCAS and even Qt does not support non bmp characters (unicode caracters > 0xFFFF)
@@ -187,3 +188,21 @@ void EgcVariableNode::deserialize(QXmlStreamReader& stream, SerializerProperties
         setValue(stream.readElementText(), subscr);
 }
 
+void EgcVariableNode::serializeBinary(EgcBinaryDocument& document)
+{
+        QXmlStreamAttributes attr;
+        if (!isSubscriptEmptyElement())
+                attr.append("subscript", getSubscript());
+        document.writeStartElement(getNodeType(), attr);
+        document.writeCharacters(m_value);
+        document.writeEndElement();
+}
+
+void EgcVariableNode::deserializeBinary(EgcBinaryReader& reader, quint32 version)
+{
+        (void) version;
+        QString subscr = reader.attributes().value("subscript").toString();
+
+        setValue(reader.readElementText(), subscr);
+}
+
@@ -121,6 +121,17 @@ public:
          * @param properties object with all neccessary information for deserializing
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;
+        /**
+         * @brief serializeBinary interface for serializing a class directly into a binary document
+         * @param document the binary document to write to
+         */
+        virtual void serializeBinary(EgcBinaryDocument& document) override;
+        /**
+         * @brief deserializeBinary interface for deserializing a class directly from a binary document
+         * @param reader the reader positioned at the start element of this node
+         * @param version the version of the document that is to be deserialized
+         */
+        virtual void deserializeBinary(EgcBinaryReader& reader, quint32 version) override;
 
 protected:
 
@@ -67,6 +67,35 @@ public:
          * change of a formula.
          */
         virtual void restartCalculation(void) = 0;
+        /**
+         * @brief entityMoved must be called after the position of an entity has changed. The entity is moved to its
+         * new place in the document and the calculation is restarted if the evaluation order changes.
+         * @param entity the entity that has been moved
+         */
+        virtual void entityMoved(EgcEntity* entity) = 0;
+        /**
+         * @brief beginGroupMove must be called before several entities are moved at once. The single moves reported
+         * until entitiesMoved is called are ignored, since the list is sorted once at the end.
+         */
+        virtual void beginGroupMove(void) = 0;
+        /**
+         * @brief entitiesMoved must be called after several entities have been moved at once (e.g. a multi selection
+         * has been dragged or items have been moved to make room). The document is sorted once and the calculation
+         * is restarted if the order has changed. A group move started with beginGroupMove is finished.
+         */
+        virtual void entitiesMoved(void) = 0;
+        /**
+         * @brief entityChanged must be called after the content of an entity has been changed by the user (e.g. after
+         * editing a formula), so the change can be written to the journal of the document
+         * @param entity the entity that has been changed
+         */
+        virtual void entityChanged(EgcEntity* entity) = 0;
+        /**
+         * @brief entityModified must be called if an entity may be changed without reporting every single change (e.g.
+         * a plot that is zoomed or a text that is edited). The entity is written to the journal at the next save.
+         * @param entity the entity that may have been changed
+         */
+        virtual void entityModified(EgcEntity* entity) = 0;
         /**
          * @brief getMaxSize get the maximum size a rectangular item can have with the given starting point in order
          * to fit into the current worksheet
@@ -0,0 +1,644 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QIODevice>
+#include <QObject>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include "egcbinarydocument.h"
+#include "egcnodecreator.h"
+#include "specialNodes/egcnode_gen.h"
+
+const char EgcBinaryDocument::s_magic[] = "EGCB";
+const quint8 EgcBinaryDocument::s_formatVersion = 1;
+const int EgcBinaryDocument::s_maxInternedText = 64;
+
+EgcBinaryDocument::EgcBinaryDocument() : m_depth{0}, m_sectionStart{0}, m_eventStart{0}, m_eventEnd{0}
+{
+}
+
+bool EgcBinaryDocument::isBinary(const QByteArray& data)
+{
+        if (data.size() < s_headerSize)
+                return false;
+
+        return data.startsWith(s_magic);
+}
+
+bool EgcBinaryDocument::encode(QIODevice& xml, QIODevice& binary)
+{
+        startEncoding();
+        if (!writeXml(xml))
+                return false;
+
+        return finishEncoding(binary);
+}
+
+void EgcBinaryDocument::startEncoding(void)
+{
+        clear();
+}
+
+void EgcBinaryDocument::writeStartElement(const QString& name, const QXmlStreamAttributes& attributes)
+{
+        writeElement(intern(name), attributes);
+}
+
+void EgcBinaryDocument::writeStartElement(EgcNodeType type, const QXmlStreamAttributes& attributes)
+{
+        int i = static_cast<int>(type);
+        if (i >= m_typeIndex.size())
+                m_typeIndex.resize(i + 1);
+        if (m_typeIndex.at(i) == 0)
+                m_typeIndex[i] = intern(EgcNodeCreator::stringize(type)) + 1;
+
+        writeElement(m_typeIndex.at(i) - 1, attributes);
+}
+
+void EgcBinaryDocument::writeCharacters(const QString& text)
+{
+        if (text.size() <= s_maxInternedText) {
+                m_events.append(static_cast<char>(Event::Characters));
+                writeVarint(m_events, intern(text));
+        } else {
+                m_events.append(static_cast<char>(Event::InlineCharacters));
+                writeInline(m_events, text);
+        }
+}
+
+void EgcBinaryDocument::writeEndElement(void)
+{
+        m_events.append(static_cast<char>(Event::EndElement));
+        if (m_depth == 2) {
+                // the name of the section follows the start event
+                int pos = m_sectionStart + 1;
+                EgcBinarySection section;
+                readVarint(m_events, pos, m_events.size(), section.m_name);
+                section.m_offset = static_cast<quint32>(m_sectionStart);
+                section.m_length = static_cast<quint32>(m_events.size() - m_sectionStart);
+                m_sections.append(section);
+        }
+        m_depth--;
+}
+
+bool EgcBinaryDocument::writeXml(QIODevice& xml)
+{
+        QXmlStreamReader reader(&xml);
+
+        while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement:
+                        writeElement(intern(reader.qualifiedName().toString()), reader.attributes());
+                        break;
+                case QXmlStreamReader::EndElement:
+                        writeEndElement();
+                        break;
+                case QXmlStreamReader::Characters:
+                        if (reader.isCDATA()) {
+                                m_events.append(static_cast<char>(Event::CData));
+                                writeInline(m_events, reader.text().toString());
+                        } else {
+                                writeCharacters(reader.text().toString());
+                        }
+                        break;
+                default: // the xml declaration, comments and processing instructions are not part of the document
+                        break;
+                }
+        }
+
+        if (reader.hasError()) {
+                m_error = reader.errorString();
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcBinaryDocument::finishEncoding(QIODevice& binary)
+{
+        if (m_depth != 0) {
+                m_error = QObject::tr("The document has an unexpected structure.");
+                return false;
+        }
+
+        QByteArray data(s_magic, 4);
+        data.append(static_cast<char>(s_formatVersion));
+
+        writeVarint(data, static_cast<quint32>(m_strings.size()));
+        for (int i = 0; i < m_strings.size(); i++)
+                writeInline(data, m_strings.at(i));
+
+        writeVarint(data, static_cast<quint32>(m_events.size()));
+        data.append(m_events);
+
+        writeVarint(data, static_cast<quint32>(m_sections.size()));
+        for (int i = 0; i < m_sections.size(); i++) {
+                writeVarint(data, m_sections.at(i).m_name);
+                writeVarint(data, m_sections.at(i).m_offset);
+                writeVarint(data, m_sections.at(i).m_length);
+        }
+
+        if (binary.write(data) != data.size()) {
+                m_error = binary.errorString();
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcBinaryDocument::decode(const QByteArray& binary, QIODevice& xml)
+{
+        if (!open(binary))
+                return false;
+
+        QXmlStreamWriter stream(&xml);
+        stream.writeStartDocument();
+        if (!decodeEvents(m_data, m_eventStart, m_eventEnd, stream))
+                return false;
+        stream.writeEndDocument();
+
+        if (stream.hasError()) {
+                m_error = xml.errorString();
+                return false;
+        }
+
+        return true;
+}
+
+bool EgcBinaryDocument::open(const QByteArray& binary)
+{
+        clear();
+
+        if (!isBinary(binary)) {
+                m_error = QObject::tr("The file is not a binary egcas file.");
+                return false;
+        }
+        if (static_cast<quint8>(binary.at(4)) > s_formatVersion) {
+                m_error = QObject::tr("This file version is not supported. Maybe saved by a newer version.");
+                return false;
+        }
+
+        int pos = s_headerSize;
+        int end = binary.size();
+        quint32 count;
+        quint32 i;
+        bool ok = readVarint(binary, pos, end, count);
+        if (ok)
+                m_strings.reserve(static_cast<int>(qMin(count, static_cast<quint32>(end - pos))));
+        for (i = 0; ok && i < count; i++) {
+                QString str;
+                ok = readInline(binary, pos, end, str);
+                m_strings.append(str);
+        }
+
+        quint32 length = 0;
+        int eventStart = pos;
+        if (ok) {
+                ok = readVarint(binary, pos, end, length);
+                eventStart = pos;
+                if (length > static_cast<quint32>(end - pos))
+                        ok = false;
+        }
+        int eventEnd = eventStart + static_cast<int>(length);
+
+        pos = eventEnd;
+        if (ok)
+                ok = readVarint(binary, pos, end, count);
+        for (i = 0; ok && i < count; i++) {
+                EgcBinarySection section;
+                ok =    readVarint(binary, pos, end, section.m_name)
+                     && readVarint(binary, pos, end, section.m_offset)
+                     && readVarint(binary, pos, end, section.m_length);
+                if (    section.m_name >= static_cast<quint32>(m_strings.size())
+                     || section.m_offset > length
+                     || section.m_length > length - section.m_offset)
+                        ok = false;
+                m_sections.append(section);
+        }
+
+        if (!ok) {
+                m_error = QObject::tr("The document has an unexpected structure.");
+                return false;
+        }
+
+        // look up the node type of each string only once, so formulas can be read without comparing element names
+        m_nodeTypes.reserve(m_strings.size());
+        for (i = 0; i < static_cast<quint32>(m_strings.size()); i++)
+                m_nodeTypes.append(EgcNodeCreator::getType(QStringRef(&m_strings.at(static_cast<int>(i)))));
+
+        m_data = binary;
+        m_eventStart = eventStart;
+        m_eventEnd = eventEnd;
+
+        return true;
+}
+
+bool EgcBinaryDocument::readRootElement(QString& name, QXmlStreamAttributes& attributes)
+{
+        int pos = m_eventStart;
+        quint32 nrAttributes;
+        bool ok =    pos < m_eventEnd
+                  && static_cast<Event>(m_data.at(pos++)) == Event::StartElement
+                  && readString(m_data, pos, m_eventEnd, name)
+                  && readVarint(m_data, pos, m_eventEnd, nrAttributes);
+
+        attributes.clear();
+        QString attrName;
+        QString value;
+        for (quint32 i = 0; ok && i < nrAttributes; i++) {
+                ok = readString(m_data, pos, m_eventEnd, attrName) && readString(m_data, pos, m_eventEnd, value);
+                if (ok)
+                        attributes.append(attrName, value);
+        }
+
+        if (!ok)
+                m_error = QObject::tr("The document has an unexpected structure.");
+
+        return ok;
+}
+
+bool EgcBinaryDocument::decodeSection(int index, QString& xml)
+{
+        if (index < 0 || index >= m_sections.size()) {
+                m_error = QObject::tr("The document has an unexpected structure.");
+                return false;
+        }
+
+        // the section index has been checked against the length of the event stream when opening the document
+        const EgcBinarySection& section = m_sections.at(index);
+        int start = m_eventStart + static_cast<int>(section.m_offset);
+        QXmlStreamWriter stream(&xml);
+
+        return decodeEvents(m_data, start, start + static_cast<int>(section.m_length), stream);
+}
+
+const QVector<EgcBinarySection>& EgcBinaryDocument::getSections(void) const
+{
+        return m_sections;
+}
+
+QString EgcBinaryDocument::getString(quint32 index) const
+{
+        if (index >= static_cast<quint32>(m_strings.size()))
+                return QString();
+
+        return m_strings.at(static_cast<int>(index));
+}
+
+EgcNodeType EgcBinaryDocument::getNodeType(quint32 index) const
+{
+        if (index >= static_cast<quint32>(m_nodeTypes.size()))
+                return EgcNodeType::NodeUndefined;
+
+        return m_nodeTypes.at(static_cast<int>(index));
+}
+
+QString EgcBinaryDocument::getErrorString(void) const
+{
+        return m_error;
+}
+
+void EgcBinaryDocument::clear(void)
+{
+        m_index.clear();
+        m_strings.clear();
+        m_typeIndex.clear();
+        m_nodeTypes.clear();
+        m_events.clear();
+        m_depth = 0;
+        m_sectionStart = 0;
+        m_sections.clear();
+        m_error.clear();
+        m_data.clear();
+        m_eventStart = 0;
+        m_eventEnd = 0;
+}
+
+quint32 EgcBinaryDocument::intern(const QString& str)
+{
+        QHash<QString, quint32>::const_iterator it = m_index.constFind(str);
+        if (it != m_index.constEnd())
+                return it.value();
+
+        quint32 index = static_cast<quint32>(m_strings.size());
+        m_strings.append(str);
+        m_index.insert(str, index);
+
+        return index;
+}
+
+void EgcBinaryDocument::writeElement(quint32 name, const QXmlStreamAttributes& attributes)
+{
+        m_depth++;
+        if (m_depth == 2)
+                m_sectionStart = m_events.size();
+        m_events.append(static_cast<char>(Event::StartElement));
+        writeVarint(m_events, name);
+        writeVarint(m_events, static_cast<quint32>(attributes.size()));
+        for (int i = 0; i < attributes.size(); i++) {
+                writeVarint(m_events, intern(attributes.at(i).qualifiedName().toString()));
+                writeVarint(m_events, intern(attributes.at(i).value().toString()));
+        }
+}
+
+void EgcBinaryDocument::writeVarint(QByteArray& data, quint32 value)
+{
+        while (value >= 0x80) {
+                data.append(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+        }
+        data.append(static_cast<char>(value));
+}
+
+void EgcBinaryDocument::writeInline(QByteArray& data, const QString& str)
+{
+        QByteArray utf8 = str.toUtf8();
+        writeVarint(data, static_cast<quint32>(utf8.size()));
+        data.append(utf8);
+}
+
+bool EgcBinaryDocument::readVarint(const QByteArray& data, int& pos, int end, quint32& value)
+{
+        value = 0;
+        for (int shift = 0; shift < 32; shift += 7) {
+                if (pos >= end)
+                        return false;
+                quint8 byte = static_cast<quint8>(data.at(pos++));
+                value |= static_cast<quint32>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                        return true;
+        }
+
+        return false;
+}
+
+bool EgcBinaryDocument::readInline(const QByteArray& data, int& pos, int end, QString& str)
+{
+        quint32 length;
+        if (!readVarint(data, pos, end, length))
+                return false;
+        if (length > static_cast<quint32>(end - pos))
+                return false;
+
+        str = QString::fromUtf8(data.constData() + pos, static_cast<int>(length));
+        pos += static_cast<int>(length);
+
+        return true;
+}
+
+bool EgcBinaryDocument::readString(const QByteArray& data, int& pos, int end, QString& str) const
+{
+        quint32 index;
+        if (!readVarint(data, pos, end, index))
+                return false;
+        if (index >= static_cast<quint32>(m_strings.size()))
+                return false;
+
+        str = m_strings.at(static_cast<int>(index));
+
+        return true;
+}
+
+bool EgcBinaryDocument::decodeEvents(const QByteArray& data, int pos, int end, QXmlStreamWriter& stream)
+{
+        int depth = 0;
+        bool ok = true;
+        QString name;
+        QString value;
+        quint32 nrAttributes;
+
+        while (ok && pos < end) {
+                Event event = static_cast<Event>(data.at(pos++));
+                switch (event) {
+                case Event::StartElement:
+                        ok = readString(data, pos, end, name) && readVarint(data, pos, end, nrAttributes);
+                        if (!ok)
+                                break;
+                        stream.writeStartElement(name);
+                        for (quint32 i = 0; ok && i < nrAttributes; i++) {
+                                ok = readString(data, pos, end, name) && readString(data, pos, end, value);
+                                if (ok)
+                                        stream.writeAttribute(name, value);
+                        }
+                        depth++;
+                        break;
+                case Event::EndElement:
+                        if (depth == 0) {
+                                ok = false;
+                                break;
+                        }
+                        stream.writeEndElement();
+                        depth--;
+                        break;
+                case Event::Characters:
+                        ok = readString(data, pos, end, value);
+                        if (ok)
+                                stream.writeCharacters(value);
+                        break;
+                case Event::InlineCharacters:
+                        ok = readInline(data, pos, end, value);
+                        if (ok)
+                                stream.writeCharacters(value);
+                        break;
+                case Event::CData:
+                        ok = readInline(data, pos, end, value);
+                        if (ok)
+                                stream.writeCDATA(value);
+                        break;
+                default:
+                        ok = false;
+                        break;
+                }
+        }
+
+        if (!ok || depth != 0) {
+                m_error = QObject::tr("The document has an unexpected structure.");
+                return false;
+        }
+
+        return true;
+}
+
+EgcBinaryReader::EgcBinaryReader(QSharedPointer<const EgcBinaryDocument> document, quint32 offset, quint32 length) :
+                                 m_document{document}, m_pos{0}, m_end{0}, m_depth{0}, m_name{0}, m_elementStart{0},
+                                 m_error{false}
+{
+        quint32 size = static_cast<quint32>(m_document->m_eventEnd - m_document->m_eventStart);
+        if (offset > size || length > size - offset) {
+                m_error = true;
+                return;
+        }
+
+        m_pos = m_document->m_eventStart + static_cast<int>(offset);
+        m_end = m_pos + static_cast<int>(length);
+        m_elementStart = m_pos;
+}
+
+bool EgcBinaryReader::readNextStartElement(void)
+{
+        while (!m_error) {
+                switch (static_cast<EgcBinaryDocument::Event>(readEvent())) {
+                case EgcBinaryDocument::Event::StartElement:
+                        return true;
+                case EgcBinaryDocument::Event::EndElement:
+                        return false;
+                case EgcBinaryDocument::Event::Characters:
+                case EgcBinaryDocument::Event::InlineCharacters:
+                case EgcBinaryDocument::Event::CData:
+                        break; // whitespace between elements
+                default:
+                        return false;
+                }
+        }
+
+        return false;
+}
+
+void EgcBinaryReader::skipCurrentElement(void)
+{
+        int depth = m_depth - 1;
+        while (!m_error && m_depth > depth) {
+                if (readEvent() == 0)
+                        break;
+        }
+}
+
+QString EgcBinaryReader::readElementText(void)
+{
+        QString text;
+        int depth = m_depth - 1;
+        while (!m_error && m_depth > depth) {
+                switch (static_cast<EgcBinaryDocument::Event>(readEvent())) {
+                case EgcBinaryDocument::Event::Characters:
+                case EgcBinaryDocument::Event::InlineCharacters:
+                case EgcBinaryDocument::Event::CData:
+                        text += m_text;
+                        break;
+                case EgcBinaryDocument::Event::EndElement:
+                        break;
+                default: // no elements allowed inside a text element
+                        raiseError();
+                        break;
+                }
+        }
+
+        return text;
+}
+
+QString EgcBinaryReader::name(void) const
+{
+        return m_document->getString(m_name);
+}
+
+EgcNodeType EgcBinaryReader::nodeType(void) const
+{
+        return m_document->getNodeType(m_name);
+}
+
+const QXmlStreamAttributes& EgcBinaryReader::attributes(void) const
+{
+        return m_attributes;
+}
+
+quint32 EgcBinaryReader::offset(void) const
+{
+        return static_cast<quint32>(m_elementStart - m_document->m_eventStart);
+}
+
+quint32 EgcBinaryReader::position(void) const
+{
+        return static_cast<quint32>(m_pos - m_document->m_eventStart);
+}
+
+QSharedPointer<const EgcBinaryDocument> EgcBinaryReader::getDocument(void) const
+{
+        return m_document;
+}
+
+void EgcBinaryReader::raiseError(void)
+{
+        m_error = true;
+}
+
+bool EgcBinaryReader::hasError(void) const
+{
+        return m_error;
+}
+
+quint8 EgcBinaryReader::readEvent(void)
+{
+        if (m_error || m_pos >= m_end)
+                return 0;
+
+        const QByteArray& data = m_document->m_data;
+        int start = m_pos;
+        quint8 event = static_cast<quint8>(data.at(m_pos++));
+        bool ok = true;
+        quint32 nrAttributes;
+        QString name;
+        QString value;
+
+        switch (static_cast<EgcBinaryDocument::Event>(event)) {
+        case EgcBinaryDocument::Event::StartElement:
+                ok =    EgcBinaryDocument::readVarint(data, m_pos, m_end, m_name)
+                     && m_name < static_cast<quint32>(m_document->m_strings.size())
+                     && EgcBinaryDocument::readVarint(data, m_pos, m_end, nrAttributes);
+                m_attributes.clear();
+                for (quint32 i = 0; ok && i < nrAttributes; i++) {
+                        ok =    m_document->readString(data, m_pos, m_end, name)
+                             && m_document->readString(data, m_pos, m_end, value);
+                        if (ok)
+                                m_attributes.append(name, value);
+                }
+                m_elementStart = start;
+                m_depth++;
+                break;
+        case EgcBinaryDocument::Event::EndElement:
+                m_depth--;
+                ok = m_depth >= 0;
+                break;
+        case EgcBinaryDocument::Event::Characters:
+                ok = m_document->readString(data, m_pos, m_end, m_text);
+                break;
+        case EgcBinaryDocument::Event::InlineCharacters:
+        case EgcBinaryDocument::Event::CData:
+                ok = EgcBinaryDocument::readInline(data, m_pos, m_end, m_text);
+                break;
+        default:
+                ok = false;
+                break;
+        }
+
+        if (!ok) {
+                raiseError();
+                return 0;
+        }
+
+        return event;
+}
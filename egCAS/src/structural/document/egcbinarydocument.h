@@ -0,0 +1,368 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCBINARYDOCUMENT_H
+#define EGCBINARYDOCUMENT_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QXmlStreamAttributes>
+
+class QIODevice;
+class QXmlStreamWriter;
+enum class EgcNodeType;
+
+/**
+ * @brief The EgcBinarySection struct describes a top level element (e.g. an entity) inside the event stream of a
+ * binary document
+ */
+struct EgcBinarySection
+{
+        quint32 m_name;         ///< index of the element name in the string table
+        quint32 m_offset;       ///< offset of the element start in the event stream
+        quint32 m_length;       ///< length of the element (including its end) in the event stream
+};
+
+/**
+ * @brief The EgcBinaryDocument class converts egcas xml documents into a compact binary format and back. The binary
+ * format is a lossless encoding of the xml events, so a document can be converted in both directions without changes.
+ * All element names, attribute names, attribute values and short texts are stored only once in a string table and
+ * are referenced by index (e.g. every formula node type is stored once and then referenced by a small tag).
+ *
+ * Layout of the format (all numbers are varint encoded, that is 7 bits per byte, least significant group first):
+ * - header: "EGCB" and the format version (one byte)
+ * - string table: number of strings, then for each string its utf-8 length and the utf-8 bytes
+ * - event stream: length of the stream in bytes, then the events (a tag byte followed by its operands)
+ * - section index: number of sections, then name, offset and length of each top level element inside the document
+ *
+ * Formulas are written directly from their node trees (see writeStartElement and EgcNode::serializeBinary) and read
+ * directly into nodes with EgcBinaryReader, so they don't take the way through xml text. The node type of every
+ * element name in the string table is looked up only once when the document is opened.
+ */
+class EgcBinaryDocument
+{
+        friend class EgcBinaryReader;
+public:
+        EgcBinaryDocument();
+        /**
+         * @brief isBinary checks if the given data starts with the header of a binary document
+         * @param data the data to check (at least the first s_headerSize bytes of a file)
+         * @return true if the data is a binary document, false otherwise
+         */
+        static bool isBinary(const QByteArray& data);
+        /**
+         * @brief encode reads the xml document from the device given and writes the binary document
+         * @param xml the device to read the xml document from
+         * @param binary the device to write the binary document to
+         * @return true if everything went well, false otherwise (see getErrorString)
+         */
+        bool encode(QIODevice& xml, QIODevice& binary);
+        /**
+         * @brief startEncoding starts writing a new document with writeStartElement, writeCharacters, writeEndElement
+         * and writeXml. The document is written to a device with finishEncoding.
+         */
+        void startEncoding(void);
+        /**
+         * @brief writeStartElement writes the start of an element
+         * @param name the name of the element
+         * @param attributes the attributes of the element
+         */
+        void writeStartElement(const QString& name, const QXmlStreamAttributes& attributes = QXmlStreamAttributes());
+        /**
+         * @brief writeStartElement writes the start of a formula node. The name of the node type is looked up in the
+         * string table only once per document.
+         * @param type the type of the node
+         * @param attributes the attributes of the node
+         */
+        void writeStartElement(EgcNodeType type, const QXmlStreamAttributes& attributes = QXmlStreamAttributes());
+        /**
+         * @brief writeCharacters writes the text of the current element
+         * @param text the text to write
+         */
+        void writeCharacters(const QString& text);
+        /**
+         * @brief writeEndElement writes the end of the current element
+         */
+        void writeEndElement(void);
+        /**
+         * @brief writeXml encodes the xml given at the current position (e.g. an entity that has been serialized as
+         * xml already)
+         * @param xml the device to read the xml from
+         * @return true if everything went well, false otherwise (see getErrorString)
+         */
+        bool writeXml(QIODevice& xml);
+        /**
+         * @brief finishEncoding writes the document started with startEncoding to the device given
+         * @param binary the device to write the binary document to
+         * @return true if everything went well, false otherwise (see getErrorString)
+         */
+        bool finishEncoding(QIODevice& binary);
+        /**
+         * @brief decode decodes the binary document given and writes the xml document
+         * @param binary the binary document
+         * @param xml the device to write the xml document to
+         * @return true if everything went well, false otherwise (see getErrorString)
+         */
+        bool decode(const QByteArray& binary, QIODevice& xml);
+        /**
+         * @brief open reads the string table and the section index of the binary document given. No events are
+         * decoded, so the document can be read section by section with readRootElement and decodeSection.
+         * @param binary the binary document
+         * @return true if everything went well, false otherwise (see getErrorString)
+         */
+        bool open(const QByteArray& binary);
+        /**
+         * @brief readRootElement reads the name and the attributes of the root element of the document opened directly
+         * from the event stream
+         * @param name the name of the root element
+         * @param attributes the attributes of the root element
+         * @return true if everything went well, false if the data is corrupted
+         */
+        bool readRootElement(QString& name, QXmlStreamAttributes& attributes);
+        /**
+         * @brief decodeSection decodes a single top level element of the document opened as xml text
+         * @param index the index of the section (see getSections)
+         * @param xml the string to write the xml text of the section to
+         * @return true if everything went well, false if the data is corrupted
+         */
+        bool decodeSection(int index, QString& xml);
+        /**
+         * @brief getSections returns the section index of the document encoded or decoded last
+         * @return the top level elements of the document with their position in the event stream
+         */
+        const QVector<EgcBinarySection>& getSections(void) const;
+        /**
+         * @brief getString returns a string of the string table of the document encoded or decoded last
+         * @param index the index of the string
+         * @return the string at the given index or an empty string if the index is out of range
+         */
+        QString getString(quint32 index) const;
+        /**
+         * @brief getNodeType returns the node type of a string of the string table of the document opened
+         * @param index the index of the string
+         * @return the node type or EgcNodeType::NodeUndefined if the string is no node name
+         */
+        EgcNodeType getNodeType(quint32 index) const;
+        /**
+         * @brief getErrorString returns a description of the last error
+         * @return the error message
+         */
+        QString getErrorString(void) const;
+
+        static const int s_headerSize = 5;      ///< size of the header (magic and format version)
+
+private:
+        /**
+         * @brief The Event enum denotes the events inside the event stream
+         */
+        enum class Event : quint8
+        {
+                StartElement = 1,       ///< element name, number of attributes, (attribute name, value) pairs
+                EndElement,             ///< end of the current element
+                Characters,             ///< text from the string table
+                InlineCharacters,       ///< text stored directly in the stream (long texts like images)
+                CData                   ///< cdata section stored directly in the stream
+        };
+
+        /**
+         * @brief clear clears the string table and the section index
+         */
+        void clear(void);
+        /**
+         * @brief intern returns the index of the string given in the string table (the string is added if needed)
+         * @param str the string to look up
+         * @return the index of the string
+         */
+        quint32 intern(const QString& str);
+        /**
+         * @brief writeVarint appends a varint to the data given
+         * @param data the data to append the varint to
+         * @param value the value to append
+         */
+        static void writeVarint(QByteArray& data, quint32 value);
+        /**
+         * @brief writeInline appends a string as utf-8 (with its length in front of it) to the data given
+         * @param data the data to append the string to
+         * @param str the string to append
+         */
+        static void writeInline(QByteArray& data, const QString& str);
+        /**
+         * @brief writeElement writes the start of an element with the name at the given index of the string table
+         * @param name the index of the element name
+         * @param attributes the attributes of the element
+         */
+        void writeElement(quint32 name, const QXmlStreamAttributes& attributes);
+        /**
+         * @brief readVarint reads a varint
+         * @param data the data to read from
+         * @param pos the position to read from, is incremented to the position behind the varint
+         * @param end the position behind the last byte that may be read
+         * @param value the value read
+         * @return true if everything went well, false if the data is corrupted
+         */
+        static bool readVarint(const QByteArray& data, int& pos, int end, quint32& value);
+        /**
+         * @brief readInline reads a string stored as utf-8 (with its length in front of it)
+         * @param data the data to read from
+         * @param pos the position to read from, is incremented to the position behind the string
+         * @param end the position behind the last byte that may be read
+         * @param str the string read
+         * @return true if everything went well, false if the data is corrupted
+         */
+        static bool readInline(const QByteArray& data, int& pos, int end, QString& str);
+        /**
+         * @brief readString reads a string table reference
+         * @param data the data to read from
+         * @param pos the position to read from, is incremented to the position behind the reference
+         * @param end the position behind the last byte that may be read
+         * @param str the string referenced
+         * @return true if everything went well, false if the data is corrupted
+         */
+        bool readString(const QByteArray& data, int& pos, int end, QString& str) const;
+        /**
+         * @brief decodeEvents decodes the events of the event stream and writes them as xml
+         * @param data the binary document
+         * @param pos the start of the events to decode
+         * @param end the position behind the last event to decode
+         * @param stream the xml stream to write to
+         * @return true if everything went well, false if the data is corrupted
+         */
+        bool decodeEvents(const QByteArray& data, int pos, int end, QXmlStreamWriter& stream);
+
+        static const char s_magic[];            ///< magic at the start of a binary document
+        static const quint8 s_formatVersion;    ///< version of the binary format
+        static const int s_maxInternedText;     ///< texts that are longer are stored inline
+
+        QHash<QString, quint32> m_index;        ///< index of each string in the string table
+        QVector<QString> m_strings;             ///< the string table
+        QVector<quint32> m_typeIndex;           ///< string index + 1 of each node type name, 0 if not added (encoding)
+        QVector<EgcNodeType> m_nodeTypes;       ///< node type of each string in the string table (decoding)
+        QByteArray m_events;                    ///< the event stream of the document being encoded
+        int m_depth;                            ///< depth of the current element of the document being encoded
+        int m_sectionStart;                     ///< start of the current top level element being encoded
+        QVector<EgcBinarySection> m_sections;   ///< the section index
+        QByteArray m_data;                      ///< the binary document opened
+        int m_eventStart;                       ///< start of the event stream in the document opened
+        int m_eventEnd;                         ///< position behind the event stream in the document opened
+        QString m_error;                        ///< description of the last error
+};
+
+/**
+ * @brief The EgcBinaryReader class reads the elements of a binary document directly from the event stream (without
+ * converting them to xml). The interface follows QXmlStreamReader, so nodes are deserialized the same way in both
+ * formats. The reader only needs read access to the document, so several readers may be used on different threads.
+ */
+class EgcBinaryReader
+{
+public:
+        /**
+         * @brief EgcBinaryReader std constructor
+         * @param document the (opened) binary document to read from
+         * @param offset the offset of the events to read in the event stream (e.g. of a section)
+         * @param length the length of the events to read
+         */
+        EgcBinaryReader(QSharedPointer<const EgcBinaryDocument> document, quint32 offset, quint32 length);
+        /**
+         * @brief readNextStartElement reads until the next start element inside the current element
+         * @return true if a start element has been read, false if the current element ended (or on errors)
+         */
+        bool readNextStartElement(void);
+        /**
+         * @brief skipCurrentElement reads until the end of the current element
+         */
+        void skipCurrentElement(void);
+        /**
+         * @brief readElementText reads the text of the current element up to its end
+         * @return the text of the element
+         */
+        QString readElementText(void);
+        /**
+         * @brief name returns the name of the current element
+         * @return the name of the element
+         */
+        QString name(void) const;
+        /**
+         * @brief nodeType returns the node type of the current element
+         * @return the node type or EgcNodeType::NodeUndefined if the element is no formula node
+         */
+        EgcNodeType nodeType(void) const;
+        /**
+         * @brief attributes returns the attributes of the current element
+         * @return the attributes of the element
+         */
+        const QXmlStreamAttributes& attributes(void) const;
+        /**
+         * @brief offset returns the offset of the current element in the event stream
+         * @return the offset of the start of the current element
+         */
+        quint32 offset(void) const;
+        /**
+         * @brief position returns the offset of the reading position in the event stream (e.g. behind the end of an
+         * element after skipCurrentElement)
+         * @return the offset of the next event to read
+         */
+        quint32 position(void) const;
+        /**
+         * @brief getDocument returns the document that is read
+         * @return the binary document
+         */
+        QSharedPointer<const EgcBinaryDocument> getDocument(void) const;
+        /**
+         * @brief raiseError marks the data as corrupted, all following reads fail
+         */
+        void raiseError(void);
+        /**
+         * @brief hasError checks if the data read has been corrupted
+         * @return true if the data is corrupted, false otherwise
+         */
+        bool hasError(void) const;
+
+private:
+        /**
+         * @brief readEvent reads the next event
+         * @return the event read, or 0 at the end of the data or on errors
+         */
+        quint8 readEvent(void);
+
+        QSharedPointer<const EgcBinaryDocument> m_document;     ///< the document to read from
+        int m_pos;                              ///< current position in the document data
+        int m_end;                              ///< position behind the last event that may be read
+        int m_depth;                            ///< depth of the current element (relative to the start)
+        quint32 m_name;                         ///< string index of the name of the current element
+        QXmlStreamAttributes m_attributes;      ///< attributes of the current element
+        int m_elementStart;                     ///< position of the start of the current element
+        QString m_text;                         ///< text read by the last event
+        bool m_error;                           ///< true if the data is corrupted
+};
+
+#endif // EGCBINARYDOCUMENT_H
@@ -31,16 +31,25 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egccalculation.h"
 #include "casKernel/egckernelconn.h"
 #include "casKernel/egcmaximaconn.h"
+#include "casKernel/egcnumericevaluator.h"
 #include "entities/egcentity.h"
 #include "entities/egcformulaentity.h"
+#include "entities/egctableentity.h"
+#include "entities/egcplotentity.h"
 #include "egcnodes.h"
+#include "iterator/egcnodeiterator.h"
 #include "casKernel/parser/egckernelparser.h"
+#include "egcsessionrecorder.h"
 
 
-EgcCalculation::EgcCalculation(QObject *parent) : QObject{parent}, m_conn{new EgcMaximaConn()}, m_iterator{nullptr},
+EgcCalculation::EgcCalculation(QObject *parent) : EgcCalculation{new EgcMaximaConn(), parent}
+{
+}
+
+EgcCalculation::EgcCalculation(EgcKernelConn* conn, QObject *parent) : QObject{parent}, m_conn{conn}, m_iterator{nullptr},
         m_kernelStarted{false}, m_computeWhenStarted{false}, m_updateInstantly{true}, m_parser{new EgcKernelParser()},
-        m_result{nullptr}, m_entity{nullptr}, m_autoCalc{true},
-        m_waitForResult{false}, m_list{nullptr}, m_state{CalcualtionState::notStarted}
+        m_numeric{new EgcNumericEvaluator()}, m_result{nullptr}, m_table{nullptr}, m_entity{nullptr},
+        m_autoCalc{true}, m_waitForResult{false}, m_list{nullptr}, m_state{CalcualtionState::notStarted}
 {
         
         connect(m_conn.data(), SIGNAL(resultReceived(QString)), this, SLOT(resultReceived(QString)));
@@ -69,9 +78,12 @@ bool EgcCalculation::calculate(EgcEntityList& list, bool updateInstantly, EgcAbs
 
         m_list = &list;
 
+        // resetting the kernel removes all definitions, including the deleted ones
+        m_pendingKills.clear();
         m_conn->reset();
+        m_numeric->clear();
                 
-        m_iterator.reset(new QMutableListIterator<EgcEntity*>(list.getIterator()));
+        m_iterator.reset(new EgcEntityListCursor(list));
 
         m_updateInstantly = updateInstantly;
         if (!m_kernelStarted) {
@@ -87,12 +99,16 @@ bool EgcCalculation::restart(void)
 {
         if (!m_iterator) {
                 if (m_list)
-                        m_iterator.reset(new QMutableListIterator<EgcEntity*>(m_list->getIterator()));
+                        m_iterator.reset(new EgcEntityListCursor(*m_list));
         }
+        if (!m_iterator)
+                return false;
         if (!m_autoCalc && m_entity) // only if auto calculation is active
                 return false;
 
+        m_pendingKills.clear();
         m_conn->reset();
+        m_numeric->clear();
 
         m_iterator->toFront();
         nextCalculation();
@@ -115,6 +131,10 @@ void EgcCalculation::nextCalculation(void)
                         if (entity) {
                                 if (entity->getEntityType() == EgcEntityType::Formula)
                                         handleCalculation(static_cast<EgcFormulaEntity&>(*entity));
+                                else if (entity->getEntityType() == EgcEntityType::Table)
+                                        handleTable(static_cast<EgcTableEntity&>(*entity));
+                                else if (entity->getEntityType() == EgcEntityType::Plot)
+                                        handlePlot(static_cast<EgcPlotEntity&>(*entity));
                                 else
                                         triggerNextCalcualtion();
                         } else {
@@ -146,6 +166,7 @@ void EgcCalculation::resumeCalculation(void)
 void EgcCalculation::handleCalculation(EgcFormulaEntity& entity)
 {
         m_result = nullptr;
+        m_table = nullptr;
         EgcNode* node = entity.getRootElement();
         if (!node) { //process next formula -> prevent recursion with event
                 triggerNextCalcualtion();
@@ -160,23 +181,89 @@ void EgcCalculation::handleCalculation(EgcFormulaEntity& entity)
         EgcNodeType type = node->getNodeType();
         switch(type) {
         //send the formula to the cas kernel if it's a definition
-        case EgcNodeType::DefinitionNode:
+        case EgcNodeType::DefinitionNode: {
+                // the kernel needs all definitions for symbolic calculations, even the numeric ones
+                QString command = entity.getCASKernelCommand();
+                // definite integrals calculated natively are passed as value, so the kernel needn't calculate them
+                QString native;
+                if (m_numeric->define(entity) && m_numeric->getDefinitionCommand(entity, native))
+                        command = native;
                 m_waitForResult = true;
-                m_conn->sendCommand(entity.getCASKernelCommand());
+                sendCommand(command);
                 break;
+        }
 
-        case EgcNodeType::EqualNode:
+        case EgcNodeType::EqualNode: {
                 entity.resetResult();
-                m_waitForResult = true;
                 m_result = &entity;
-                m_conn->sendCommand(entity.getCASKernelCommand());
+                // purely numeric formulas are calculated without a round trip to the kernel
+                QString result;
+                if (m_numeric->calculate(entity, result)) {
+                        applyResult(result);
+                        triggerNextCalcualtion();
+                        break;
+                }
+                m_waitForResult = true;
+                sendCommand(entity.getCASKernelCommand());
                 break;
+        }
         default:
                 triggerNextCalcualtion();
                 break;
         }
 }
 
+void EgcCalculation::handleTable(EgcTableEntity& entity)
+{
+        m_result = nullptr;
+        m_table = nullptr;
+
+        if (!entity.getSweep().isValid()) {
+                entity.resetResult();
+                if (m_updateInstantly)
+                        entity.updateView();
+                triggerNextCalcualtion();
+                return;
+        }
+
+        // purely numeric tables are calculated without a round trip to the kernel
+        if (entity.calculate(*m_numeric)) {
+                if (m_updateInstantly)
+                        entity.updateView();
+                triggerNextCalcualtion();
+                return;
+        }
+
+        // all points are calculated with a single kernel command
+        entity.resetResult();
+        m_table = &entity;
+        m_waitForResult = true;
+        sendCommand(entity.getCASKernelCommand());
+}
+
+void EgcCalculation::handlePlot(EgcPlotEntity& entity)
+{
+        m_result = nullptr;
+        m_table = nullptr;
+
+        // the plot keeps the definitions, so zooming and panning doesn't need another calculation
+        entity.setContext(*m_numeric);
+        if (m_updateInstantly)
+                entity.updateView();
+        triggerNextCalcualtion();
+}
+
+void EgcCalculation::sendCommand(const QString& command)
+{
+        QString cmd = command;
+        if (!m_pendingKills.isEmpty()) {
+                cmd.prepend(QString("kill(%1)$").arg(m_pendingKills.join(',')));
+                m_pendingKills.clear();
+        }
+
+        m_conn->sendCommand(cmd);
+}
+
 void EgcCalculation::triggerNextCalcualtion(void)
 {
         if (!m_waitForResult)
@@ -186,19 +273,31 @@ void EgcCalculation::triggerNextCalcualtion(void)
 void EgcCalculation::resultReceived(QString result)
 {
         m_waitForResult = false;
+        if (m_table) {
+                m_table->setKernelResult(result);
+                if (m_updateInstantly)
+                        m_table->updateView();
+                m_table = nullptr;
+        } else {
+                applyResult(result);
+        }
+
+        //go on to next calculation
+        nextCalculation();
+}
+
+void EgcCalculation::applyResult(const QString& result)
+{
         if (m_result) {
+                EgcSessionRecorder::recordKernelResult(m_result, result);
                 EgcNode* tree = m_parser->parseKernelOutput(result);
-                if (tree) {
+                if (tree)
                         m_result->setResult(tree);
-                } else {
+                else
                         m_result->setErrorMessage(m_parser->getErrorMessage());
-                }
                 if (m_updateInstantly)
                         m_result->updateView();
         }
-        
-        //go on to next calculation
-        nextCalculation();
 }
 
 void EgcCalculation::errorReceived(QString errorMsg)
@@ -206,10 +305,17 @@ void EgcCalculation::errorReceived(QString errorMsg)
         m_waitForResult = false;
         
         if (m_result) {
+                EgcSessionRecorder::recordKernelResult(m_result, errorMsg, true);
                 m_result->setErrorMessage(errorMsg);
                 if (m_updateInstantly)
                         m_result->updateView();
         }
+        if (m_table) {
+                m_table->setErrorMessage(errorMsg);
+                if (m_updateInstantly)
+                        m_table->updateView();
+                m_table = nullptr;
+        }
 
         //go on to next calculation (even after an error with the current calculation)
         if (m_waitForResult) {
@@ -278,21 +384,147 @@ void EgcCalculation::setAutoCalculation(bool on)
 
 void EgcCalculation::startDeletingEntity(EgcEntity* entity)
 {
-        if (m_list)
-                m_iterator.reset(new QMutableListIterator<EgcEntity*>(m_list->getIterator()));
-        else
-                m_iterator.reset();
+        if (!entity)
+                return;
         if (entity == m_entity)
                 m_entity = nullptr;
+        if (entity == m_result)
+                m_result = nullptr;
+        if (entity == m_table)
+                m_table = nullptr;
+
+        // the cursor stays valid when the entity is removed from the list, so nothing needs to be calculated again,
+        // as long as the entity did not define anything the kernel already knows about
+        if (!m_iterator || !m_list || entity->getEntityType() != EgcEntityType::Formula)
+                return;
+        if (!m_iterator->hasPassed(entity))
+                return;
+        QString symbol = getDefinedSymbol(static_cast<EgcFormulaEntity&>(*entity));
+        if (symbol.isEmpty())
+                return;
+
+        // search for the first definition of the same symbol, everything behind may depend on the deleted definition
+        EgcEntity* restartAt = entity;
+        EgcEntityListCursor cursor(*m_list);
+        while (cursor.hasNext()) {
+                EgcEntity* i = cursor.next();
+                if (i == entity)
+                        break;
+                if (i->getEntityType() != EgcEntityType::Formula)
+                        continue;
+                if (getDefinedSymbol(static_cast<EgcFormulaEntity&>(*i)) == symbol) {
+                        restartAt = i;
+                        break;
+                }
+        }
+
+        // a command sent now would interfere with the result the kernel is working on, so the kill is sent together
+        // with the next command
+        if (!m_pendingKills.contains(symbol))
+                m_pendingKills.append(symbol);
+        m_numeric->undefine(symbol);
+        m_iterator->moveTo(restartAt);
+        if (m_state == CalcualtionState::notStarted && m_kernelStarted && m_autoCalc)
+                triggerNextCalcualtion();
+}
+
+bool EgcCalculation::moveChangesOrder(EgcEntityList& list, EgcFormulaEntity& formula)
+{
+        // The list inserts a moved entity behind all entities at the same position (EgcEntityList::repositionEntity),
+        // so in the new order an entity is in front of the formula if the formula is not less than the entity.
+        bool running = m_iterator && m_state != CalcualtionState::notStarted;
+        QString defined = getDefinedSymbol(formula);
+        QSet<QString> used = getUsedSymbols(formula);
+        used.remove(defined);
+
+        int passed = 0;
+        int newIndex = 0;
+        bool before = true;
+        bool changed = false;
+        EgcEntityListCursor cursor(list);
+        while (cursor.hasNext()) {
+                EgcEntity* entity = cursor.next();
+                if (entity == &formula) {
+                        before = false;
+                        continue;
+                }
+                bool newBefore = !(formula < *entity);
+                if (running) {
+                        if (m_iterator->hasPassed(entity))
+                                passed++;
+                        if (newBefore)
+                                newIndex++;
+                }
+                if (changed || entity->getEntityType() != EgcEntityType::Formula)
+                        continue;
+
+                // compare the old order (list) with the new order (positions) for all formulas related to the moved one
+                EgcFormulaEntity& other = static_cast<EgcFormulaEntity&>(*entity);
+                QString otherDefined = getDefinedSymbol(other);
+                bool related = !otherDefined.isEmpty() && (otherDefined == defined || used.contains(otherDefined));
+                if (!related && !defined.isEmpty())
+                        related = getUsedSymbols(other).contains(defined);
+                if (related && newBefore != before)
+                        changed = true;
+        }
+        if (changed)
+                return true;
+
+        // a formula that crosses the position of a running calculation is either calculated twice or not at all
+        if (running && m_iterator->hasPassed(&formula) != (newIndex < passed))
+                return true;
+
+        return false;
+}
+
+QSet<QString> EgcCalculation::getUsedSymbols(EgcFormulaEntity& formula)
+{
+        QSet<QString> symbols;
+        if (!formula.getRootElement())
+                return symbols;
+
+        EgcNodeIterator iter(formula);
+        while (iter.hasNext()) {
+                EgcNode& node = iter.next();
+                if (node.getNodeType() == EgcNodeType::VariableNode)
+                        symbols.insert(static_cast<EgcVariableNode&>(node).getStuffedValue());
+                else if (node.getNodeType() == EgcNodeType::FunctionNode)
+                        symbols.insert(static_cast<EgcFunctionNode&>(node).getStuffedName());
+        }
+
+        return symbols;
+}
+
+QString EgcCalculation::getDefinedSymbol(EgcFormulaEntity& formula)
+{
+        EgcNode* node = formula.getRootElement();
+        if (!node)
+                return QString();
+        if (node->getNodeType() != EgcNodeType::DefinitionNode)
+                return QString();
+
+        // the left side of the definition is a variable or a function (the names are stuffed like in the kernel)
+        EgcNode* lhs = static_cast<EgcBinaryNode*>(node)->getChild(0);
+        if (!lhs)
+                return QString();
+        if (lhs->getNodeType() == EgcNodeType::VariableNode)
+                return static_cast<EgcVariableNode*>(lhs)->getStuffedValue();
+        if (lhs->getNodeType() == EgcNodeType::FunctionNode)
+                return static_cast<EgcFunctionNode*>(lhs)->getStuffedName();
+
+        return QString();
 }
 
 void EgcCalculation::reset()
 {
+        m_pendingKills.clear();
         m_conn->reset();
+        m_numeric->clear();
         m_iterator.reset();
         m_computeWhenStarted = false;
         m_updateInstantly = true;
         m_result = nullptr;
+        m_table = nullptr;
         m_entity = nullptr;
         m_state = CalcualtionState::notStarted;
         m_autoCalc = true;
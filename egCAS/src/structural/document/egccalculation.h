@@ -31,12 +31,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCCALCULATION_H
 
 #include <QObject>
+#include <QSet>
+#include <QStringList>
 #include "entities/egcentitylist.h"
 #include "casKernel/egcmaximaconn.h"
 
 
 class EgcFormulaEntity;
+class EgcTableEntity;
+class EgcPlotEntity;
 class EgcKernelParser;
+class EgcNumericEvaluator;
 class EgcAbstractFormulaEntity;
 
 enum class EgcKernelErrorType {
@@ -62,6 +67,12 @@ class EgcCalculation : public QObject
         Q_OBJECT
 public:
         EgcCalculation(QObject *parent = 0);
+        /**
+         * @brief EgcCalculation creates a calculation that uses the given kernel connection
+         * @param conn the connection to the cas kernel, the calculation takes ownership of it
+         * @param parent the parent object
+         */
+        EgcCalculation(EgcKernelConn* conn, QObject *parent = 0);
         virtual ~EgcCalculation();
         /**
          * @brief calculate start calculation of the given list
@@ -91,10 +102,21 @@ public:
          */
         void setAutoCalculation(bool on);
         /**
-         * @brief deleteEntity must be called when any entity is deleted. So that calc class knows about that.
-         * @param entity the entity that is deleted.
+         * @brief startDeletingEntity must be called before a formula entity is deleted, so that the calculation knows
+         * about that. If the formula is a definition that has already been calculated, the definition is removed from
+         * the kernel and the calculation goes back to the first formula that (re)defines the same symbol.
+         * @param entity the entity that is about to be deleted.
          */
         void startDeletingEntity(EgcEntity* entity);
+        /**
+         * @brief moveChangesOrder checks if moving a formula changes the evaluation order of the formulas it depends
+         * on or that depend on it. Must be called after the position of the formula changed, but before the list has
+         * been reordered.
+         * @param list the list containing the formula (still in the old order)
+         * @param formula the formula that has been moved
+         * @return true if the calculation must be restarted, false if the results stay the same
+         */
+        bool moveChangesOrder(EgcEntityList& list, EgcFormulaEntity& formula);
         /**
          * @brief reset reset the calculation (stop all running calculations and cleanup states)
          */
@@ -126,23 +148,61 @@ private:
          * @param entity a reference to the formula currently computed
          */
         void handleCalculation(EgcFormulaEntity& entity);
+        /**
+         * @brief handleTable computes all values of the given table. Purely numeric tables are calculated natively,
+         * all other tables are calculated with one kernel command for all points.
+         * @param entity a reference to the table currently computed
+         */
+        void handleTable(EgcTableEntity& entity);
+        /**
+         * @brief handlePlot samples the given plot with the numeric definitions known at its position. Plots are never
+         * calculated by the kernel.
+         * @param entity a reference to the plot currently computed
+         */
+        void handlePlot(EgcPlotEntity& entity);
+        /**
+         * @brief sendCommand sends the given command to the kernel. Symbols that have been deleted since the last
+         * command are killed in the same line, so the kernel answers with a single prompt.
+         * @param command the command to send
+         */
+        void sendCommand(const QString& command);
         /**
          * @brief triggerNextCalcualtion triggers the next calculation
          */
         void triggerNextCalcualtion(void);
+        /**
+         * @brief applyResult parses the given result and sets it as result of the formula currently calculated
+         * @param result the result as returned by the cas kernel
+         */
+        void applyResult(const QString& result);
+        /**
+         * @brief getDefinedSymbol returns the symbol (variable or function name) that is defined by the given formula
+         * @param formula the formula to check
+         * @return the symbol defined, or an empty string if the formula is no definition
+         */
+        QString getDefinedSymbol(EgcFormulaEntity& formula);
+        /**
+         * @brief getUsedSymbols returns all symbols (variables and functions) that are used in the given formula
+         * @param formula the formula to check
+         * @return the symbols used in the formula
+         */
+        QSet<QString> getUsedSymbols(EgcFormulaEntity& formula);
 
         QScopedPointer<EgcKernelConn> m_conn;   ///< the connection to the cas kernel
-        QScopedPointer<QMutableListIterator<EgcEntity*>> m_iterator;   ///< iterator that operates on the entity list we are calculating on
+        QScopedPointer<EgcEntityListCursor> m_iterator; ///< cursor that operates on the entity list we are calculating on
         bool m_kernelStarted;   ///< indicates that cas kernel has started and can calculate formulas now
         bool m_computeWhenStarted;              ///< begin with computation when the kernel has started
         bool m_updateInstantly;                 ///< when true, update the view instantly, otherwise it's updated after resuming the calculation
         EgcFormulaEntity* m_result;             ///< a pointer to the formula entity that is currently being calculated
+        EgcTableEntity* m_table;                ///< a pointer to the table entity that is currently being calculated
         QScopedPointer<EgcKernelParser> m_parser; ///< the parser used for parsing cas kernel output
+        QScopedPointer<EgcNumericEvaluator> m_numeric; ///< evaluates purely numeric formulas without the cas kernel
         EgcEntity* m_entity;                    ///< pointer to entity where to pause calculation
         bool m_autoCalc;                        ///< if false the calculation is only done when calculation is triggered manually
         bool m_waitForResult;                   ///< if true class will wait for the result of a calculation
         EgcEntityList* m_list;                  ///< pointer to list
         CalcualtionState m_state;               ///< the state of the calculation
+        QStringList m_pendingKills;             ///< deleted symbols that must be removed from the kernel with the next command
 };
 
 #endif // EGCCALCULATION_H
@@ -42,13 +42,31 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "view/egctextitem.h"
 #include "entities/egcpixmapentity.h"
 #include "view/egcpixmapitem.h"
+#include "entities/egctableentity.h"
+#include "view/egctableitem.h"
+#include "entities/egcplotentity.h"
+#include "view/egcplotitem.h"
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QFile>
 #include "menu/richtexteditor.h"
+#include "egcsessionrecorder.h"
+#include "egcbinarydocument.h"
+#include "entities/egcentitysnapshot.h"
 
-EgcDocument::EgcDocument() : m_list{new EgcEntityList(this)}, m_scene{new EgCasScene(*this, nullptr)}, m_calc{new EgcCalculation()}
+EgcDocument::EgcDocument() : EgcDocument{new EgcMaximaConn()}
 {
+}
+
+EgcDocument::EgcDocument(EgcKernelConn* conn) : m_list{new EgcEntityList(this)}, m_scene{new EgCasScene(*this, nullptr)},
+                             m_calc{new EgcCalculation(conn)}, m_loader{new EgcFormulaLoader()},
+                             m_externalImages{false}, m_journal{new EgcDocumentJournal()},
+                             m_saver{new EgcDocumentSaver()}, m_savePending{false},
+                             m_groupMove{false}
+{
+        m_loadTimer.setInterval(10);
+        connect(&m_loadTimer, &QTimer::timeout, this, &EgcDocument::loadPendingFormulas);
+        connect(m_saver.data(), &EgcDocumentSaver::saved, this, &EgcDocument::documentSaved);
         connect(m_scene.data(), SIGNAL(createFormula(QPointF, EgcAction)), this, SLOT(insertFormulaOnKeyPress(QPointF, EgcAction)));
         connect(m_scene.data(), &EgCasScene::selectionChanged, this, &EgcDocument::selectionChanged);
         connect(m_calc.data(), SIGNAL(errorOccurred(EgcKernelErrorType,QString)),  this, SLOT(handleKernelMessages(EgcKernelErrorType,QString)));
@@ -89,6 +107,8 @@ EgcEntity* EgcDocument::createEntity(EgcEntityType type, QPointF point)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordCreation(retval, type, point);
+                        m_journal->recordCreation(retval);
                         return retval;
                 }
         } else if (type == EgcEntityType::Picture) {
@@ -101,6 +121,38 @@ EgcEntity* EgcDocument::createEntity(EgcEntityType type, QPointF point)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordCreation(retval, type, point);
+                        m_journal->recordCreation(retval);
+                        return retval;
+                }
+        } else if (type == EgcEntityType::Table) {
+                QScopedPointer<EgcTableEntity> entity(new EgcTableEntity());
+                if (entity.isNull())
+                        return nullptr;
+                EgCasScene* scene = getScene();
+                item = scene->addTable(*entity, point);
+                if (item) {
+                        entity->updateView();
+                        retval = entity.data();
+                        mapItem(item, entity.data());
+                        m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordCreation(retval, type, point);
+                        m_journal->recordCreation(retval);
+                        return retval;
+                }
+        } else if (type == EgcEntityType::Plot) {
+                QScopedPointer<EgcPlotEntity> entity(new EgcPlotEntity());
+                if (entity.isNull())
+                        return nullptr;
+                EgCasScene* scene = getScene();
+                item = scene->addPlot(*entity, point);
+                if (item) {
+                        entity->updateView();
+                        retval = entity.data();
+                        mapItem(item, entity.data());
+                        m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordCreation(retval, type, point);
+                        m_journal->recordCreation(retval);
                         return retval;
                 }
         } else { // formula
@@ -114,6 +166,8 @@ EgcEntity* EgcDocument::createEntity(EgcEntityType type, QPointF point)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordCreation(retval, type, point);
+                        m_journal->recordCreation(retval);
                         return retval;
                 }
         }
@@ -138,6 +192,8 @@ EgcEntity* EgcDocument::cloneEntity(EgcEntity& entity2copy)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordClone(retval, &entity2copy);
+                        m_journal->recordCreation(retval);
 
                         return retval;
                 }
@@ -155,6 +211,49 @@ EgcEntity* EgcDocument::cloneEntity(EgcEntity& entity2copy)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordClone(retval, &entity2copy);
+                        m_journal->recordCreation(retval);
+
+                        return retval;
+                }
+
+                return nullptr;
+        } else if (type == EgcEntityType::Table) {
+                EgcTableEntity& entityCopyRef = static_cast<EgcTableEntity&>(entity2copy);
+                QScopedPointer<EgcTableEntity> entity(new EgcTableEntity(entityCopyRef));
+                if (entity.isNull())
+                        return nullptr;
+                EgCasScene* scene = getScene();
+                QGraphicsItem* item = scene->addTable(*entity, entity2copy.getPosition());
+                if (item) {
+                        //set the item properties
+                        entity->updateView();
+                        retval = entity.data();
+                        mapItem(item, entity.data());
+                        m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordClone(retval, &entity2copy);
+                        m_journal->recordCreation(retval);
+
+                        return retval;
+                }
+
+                return nullptr;
+        } else if (type == EgcEntityType::Plot) {
+                EgcPlotEntity& entityCopyRef = static_cast<EgcPlotEntity&>(entity2copy);
+                QScopedPointer<EgcPlotEntity> entity(new EgcPlotEntity(entityCopyRef));
+                if (entity.isNull())
+                        return nullptr;
+                EgCasScene* scene = getScene();
+                QGraphicsItem* item = scene->addPlot(*entity, entity2copy.getPosition());
+                if (item) {
+                        //set the item properties
+                        entity->resample();
+                        entity->updateView();
+                        retval = entity.data();
+                        mapItem(item, entity.data());
+                        m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordClone(retval, &entity2copy);
+                        m_journal->recordCreation(retval);
 
                         return retval;
                 }
@@ -173,6 +272,8 @@ EgcEntity* EgcDocument::cloneEntity(EgcEntity& entity2copy)
                         retval = entity.data();
                         mapItem(item, entity.data());
                         m_list->addEntity(entity.take());
+                        EgcSessionRecorder::recordClone(retval, &entity2copy);
+                        m_journal->recordCreation(retval);
 
                         return retval;
                 }
@@ -197,7 +298,7 @@ void EgcDocument::insertFormulaOnKeyPress(QPointF point, EgcAction action)
 
 bool EgcDocument::formulaEntityDeleted(EgcEntity* formula)
 {
-        //inform calculation about deleting an entity
+        //inform calculation about deleting an entity (the entity is still valid at this point)
         m_calc->startDeletingEntity(formula);
 
         return true;
@@ -205,14 +306,17 @@ bool EgcDocument::formulaEntityDeleted(EgcEntity* formula)
 
 void EgcDocument::deleteEntity(EgcEntity* entity)
 {        
-        bool notifyFormula = false;
+        if (!entity)
+                return;
+
+        EgcSessionRecorder::recordDeletion(entity);
+        m_journal->recordDeletion(entity);
         if (entity->getEntityType() == EgcEntityType::Formula)
-                notifyFormula = true;
-        if (entity) {
-                m_list->deleteEntity(entity);
-        }
-        if (notifyFormula)
+                m_loader->remove(static_cast<EgcFormulaEntity*>(entity));
+        if (    entity->getEntityType() == EgcEntityType::Formula
+             || entity->getEntityType() == EgcEntityType::Table)
                 formulaEntityDeleted(entity);
+        m_list->deleteEntity(entity);
 }
 
 void EgcDocument::itemDeleted(QGraphicsItem* item)
@@ -227,11 +331,17 @@ void EgcDocument::itemDeleted(QGraphicsItem* item)
 
 void EgcDocument::deleteAll()
 {
+        m_loadTimer.stop();
+        m_loader->stop();
+        // the document doesn't belong to its file anymore
+        m_journal->stop();
+        m_fileName.clear();
         //reset calculation
         m_calc->reset();
         m_list->deleteAll();
         m_itemMapper.clear();
         m_scene->deleteAll();
+        EgcSessionRecorder::recordSnapshot(*this, getEntities());
 }
 
 void EgcDocument::resumeCalculation(void)
@@ -250,6 +360,62 @@ void EgcDocument::restartCalculation(void)
         m_calc->restart();
 }
 
+void EgcDocument::entityMoved(EgcEntity* entity)
+{
+        // the other entities of a group move are not sorted yet, so the list is sorted once in entitiesMoved
+        if (!entity || m_groupMove)
+                return;
+
+        // the list still has the old order here, so the calculation can compare it with the new positions
+        bool restart;
+        switch (entity->getEntityType()) {
+        case EgcEntityType::Formula:
+                restart = m_calc.isNull() || m_calc->moveChangesOrder(*m_list, static_cast<EgcFormulaEntity&>(*entity));
+                break;
+        case EgcEntityType::Table:
+        case EgcEntityType::Plot:
+                // tables and plots are calculated with the definitions in front of them
+                restart = true;
+                break;
+        default:
+                restart = false;
+                break;
+        }
+        m_list->repositionEntity(entity);
+        m_journal->recordMove(entity, entity->getPosition());
+        if (restart)
+                restartCalculation();
+}
+
+void EgcDocument::beginGroupMove(void)
+{
+        m_groupMove = true;
+}
+
+void EgcDocument::entitiesMoved(void)
+{
+        m_groupMove = false;
+        QList<EgcEntity*> before = getEntities();
+        m_list->sort();
+        QList<EgcEntity*> after = getEntities();
+        m_journal->recordPositions(after);
+        if (before != after)
+                restartCalculation();
+}
+
+void EgcDocument::entityChanged(EgcEntity* entity)
+{
+        if (!entity)
+                return;
+
+        m_journal->recordChange(entity);
+}
+
+void EgcDocument::entityModified(EgcEntity* entity)
+{
+        m_journal->markDirty(entity);
+}
+
 void EgcDocument::startCalulation(EgcAbstractFormulaEntity* entity)
 {
         if (m_calc.isNull())
@@ -377,47 +543,254 @@ void EgcDocument::updateView()
         }
 }
 
-void EgcDocument::saveToFile(QString filename)
+void EgcDocument::saveToFile(QString filename, FileFormat format)
 {
-        QFile file(filename);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-                return;
+        waitForSave();
+
+        if (filename == m_fileName && !m_journal->needsCompaction()) {
+                // entities that don't report every change (e.g. zoomed plots) have been marked as modified, and the
+                // active formula reports its changes only when it is deactivated, so record them before committing
+                QList<EgcEntity*> entities = getEntities();
+                m_journal->recordDirty();
+                EgcFormulaEntity* active = getActiveFormulaEntity();
+                if (active)
+                        m_journal->recordChange(active);
+                // formulas that have been moved together with others (or by inserting pages) don't report the move
+                m_journal->recordPositions(entities);
+                // the document file and the journal up to the commit make up the saved document
+                if (m_journal->commit()) {
+                        emit saveFinished(true, filename, QString());
+                        return;
+                }
+        }
 
-        QXmlStreamWriter stream(&file);
+        // only the snapshot is taken here, serializing and writing is done by the saver thread
         SerializerProperties properties;
         properties.filePath = filename;
-        serialize(stream, properties);
+        properties.externalImages = m_externalImages;
+        QList<EgcEntity*> entities = getEntities();
+        QList<EgcEntitySnapshot*> snapshots;
+        foreach (EgcEntity* entity, entities) {
+                EgcEntitySnapshot* snapshot = entity->takeSnapshot(properties);
+                if (!snapshot) {
+                        qDeleteAll(snapshots);
+                        emit saveFinished(false, filename, tr("Not enough memory to save the document."));
+                        return;
+                }
+                snapshots.append(snapshot);
+        }
 
-        file.close();
+        m_journal->prepareRestart();
+        m_savePending = m_saver->save(filename, format == FileFormat::Binary, properties, getWidth(), getHeight(),
+                                      EgcTextEntity::getGenericFont().toString(), snapshots);
+        if (!m_savePending)
+                m_journal->cancelRestart();
+}
+
+bool EgcDocument::isSaving(void) const
+{
+        return m_savePending;
+}
+
+void EgcDocument::waitForSave(void)
+{
+        if (!m_savePending)
+                return;
+
+        m_saver->wait();
+        finishSave();
+}
+
+void EgcDocument::documentSaved(quint32 sequence)
+{
+        // the signal of a save that has already been taken by waitForSave is ignored
+        if (!m_savePending || sequence != m_saver->getSequence())
+                return;
+
+        // the signal is emitted at the very end of the thread, so this doesn't block
+        m_saver->wait();
+        finishSave();
+}
+
+void EgcDocument::finishSave(void)
+{
+        m_savePending = false;
+        QString fileName = m_saver->getFileName();
+        bool saved = m_saver->isSaved();
+        // the journal is restarted only if the document still belongs to the snapshot (it may have been cleared)
+        if (saved && m_journal->isRestarting()) {
+                m_fileName = fileName;
+                m_journal->finishRestart(fileName);
+        } else {
+                m_journal->cancelRestart();
+        }
+
+        emit saveFinished(saved, fileName, m_saver->getErrorString());
+}
+
+void EgcDocument::setExternalImages(bool external)
+{
+        // the pictures of the document file are stored the other way round, so the next save writes the whole file
+        if (external != m_externalImages)
+                m_journal->stop();
+        m_externalImages = external;
+        m_journal->setExternalImages(external);
+}
+
+bool EgcDocument::getExternalImages(void) const
+{
+        return m_externalImages;
 }
 
 void EgcDocument::readFromFile(QString filename)
 {
+        waitForSave();
+
         QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        if (!file.open(QIODevice::ReadOnly))
                 return;
 
-        QXmlStreamReader stream(&file);
+        QByteArray data = file.readAll();
+        file.close();
         SerializerProperties properties;
         properties.version = 0;
         properties.filePath = filename;
-        deserialize(stream, properties);
-        // sort the list if all items are deserialized
-        m_list->sort();
+        bool loaded;
+        // the loaded document is recorded as a whole and not as a sequence of entity creations
+        EgcSessionRecorder::suspend(true);
+        if (EgcBinaryDocument::isBinary(data.left(EgcBinaryDocument::s_headerSize))) {
+                // the formulas keep a reference to the binary document, so their trees can be built later on
+                QSharedPointer<EgcBinaryDocument> binary(new EgcBinaryDocument());
+                loaded = binary->open(data);
+                data.clear();
+                if (loaded)
+                        loaded = deserializeBinary(binary, properties);
+                else
+                        handleDocumentMessages(tr("Document corrupted. ") + binary->getErrorString());
+        } else {
+                // the formulas keep a reference to the document text, so their trees can be built later on
+                QString source = QString::fromUtf8(data);
+                data.clear();
+                QXmlStreamReader stream(source);
+                properties.source = &source;
+                deserialize(stream, properties);
+                loaded = !stream.hasError();
+        }
+        if (loaded) {
+                m_fileName = filename;
+                // the saved changes that have been written to the journal only belong to the document
+                if (m_journal->open(filename, getEntities())) {
+                        replayJournal(m_journal->getSavedRecords());
+                        if (m_journal->getUnsavedRecords().isEmpty())
+                                m_journal->releaseRecords();
+                } else {
+                        m_journal->start(filename, getEntities());
+                }
+        }
+        EgcSessionRecorder::suspend(false);
+        EgcSessionRecorder::recordSnapshot(*this, getEntities());
+
+        // positions and sizes are known now, the formula trees are built in parallel in the background
+        QList<EgcFormulaEntity*> formulas;
+        foreach (EgcEntity* entity, getEntities()) {
+                if (entity->getEntityType() == EgcEntityType::Formula)
+                        formulas.append(static_cast<EgcFormulaEntity*>(entity));
+        }
+        QRectF visible;
+        if (!m_scene->views().isEmpty()) {
+                QGraphicsView* view = m_scene->views().at(0);
+                visible = view->mapToScene(view->viewport()->rect()).boundingRect();
+        }
+        m_loader->start(formulas, visible);
+        if (!m_loader->isFinished()) {
+                emit loadingProgress(0, m_loader->getTotal());
+                m_loadTimer.start();
+        }
+}
 
-        file.close();
+bool EgcDocument::canRecover(void) const
+{
+        return !m_journal->getUnsavedRecords().isEmpty();
 }
 
-void EgcDocument::serialize(QXmlStreamWriter& stream, SerializerProperties &properties)
+void EgcDocument::recover(bool apply)
 {
-        stream.setAutoFormatting(true);
-        stream.writeStartDocument();
+        if (apply) {
+                EgcSessionRecorder::suspend(true);
+                replayJournal(m_journal->getUnsavedRecords());
+                EgcSessionRecorder::suspend(false);
+                EgcSessionRecorder::recordSnapshot(*this, getEntities());
+        } else {
+                m_journal->discardUnsaved();
+        }
+        m_journal->releaseRecords();
+}
 
-        stream.writeStartElement("document");
-        stream.writeAttribute("width", QString("%1").arg(getWidth()));
-        stream.writeAttribute("height", QString("%1").arg(getHeight()));
-        stream.writeAttribute("version", QString(EGCAS_VERSION));
-        stream.writeAttribute("doc_font", EgcTextEntity::getGenericFont().toString());
+void EgcDocument::replayJournal(const QList<EgcJournalRecord>& records)
+{
+        SerializerProperties properties;
+        properties.version = parseVersion(QString(EGCAS_VERSION));
+        properties.filePath = m_fileName;
+
+        m_journal->suspend(true);
+        m_list->setBulkLoad(true);
+        foreach (const EgcJournalRecord& record, records) {
+                EgcEntity* entity = m_journal->getEntity(record.m_id);
+                switch (record.m_type) {
+                case EgcJournalRecordType::EntityCreated:
+                case EgcJournalRecordType::EntityChanged: {
+                        // a changed entity is replaced by the entity recorded
+                        if (entity)
+                                removeEntity(entity);
+                        QXmlStreamReader stream(record.m_xml);
+                        if (stream.readNextStartElement())
+                                m_journal->setEntity(record.m_id, deserializeEntity(stream, properties));
+                        break;
+                }
+                case EgcJournalRecordType::EntityDeleted:
+                        if (entity)
+                                removeEntity(entity);
+                        break;
+                case EgcJournalRecordType::EntityMoved:
+                        if (entity) {
+                                entity->setPosition(record.m_pos);
+                                // only remembers the position, since the journal is suspended
+                                m_journal->recordMove(entity, record.m_pos);
+                        }
+                        break;
+                default:
+                        break;
+                }
+        }
+        // the list is sorted by the new positions once all records have been applied
+        m_list->setBulkLoad(false);
+        m_journal->suspend(false);
+}
+
+void EgcDocument::removeEntity(EgcEntity* entity)
+{
+        QGraphicsItem* item = m_itemMapper.key(entity, nullptr);
+        if (!item)
+                return;
+
+        m_scene->deleteItem(item);
+        itemDeleted(item);
+}
+
+void EgcDocument::loadPendingFormulas(void)
+{
+        // attach the trees for 15ms at most, then give control back to the event loop
+        if (m_loader->attachFinished(15) == 0)
+                return;
+
+        if (m_loader->isFinished())
+                m_loadTimer.stop();
+        emit loadingProgress(m_loader->getAttached(), m_loader->getTotal());
+}
+
+void EgcDocument::serialize(QXmlStreamWriter& stream, SerializerProperties &properties)
+{
+        EgcDocumentSaver::writeDocumentStart(stream, getWidth(), getHeight(), EgcTextEntity::getGenericFont().toString());
 
         EgcEntityList* list = getEntityList();
         QMutableListIterator<EgcEntity*> iter = list->getIterator();
@@ -425,9 +798,7 @@ void EgcDocument::serialize(QXmlStreamWriter& stream, SerializerProperties &prop
                 iter.next()->serialize(stream, properties);
         }
 
-        stream.writeEndElement(); // document
-
-        stream.writeEndDocument();
+        EgcDocumentSaver::writeDocumentEnd(stream);
 }
 
 void EgcDocument::deserialize(QXmlStreamReader& stream, SerializerProperties &properties)
@@ -437,44 +808,12 @@ void EgcDocument::deserialize(QXmlStreamReader& stream, SerializerProperties &pr
         if (stream.readNextStartElement()) {
                 if (stream.name() == QLatin1String("document")) {
                         QXmlStreamAttributes attr = stream.attributes();
-                        if (attr.hasAttribute("doc_font")) {
-                                QString font_str = attr.value("doc_font").toString();
-                                QFont fnt;
-                                fnt.fromString(font_str);
-                                EgcTextEntity::setGenericFont(fnt);
-                                RichTextEditor::setGenericFont(fnt);
-                        }
-                        QString ver = attr.value("version").toString();
-                        QStringList list = ver.split('.');
-                        if (list.size() == 3) {
-                                properties.version = list.at(0).toUInt() << 16;
-                                properties.version += list.at(1).toUInt() << 8;
-                                properties.version += list.at(2).toUInt();
-                        }
-                        if (    attr.hasAttribute("height") && attr.hasAttribute("width")
-                             && (properties.version == 2 || properties.version == 3)) {
-                                qreal height = attr.value("height").toFloat();
-                                qreal width = attr.value("width").toFloat();
-                                setWidth(width);
-                                setHeight(height);
-                                //delete all contents from the document
-                                deleteAll();
-
-                                EgcEntity* entity = nullptr;
-                                while (stream.readNextStartElement()) {
-                                        entity = nullptr;
-                                        if (stream.name() == QLatin1String("text_entity"))
-                                                entity = createEntity(EgcEntityType::Text);
-                                        else if (stream.name() == QLatin1String("pic_entity"))
-                                                entity = createEntity(EgcEntityType::Picture);
-                                        else if (stream.name() == QLatin1String("formula_entity"))
-                                                entity = createEntity(EgcEntityType::Formula);
-                                        else
-                                                stream.skipCurrentElement();
-
-                                        if (entity)
-                                                entity->deserialize(stream, properties);
-                                }
+                        if (readDocumentAttributes(attr, properties)) {
+                                // the positions are known only after deserializing the entities, so sort only once
+                                m_list->setBulkLoad(true);
+                                while (stream.readNextStartElement())
+                                        (void) deserializeEntity(stream, properties);
+                                m_list->setBulkLoad(false);
                         } else {
                                 stream.raiseError(QObject::tr("This file version is not supported. Maybe saved by a newer version."));
                         }
@@ -500,6 +839,169 @@ void EgcDocument::deserialize(QXmlStreamReader& stream, SerializerProperties &pr
                 handleDocumentMessages(properties.warningMessage, QMessageBox::Warning);
 }
 
+bool EgcDocument::readDocumentAttributes(const QXmlStreamAttributes& attr, SerializerProperties& properties)
+{
+        if (attr.hasAttribute("doc_font")) {
+                QString font_str = attr.value("doc_font").toString();
+                QFont fnt;
+                fnt.fromString(font_str);
+                EgcTextEntity::setGenericFont(fnt);
+                RichTextEditor::setGenericFont(fnt);
+        }
+        properties.version = parseVersion(attr.value("version").toString());
+        if (    !attr.hasAttribute("height") || !attr.hasAttribute("width")
+             || (properties.version != 2 && properties.version != 3))
+                return false;
+
+        qreal height = attr.value("height").toFloat();
+        qreal width = attr.value("width").toFloat();
+        setWidth(width);
+        setHeight(height);
+        //delete all contents from the document
+        deleteAll();
+
+        return true;
+}
+
+bool EgcDocument::deserializeBinary(QSharedPointer<EgcBinaryDocument> binary, SerializerProperties& properties)
+{
+        QString name;
+        QXmlStreamAttributes attr;
+        if (!binary->readRootElement(name, attr)) {
+                handleDocumentMessages(tr("Document corrupted. ") + binary->getErrorString());
+                return false;
+        }
+        if (name != QLatin1String("document")) {
+                handleDocumentMessages(QObject::tr("The file is not an egcas file."));
+                return false;
+        }
+        if (!readDocumentAttributes(attr, properties)) {
+                handleDocumentMessages(QObject::tr("This file version is not supported. Maybe saved by a newer version."));
+                return false;
+        }
+
+        // the positions are known only after deserializing the entities, so sort only once
+        m_list->setBulkLoad(true);
+        bool decoded = true;
+        bool wellFormed = true;
+        const QVector<EgcBinarySection>& sections = binary->getSections();
+        for (int i = 0; wellFormed && i < sections.size(); i++) {
+                // the section index tells the element name, so elements that are no entities are not even decoded
+                QString section = binary->getString(sections.at(i).m_name);
+                if (!section.endsWith(QLatin1String("_entity")))
+                        continue;
+                // formulas are read directly into the entity (the tree is built later on from the event stream)
+                if (section == QLatin1String("formula_entity")) {
+                        EgcBinaryReader reader(binary, sections.at(i).m_offset, sections.at(i).m_length);
+                        EgcEntity* entity = nullptr;
+                        if (reader.readNextStartElement())
+                                entity = createEntity(EgcEntityType::Formula);
+                        if (entity) {
+                                quint32 id = entity->getId();
+                                static_cast<EgcFormulaEntity*>(entity)->deserializeBinary(reader, properties);
+                                m_list->updateId(entity, id);
+                        }
+                        wellFormed = !reader.hasError();
+                        continue;
+                }
+                // all other entities are decoded as xml text
+                QString source;
+                decoded = binary->decodeSection(i, source);
+                if (!decoded)
+                        break;
+                QXmlStreamReader stream(source);
+                properties.source = &source;
+                if (stream.readNextStartElement())
+                        (void) deserializeEntity(stream, properties);
+                wellFormed = !stream.hasError();
+        }
+        properties.source = nullptr;
+        m_list->setBulkLoad(false);
+
+        if (!decoded)
+                handleDocumentMessages(tr("Document corrupted. ") + binary->getErrorString());
+        else if (!wellFormed)
+                handleDocumentMessages(tr("Document corrupted. The document has an unexpected structure."));
+        else if (!properties.warningMessage.isEmpty())
+                handleDocumentMessages(properties.warningMessage, QMessageBox::Warning);
+
+        return decoded && wellFormed;
+}
+
+quint32 EgcDocument::parseVersion(const QString& version)
+{
+        quint32 retval = 0;
+        QStringList list = version.split('.');
+        if (list.size() == 3) {
+                retval = list.at(0).toUInt() << 16;
+                retval += list.at(1).toUInt() << 8;
+                retval += list.at(2).toUInt();
+        }
+
+        return retval;
+}
+
+EgcEntity* EgcDocument::deserializeEntity(QXmlStreamReader& stream, SerializerProperties& properties)
+{
+        EgcEntity* entity = nullptr;
+        if (stream.name() == QLatin1String("text_entity"))
+                entity = createEntity(EgcEntityType::Text);
+        else if (stream.name() == QLatin1String("pic_entity"))
+                entity = createEntity(EgcEntityType::Picture);
+        else if (stream.name() == QLatin1String("formula_entity"))
+                entity = createEntity(EgcEntityType::Formula);
+        else if (stream.name() == QLatin1String("table_entity"))
+                entity = createEntity(EgcEntityType::Table);
+        else if (stream.name() == QLatin1String("plot_entity"))
+                entity = createEntity(EgcEntityType::Plot);
+        else
+                stream.skipCurrentElement();
+
+        if (entity) {
+                // the id saved with the entity replaces the one assigned when creating it
+                quint32 id = entity->getId();
+                entity->deserialize(stream, properties);
+                m_list->updateId(entity, id);
+        }
+
+        return entity;
+}
+
+bool EgcDocument::startSessionRecording(const QString& logFile)
+{
+        return EgcSessionRecorder::start(logFile, *this, getEntities());
+}
+
+void EgcDocument::stopSessionRecording(void)
+{
+        EgcSessionRecorder::stop();
+}
+
+void EgcDocument::reformatResults(void)
+{
+        QMutableListIterator<EgcEntity*> iter = m_list->getIterator();
+        while (iter.hasNext()) {
+                EgcEntity* entity = iter.next();
+                if (entity && entity->getEntityType() == EgcEntityType::Formula) {
+                        EgcFormulaEntity* formula = static_cast<EgcFormulaEntity*>(entity);
+                        if (formula->reformatResult())
+                                formula->updateView();
+                } else if (entity && entity->getEntityType() == EgcEntityType::Table) {
+                        static_cast<EgcTableEntity*>(entity)->updateView();
+                }
+        }
+}
+
+QList<EgcEntity*> EgcDocument::getEntities(void)
+{
+        QList<EgcEntity*> entities;
+        QMutableListIterator<EgcEntity*> iter = m_list->getIterator();
+        while (iter.hasNext())
+                entities.append(iter.next());
+
+        return entities;
+}
+
 void EgcDocument::setHeight(qreal height)
 {
         QRectF rct = getScene()->sceneRect();
@@ -32,18 +32,24 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QObject>
 #include <QScopedPointer>
+#include <QSharedPointer>
 #include <QPointF>
 #include <QMessageBox>
+#include <QTimer>
 #include "entities/egcentity.h"
 #include "entities/egcabstractentitylist.h"
 #include "egccalculation.h"
 #include "actions/egcaction.h"
 #include "egcabstractdocument.h"
 #include "abstractserializer.h"
+#include "egcformulaloader.h"
+#include "egcdocumentjournal.h"
+#include "egcdocumentsaver.h"
 
 class EgcEntityList;
 class EgCasScene;
 class EgcTextEntity;
+class EgcBinaryDocument;
 
 class EgcDocument : public QObject, EgcAbstractEntityList, public EgcAbstractDocument, public AbstractSerializer
 {
@@ -51,6 +57,12 @@ class EgcDocument : public QObject, EgcAbstractEntityList, public EgcAbstractDoc
 public:
         ///std constructor
         EgcDocument();
+        /**
+         * @brief EgcDocument creates a document that calculates with the given kernel connection (e.g. a stub
+         * kernel if the document is used without the cas kernel)
+         * @param conn the connection to the cas kernel, the document takes ownership of it
+         */
+        explicit EgcDocument(EgcKernelConn* conn);
         /**
          * @brief getEntityList get a pointer to the top level entity list of the document
          * @return a pointer to the Entity list
@@ -92,8 +104,8 @@ public:
          */
         EgcEntity* cloneEntity(EgcEntity& entity2copy);
         /**
-         * @brief deleteFormula delete a formula
-         * @param formula the formula to delete
+         * @brief formulaEntityDeleted must be called before a formula is deleted
+         * @param formula the formula that is about to be deleted
          * @return true if everything went well, false otherwise
          */
         virtual bool formulaEntityDeleted(EgcEntity* formula) override;
@@ -107,6 +119,17 @@ public:
          * @param item the item that has been deleted
          */
         virtual void itemDeleted(QGraphicsItem* item) override;
+        /**
+         * @brief entityChanged must be called after the content of an entity has been changed by the user
+         * @param entity the entity that has been changed
+         */
+        virtual void entityChanged(EgcEntity* entity) override;
+        /**
+         * @brief entityModified must be called if an entity may be changed without reporting every single change. The
+         * entity is written to the journal at the next save.
+         * @param entity the entity that may have been changed
+         */
+        virtual void entityModified(EgcEntity* entity) override;
         /**
          * @brief deleteAll delete all entities from document
          */
@@ -120,6 +143,22 @@ public:
          * change of a formula.
          */
         virtual void restartCalculation(void) override;
+        /**
+         * @brief entityMoved must be called after the position of an entity has changed. The entity is moved to its
+         * new place in the document and the calculation is restarted if the evaluation order changes.
+         * @param entity the entity that has been moved
+         */
+        virtual void entityMoved(EgcEntity* entity) override;
+        /**
+         * @brief beginGroupMove must be called before several entities are moved at once. Single moves are ignored
+         * until entitiesMoved is called.
+         */
+        virtual void beginGroupMove(void) override;
+        /**
+         * @brief entitiesMoved must be called after several entities have been moved at once. The document is sorted
+         * once and the calculation is restarted if the order has changed. A group move is finished.
+         */
+        virtual void entitiesMoved(void) override;
         /**
          * @brief startCalulation start the calculation of the document
          * @param entity the entity where to pause calculation
@@ -131,6 +170,11 @@ public:
          * @param on if true auto calculation is on ohterwise off.
          */
         void setAutoCalculation(bool on);
+        /**
+         * @brief reformatResults formats the results of all formulas again (e.g. after the standard number of
+         * significant digits changed). This doesn't need the kernel.
+         */
+        void reformatResults(void);
         /**
          * @brief getActiveFormulaEntity returns a pointer to the active Formula entity (has Focus)
          * @return pointer to active formula entity if any, or nullptr if none
@@ -158,15 +202,58 @@ public:
          */
         void updateView(void);
         /**
-         * @brief saveToFile saves complete document in file given
+         * @brief The FileFormat enum selects the format a document is saved in
+         */
+        enum class FileFormat {
+                Xml,            ///< xml document
+                Binary          ///< compact binary encoding of the xml document (see EgcBinaryDocument)
+        };
+        /**
+         * @brief saveToFile saves complete document in file given. If the document is saved into the file it has
+         * been read from or saved to last time, only a commit is appended to the journal of the document, unless
+         * the journal has grown too large. Otherwise a snapshot of the document is taken and written in the
+         * background, the signal saveFinished is emitted when the file has been written.
          * @param filename the filename (including path) in which to save the document
+         * @param format the format to save the document in
+         */
+        void saveToFile(QString filename, FileFormat format = FileFormat::Xml);
+        /**
+         * @brief isSaving checks if the document is being written in the background
+         * @return true if a save is in progress, false otherwise
          */
-        void saveToFile(QString filename);
+        bool isSaving(void) const;
         /**
-         * @brief readFromFile reads complete document from file given
+         * @brief waitForSave waits until the document has been written if it is being saved in the background
+         */
+        void waitForSave(void);
+        /**
+         * @brief readFromFile reads complete document from file given. The format (xml or binary) is detected
+         * automatically.
          * @param filename the filename (including path) from which to read the document
          */
         void readFromFile(QString filename);
+        /**
+         * @brief canRecover checks if the journal of the document read last contains changes that haven't been saved
+         * (e.g. since the application crashed)
+         * @return true if there are changes to recover, false otherwise
+         */
+        bool canRecover(void) const;
+        /**
+         * @brief recover applies or discards the changes found in the journal that haven't been saved
+         * @param apply true to apply the changes to the document, false to discard them
+         */
+        void recover(bool apply);
+        /**
+         * @brief setExternalImages sets whether embedded images are saved into files next to the document. The image
+         * files are named by a hash of their contents and are written only if they don't exist yet.
+         * @param external true to save the images next to the document, false to save them inside the document
+         */
+        void setExternalImages(bool external);
+        /**
+         * @brief getExternalImages returns whether embedded images are saved into files next to the document
+         * @return true if images are saved next to the document, false otherwise
+         */
+        bool getExternalImages(void) const;
         /**
          * @brief interface for serializing a class
          * @param stream the stream to use for serializing this class
@@ -180,6 +267,16 @@ public:
          * @param properties object with all neccessary information for deserializing
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;
+        /**
+         * @brief startSessionRecording starts recording the user session (see EgcSessionRecorder) into the given file
+         * @param logFile the file to record the session into
+         * @return true if recording has been started, false otherwise
+         */
+        bool startSessionRecording(const QString& logFile);
+        /**
+         * @brief stopSessionRecording stops recording the user session
+         */
+        void stopSessionRecording(void);
         /**
          * @brief setHeight
          * @param height
@@ -206,6 +303,20 @@ signals:
          * @brief selectionChanged signal that is emitted when the selection of an item changes
          */
         void selectionChanged(void);
+        /**
+         * @brief loadingProgress signal that is emitted while the formulas of a document that has been read are built
+         * in the background
+         * @param loaded the number of formulas already built
+         * @param total the number of formulas to build (loading is finished if loaded equals total)
+         */
+        void loadingProgress(int loaded, int total);
+        /**
+         * @brief saveFinished signal that is emitted when saving the document has finished
+         * @param success true if the document has been saved, false otherwise
+         * @param fileName the file the document has been saved into
+         * @param error a description of the error if saving failed
+         */
+        void saveFinished(bool success, QString fileName, QString error);
 private slots:
         /**
          * @brief insertFormula insert a formula into the current document
@@ -223,6 +334,16 @@ private slots:
          * @param message message associated with type
          */
         void handleKernelMessages(EgcKernelErrorType type, QString message);
+        /**
+         * @brief loadPendingFormulas attaches the formula trees built by the loader threads since the last call. Each
+         * call only runs for a short time, so the document stays responsive while loading.
+         */
+        void loadPendingFormulas(void);
+        /**
+         * @brief documentSaved is called when the saver thread has finished writing the document
+         * @param sequence the sequence number of the save that has finished
+         */
+        void documentSaved(quint32 sequence);
 private:
         /**
          * @brief handleDocumentMessages show error messages while loading a document if there is an error during loading
@@ -230,17 +351,75 @@ private:
          */
         void handleDocumentMessages(QString message, QMessageBox::Icon iconType = QMessageBox::Critical);
         virtual void sort(void) override {}
+        virtual void repositionEntity(EgcEntity* entity) override {(void) entity;}
         /**
          * @brief mapItem maps an given item to a given entity
          * @param item the item that is mapped to the given entity
          * @param entity the entity that is linked with the given item
          */
         void mapItem(QGraphicsItem* item, EgcEntity* entity);
+        /**
+         * @brief getEntities returns all entities of the document in the order of the entity list
+         * @return list with all entities of the document
+         */
+        QList<EgcEntity*> getEntities(void);
+        /**
+         * @brief finishSave takes the result of the background save after the saver thread has finished
+         */
+        void finishSave(void);
+        /**
+         * @brief deserializeEntity creates an entity from the entity element the stream is positioned at
+         * @param stream the stream to read the entity from
+         * @param properties object with all neccessary information for deserializing
+         * @return the entity created or a nullptr if the element isn't an entity
+         */
+        EgcEntity* deserializeEntity(QXmlStreamReader& stream, SerializerProperties& properties);
+        /**
+         * @brief readDocumentAttributes applies the attributes of the document element (size and font) and deletes all
+         * contents of the document, so the entities can be read afterwards
+         * @param attr the attributes of the document element
+         * @param properties object with all neccessary information for deserializing (the version is set)
+         * @return true if the document can be read, false if the version is not supported
+         */
+        bool readDocumentAttributes(const QXmlStreamAttributes& attr, SerializerProperties& properties);
+        /**
+         * @brief deserializeBinary reads the document from the binary document given. The entities are read one
+         * after the other with the help of the section index, so there is no xml text of the whole document. Formulas
+         * are read directly from the event stream and keep a reference to the document to build their trees later on.
+         * @param binary the binary document (already opened)
+         * @param properties object with all neccessary information for deserializing
+         * @return true if everything went well, false otherwise (an error message has been shown then)
+         */
+        bool deserializeBinary(QSharedPointer<EgcBinaryDocument> binary, SerializerProperties& properties);
+        /**
+         * @brief removeEntity removes the given entity together with its item from the document
+         * @param entity the entity to remove
+         */
+        void removeEntity(EgcEntity* entity);
+        /**
+         * @brief replayJournal applies the given journal records to the document
+         * @param records the records to apply
+         */
+        void replayJournal(const QList<EgcJournalRecord>& records);
+        /**
+         * @brief parseVersion converts a version string (e.g. "0.0.3") into a version number
+         * @param version the version string
+         * @return the version number (0 if the string isn't valid)
+         */
+        static quint32 parseVersion(const QString& version);
         
         QScopedPointer<EgcEntityList> m_list;           ///< the list with the items to the text, pixmap and formual items
         QScopedPointer<EgCasScene> m_scene;             ///< the scene for rendering all items
         QScopedPointer<EgcCalculation> m_calc;          ///< the class which holds all tools for doing calculations
         QHash<QGraphicsItem*, EgcEntity*> m_itemMapper; ///< hash table for looking up entity that is linked to an item
+        QScopedPointer<EgcFormulaLoader> m_loader;     ///< builds the formula trees of a loaded document in parallel
+        QTimer m_loadTimer;                             ///< timer for attaching the formula trees built
+        bool m_externalImages;                          ///< save embedded images next to the document
+        QScopedPointer<EgcDocumentJournal> m_journal;   ///< journal of the changes since the document file was written
+        QString m_fileName;                             ///< the document file (read or written last)
+        QScopedPointer<EgcDocumentSaver> m_saver;       ///< writes the document in the background
+        bool m_savePending;                             ///< true until the result of the background save is taken
+        bool m_groupMove;                               ///< true while several entities are moved at once
 };
 
 #endif // EGCDOCUMENT_H
@@ -0,0 +1,473 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <new>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QXmlStreamWriter>
+#include "egcdocumentjournal.h"
+#include "entities/egcentity.h"
+
+EgcDocumentJournal::EgcDocumentJournal() : m_suspended{false}, m_externalImages{false}, m_documentSize{0},
+                                           m_commitOffset{0}, m_restarting{false}
+{
+}
+
+EgcDocumentJournal::~EgcDocumentJournal()
+{
+        stop();
+}
+
+QString EgcDocumentJournal::getJournalFile(const QString& documentFile)
+{
+        return documentFile + QString(".journal");
+}
+
+void EgcDocumentJournal::getSignature(const QString& documentFile, qint64& size, qint64& modified)
+{
+        QFileInfo info(documentFile);
+        size = info.size();
+        modified = info.lastModified().toMSecsSinceEpoch();
+}
+
+bool EgcDocumentJournal::start(const QString& documentFile, const QList<EgcEntity*>& entities)
+{
+        stop();
+        if (!create(documentFile))
+                return false;
+        remember(entities);
+
+        return true;
+}
+
+bool EgcDocumentJournal::create(const QString& documentFile)
+{
+        QScopedPointer<QFile> file(new (std::nothrow) QFile(getJournalFile(documentFile)));
+        if (file.isNull())
+                return false;
+        if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate))
+                return false;
+
+        qint64 modified;
+        getSignature(documentFile, m_documentSize, modified);
+        QDataStream stream(file.data());
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << s_magic << s_version << m_documentSize << modified;
+        if (stream.status() != QDataStream::Ok || !file->flush())
+                return false;
+
+        m_file.reset(file.take());
+        m_documentFile = documentFile;
+        m_commitOffset = m_file->pos();
+
+        return true;
+}
+
+bool EgcDocumentJournal::open(const QString& documentFile, const QList<EgcEntity*>& entities)
+{
+        stop();
+
+        QString journalFile = getJournalFile(documentFile);
+        if (!QFileInfo::exists(journalFile))
+                return false;
+        QScopedPointer<QFile> file(new (std::nothrow) QFile(journalFile));
+        if (file.isNull())
+                return false;
+        if (!file->open(QIODevice::ReadWrite))
+                return false;
+
+        QDataStream stream(file.data());
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic;
+        quint16 version;
+        qint64 size;
+        qint64 modified;
+        stream >> magic >> version >> size >> modified;
+        qint64 currentSize;
+        qint64 currentModified;
+        getSignature(documentFile, currentSize, currentModified);
+        // a journal that has been written for another version of the document file is of no use
+        if (    stream.status() != QDataStream::Ok || magic != s_magic || version != s_version
+             || size != currentSize || modified != currentModified)
+                return false;
+
+        qint64 valid = file->pos();
+        m_commitOffset = valid;
+        QList<EgcJournalRecord> records;
+        while (!stream.atEnd()) {
+                QByteArray payload;
+                quint16 checksum;
+                stream >> payload >> checksum;
+                // a record that has only partly been written ends the journal
+                if (    stream.status() != QDataStream::Ok
+                     || checksum != qChecksum(payload.constData(), static_cast<uint>(payload.size())))
+                        break;
+
+                QDataStream recordStream(payload);
+                recordStream.setVersion(QDataStream::Qt_5_0);
+                quint8 type;
+                EgcJournalRecord record;
+                QByteArray data;
+                recordStream >> type >> record.m_id >> data;
+                if (    recordStream.status() != QDataStream::Ok
+                     || type >= static_cast<quint8>(EgcJournalRecordType::NrRecordTypes))
+                        break;
+                record.m_type = static_cast<EgcJournalRecordType>(type);
+                if (record.m_type == EgcJournalRecordType::EntityMoved) {
+                        QDataStream posStream(data);
+                        posStream.setVersion(QDataStream::Qt_5_0);
+                        posStream >> record.m_pos;
+                } else {
+                        record.m_xml = data;
+                }
+                valid = file->pos();
+
+                if (record.m_type == EgcJournalRecordType::Commit) {
+                        m_saved.append(records);
+                        records.clear();
+                        m_commitOffset = valid;
+                } else {
+                        records.append(record);
+                }
+        }
+        m_unsaved = records;
+
+        // remove a record that has only partly been written, the next records are appended after the valid ones
+        if (!file->resize(valid) || !file->seek(valid)) {
+                m_saved.clear();
+                m_unsaved.clear();
+                return false;
+        }
+
+        m_file.reset(file.take());
+        m_documentFile = documentFile;
+        m_documentSize = size;
+        remember(entities);
+
+        return true;
+}
+
+void EgcDocumentJournal::stop(void)
+{
+        if (!m_file.isNull())
+                m_file->flush();
+        m_file.reset();
+        m_entities.clear();
+        m_digests.clear();
+        m_dirty.clear();
+        m_positions.clear();
+        m_suspended = false;
+        m_documentSize = 0;
+        m_commitOffset = 0;
+        m_saved.clear();
+        m_unsaved.clear();
+        cancelRestart();
+}
+
+void EgcDocumentJournal::prepareRestart(void)
+{
+        m_restarting = true;
+        m_restartRecords.clear();
+}
+
+bool EgcDocumentJournal::finishRestart(const QString& documentFile)
+{
+        if (!m_restarting)
+                return false;
+
+        QList<PendingRecord> records = m_restartRecords;
+        // the entities that have been recorded are still the same, so the digests and positions remain valid
+        QHash<EgcEntity*, QByteArray> digests = m_digests;
+        QSet<EgcEntity*> dirty = m_dirty;
+        QHash<EgcEntity*, QPointF> positions = m_positions;
+        stop();
+        m_digests = digests;
+        m_dirty = dirty;
+        m_positions = positions;
+        if (!create(documentFile))
+                return false;
+
+        foreach (const PendingRecord& record, records)
+                append(record.m_type, record.m_id, record.m_data);
+
+        return true;
+}
+
+void EgcDocumentJournal::cancelRestart(void)
+{
+        m_restarting = false;
+        m_restartRecords.clear();
+}
+
+bool EgcDocumentJournal::isRestarting(void) const
+{
+        return m_restarting;
+}
+
+bool EgcDocumentJournal::isActive(void) const
+{
+        return !m_file.isNull();
+}
+
+void EgcDocumentJournal::suspend(bool suspend)
+{
+        m_suspended = suspend;
+}
+
+const QList<EgcJournalRecord>& EgcDocumentJournal::getSavedRecords(void) const
+{
+        return m_saved;
+}
+
+const QList<EgcJournalRecord>& EgcDocumentJournal::getUnsavedRecords(void) const
+{
+        return m_unsaved;
+}
+
+void EgcDocumentJournal::releaseRecords(void)
+{
+        m_saved.clear();
+        m_unsaved.clear();
+}
+
+void EgcDocumentJournal::discardUnsaved(void)
+{
+        m_unsaved.clear();
+        if (!isActive())
+                return;
+
+        if (!m_file->resize(m_commitOffset) || !m_file->seek(m_commitOffset))
+                stop();
+}
+
+void EgcDocumentJournal::remember(const QList<EgcEntity*>& entities)
+{
+        m_entities.clear();
+        foreach (EgcEntity* entity, entities) {
+                if (!entity)
+                        continue;
+                m_entities.insert(entity->getId(), entity);
+                m_positions.insert(entity, entity->getPosition());
+        }
+}
+
+void EgcDocumentJournal::setEntity(quint32 id, EgcEntity* entity)
+{
+        if (!entity) {
+                m_entities.remove(id);
+                return;
+        }
+
+        m_entities.insert(id, entity);
+        m_positions.insert(entity, entity->getPosition());
+}
+
+EgcEntity* EgcDocumentJournal::getEntity(quint32 id) const
+{
+        return m_entities.value(id, nullptr);
+}
+
+void EgcDocumentJournal::setExternalImages(bool external)
+{
+        m_externalImages = external;
+}
+
+bool EgcDocumentJournal::serialize(EgcEntity* entity, QByteArray& xml) const
+{
+        xml.clear();
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        QXmlStreamWriter stream(&buffer);
+        SerializerProperties properties;
+        properties.filePath = m_documentFile;
+        properties.externalImages = m_externalImages;
+        entity->serialize(stream, properties);
+        buffer.close();
+
+        return properties.errorMessage.isEmpty();
+}
+
+bool EgcDocumentJournal::write(EgcJournalRecordType type, quint32 id, const QByteArray& data)
+{
+        QByteArray payload;
+        QDataStream recordStream(&payload, QIODevice::WriteOnly);
+        recordStream.setVersion(QDataStream::Qt_5_0);
+        recordStream << static_cast<quint8>(type) << id << data;
+
+        QDataStream stream(m_file.data());
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << payload << qChecksum(payload.constData(), static_cast<uint>(payload.size()));
+
+        // flush every record, so the changes are in the file if the application crashes
+        return stream.status() == QDataStream::Ok && m_file->flush();
+}
+
+void EgcDocumentJournal::append(EgcJournalRecordType type, quint32 id, const QByteArray& data)
+{
+        if (m_suspended)
+                return;
+
+        // the records are applied to the journal that is started when the document has been written
+        if (m_restarting) {
+                PendingRecord record;
+                record.m_type = type;
+                record.m_id = id;
+                record.m_data = data;
+                m_restartRecords.append(record);
+        }
+
+        if (isActive())
+                write(type, id, data);
+}
+
+void EgcDocumentJournal::recordCreation(EgcEntity* entity)
+{
+        // the entities created while replaying are set by the replay
+        if (m_suspended || !entity || (!isActive() && !m_restarting))
+                return;
+
+        // entities that don't belong to a document can't be referenced
+        if (entity->getId() == 0)
+                return;
+
+        // a record that refers to an image file that could not be written is useless, the next save must write the
+        // whole document (and reports the error)
+        QByteArray xml;
+        if (!serialize(entity, xml)) {
+                stop();
+                return;
+        }
+        m_digests.insert(entity, QCryptographicHash::hash(xml, QCryptographicHash::Sha1));
+        m_positions.insert(entity, entity->getPosition());
+        append(EgcJournalRecordType::EntityCreated, entity->getId(), xml);
+}
+
+void EgcDocumentJournal::recordChange(EgcEntity* entity)
+{
+        if (m_suspended || !entity || entity->getId() == 0 || (!isActive() && !m_restarting))
+                return;
+
+        m_dirty.remove(entity);
+        QByteArray xml;
+        if (!serialize(entity, xml)) {
+                stop();
+                return;
+        }
+        QByteArray digest = QCryptographicHash::hash(xml, QCryptographicHash::Sha1);
+        if (m_digests.value(entity) == digest)
+                return;
+        m_digests.insert(entity, digest);
+        // the serialized entity contains the position as well
+        m_positions.insert(entity, entity->getPosition());
+        append(EgcJournalRecordType::EntityChanged, entity->getId(), xml);
+}
+
+void EgcDocumentJournal::markDirty(EgcEntity* entity)
+{
+        if (m_suspended || !entity)
+                return;
+
+        m_dirty.insert(entity);
+}
+
+void EgcDocumentJournal::recordDirty(void)
+{
+        QSet<EgcEntity*> dirty = m_dirty;
+        foreach (EgcEntity* entity, dirty)
+                recordChange(entity);
+        m_dirty.clear();
+}
+
+void EgcDocumentJournal::recordDeletion(EgcEntity* entity)
+{
+        if (!entity)
+                return;
+
+        m_digests.remove(entity);
+        m_dirty.remove(entity);
+        m_positions.remove(entity);
+        // the entity is removed also while suspended, since it is deleted in any case
+        if (m_entities.value(entity->getId(), nullptr) == entity)
+                m_entities.remove(entity->getId());
+        if (entity->getId() != 0)
+                append(EgcJournalRecordType::EntityDeleted, entity->getId());
+}
+
+void EgcDocumentJournal::recordMove(EgcEntity* entity, QPointF pos)
+{
+        if (!entity)
+                return;
+
+        // the position is remembered also while suspended (e.g. when replaying a move)
+        m_positions.insert(entity, pos);
+        if (m_suspended || entity->getId() == 0 || (!isActive() && !m_restarting))
+                return;
+
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << pos;
+        append(EgcJournalRecordType::EntityMoved, entity->getId(), data);
+}
+
+void EgcDocumentJournal::recordPositions(const QList<EgcEntity*>& entities)
+{
+        foreach (EgcEntity* entity, entities) {
+                if (!entity)
+                        continue;
+                QPointF pos = entity->getPosition();
+                if (!m_positions.contains(entity) || m_positions.value(entity) != pos)
+                        recordMove(entity, pos);
+        }
+}
+
+bool EgcDocumentJournal::commit(void)
+{
+        if (!isActive())
+                return false;
+
+        if (!write(EgcJournalRecordType::Commit, 0))
+                return false;
+        m_commitOffset = m_file->pos();
+
+        return true;
+}
+
+bool EgcDocumentJournal::needsCompaction(void) const
+{
+        if (!isActive())
+                return true;
+
+        qint64 minSize = s_minCompactionSize;
+
+        return m_file->size() > qMax(minSize, m_documentSize / 2);
+}
@@ -0,0 +1,299 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCDOCUMENTJOURNAL_H
+#define EGCDOCUMENTJOURNAL_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPointF>
+#include <QScopedPointer>
+#include <QString>
+#include <QFile>
+
+class EgcEntity;
+
+/**
+ * @brief The EgcJournalRecordType enum denotes the type of a record inside a document journal
+ */
+enum class EgcJournalRecordType : quint8
+{
+        EntityCreated = 0,      ///< an entity has been created (id and the serialized entity)
+        EntityChanged,          ///< the content of an entity has been replaced (id and the serialized entity)
+        EntityDeleted,          ///< an entity has been deleted (id)
+        EntityMoved,            ///< an entity has been moved (id and new position)
+        Commit,                 ///< the document has been saved, all records before belong to the saved document
+        NrRecordTypes           ///< number of record types, must be the last entry
+};
+
+/**
+ * @brief The EgcJournalRecord class holds a record read from a document journal
+ */
+class EgcJournalRecord
+{
+public:
+        EgcJournalRecordType m_type;    ///< type of the record
+        quint32 m_id;                   ///< id of the entity the record is for
+        QByteArray m_xml;               ///< serialized entity (created and changed records)
+        QPointF m_pos;                  ///< new position of the entity (moved records)
+};
+
+/**
+ * @brief The EgcDocumentJournal class writes an append-only journal of the changes of a document next to the document
+ * file. The document file and the records up to the last commit record make up the saved document, so saving a
+ * document only needs to append a commit record instead of writing the whole document. The records after the last
+ * commit are the changes not saved yet, they can be recovered after a crash.
+ * Entities are referenced by their ids (see EgcEntity::getId), which are saved with the document, so the records refer
+ * to the same entities no matter in which order the entities are written or loaded.
+ * Every record is written with its length and a checksum, so a record that has only partly been written (e.g. due to
+ * a crash) is detected and ignored.
+ */
+class EgcDocumentJournal
+{
+public:
+        EgcDocumentJournal();
+        ~EgcDocumentJournal();
+        /**
+         * @brief getJournalFile returns the file name of the journal for the given document file
+         * @param documentFile the document file
+         * @return the file name of the journal
+         */
+        static QString getJournalFile(const QString& documentFile);
+        /**
+         * @brief start starts a new (empty) journal for the given document file. This must be called after the whole
+         * document has been written to the document file.
+         * @param documentFile the document file the journal belongs to
+         * @param entities the entities of the document
+         * @return true if the journal has been started, false otherwise
+         */
+        bool start(const QString& documentFile, const QList<EgcEntity*>& entities);
+        /**
+         * @brief open opens the existing journal of the given document file and reads its records. The journal is
+         * only opened if it has been started for the current version of the document file.
+         * @param documentFile the document file the journal belongs to
+         * @param entities the entities of the document (just loaded)
+         * @return true if the journal has been opened, false if there is no valid journal for the document
+         */
+        bool open(const QString& documentFile, const QList<EgcEntity*>& entities);
+        /**
+         * @brief stop closes the journal
+         */
+        void stop(void);
+        /**
+         * @brief prepareRestart must be called when a snapshot of the document is taken to write the document in the
+         * background. All changes recorded until finishRestart is called are also kept for the new journal.
+         */
+        void prepareRestart(void);
+        /**
+         * @brief finishRestart starts a new journal after the snapshot has been written to the document file. The
+         * changes recorded since prepareRestart are written to the new journal.
+         * @param documentFile the document file the snapshot has been written to
+         * @return true if the new journal has been started, false otherwise
+         */
+        bool finishRestart(const QString& documentFile);
+        /**
+         * @brief cancelRestart discards the changes kept since prepareRestart (e.g. if writing the document failed)
+         */
+        void cancelRestart(void);
+        /**
+         * @brief isRestarting checks if prepareRestart has been called and the restart isn't finished yet
+         * @return true if the journal is waiting for the document to be written, false otherwise
+         */
+        bool isRestarting(void) const;
+        /**
+         * @brief isActive checks if the journal is open
+         * @return true if changes are written to the journal, false otherwise
+         */
+        bool isActive(void) const;
+        /**
+         * @brief suspend suspends writing records, e.g. while the records of the journal are replayed
+         * @param suspend true to suspend writing, false to resume
+         */
+        void suspend(bool suspend);
+        /**
+         * @brief getSavedRecords returns the records read by open that belong to the saved document
+         * @return the records up to the last commit record
+         */
+        const QList<EgcJournalRecord>& getSavedRecords(void) const;
+        /**
+         * @brief getUnsavedRecords returns the records read by open that haven't been saved (e.g. due to a crash)
+         * @return the records after the last commit record
+         */
+        const QList<EgcJournalRecord>& getUnsavedRecords(void) const;
+        /**
+         * @brief releaseRecords releases the records read by open after they have been applied to the document
+         */
+        void releaseRecords(void);
+        /**
+         * @brief discardUnsaved removes the records after the last commit record from the journal
+         */
+        void discardUnsaved(void);
+        /**
+         * @brief setEntity sets the entity with the given id (used when replaying the records)
+         * @param id the id of the entity
+         * @param entity the entity
+         */
+        void setEntity(quint32 id, EgcEntity* entity);
+        /**
+         * @brief getEntity returns the entity with the given id
+         * @param id the id of the entity
+         * @return the entity or a nullptr if there is no entity with the given id
+         */
+        EgcEntity* getEntity(quint32 id) const;
+        /**
+         * @brief setExternalImages sets whether embedded images are serialized as references to external files
+         * @param external true if images are saved next to the document
+         */
+        void setExternalImages(bool external);
+        /**
+         * @brief recordCreation records the creation of an entity
+         * @param entity the entity created
+         */
+        void recordCreation(EgcEntity* entity);
+        /**
+         * @brief recordChange records that the content of an entity has been changed. Nothing is written if the
+         * entity is still the same as recorded last time.
+         * @param entity the entity changed
+         */
+        void recordChange(EgcEntity* entity);
+        /**
+         * @brief markDirty marks an entity that may have been changed without reporting it (e.g. a plot that has been
+         * zoomed), so it is recorded by recordDirty
+         * @param entity the entity that may have been changed
+         */
+        void markDirty(EgcEntity* entity);
+        /**
+         * @brief recordDirty records the changes of all entities marked as dirty (e.g. before committing)
+         */
+        void recordDirty(void);
+        /**
+         * @brief recordDeletion records the deletion of an entity
+         * @param entity the entity that is going to be deleted
+         */
+        void recordDeletion(EgcEntity* entity);
+        /**
+         * @brief recordMove records that an entity has been moved
+         * @param entity the entity moved
+         * @param pos the new position of the entity
+         */
+        void recordMove(EgcEntity* entity, QPointF pos);
+        /**
+         * @brief recordPositions records a move for every entity whose position is not the one recorded last time
+         * (not all moves are reported, e.g. when moving several items at once)
+         * @param entities the entities to check
+         */
+        void recordPositions(const QList<EgcEntity*>& entities);
+        /**
+         * @brief commit marks all records written so far as saved
+         * @return true if the commit has been written, false otherwise
+         */
+        bool commit(void);
+        /**
+         * @brief needsCompaction checks if the journal has grown so much, that the document should be written again
+         * @return true if the document should be written completely at the next save, false otherwise
+         */
+        bool needsCompaction(void) const;
+
+        static const quint32 s_magic = 0x4547434A;      ///< magic number of a journal ("EGCJ")
+        static const quint16 s_version = 2;             ///< version of the journal format
+        static const qint64 s_minCompactionSize = 256 * 1024; ///< the journal is never compacted below this size
+
+private:
+        /**
+         * @brief The PendingRecord struct holds a record that is kept for the journal started after a background save
+         */
+        struct PendingRecord
+        {
+                EgcJournalRecordType m_type;    ///< type of the record
+                quint32 m_id;                   ///< id of the entity the record is for
+                QByteArray m_data;              ///< the data of the record
+        };
+
+        /**
+         * @brief create creates the journal file for the given document file and writes the header
+         * @param documentFile the document file the journal belongs to
+         * @return true if the journal file has been created, false otherwise
+         */
+        bool create(const QString& documentFile);
+        /**
+         * @brief append writes a record for the entity with the given id
+         * @param type the type of the record
+         * @param id the id of the entity the record is for
+         * @param data the data of the record
+         */
+        void append(EgcJournalRecordType type, quint32 id, const QByteArray& data = QByteArray());
+        /**
+         * @brief write writes a record to the journal
+         * @param type the type of the record
+         * @param id the id of the entity
+         * @param data the data of the record
+         * @return true if the record has been written, false otherwise
+         */
+        bool write(EgcJournalRecordType type, quint32 id, const QByteArray& data = QByteArray());
+        /**
+         * @brief serialize serializes the given entity
+         * @param entity the entity to serialize
+         * @param xml the serialized entity
+         * @return true if the entity has been serialized completely, false if e.g. an image file could not be written
+         */
+        bool serialize(EgcEntity* entity, QByteArray& xml) const;
+        /**
+         * @brief getSignature returns the signature of the document file (size and modification time) that is stored
+         * in the journal header to detect journals that don't belong to the current document file
+         * @param documentFile the document file
+         * @param size is set to the size of the file
+         * @param modified is set to the modification time of the file (ms since epoch)
+         */
+        static void getSignature(const QString& documentFile, qint64& size, qint64& modified);
+        /**
+         * @brief remember remembers the entities of the document file and their positions
+         * @param entities the entities of the document file
+         */
+        void remember(const QList<EgcEntity*>& entities);
+
+        QScopedPointer<QFile> m_file;                   ///< the journal file
+        QString m_documentFile;                         ///< the document file the journal belongs to
+        QHash<quint32, EgcEntity*> m_entities;          ///< maps the ids to the entities (for replaying)
+        QHash<EgcEntity*, QByteArray> m_digests;        ///< digests of the entities as recorded last time
+        QSet<EgcEntity*> m_dirty;                       ///< entities that may have been changed since the last record
+        QHash<EgcEntity*, QPointF> m_positions;         ///< positions of the entities as recorded last time
+        bool m_suspended;                               ///< true if writing records is suspended
+        bool m_externalImages;                          ///< serialize embedded images as external files
+        qint64 m_documentSize;                          ///< size of the document file
+        qint64 m_commitOffset;                          ///< end of the last commit record in the journal file
+        QList<EgcJournalRecord> m_saved;                ///< saved records read by open
+        QList<EgcJournalRecord> m_unsaved;              ///< unsaved records read by open
+        bool m_restarting;                              ///< true while the document is written in the background
+        QList<PendingRecord> m_restartRecords;          ///< records kept for the journal after the background save
+};
+
+#endif // EGCDOCUMENTJOURNAL_H
@@ -0,0 +1,191 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QSaveFile>
+#include <QXmlStreamWriter>
+#include "egcdocumentsaver.h"
+#include "egcbinarydocument.h"
+#include "entities/egcentitysnapshot.h"
+
+EgcDocumentSaver::EgcDocumentSaver(QObject* parent) : QThread(parent), m_binary{false}, m_width{0.0},
+                                                      m_height{0.0}, m_sequence{0}, m_saved{false}
+{
+}
+
+EgcDocumentSaver::~EgcDocumentSaver()
+{
+        // the snapshots are in use as long as the thread is running
+        wait();
+        qDeleteAll(m_entities);
+}
+
+bool EgcDocumentSaver::save(const QString& fileName, bool binary, const SerializerProperties& properties, qreal width,
+                            qreal height, const QString& font, const QList<EgcEntitySnapshot*>& entities)
+{
+        if (isRunning()) {
+                qDeleteAll(entities);
+                return false;
+        }
+
+        qDeleteAll(m_entities);
+        m_entities = entities;
+        m_fileName = fileName;
+        m_binary = binary;
+        m_properties = properties;
+        m_width = width;
+        m_height = height;
+        m_font = font;
+        m_saved = false;
+        m_errorString.clear();
+        m_sequence++;
+        start();
+
+        return true;
+}
+
+quint32 EgcDocumentSaver::getSequence(void) const
+{
+        return m_sequence;
+}
+
+bool EgcDocumentSaver::isSaved(void) const
+{
+        return m_saved;
+}
+
+QString EgcDocumentSaver::getFileName(void) const
+{
+        return m_fileName;
+}
+
+QString EgcDocumentSaver::getErrorString(void) const
+{
+        return m_errorString;
+}
+
+void EgcDocumentSaver::writeDocumentStart(QXmlStreamWriter& stream, qreal width, qreal height, const QString& font)
+{
+        stream.setAutoFormatting(true);
+        stream.writeStartDocument();
+
+        stream.writeStartElement("document");
+        stream.writeAttributes(getDocumentAttributes(width, height, font));
+}
+
+void EgcDocumentSaver::writeDocumentEnd(QXmlStreamWriter& stream)
+{
+        stream.writeEndElement(); // document
+
+        stream.writeEndDocument();
+}
+
+QXmlStreamAttributes EgcDocumentSaver::getDocumentAttributes(qreal width, qreal height, const QString& font)
+{
+        QXmlStreamAttributes attr;
+        attr.append("width", QString("%1").arg(width));
+        attr.append("height", QString("%1").arg(height));
+        attr.append("version", QString(EGCAS_VERSION));
+        attr.append("doc_font", font);
+
+        return attr;
+}
+
+bool EgcDocumentSaver::write(QIODevice& device)
+{
+        QXmlStreamWriter stream(&device);
+        writeDocumentStart(stream, m_width, m_height, m_font);
+        foreach (EgcEntitySnapshot* entity, m_entities)
+                entity->serialize(stream, m_properties);
+        writeDocumentEnd(stream);
+
+        // e.g. an image file next to the document could not be written
+        if (!m_properties.errorMessage.isEmpty()) {
+                m_errorString = m_properties.errorMessage;
+                return false;
+        }
+
+        return !stream.hasError();
+}
+
+bool EgcDocumentSaver::write(EgcBinaryDocument& document)
+{
+        document.startEncoding();
+        document.writeStartElement(QString("document"), getDocumentAttributes(m_width, m_height, m_font));
+        foreach (EgcEntitySnapshot* entity, m_entities) {
+                if (!entity->serializeBinary(document, m_properties)) {
+                        m_errorString = document.getErrorString();
+                        return false;
+                }
+        }
+        document.writeEndElement(); // document
+
+        // e.g. an image file next to the document could not be written
+        if (!m_properties.errorMessage.isEmpty()) {
+                m_errorString = m_properties.errorMessage;
+                return false;
+        }
+
+        return true;
+}
+
+void EgcDocumentSaver::run(void)
+{
+        // the document file is replaced only when commit is called, so a failed save leaves the old file intact
+        QSaveFile file(m_fileName);
+        QIODevice::OpenMode mode = QIODevice::WriteOnly;
+        if (!m_binary)
+                mode |= QIODevice::Text;
+
+        bool ok = file.open(mode);
+        if (ok && m_binary) {
+                // the formulas are written directly from their trees, there is no xml text of the whole document
+                EgcBinaryDocument binary;
+                ok = write(binary);
+                if (ok && !binary.finishEncoding(file)) {
+                        m_errorString = binary.getErrorString();
+                        ok = false;
+                }
+        } else if (ok) {
+                ok = write(file);
+        }
+
+        if (ok)
+                ok = file.commit();
+        else
+                file.cancelWriting();
+        if (!ok && m_errorString.isEmpty())
+                m_errorString = file.errorString();
+        m_saved = ok;
+
+        // the snapshots aren't needed anymore, free the memory as early as possible
+        qDeleteAll(m_entities);
+        m_entities.clear();
+
+        emit saved(m_sequence);
+}
@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCDOCUMENTSAVER_H
+#define EGCDOCUMENTSAVER_H
+
+#include <QList>
+#include <QString>
+#include <QThread>
+#include "entities/egcentity.h"
+
+class QIODevice;
+class QXmlStreamWriter;
+class EgcEntitySnapshot;
+class EgcBinaryDocument;
+class QXmlStreamAttributes;
+
+/**
+ * @brief The EgcDocumentSaver class writes a document from a snapshot of its entities in a worker thread, so the
+ * document can be edited further while it is saved. The snapshots are taken on the GUI thread (see
+ * EgcEntity::takeSnapshot). The document is written into a temporary file that replaces the document file only if
+ * everything has been written, so the document file is never left half written.
+ */
+class EgcDocumentSaver : public QThread
+{
+        Q_OBJECT
+public:
+        EgcDocumentSaver(QObject* parent = nullptr);
+        virtual ~EgcDocumentSaver();
+        /**
+         * @brief save starts saving the given snapshot into a file
+         * @param fileName the file to save the document into
+         * @param binary true to save the document in the binary format (see EgcBinaryDocument)
+         * @param properties object with all neccessary information for serializing
+         * @param width the width of the document
+         * @param height the height of the document
+         * @param font the generic font of the document
+         * @param entities the snapshots of the entities in the order of the entity list (the saver takes ownership)
+         * @return true if saving has been started, false if a document is still being saved
+         */
+        bool save(const QString& fileName, bool binary, const SerializerProperties& properties, qreal width,
+                  qreal height, const QString& font, const QList<EgcEntitySnapshot*>& entities);
+        /**
+         * @brief getSequence returns the number of the save started last
+         * @return the sequence number (incremented by every save)
+         */
+        quint32 getSequence(void) const;
+        /**
+         * @brief isSaved checks if the document has been saved successfully (valid after the thread has finished)
+         * @return true if the document file has been written, false otherwise
+         */
+        bool isSaved(void) const;
+        /**
+         * @brief getFileName returns the file the document is saved into
+         * @return the file name of the document
+         */
+        QString getFileName(void) const;
+        /**
+         * @brief getErrorString returns a description of the error if saving failed
+         * @return the error description
+         */
+        QString getErrorString(void) const;
+        /**
+         * @brief writeDocumentStart writes the document element and its attributes
+         * @param stream the stream to write to
+         * @param width the width of the document
+         * @param height the height of the document
+         * @param font the generic font of the document
+         */
+        static void writeDocumentStart(QXmlStreamWriter& stream, qreal width, qreal height, const QString& font);
+        /**
+         * @brief writeDocumentEnd closes the document element
+         * @param stream the stream to write to
+         */
+        static void writeDocumentEnd(QXmlStreamWriter& stream);
+        /**
+         * @brief getDocumentAttributes returns the attributes of the document element
+         * @param width the width of the document
+         * @param height the height of the document
+         * @param font the generic font of the document
+         * @return the attributes of the document element
+         */
+        static QXmlStreamAttributes getDocumentAttributes(qreal width, qreal height, const QString& font);
+
+signals:
+        /**
+         * @brief saved is emitted from the worker thread when saving has finished (successfully or not)
+         * @param sequence the sequence number of the save
+         */
+        void saved(quint32 sequence);
+
+protected:
+        /**
+         * @brief run writes the document (runs in the worker thread)
+         */
+        virtual void run(void) override;
+
+private:
+        /**
+         * @brief write writes the xml document into the given device
+         * @param device the device to write to
+         * @return true if the document has been written, false otherwise
+         */
+        bool write(QIODevice& device);
+        /**
+         * @brief write writes the document into the given binary document (the formulas are written directly from
+         * their trees)
+         * @param document the binary document to write to
+         * @return true if the document has been written, false otherwise
+         */
+        bool write(EgcBinaryDocument& document);
+
+        QString m_fileName;                     ///< the file to save the document into
+        bool m_binary;                          ///< save the document in the binary format
+        SerializerProperties m_properties;      ///< properties for serializing the entities
+        qreal m_width;                          ///< width of the document
+        qreal m_height;                         ///< height of the document
+        QString m_font;                         ///< generic font of the document
+        QList<EgcEntitySnapshot*> m_entities;   ///< snapshots of the entities to save
+        quint32 m_sequence;                     ///< number of the save started last
+        bool m_saved;                           ///< true if the document has been saved successfully
+        QString m_errorString;                  ///< description of the error if saving failed
+};
+
+#endif // EGCDOCUMENTSAVER_H
@@ -0,0 +1,179 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <algorithm>
+#include "egcformulaloader.h"
+#include "egcnodes.h"
+
+/**
+ * @brief The EgcFormulaLoaderWorker class builds trees of the loader given until there is nothing left to do
+ */
+class EgcFormulaLoaderWorker : public QRunnable
+{
+public:
+        EgcFormulaLoaderWorker(EgcFormulaLoader& loader) : m_loader(loader) {}
+        virtual void run(void) override
+        {
+                while (m_loader.buildNext())
+                        ;
+        }
+private:
+        EgcFormulaLoader& m_loader;     ///< the loader to build the trees for
+};
+
+EgcFormulaLoader::EgcFormulaLoader() : m_attached{0}
+{
+}
+
+EgcFormulaLoader::~EgcFormulaLoader()
+{
+        stop();
+}
+
+void EgcFormulaLoader::start(const QList<EgcFormulaEntity*>& formulas, const QRectF& visible)
+{
+        stop();
+
+        foreach (EgcFormulaEntity* formula, formulas) {
+                QScopedPointer<Job> job(new Job());
+                if (!formula || !formula->getPendingTree(job->m_pending))
+                        continue;
+                job->m_formula = formula;
+                job->m_tree = nullptr;
+                job->m_attached = false;
+                m_jobs.append(job.take());
+        }
+        if (m_jobs.isEmpty())
+                return;
+
+        // formulas in the visible area first, then by distance to it
+        QPointF center = visible.center();
+        std::stable_sort(m_jobs.begin(), m_jobs.end(), [&visible, &center](const Job* a, const Job* b) {
+                QPointF posA = a->m_formula->getPosition();
+                QPointF posB = b->m_formula->getPosition();
+                bool aVisible = visible.contains(posA);
+                bool bVisible = visible.contains(posB);
+                if (aVisible != bVisible)
+                        return aVisible;
+                return (posA - center).manhattanLength() < (posB - center).manhattanLength();
+        });
+
+        // the nodes optimize their shared regexes when the first one is created, so do this before the threads start
+        EgcVariableNode variable;
+        EgcNumberNode number;
+        (void) variable;
+        (void) number;
+
+        int workers = qMin(m_pool.maxThreadCount(), m_jobs.size());
+        for (int i = 0; i < workers; i++)
+                m_pool.start(new EgcFormulaLoaderWorker(*this));
+}
+
+bool EgcFormulaLoader::buildNext(void)
+{
+        if (m_cancel.loadAcquire())
+                return false;
+
+        int index = m_next.fetchAndAddRelaxed(1);
+        if (index >= m_jobs.size())
+                return false;
+
+        Job* job = m_jobs.at(index);
+        job->m_tree = EgcFormulaEntity::buildTree(job->m_pending);
+        job->m_done.storeRelease(1);
+
+        return true;
+}
+
+int EgcFormulaLoader::attachFinished(qint64 timeBudget)
+{
+        QElapsedTimer timer;
+        timer.start();
+        int attached = 0;
+
+        foreach (Job* job, m_jobs) {
+                if (timer.hasExpired(timeBudget))
+                        break;
+                if (job->m_attached || !job->m_done.loadAcquire())
+                        continue;
+                if (job->m_formula)
+                        job->m_formula->attachTree(job->m_tree);
+                else
+                        delete job->m_tree;
+                job->m_tree = nullptr;
+                job->m_pending.m_source = QString();
+                job->m_pending.m_binary.clear();
+                job->m_attached = true;
+                attached++;
+        }
+        m_attached += attached;
+
+        return attached;
+}
+
+void EgcFormulaLoader::remove(EgcFormulaEntity* formula)
+{
+        foreach (Job* job, m_jobs) {
+                if (job->m_formula == formula)
+                        job->m_formula = nullptr;
+        }
+}
+
+void EgcFormulaLoader::stop(void)
+{
+        m_cancel.storeRelease(1);
+        m_pool.waitForDone();
+
+        foreach (Job* job, m_jobs) {
+                if (!job->m_attached)
+                        delete job->m_tree;
+        }
+        qDeleteAll(m_jobs);
+        m_jobs.clear();
+        m_next.storeRelease(0);
+        m_cancel.storeRelease(0);
+        m_attached = 0;
+}
+
+bool EgcFormulaLoader::isFinished(void) const
+{
+        return m_attached == m_jobs.size();
+}
+
+int EgcFormulaLoader::getTotal(void) const
+{
+        return m_jobs.size();
+}
+
+int EgcFormulaLoader::getAttached(void) const
+{
+        return m_attached;
+}
@@ -0,0 +1,120 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCFORMULALOADER_H
+#define EGCFORMULALOADER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QRectF>
+#include <QThreadPool>
+#include <QVector>
+#include "entities/egcformulaentity.h"
+
+class EgcFormulaLoaderWorker;
+
+/**
+ * @brief The EgcFormulaLoader class builds the trees of the formulas of a loaded document on a thread pool. Reading
+ * the document only records where each formula tree is found in the document text (see EgcFormulaEntity::deserialize),
+ * the trees are independent of each other and are built in parallel by the worker threads. The trees finished are
+ * attached to their formulas in the thread of the document by calling attachFinished.
+ */
+class EgcFormulaLoader
+{
+        friend class EgcFormulaLoaderWorker;
+public:
+        EgcFormulaLoader();
+        virtual ~EgcFormulaLoader();
+        /**
+         * @brief start starts building the trees of all formulas given that are still pending. The formulas in the
+         * visible area are built first, then the remaining ones by their distance to the visible area.
+         * @param formulas the formulas to build the trees for
+         * @param visible the visible area of the scene
+         */
+        void start(const QList<EgcFormulaEntity*>& formulas, const QRectF& visible);
+        /**
+         * @brief attachFinished attaches the trees finished by the worker threads to their formulas
+         * @param timeBudget the maximum time in ms to spend on attaching trees
+         * @return the number of trees attached
+         */
+        int attachFinished(qint64 timeBudget);
+        /**
+         * @brief remove must be called if a formula is deleted while its tree is being built
+         * @param formula the formula that is about to be deleted
+         */
+        void remove(EgcFormulaEntity* formula);
+        /**
+         * @brief stop stops building the trees and discards all trees not yet attached. Returns after the worker
+         * threads have finished their current tree.
+         */
+        void stop(void);
+        /**
+         * @brief isFinished checks if all trees have been attached
+         * @return true if there is nothing left to do, false otherwise
+         */
+        bool isFinished(void) const;
+        /**
+         * @brief getTotal returns the number of trees to build
+         * @return the number of formulas pending when start was called
+         */
+        int getTotal(void) const;
+        /**
+         * @brief getAttached returns the number of trees already attached
+         * @return the number of formulas done
+         */
+        int getAttached(void) const;
+
+private:
+        /**
+         * @brief The Job struct holds a tree to build
+         */
+        struct Job
+        {
+                EgcFormulaEntity* m_formula;            ///< formula the tree belongs to (nullptr if deleted meanwhile)
+                EgcFormulaEntity::PendingTree m_pending;///< location of the tree in the document
+                EgcBaseNode* m_tree;                    ///< tree built by a worker thread
+                QAtomicInt m_done;                      ///< set by the worker thread if m_tree is valid
+                bool m_attached;                        ///< tree has been attached (or discarded)
+        };
+
+        /**
+         * @brief buildNext builds the next tree that hasn't been taken by another worker thread (is called by the
+         * worker threads)
+         * @return true if a tree has been built, false if there is nothing left to do
+         */
+        bool buildNext(void);
+
+        QThreadPool m_pool;             ///< the thread pool for building the trees
+        QVector<Job*> m_jobs;           ///< trees to build (in the order of building them)
+        QAtomicInt m_next;              ///< index of the next job to take by a worker thread
+        QAtomicInt m_cancel;            ///< set to stop the worker threads
+        int m_attached;                 ///< number of jobs attached
+};
+
+#endif // EGCFORMULALOADER_H
@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <new>
+#include <QBuffer>
+#include <QXmlStreamWriter>
+#include "egcsessionrecorder.h"
+#include "abstractserializer.h"
+
+QScopedPointer<QFile> EgcSessionRecorder::s_file;
+QScopedPointer<QDataStream> EgcSessionRecorder::s_stream;
+QElapsedTimer EgcSessionRecorder::s_timer;
+QHash<const EgcEntity*, quint32> EgcSessionRecorder::s_ids;
+quint32 EgcSessionRecorder::s_nextId = 0;
+bool EgcSessionRecorder::s_suspended = false;
+bool EgcSessionRecorder::s_routed = false;
+
+bool EgcSessionRecorder::start(const QString& logFile, AbstractSerializer& document, const QList<EgcEntity*>& entities)
+{
+        stop();
+
+        s_file.reset(new (std::nothrow) QFile(logFile));
+        if (s_file.isNull())
+                return false;
+        if (!s_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                s_file.reset();
+                return false;
+        }
+
+        s_stream.reset(new (std::nothrow) QDataStream(s_file.data()));
+        if (s_stream.isNull()) {
+                s_file.reset();
+                return false;
+        }
+        s_stream->setVersion(QDataStream::Qt_5_0);
+        *s_stream << s_magic << s_version;
+
+        s_suspended = false;
+        s_routed = false;
+        s_timer.start();
+        recordSnapshot(document, entities);
+
+        return true;
+}
+
+void EgcSessionRecorder::stop(void)
+{
+        if (!s_file.isNull())
+                s_file->flush();
+        s_stream.reset();
+        s_file.reset();
+        s_ids.clear();
+        s_nextId = 0;
+        s_suspended = false;
+        s_routed = false;
+}
+
+void EgcSessionRecorder::writeHeader(EgcSessionRecordType type)
+{
+        *s_stream << static_cast<quint8>(type) << static_cast<quint32>(s_timer.elapsed());
+}
+
+quint32 EgcSessionRecorder::getId(const EgcEntity* entity)
+{
+        return s_ids.value(entity, s_noEntity);
+}
+
+quint32 EgcSessionRecorder::addEntity(const EgcEntity* entity)
+{
+        quint32 id = s_nextId++;
+        s_ids.insert(entity, id);
+
+        return id;
+}
+
+void EgcSessionRecorder::recordSnapshot(AbstractSerializer& document, const QList<EgcEntity*>& entities)
+{
+        if (!isRecording())
+                return;
+
+        QByteArray xml;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        QXmlStreamWriter stream(&buffer);
+        SerializerProperties properties;
+        document.serialize(stream, properties);
+        buffer.close();
+
+        s_ids.clear();
+        s_nextId = 0;
+        foreach (EgcEntity* entity, entities)
+                (void) addEntity(entity);
+
+        writeHeader(EgcSessionRecordType::Snapshot);
+        *s_stream << qCompress(xml);
+}
+
+void EgcSessionRecorder::recordCreation(const EgcEntity* entity, EgcEntityType type, QPointF pos)
+{
+        if (!isRecording() || !entity)
+                return;
+
+        writeHeader(EgcSessionRecordType::EntityCreated);
+        *s_stream << addEntity(entity) << static_cast<quint8>(type) << pos;
+}
+
+void EgcSessionRecorder::recordClone(const EgcEntity* entity, const EgcEntity* original)
+{
+        if (!isRecording() || !entity)
+                return;
+
+        quint32 originalId = getId(original);
+        writeHeader(EgcSessionRecordType::EntityCloned);
+        *s_stream << addEntity(entity) << originalId;
+}
+
+void EgcSessionRecorder::recordDeletion(const EgcEntity* entity)
+{
+        if (!isRecording() || !s_ids.contains(entity))
+                return;
+
+        writeHeader(EgcSessionRecordType::EntityDeleted);
+        *s_stream << getId(entity);
+        s_ids.remove(entity);
+}
+
+void EgcSessionRecorder::recordMove(const EgcEntity* entity, QPointF pos)
+{
+        if (!isRecording() || !s_ids.contains(entity))
+                return;
+
+        writeHeader(EgcSessionRecordType::EntityMoved);
+        *s_stream << getId(entity) << pos;
+}
+
+void EgcSessionRecorder::recordAction(const EgcEntity* entity, const EgcAction& action)
+{
+        if (!isRecording() || !s_ids.contains(entity))
+                return;
+
+        writeHeader(EgcSessionRecordType::FormulaAction);
+        *s_stream << getId(entity) << s_routed << static_cast<quint8>(action.m_op) << action.m_character
+                  << action.m_elementId << action.m_subId << static_cast<quint8>(action.m_intType)
+                  << static_cast<quint8>(action.m_OpModificators) << static_cast<quint8>(action.m_lookModificatiors)
+                  << action.m_additionalData;
+}
+
+void EgcSessionRecorder::recordKernelResult(const EgcEntity* entity, const QString& result, bool isError)
+{
+        if (!isRecording())
+                return;
+
+        if (isError)
+                writeHeader(EgcSessionRecordType::KernelError);
+        else
+                writeHeader(EgcSessionRecordType::KernelResult);
+        *s_stream << getId(entity) << result;
+}
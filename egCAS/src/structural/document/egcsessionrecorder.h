@@ -0,0 +1,173 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCSESSIONRECORDER_H
+#define EGCSESSIONRECORDER_H
+
+#include <QtGlobal>
+#include <QHash>
+#include <QList>
+#include <QPointF>
+#include <QScopedPointer>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFile>
+#include "actions/egcaction.h"
+#include "entities/egcentity.h"
+
+class AbstractSerializer;
+
+/**
+ * @brief The EgcSessionRecordType enum denotes the type of a record inside a session log
+ */
+enum class EgcSessionRecordType : quint8
+{
+        Snapshot = 0,           ///< complete (serialized) document, e.g. at start of recording or after loading a file
+        EntityCreated,          ///< a new entity has been created
+        EntityCloned,           ///< an entity has been cloned
+        EntityDeleted,          ///< an entity has been deleted
+        EntityMoved,            ///< an entity has been moved by the user
+        FormulaAction,          ///< an action that has been handled by a formula entity
+        KernelResult,           ///< the kernel delivered a result for a formula
+        KernelError,            ///< the kernel delivered an error for a formula
+        NrRecordTypes           ///< number of record types, must be the last entry
+};
+
+/**
+ * @brief The EgcSessionRecorder class records a user session (actions, entity creation, moves and kernel results) in a
+ * compact binary log. The log can be replayed with the EgcSessionReplayer to reproduce performance problems offline.
+ * Entities are referenced by ids that are assigned in the order the entities appear in the document at a snapshot and
+ * in the order they are created afterwards, so the replayer is able to assign the same ids.
+ */
+class EgcSessionRecorder
+{
+public:
+        /**
+         * @brief start starts recording into the given file. The current document content is written as snapshot.
+         * @param logFile the file to write the session log to
+         * @param document the document to record
+         * @param entities the entities of the document in the order of the entity list
+         * @return true if recording has been started, false otherwise
+         */
+        static bool start(const QString& logFile, AbstractSerializer& document, const QList<EgcEntity*>& entities);
+        /**
+         * @brief stop stops recording and closes the log file
+         */
+        static void stop(void);
+        /**
+         * @brief isRecording checks if a session is currently recorded
+         * @return true if a session is recorded, false otherwise
+         */
+        static bool isRecording(void) { return !s_stream.isNull() && !s_suspended; }
+        /**
+         * @brief suspend suspends recording, e.g. while loading a document (the result is recorded as snapshot)
+         * @param suspend true to suspend recording, false to resume recording
+         */
+        static void suspend(bool suspend) { s_suspended = suspend; }
+        /**
+         * @brief recordSnapshot records the complete document. The entity ids are reassigned in list order.
+         * @param document the document to record
+         * @param entities the entities of the document in the order of the entity list
+         */
+        static void recordSnapshot(AbstractSerializer& document, const QList<EgcEntity*>& entities);
+        /**
+         * @brief recordCreation records the creation of an entity
+         * @param entity the entity created
+         * @param type the type of the entity
+         * @param pos the position where the entity has been created
+         */
+        static void recordCreation(const EgcEntity* entity, EgcEntityType type, QPointF pos);
+        /**
+         * @brief recordClone records the cloning of an entity
+         * @param entity the entity created
+         * @param original the entity that has been cloned
+         */
+        static void recordClone(const EgcEntity* entity, const EgcEntity* original);
+        /**
+         * @brief recordDeletion records the deletion of an entity
+         * @param entity the entity that is going to be deleted
+         */
+        static void recordDeletion(const EgcEntity* entity);
+        /**
+         * @brief recordMove records that an entity has been moved by the user
+         * @param entity the entity that has been moved
+         * @param pos the new position of the entity
+         */
+        static void recordMove(const EgcEntity* entity, QPointF pos);
+        /**
+         * @brief recordAction records an action handled by a formula entity
+         * @param entity the formula entity that handles the action
+         * @param action the action to record
+         */
+        static void recordAction(const EgcEntity* entity, const EgcAction& action);
+        /**
+         * @brief setRouted marks the following actions as routed through the scene (e.g. actions from the menu)
+         * @param routed true if the following actions are routed through the scene, false otherwise
+         */
+        static void setRouted(bool routed) { s_routed = routed; }
+        /**
+         * @brief recordKernelResult records a result (or an error) of the kernel
+         * @param entity the formula entity the result is for (may be a nullptr, e.g. for definitions)
+         * @param result the result string or error message delivered by the kernel
+         * @param isError true if the kernel delivered an error
+         */
+        static void recordKernelResult(const EgcEntity* entity, const QString& result, bool isError = false);
+
+        static const quint32 s_magic = 0x45475353;      ///< magic number of a session log ("EGSS")
+        static const quint16 s_version = 1;             ///< version of the session log format
+        static const quint32 s_noEntity = 0xFFFFFFFF;   ///< id used if no entity is associated with a record
+private:
+        /**
+         * @brief writeHeader writes the header of a record (type and time stamp)
+         * @param type the type of the record
+         */
+        static void writeHeader(EgcSessionRecordType type);
+        /**
+         * @brief getId returns the id of the given entity
+         * @param entity the entity to get the id of
+         * @return the id of the entity or s_noEntity if the entity is not known
+         */
+        static quint32 getId(const EgcEntity* entity);
+        /**
+         * @brief addEntity assigns a new id to the given entity
+         * @param entity the entity to assign the id to
+         * @return the id assigned
+         */
+        static quint32 addEntity(const EgcEntity* entity);
+
+        static QScopedPointer<QFile> s_file;                    ///< the file the session is recorded into
+        static QScopedPointer<QDataStream> s_stream;            ///< the stream the session is recorded with
+        static QElapsedTimer s_timer;                           ///< timer for the time stamps of the records
+        static QHash<const EgcEntity*, quint32> s_ids;          ///< maps the entities to their ids
+        static quint32 s_nextId;                                ///< next id to assign
+        static bool s_suspended;                                ///< true if recording is currently suspended
+        static bool s_routed;                                   ///< true if the actions are routed through the scene
+};
+
+#endif // EGCSESSIONRECORDER_H
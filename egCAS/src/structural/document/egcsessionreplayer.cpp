@@ -0,0 +1,381 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <new>
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QXmlStreamReader>
+#include <QPainter>
+#include <QGraphicsItem>
+#include <QStringBuilder>
+#include "egcsessionreplayer.h"
+#include "egcdocument.h"
+#include "entities/egcentitylist.h"
+#include "entities/egcformulaentity.h"
+#include "entities/egctextentity.h"
+#include "entities/egcpixmapentity.h"
+#include "entities/egctableentity.h"
+#include "entities/egcplotentity.h"
+#include "view/egcasscene.h"
+#include "egcabstractformulaitem.h"
+#include "egcabstracttextitem.h"
+#include "egcabstractpixmapitem.h"
+#include "egcabstracttableitem.h"
+#include "egcabstractplotitem.h"
+#include "casKernel/parser/egckernelparser.h"
+
+EgcSessionReplayer::EgcSessionReplayer(EgcDocument& document) : m_document(document),
+        m_parser{new (std::nothrow) EgcKernelParser()}, m_canvas{2100, 2900, QImage::Format_ARGB32_Premultiplied},
+        m_render{true}
+{
+}
+
+EgcSessionReplayer::~EgcSessionReplayer()
+{
+}
+
+void EgcSessionReplayer::setRendering(bool render)
+{
+        m_render = render;
+}
+
+QString EgcSessionReplayer::getErrorMessage(void) const
+{
+        return m_errorMessage;
+}
+
+const QList<EgcSessionSpike>& EgcSessionReplayer::getSpikes(void) const
+{
+        return m_spikes;
+}
+
+bool EgcSessionReplayer::replay(const QString& logFile)
+{
+        m_errorMessage.clear();
+        m_entities.clear();
+        m_spikes.clear();
+        for (int i = 0; i < static_cast<int>(EgcSessionRecordType::NrRecordTypes); i++) {
+                m_nsecs[i] = 0;
+                m_max[i] = 0;
+                m_count[i] = 0;
+        }
+
+        if (!m_parser) {
+                m_errorMessage = QObject::tr("Not enough memory to replay the session.");
+                return false;
+        }
+
+        QFile file(logFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+                m_errorMessage = QObject::tr("Unable to open the session log %1.").arg(logFile);
+                return false;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic;
+        quint16 version;
+        stream >> magic >> version;
+        if (magic != EgcSessionRecorder::s_magic || version != EgcSessionRecorder::s_version) {
+                m_errorMessage = QObject::tr("The file %1 is not a session log of this version.").arg(logFile);
+                return false;
+        }
+
+        QElapsedTimer timer;
+        quint32 recordIndex = 0;
+        while (!stream.atEnd()) {
+                quint8 rawType;
+                quint32 timeStamp;
+                stream >> rawType >> timeStamp;
+                if (rawType >= static_cast<quint8>(EgcSessionRecordType::NrRecordTypes)) {
+                        m_errorMessage = QObject::tr("Unknown record type in session log at record %1.")
+                                                    .arg(recordIndex);
+                        return false;
+                }
+                EgcSessionRecordType type = static_cast<EgcSessionRecordType>(rawType);
+
+                timer.start();
+                EgcEntity* entity = replayRecord(type, stream);
+                if (m_render)
+                        render(entity);
+                qint64 nsecs = timer.nsecsElapsed();
+
+                if (stream.status() != QDataStream::Ok) {
+                        m_errorMessage = QObject::tr("The session log is corrupted at record %1.").arg(recordIndex);
+                        return false;
+                }
+
+                m_nsecs[rawType] += nsecs;
+                m_count[rawType]++;
+                if (nsecs > m_max[rawType])
+                        m_max[rawType] = nsecs;
+
+                EgcSessionSpike spike;
+                spike.m_recordIndex = recordIndex;
+                spike.m_type = type;
+                spike.m_timeStamp = timeStamp;
+                spike.m_nsecs = nsecs;
+                addSpike(spike);
+
+                recordIndex++;
+        }
+
+        return true;
+}
+
+EgcEntity* EgcSessionReplayer::replayRecord(EgcSessionRecordType type, QDataStream& stream)
+{
+        EgcEntity* entity = nullptr;
+        quint32 id;
+
+        switch (type) {
+        case EgcSessionRecordType::Snapshot: {
+                QByteArray xml;
+                stream >> xml;
+                QXmlStreamReader reader(qUncompress(xml));
+                SerializerProperties properties;
+                properties.version = 0;
+                m_document.deserialize(reader, properties);
+                m_entities.clear();
+                QMutableListIterator<EgcEntity*> iter = m_document.getEntityList()->getIterator();
+                while (iter.hasNext())
+                        m_entities.append(iter.next());
+                return nullptr;
+        }
+        case EgcSessionRecordType::EntityCreated: {
+                quint8 entityType;
+                QPointF pos;
+                stream >> id >> entityType >> pos;
+                entity = m_document.createEntity(static_cast<EgcEntityType>(entityType), pos);
+                break;
+        }
+        case EgcSessionRecordType::EntityCloned: {
+                quint32 originalId;
+                stream >> id >> originalId;
+                EgcEntity* original = getEntity(originalId);
+                if (original)
+                        entity = m_document.cloneEntity(*original);
+                break;
+        }
+        case EgcSessionRecordType::EntityDeleted: {
+                stream >> id;
+                EgcEntity* toDelete = getEntity(id);
+                if (toDelete) {
+                        QGraphicsItem* item = nullptr;
+                        EgCasScene* scene = m_document.getScene();
+                        if (toDelete->getEntityType() == EgcEntityType::Formula) {
+                                EgcAbstractFormulaItem* aItem = static_cast<EgcFormulaEntity*>(toDelete)->getItem();
+                                item = dynamic_cast<QGraphicsItem*>(aItem);
+                                scene->deleteItem(aItem);
+                        } else if (toDelete->getEntityType() == EgcEntityType::Text) {
+                                EgcAbstractTextItem* aItem = static_cast<EgcTextEntity*>(toDelete)->getItem();
+                                item = dynamic_cast<QGraphicsItem*>(aItem);
+                                scene->deleteItem(aItem);
+                        } else if (toDelete->getEntityType() == EgcEntityType::Table) {
+                                EgcAbstractTableItem* aItem = static_cast<EgcTableEntity*>(toDelete)->getItem();
+                                item = dynamic_cast<QGraphicsItem*>(aItem);
+                                scene->deleteItem(aItem);
+                        } else if (toDelete->getEntityType() == EgcEntityType::Plot) {
+                                EgcAbstractPlotItem* aItem = static_cast<EgcPlotEntity*>(toDelete)->getItem();
+                                item = dynamic_cast<QGraphicsItem*>(aItem);
+                                scene->deleteItem(aItem);
+                        } else {
+                                EgcAbstractPixmapItem* aItem = static_cast<EgcPixmapEntity*>(toDelete)->getItem();
+                                item = dynamic_cast<QGraphicsItem*>(aItem);
+                                scene->deleteItem(aItem);
+                        }
+                        m_document.itemDeleted(item);
+                        m_entities[static_cast<int>(id)] = nullptr;
+                }
+                // do not append the id below
+                return nullptr;
+        }
+        case EgcSessionRecordType::EntityMoved: {
+                QPointF pos;
+                stream >> id >> pos;
+                entity = getEntity(id);
+                if (entity) {
+                        entity->setPosition(pos);
+                        // the calculation restart of a move is not replayed, since the kernel is not used
+                        m_document.getEntityList()->repositionEntity(entity);
+                }
+                return entity;
+        }
+        case EgcSessionRecordType::FormulaAction: {
+                bool routed;
+                quint8 op, intType, opMod, lookMod;
+                EgcAction action;
+                stream >> id >> routed >> op >> action.m_character >> action.m_elementId >> action.m_subId
+                       >> intType >> opMod >> lookMod >> action.m_additionalData;
+                action.m_op = static_cast<EgcOperations>(op);
+                action.m_intType = static_cast<InternalFunctionType>(intType);
+                action.m_OpModificators = static_cast<OpModificators>(opMod);
+                action.m_lookModificatiors = static_cast<LookModificators>(lookMod);
+                entity = getEntity(id);
+                if (entity && entity->getEntityType() == EgcEntityType::Formula) {
+                        EgcFormulaEntity* formula = static_cast<EgcFormulaEntity*>(entity);
+                        // actions from the menu took the way through the scene when recording
+                        if (routed)
+                                m_document.getScene()->routeToFormula(*formula, action);
+                        else
+                                formula->handleAction(action);
+                }
+                return entity;
+        }
+        case EgcSessionRecordType::KernelResult:
+        case EgcSessionRecordType::KernelError: {
+                QString result;
+                stream >> id >> result;
+                entity = getEntity(id);
+                if (entity && entity->getEntityType() == EgcEntityType::Formula) {
+                        EgcFormulaEntity* formula = static_cast<EgcFormulaEntity*>(entity);
+                        if (type == EgcSessionRecordType::KernelResult) {
+                                EgcNode* tree = m_parser->parseKernelOutput(result);
+                                if (tree)
+                                        formula->setResult(tree);
+                                else
+                                        formula->setErrorMessage(m_parser->getErrorMessage());
+                        } else {
+                                formula->setErrorMessage(result);
+                        }
+                        formula->updateView();
+                }
+                return entity;
+        }
+        default:
+                return nullptr;
+        }
+
+        // the entity has been created or cloned -> assign the id of the record
+        if (id >= static_cast<quint32>(m_entities.size()))
+                m_entities.resize(static_cast<int>(id) + 1);
+        m_entities[static_cast<int>(id)] = entity;
+
+        return entity;
+}
+
+EgcEntity* EgcSessionReplayer::getEntity(quint32 id) const
+{
+        if (id >= static_cast<quint32>(m_entities.size()))
+                return nullptr;
+
+        return m_entities.at(static_cast<int>(id));
+}
+
+void EgcSessionReplayer::render(EgcEntity* entity)
+{
+        if (!entity)
+                return;
+
+        QGraphicsItem* item = nullptr;
+        if (entity->getEntityType() == EgcEntityType::Formula)
+                item = dynamic_cast<QGraphicsItem*>(static_cast<EgcFormulaEntity*>(entity)->getItem());
+        else if (entity->getEntityType() == EgcEntityType::Text)
+                item = dynamic_cast<QGraphicsItem*>(static_cast<EgcTextEntity*>(entity)->getItem());
+        else if (entity->getEntityType() == EgcEntityType::Table)
+                item = dynamic_cast<QGraphicsItem*>(static_cast<EgcTableEntity*>(entity)->getItem());
+        else if (entity->getEntityType() == EgcEntityType::Plot)
+                item = dynamic_cast<QGraphicsItem*>(static_cast<EgcPlotEntity*>(entity)->getItem());
+        else
+                item = dynamic_cast<QGraphicsItem*>(static_cast<EgcPixmapEntity*>(entity)->getItem());
+
+        if (!item)
+                return;
+
+        QRectF source = item->sceneBoundingRect();
+        m_document.getScene()->materializeItems(source);
+        QPainter painter(&m_canvas);
+        m_document.getScene()->render(&painter, QRectF(QPointF(0.0, 0.0), source.size()), source);
+}
+
+void EgcSessionReplayer::addSpike(const EgcSessionSpike& spike)
+{
+        int i;
+        for (i = 0; i < m_spikes.size(); i++) {
+                if (spike.m_nsecs > m_spikes.at(i).m_nsecs)
+                        break;
+        }
+
+        if (i < s_nrSpikes)
+                m_spikes.insert(i, spike);
+        if (m_spikes.size() > s_nrSpikes)
+                m_spikes.removeLast();
+}
+
+QString EgcSessionReplayer::getTypeName(EgcSessionRecordType type)
+{
+        switch (type) {
+        case EgcSessionRecordType::Snapshot:
+                return QString("snapshot");
+        case EgcSessionRecordType::EntityCreated:
+                return QString("entity created");
+        case EgcSessionRecordType::EntityCloned:
+                return QString("entity cloned");
+        case EgcSessionRecordType::EntityDeleted:
+                return QString("entity deleted");
+        case EgcSessionRecordType::EntityMoved:
+                return QString("entity moved");
+        case EgcSessionRecordType::FormulaAction:
+                return QString("formula action");
+        case EgcSessionRecordType::KernelResult:
+                return QString("kernel result");
+        case EgcSessionRecordType::KernelError:
+                return QString("kernel error");
+        default:
+                return QString();
+        }
+}
+
+QString EgcSessionReplayer::report(void) const
+{
+        QString retval;
+
+        for (int i = 0; i < static_cast<int>(EgcSessionRecordType::NrRecordTypes); i++) {
+                qint64 avg = 0;
+                if (m_count[i])
+                        avg = m_nsecs[i] / static_cast<qint64>(m_count[i]);
+                retval = retval % getTypeName(static_cast<EgcSessionRecordType>(i)).leftJustified(16, ' ')
+                         % QString(" records: ") % QString::number(m_count[i]).rightJustified(8, ' ')
+                         % QString("  total [us]: ") % QString::number(m_nsecs[i] / 1000).rightJustified(10, ' ')
+                         % QString("  avg [us]: ") % QString::number(avg / 1000).rightJustified(8, ' ')
+                         % QString("  max [us]: ") % QString::number(m_max[i] / 1000).rightJustified(8, ' ')
+                         % QString("\n");
+        }
+
+        retval = retval % QString("\nslowest records:\n");
+        foreach (EgcSessionSpike spike, m_spikes) {
+                retval = retval % QString("#") % QString::number(spike.m_recordIndex).leftJustified(8, ' ')
+                         % getTypeName(spike.m_type).leftJustified(16, ' ') % QString(" at [ms]: ")
+                         % QString::number(spike.m_timeStamp).rightJustified(10, ' ') % QString("  took [us]: ")
+                         % QString::number(spike.m_nsecs / 1000).rightJustified(8, ' ') % QString("\n");
+        }
+
+        return retval;
+}
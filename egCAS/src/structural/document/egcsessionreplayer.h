@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCSESSIONREPLAYER_H
+#define EGCSESSIONREPLAYER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QImage>
+#include <QScopedPointer>
+#include "egcsessionrecorder.h"
+#include "casKernel/egckernelconn.h"
+
+class EgcDocument;
+class EgcEntity;
+class EgcKernelParser;
+class QDataStream;
+
+/**
+ * @brief The EgcSessionSpike class describes a record whose replay took especially long
+ */
+class EgcSessionSpike
+{
+public:
+        quint32 m_recordIndex;          ///< index of the record inside the session log
+        EgcSessionRecordType m_type;    ///< type of the record
+        quint32 m_timeStamp;            ///< time stamp of the record in ms (time of recording)
+        qint64 m_nsecs;                 ///< time needed to replay the record in ns
+};
+
+/**
+ * @brief The EgcReplayKernelConn class is a kernel connection that does not start a kernel and drops all commands.
+ * Documents that are used for replaying a session are created with it, since the recorded kernel results are fed into
+ * the formulas instead.
+ */
+class EgcReplayKernelConn : public EgcKernelConn
+{
+public:
+        EgcReplayKernelConn(QObject *parent = 0) : EgcKernelConn{parent} {}
+        virtual ~EgcReplayKernelConn() {}
+        virtual void startKernel(QString binaryStartCmd) override {(void) binaryStartCmd;}
+        virtual void sendCommand(QString cmd) override {(void) cmd;}
+        virtual void quit(void) override {}
+        virtual void reset() override {}
+        virtual void restart(void) override {}
+protected:
+        virtual void stdOutput(void) override {}
+        virtual void errorOutput(void) override {}
+};
+
+/**
+ * @brief The EgcSessionReplayer class replays a session log (recorded with EgcSessionRecorder) headless on a document
+ * and measures the time needed to replay every record. The kernel is not used while replaying, the results recorded
+ * are fed into the formulas instead. So the replay is deterministic and latency spikes can be reproduced offline.
+ */
+class EgcSessionReplayer
+{
+public:
+        /**
+         * @brief EgcSessionReplayer constructor
+         * @param document the document to replay the session on (create it with an EgcReplayKernelConn, so no
+         * kernel is started)
+         */
+        explicit EgcSessionReplayer(EgcDocument& document);
+        ~EgcSessionReplayer();
+        /**
+         * @brief replay replays the given session log
+         * @param logFile the session log to replay
+         * @return true if the complete log has been replayed, false otherwise (see getErrorMessage)
+         */
+        bool replay(const QString& logFile);
+        /**
+         * @brief setRendering if activated, the affected entity is rendered after each record (into an offscreen
+         * image), so the rendering time is included in the measurement
+         * @param render true if rendering shall be measured (default), false otherwise
+         */
+        void setRendering(bool render);
+        /**
+         * @brief getErrorMessage returns the error message if replaying the log failed
+         * @return the error message
+         */
+        QString getErrorMessage(void) const;
+        /**
+         * @brief report returns a report with the time spent per record type and the slowest records
+         * @return the report as human readable string
+         */
+        QString report(void) const;
+        /**
+         * @brief getSpikes returns the slowest records of the last replay (slowest first)
+         * @return list with the slowest records
+         */
+        const QList<EgcSessionSpike>& getSpikes(void) const;
+        /**
+         * @brief getTypeName returns a human readable name of the given record type
+         * @param type the record type
+         * @return the name of the record type
+         */
+        static QString getTypeName(EgcSessionRecordType type);
+private:
+        /**
+         * @brief replayRecord replays a single record
+         * @param type the type of the record
+         * @param stream the stream to read the record data from
+         * @return the entity that has been affected by the record (may be a nullptr)
+         */
+        EgcEntity* replayRecord(EgcSessionRecordType type, QDataStream& stream);
+        /**
+         * @brief getEntity returns the entity with the given id
+         * @param id the id of the entity
+         * @return pointer to the entity or a nullptr if there is no entity with the given id
+         */
+        EgcEntity* getEntity(quint32 id) const;
+        /**
+         * @brief render renders the given entity into the offscreen image
+         * @param entity the entity to render
+         */
+        void render(EgcEntity* entity);
+        /**
+         * @brief addSpike adds the given record to the list of spikes if it is one of the slowest records
+         * @param spike the record to add
+         */
+        void addSpike(const EgcSessionSpike& spike);
+
+        static const int s_nrSpikes = 10;       ///< number of slowest records to remember
+
+        EgcDocument& m_document;                        ///< the document the session is replayed on
+        QScopedPointer<EgcKernelParser> m_parser;       ///< parser for the kernel results recorded
+        QVector<EgcEntity*> m_entities;                 ///< maps the ids of the session log to the entities
+        QImage m_canvas;                                ///< image to render the entities into
+        bool m_render;                                  ///< true if the entities shall be rendered
+        QString m_errorMessage;                         ///< error message if replaying failed
+        qint64 m_nsecs[static_cast<int>(EgcSessionRecordType::NrRecordTypes)];  ///< time spent per record type
+        qint64 m_max[static_cast<int>(EgcSessionRecordType::NrRecordTypes)];    ///< longest time per record type
+        quint64 m_count[static_cast<int>(EgcSessionRecordType::NrRecordTypes)]; ///< number of records per type
+        QList<EgcSessionSpike> m_spikes;                ///< the slowest records
+};
+
+#endif // EGCSESSIONREPLAYER_H
@@ -26,9 +26,128 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#include <QString>
 #include "egcnodecreator.h"
 #include "egcnodes.h"
 
+namespace {
+
+/**
+ * @brief s_nameHashSeed and s_nameSlots form a perfect hash table of the node type names. The seed is chosen at build
+ * time so that every name maps to its own slot, so a lookup needs one hash calculation and one string compare.
+ *
+ * This list is generated form the cog python code below. Do not change it manually!!!
+ */
+const quint32 s_nameHashSeed = 180u;
+const EgcNodeType s_nameSlots[] = {
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NatLogNode,
+        EgcNodeType::NumberNode,
+        EgcNodeType::ListNode,
+        EgcNodeType::MatrixNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::EqualNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::FncContainerNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::EmptyNode,
+        EgcNodeType::DifferentialNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::IntegralNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::LogNode,
+        EgcNodeType::DefinitionNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::ParenthesisNode,
+        EgcNodeType::MultiplicationNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::FunctionNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::ArgumentsNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::MinusNode,
+        EgcNodeType::ExponentNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::BaseNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::LParenthesisNode,
+        EgcNodeType::AlnumNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::RootNode,
+        EgcNodeType::PlusNode,
+        EgcNodeType::RParenthesisNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::UnaryMinusNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::BinEmptyNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::DivisionNode,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::NodeUndefined,
+        EgcNodeType::VariableNode,
+//The list is generated automatically. Do NOT change it manually.
+};
+
+const quint32 s_nameSlotCount = sizeof(s_nameSlots) / sizeof(EgcNodeType);
+
+inline quint32 charCode(char character)
+{
+        return static_cast<uchar>(character);
+}
+
+inline quint32 charCode(QChar character)
+{
+        return character.unicode();
+}
+
+/**
+ * @brief lookupType looks up the node type of the given name in the perfect hash table. The hash must be kept in sync
+ * with node_name_hash in python_helper.py.
+ * @param name the name of the node type in lowercase
+ * @param length the length of the name
+ * @return the node type or EgcNodeType::NodeUndefined if there is no node type with this name
+ */
+template <typename Char>
+EgcNodeType lookupType(const Char* name, int length)
+{
+        quint32 hash = s_nameHashSeed;
+        for (int i = 0; i < length; i++)
+                hash = (hash ^ charCode(name[i])) * 16777619u;
+        hash ^= hash >> 16;
+
+        EgcNodeType type = s_nameSlots[hash & (s_nameSlotCount - 1)];
+        const EgcNodeTraits& traits = egcNodeTraits(type);
+        if (traits.m_nameLength != length)
+                return EgcNodeType::NodeUndefined;
+        for (int i = 0; i < length; i++) {
+                if (charCode(name[i]) != charCode(traits.m_name[i]))
+                        return EgcNodeType::NodeUndefined;
+        }
+
+        return type;
+}
+
+}
+
 EgcNode* EgcNodeCreator::create(EgcNodeType type)
 {
         EgcNode *retval;
@@ -100,6 +219,12 @@ EgcNode* EgcNodeCreator::create(EgcNodeType type)
         case EgcNodeType::DifferentialNode:
                 retval = new (std::nothrow) EgcDifferentialNode();
                 break;
+        case EgcNodeType::ListNode:
+                retval = new (std::nothrow) EgcListNode();
+                break;
+        case EgcNodeType::MatrixNode:
+                retval = new (std::nothrow) EgcMatrixNode();
+                break;
         case EgcNodeType::EmptyNode:
                 retval = new (std::nothrow) EgcEmptyNode();
                 break;
@@ -122,150 +247,21 @@ EgcNode* EgcNodeCreator::create(EgcNodeType type)
 
 EgcNode*EgcNodeCreator::create(QLatin1String name)
 {
-        EgcNode *retval = nullptr;
-
-        if (name == QLatin1String("lognode"))
-                retval = new (std::nothrow) EgcLogNode();
-        if (name == QLatin1String("rparenthesisnode"))
-                retval = new (std::nothrow) RParenthesisNode();
-        if (name == QLatin1String("definitionnode"))
-                retval = new (std::nothrow) EgcDefinitionNode();
-        if (name == QLatin1String("lparenthesisnode"))
-                retval = new (std::nothrow) LParenthesisNode();
-        if (name == QLatin1String("equalnode"))
-                retval = new (std::nothrow) EgcEqualNode();
-        if (name == QLatin1String("divisionnode"))
-                retval = new (std::nothrow) EgcDivisionNode();
-        if (name == QLatin1String("plusnode"))
-                retval = new (std::nothrow) EgcPlusNode();
-        if (name == QLatin1String("binemptynode"))
-                retval = new (std::nothrow) EgcBinEmptyNode();
-        if (name == QLatin1String("multiplicationnode"))
-                retval = new (std::nothrow) EgcMultiplicationNode();
-        if (name == QLatin1String("natlognode"))
-                retval = new (std::nothrow) EgcNatLogNode();
-        if (name == QLatin1String("parenthesisnode"))
-                retval = new (std::nothrow) EgcParenthesisNode();
-        if (name == QLatin1String("unaryminusnode"))
-                retval = new (std::nothrow) EgcUnaryMinusNode();
-        if (name == QLatin1String("variablenode"))
-                retval = new (std::nothrow) EgcVariableNode();
-        if (name == QLatin1String("rootnode"))
-                retval = new (std::nothrow) EgcRootNode();
-        if (name == QLatin1String("alnumnode"))
-                retval = new (std::nothrow) EgcAlnumNode();
-        if (name == QLatin1String("minusnode"))
-                retval = new (std::nothrow) EgcMinusNode();
-        if (name == QLatin1String("integralnode"))
-                retval = new (std::nothrow) EgcIntegralNode();
-        if (name == QLatin1String("exponentnode"))
-                retval = new (std::nothrow) EgcExponentNode();
-        if (name == QLatin1String("fnccontainernode"))
-                retval = new (std::nothrow) EgcFncContainerNode();
-        if (name == QLatin1String("functionnode"))
-                retval = new (std::nothrow) EgcFunctionNode();
-        if (name == QLatin1String("numbernode"))
-                retval = new (std::nothrow) EgcNumberNode();
-        if (name == QLatin1String("differentialnode"))
-                retval = new (std::nothrow) EgcDifferentialNode();
-        if (name == QLatin1String("emptynode"))
-                retval = new (std::nothrow) EgcEmptyNode();
-        if (name == QLatin1String("argumentsnode"))
-                retval = new (std::nothrow) EgcArgumentsNode();
-        //The list is generated automatically. Do NOT change it manually.
-
-        if (name == QLatin1String("basenode"))
-                retval = new (std::nothrow) EgcBaseNode();
-
+        EgcNodeType type = lookupType(name.data(), name.size());
+        if (type == EgcNodeType::NodeUndefined)
+                return nullptr;
 
-        return retval;
+        return create(type);
 }
 
 QLatin1String EgcNodeCreator::stringize(EgcNodeType type)
 {
-        QLatin1String retval = QLatin1String("");
-
-        switch (type) {
-
-        case EgcNodeType::LogNode:
-                retval = QLatin1String("lognode");
-                break;
-        case EgcNodeType::RParenthesisNode:
-                retval = QLatin1String("rparenthesisnode");
-                break;
-        case EgcNodeType::DefinitionNode:
-                retval = QLatin1String("definitionnode");
-                break;
-        case EgcNodeType::LParenthesisNode:
-                retval = QLatin1String("lparenthesisnode");
-                break;
-        case EgcNodeType::EqualNode:
-                retval = QLatin1String("equalnode");
-                break;
-        case EgcNodeType::DivisionNode:
-                retval = QLatin1String("divisionnode");
-                break;
-        case EgcNodeType::PlusNode:
-                retval = QLatin1String("plusnode");
-                break;
-        case EgcNodeType::BinEmptyNode:
-                retval = QLatin1String("binemptynode");
-                break;
-        case EgcNodeType::MultiplicationNode:
-                retval = QLatin1String("multiplicationnode");
-                break;
-        case EgcNodeType::NatLogNode:
-                retval = QLatin1String("natlognode");
-                break;
-        case EgcNodeType::ParenthesisNode:
-                retval = QLatin1String("parenthesisnode");
-                break;
-        case EgcNodeType::UnaryMinusNode:
-                retval = QLatin1String("unaryminusnode");
-                break;
-        case EgcNodeType::VariableNode:
-                retval = QLatin1String("variablenode");
-                break;
-        case EgcNodeType::RootNode:
-                retval = QLatin1String("rootnode");
-                break;
-        case EgcNodeType::AlnumNode:
-                retval = QLatin1String("alnumnode");
-                break;
-        case EgcNodeType::MinusNode:
-                retval = QLatin1String("minusnode");
-                break;
-        case EgcNodeType::IntegralNode:
-                retval = QLatin1String("integralnode");
-                break;
-        case EgcNodeType::ExponentNode:
-                retval = QLatin1String("exponentnode");
-                break;
-        case EgcNodeType::FncContainerNode:
-                retval = QLatin1String("fnccontainernode");
-                break;
-        case EgcNodeType::FunctionNode:
-                retval = QLatin1String("functionnode");
-                break;
-        case EgcNodeType::NumberNode:
-                retval = QLatin1String("numbernode");
-                break;
-        case EgcNodeType::DifferentialNode:
-                retval = QLatin1String("differentialnode");
-                break;
-        case EgcNodeType::EmptyNode:
-                retval = QLatin1String("emptynode");
-                break;
-        case EgcNodeType::ArgumentsNode:
-                retval = QLatin1String("argumentsnode");
-                break;
-        //The list is generated automatically. Do NOT change it manually.
+        const EgcNodeTraits& traits = egcNodeTraits(type);
 
-        case EgcNodeType::BaseNode:
-                retval = QLatin1String("basenode");
-                break;
-        }
-
-        return retval;
+        return QLatin1String(traits.m_name, traits.m_nameLength);
+}
 
+EgcNodeType EgcNodeCreator::getType(const QStringRef& name)
+{
+        return lookupType(name.unicode(), name.size());
 }
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCNODECREATOR_H
 
 #include <QLatin1String>
+#include <QStringRef>
 
 class EgcNode;
 enum class EgcNodeType;
@@ -59,6 +60,13 @@ public:
          * @return node type as latin1 string in lowercase
          */
         static QLatin1String stringize(EgcNodeType type);
+        /**
+         * @brief getType returns the node type of the name given (the name as returned by stringize). This uses a
+         * perfect hash table generated at build time and is meant for deserializing large documents.
+         * @param name the name of the node type in lowercase. E.g. multiplicationnode
+         * @return the node type or EgcNodeType::NodeUndefined if there is no node type with this name
+         */
+        static EgcNodeType getType(const QStringRef& name);
 private:
         EgcNodeCreator(){}
 };
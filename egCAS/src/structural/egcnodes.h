@@ -30,6 +30,8 @@
 #include "concreteNodes/egcfunctionnode.h"
 #include "concreteNodes/egcnumbernode.h"
 #include "concreteNodes/egcdifferentialnode.h"
+#include "concreteNodes/egclistnode.h"
+#include "concreteNodes/egcmatrixnode.h"
 //The list is generated automatically. Do NOT change it manually.
 
 #endif // EGCNODES_H
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCABSTRACTENTITYLIST_H
 
 class EgcDocument;
+class EgcEntity;
 
 class EgcAbstractEntityList
 {
@@ -48,6 +49,11 @@ public:
         virtual EgcDocument* getDocument(void) = 0;
         /// sort the list
         virtual void sort(void) = 0;
+        /**
+         * @brief repositionEntity moves the given entity to its new place in the list after its position has changed
+         * @param entity the entity whose position has changed
+         */
+        virtual void repositionEntity(EgcEntity* entity) = 0;
         
 };
 
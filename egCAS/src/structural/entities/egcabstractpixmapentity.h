@@ -48,6 +48,11 @@ public:
          * @param item the item that is associated with this entity (can also be a nullptr)
          */
         virtual EgcAbstractPixmapItem* getItem(void) = 0;
+        /**
+         * @brief decodePixmap decodes the image data of the entity and sets the pixmap of the item. Images are only
+         * decoded when they are needed (e.g. painted) the first time.
+         */
+        virtual void decodePixmap(void) = 0;
 
 };
 
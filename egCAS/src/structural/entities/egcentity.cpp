@@ -26,12 +26,17 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#include <new>
 #include <QPointF>
+#include <QBuffer>
+#include <QXmlStreamWriter>
+#include <QXmlStreamAttributes>
 #include "egcentity.h"
+#include "egcentitysnapshot.h"
 #include "egcabstractentitylist.h"
 #include "document/egcdocument.h"
 
-EgcEntity::EgcEntity(void)
+EgcEntity::EgcEntity(void) : m_list{nullptr}, m_id{0}
 {
 
 }
@@ -58,7 +63,7 @@ bool EgcEntity::operator<(const EgcEntity& rhs) const
         if ( op1.x() > op2.x() )
                 return false;
 
-        return true;
+        return false;
 }
 
 void EgcEntity::setList(EgcAbstractEntityList* list)
@@ -66,7 +71,7 @@ void EgcEntity::setList(EgcAbstractEntityList* list)
         m_list = list;
 }
 
-bool EgcEntity::lessThan(EgcEntity* o1, EgcEntity* o2)
+bool EgcEntity::lessThan(const EgcEntity* o1, const EgcEntity* o2)
 {
         if (!o1 || !o2)
                 return false;
@@ -84,3 +89,61 @@ EgcAbstractDocument* EgcEntity::getDocument(void)
 
         return m_list->getDocument();
 }
+
+void EgcEntity::positionChanged(void)
+{
+        EgcAbstractDocument* doc = getDocument();
+        if (doc)
+                doc->entityMoved(this);
+        else if (m_list)
+                m_list->repositionEntity(this);
+}
+
+void EgcEntity::contentModified(void)
+{
+        EgcAbstractDocument* doc = getDocument();
+        if (doc)
+                doc->entityModified(this);
+}
+
+EgcEntitySnapshot* EgcEntity::takeSnapshot(SerializerProperties& properties)
+{
+        QByteArray xml;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        QXmlStreamWriter stream(&buffer);
+        serialize(stream, properties);
+        buffer.close();
+
+        return new (std::nothrow) EgcXmlSnapshot(xml);
+}
+
+quint32 EgcEntity::getId(void) const
+{
+        return m_id;
+}
+
+void EgcEntity::setId(quint32 id)
+{
+        m_id = id;
+}
+
+void EgcEntity::writeId(QXmlStreamWriter& stream, quint32 id)
+{
+        if (id != 0)
+                stream.writeAttribute("id", QString::number(id));
+}
+
+void EgcEntity::writeId(QXmlStreamAttributes& attr, quint32 id)
+{
+        if (id != 0)
+                attr.append("id", QString::number(id));
+}
+
+quint32 EgcEntity::readId(const QXmlStreamAttributes& attr)
+{
+        if (!attr.hasAttribute("id"))
+                return 0;
+
+        return attr.value("id").toUInt();
+}
@@ -30,8 +30,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCENTITY_H
 
 class QPointF;
+class QXmlStreamAttributes;
 class EgcAbstractEntityList;
 class EgcAbstractDocument;
+class EgcEntitySnapshot;
 
 #include "abstractserializer.h"
 #include <QString>
@@ -43,7 +45,9 @@ enum class EgcEntityType
 {
         Formula = 0,        ///< this is a formula int the document
         Picture,            ///< this is a picture in the document
-        Text                ///< this is a text element in the document
+        Text,               ///< this is a text element in the document
+        Table,              ///< this is a table with the values of a parameter sweep in the document
+        Plot                ///< this is a plot of a function in the document
 };
 
 /**
@@ -51,9 +55,15 @@ enum class EgcEntityType
  */
 class SerializerProperties {
 public:
+        SerializerProperties() : version{0}, source{nullptr}, externalImages{false} {}
         quint32 version;        ///< version of the file format
         QString filePath;       ///< file path of the file where the document is saved into
         QString warningMessage; ///< if a warning occurred during loading of a document it is given here
+        QString errorMessage;   ///< if an error occurred during saving of a document (e.g. an image file could not be
+                                ///< written) it is given here, the document must not be considered as saved then
+        const QString* source;  ///< complete text of the document being read (if given, entities may defer parts of
+                                ///< the deserialization and read them from this text on first use)
+        bool externalImages;    ///< if true, embedded images are saved into files next to the document (not inside)
 };
 
 /**
@@ -85,9 +95,10 @@ public:
         virtual void setPosition(QPointF pos) = 0;
         /**
          * @brief operator < overloads the "<" operator to be able to sort the entities in the order they are inserted
-         * on the document sheet
+         * on the document sheet (top to bottom, left to right). This is a strict ordering, entities at the same
+         * position are not less than each other.
          * @param rhs the entity to compare against
-         * @return true if condition is true, false otherwise
+         * @return true if this entity is in front of rhs, false otherwise
          */
         bool operator<(const EgcEntity& rhs) const;
         /**
@@ -101,7 +112,7 @@ public:
          * @param o2 entity 2 to compare to entity o1
          * @return true if o1 is less than 02, false otherwise
          */
-        static bool lessThan(EgcEntity* o1, EgcEntity* o2);
+        static bool lessThan(const EgcEntity* o1, const EgcEntity* o2);
         /**
          * @brief getDocument returns the document that contains the current entity
          * @return the document
@@ -119,11 +130,58 @@ public:
          * @param properties object with all neccessary information for deserializing
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override = 0;
-
-
+        /**
+         * @brief takeSnapshot takes a snapshot of the entity that can be serialized on another thread. The default
+         * implementation serializes the entity right away, so entities that are expensive to serialize should
+         * reimplement this.
+         * @param properties object with all neccessary information for serializing
+         * @return the snapshot (the caller takes ownership) or a nullptr if there is not enough memory
+         */
+        virtual EgcEntitySnapshot* takeSnapshot(SerializerProperties& properties);
+        /**
+         * @brief getId returns the id of the entity. The id identifies the entity inside its document and is saved
+         * with the document, so it stays the same when the document is loaded again.
+         * @return the id of the entity, 0 if the entity hasn't been added to a document yet
+         */
+        quint32 getId(void) const;
+        /**
+         * @brief setId sets the id of the entity (the ids are assigned by the entity list)
+         * @param id the new id of the entity
+         */
+        void setId(quint32 id);
+        /**
+         * @brief writeId writes the given entity id as attribute of the current element
+         * @param stream the stream to write the attribute to
+         * @param id the id to write (nothing is written if the id is 0)
+         */
+        static void writeId(QXmlStreamWriter& stream, quint32 id);
+        /**
+         * @brief writeId adds the given entity id to the attributes given
+         * @param attr the attributes to add the id to
+         * @param id the id to add (nothing is added if the id is 0)
+         */
+        static void writeId(QXmlStreamAttributes& attr, quint32 id);
+        /**
+         * @brief readId reads the entity id from the given attributes
+         * @param attr the attributes of the entity element
+         * @return the id or 0 if there is no id (e.g. documents written by older versions)
+         */
+        static quint32 readId(const QXmlStreamAttributes& attr);
 
 protected:
+        /**
+         * @brief positionChanged must be called after the position of the entity has been changed by the user. The
+         * document (or the list if the entity is not in a document) moves the entity to its new place.
+         */
+        void positionChanged(void);
+        /**
+         * @brief contentModified must be called if the content of the entity may have been changed without reporting
+         * the change to the document (e.g. zooming a plot). The entity is written to the journal at the next save.
+         */
+        void contentModified(void);
+
         EgcAbstractEntityList* m_list;            ///< pointer to the list containing this entity
+        quint32 m_id;                             ///< id of the entity inside its document (0 if not assigned)
 };
 
 #endif // EGCENTITY_H
@@ -27,15 +27,87 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#include <algorithm>
 #include "egcentitylist.h"
 #include "document/egcdocument.h"
 
-EgcEntityList::EgcEntityList(EgcAbstractEntityList* parent) : m_index(0), m_parent(parent)
+EgcEntityListCursor::EgcEntityListCursor(EgcEntityList& list) : m_list{&list}, m_pos{0}
+{
+        list.m_cursors.append(this);
+}
+
+EgcEntityListCursor::~EgcEntityListCursor()
+{
+        if (m_list)
+                m_list->m_cursors.removeOne(this);
+}
+
+void EgcEntityListCursor::toFront(void)
+{
+        m_pos = 0;
+}
+
+bool EgcEntityListCursor::hasNext(void) const
+{
+        if (!m_list)
+                return false;
+
+        return m_pos < m_list->m_list.count();
+}
+
+EgcEntity* EgcEntityListCursor::peekNext(void) const
+{
+        if (!hasNext())
+                return nullptr;
+
+        return m_list->m_list.at(m_pos);
+}
+
+EgcEntity* EgcEntityListCursor::next(void)
+{
+        if (!hasNext())
+                return nullptr;
+
+        return m_list->m_list.at(m_pos++);
+}
+
+bool EgcEntityListCursor::hasPassed(EgcEntity* entity) const
+{
+        if (!m_list)
+                return false;
+
+        int i = m_list->indexOf(entity);
+        if (i < 0)
+                return false;
+
+        return i < m_pos;
+}
+
+bool EgcEntityListCursor::moveTo(EgcEntity* entity)
+{
+        if (!m_list)
+                return false;
+
+        int i = m_list->indexOf(entity);
+        if (i < 0)
+                return false;
+        m_pos = i;
+
+        return true;
+}
+
+EgcEntityList::EgcEntityList(EgcAbstractEntityList* parent) : m_bulkLoad{false}, m_nextId{1}, m_index(0),
+                                                               m_parent(parent)
 {
 }
 
 EgcEntityList::~EgcEntityList()
 {
+        EgcEntityListCursor* cursor;
+        foreach (cursor, m_cursors) {
+                cursor->m_list = nullptr;
+        }
+
         EgcEntity* i;
         foreach (i, m_list) {
                 delete i;
@@ -44,21 +116,131 @@ EgcEntityList::~EgcEntityList()
 
 void EgcEntityList::sort(void)
 {
-        qSort(m_list.begin(), m_list.end(), EgcEntity::lessThan);
+        // remember the entities the cursors point to, to be able to restore the cursors after sorting
+        QList<EgcEntity*> nextEntities;
+        EgcEntityListCursor* cursor;
+        foreach (cursor, m_cursors) {
+                nextEntities.append(cursor->peekNext());
+        }
+
+        std::stable_sort(m_list.begin(), m_list.end(), EgcEntity::lessThan);
+
+        for (int i = 0; i < m_cursors.count(); i++) {
+                EgcEntity* entity = nextEntities.at(i);
+                m_cursors.at(i)->m_pos = entity ? m_list.indexOf(entity) : m_list.count();
+        }
+}
+
+void EgcEntityList::repositionEntity(EgcEntity* entity)
+{
+        if (m_bulkLoad)
+                return;
+
+        // the position of the entity has already changed, so a binary search is not possible
+        int i = m_list.indexOf(entity);
+        if (i < 0)
+                return;
+
+        removeAt(i);
+        insertSorted(entity);
+}
+
+void EgcEntityList::setBulkLoad(bool on)
+{
+        if (m_bulkLoad && !on) {
+                m_bulkLoad = false;
+                sort();
+        }
+
+        m_bulkLoad = on;
+}
+
+void EgcEntityList::insertSorted(EgcEntity* entity)
+{
+        QList<EgcEntity*>::iterator it = std::upper_bound(m_list.begin(), m_list.end(), entity, EgcEntity::lessThan);
+        int i = static_cast<int>(it - m_list.begin());
+        m_list.insert(i, entity);
+
+        EgcEntityListCursor* cursor;
+        foreach (cursor, m_cursors) {
+                if (cursor->m_pos > i)
+                        cursor->m_pos++;
+        }
+}
+
+int EgcEntityList::indexOf(EgcEntity* entity) const
+{
+        if (!entity)
+                return -1;
+
+        if (!m_bulkLoad) {
+                QList<EgcEntity*>::const_iterator it = std::lower_bound(m_list.constBegin(), m_list.constEnd(),
+                                                                        entity, EgcEntity::lessThan);
+                while (it != m_list.constEnd() && !EgcEntity::lessThan(entity, *it)) {
+                        if (*it == entity)
+                                return static_cast<int>(it - m_list.constBegin());
+                        ++it;
+                }
+        }
+
+        return m_list.indexOf(entity);
+}
+
+EgcEntity* EgcEntityList::removeAt(int i)
+{
+        EgcEntityListCursor* cursor;
+        foreach (cursor, m_cursors) {
+                if (cursor->m_pos > i)
+                        cursor->m_pos--;
+        }
+
+        EgcEntity* entity = m_list.takeAt(i);
+        m_ids.remove(entity->getId());
+
+        return entity;
+}
+
+void EgcEntityList::assignId(EgcEntity* entity)
+{
+        quint32 id = entity->getId();
+        if (id == 0 || m_ids.contains(id)) {
+                id = m_nextId;
+                entity->setId(id);
+        }
+        m_ids.insert(id);
+        if (id >= m_nextId)
+                m_nextId = id + 1;
 }
 
 void EgcEntityList::addEntity(EgcEntity* entity)
 {
-        m_list.append(entity);
         entity->setList(this);
-        sort();
+        assignId(entity);
+        if (m_bulkLoad) {
+                m_list.append(entity);
+                return;
+        }
+
+        insertSorted(entity);
+}
+
+void EgcEntityList::updateId(EgcEntity* entity, quint32 oldId)
+{
+        // entities of documents written by older versions have no id, they keep the one assigned when adding them
+        if (entity->getId() == 0)
+                entity->setId(oldId);
+        if (entity->getId() == oldId)
+                return;
+
+        m_ids.remove(oldId);
+        assignId(entity);
 }
 
 bool EgcEntityList::deleteEntity(EgcEntity* entity)
 {
-        int i = m_list.indexOf(entity);
+        int i = indexOf(entity);
         if (i >= 0) {
-                delete m_list.takeAt(i);
+                delete removeAt(i);
         }
 
         return true;
@@ -71,6 +253,13 @@ bool EgcEntityList::deleteAll(void)
                 delete entity;
         }
         m_list.clear();
+        m_ids.clear();
+        m_nextId = 1;
+
+        EgcEntityListCursor* cursor;
+        foreach (cursor, m_cursors) {
+                cursor->m_pos = 0;
+        }
 
         return true;
 }
@@ -79,9 +268,9 @@ EgcEntity* EgcEntityList::takeEntity(EgcEntity* entity)
 {
         EgcEntity* retval = nullptr;
 
-        int i = m_list.indexOf(entity);
-        if (i > 0) {
-                retval = m_list.takeAt(i);
+        int i = indexOf(entity);
+        if (i >= 0) {
+                retval = removeAt(i);
                 retval->setList(nullptr);
         }
 
@@ -31,10 +31,66 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCENTITYLIST_H
 
 #include <QList>
+#include <QSet>
 #include "egcentity.h"
 #include "egcabstractentitylist.h"
 
 class EgcDocument;
+class EgcEntityList;
+
+/**
+ * @brief The EgcEntityListCursor class is a cursor for iterating over an entity list. In contrast to list iterators it
+ * stays valid if entities are inserted, deleted or moved in the list.
+ */
+class EgcEntityListCursor
+{
+public:
+        /**
+         * @brief EgcEntityListCursor creates a cursor at the front of the given list
+         * @param list the list to iterate over
+         */
+        explicit EgcEntityListCursor(EgcEntityList& list);
+        /// std destructor
+        ~EgcEntityListCursor();
+        /**
+         * @brief toFront sets the cursor in front of the first entity
+         */
+        void toFront(void);
+        /**
+         * @brief hasNext checks if there is an entity in front of the cursor
+         * @return true if there is a next entity, false otherwise
+         */
+        bool hasNext(void) const;
+        /**
+         * @brief peekNext returns the next entity without moving the cursor
+         * @return the next entity or nullptr if at the end of the list
+         */
+        EgcEntity* peekNext(void) const;
+        /**
+         * @brief next returns the next entity and moves the cursor behind it
+         * @return the next entity or nullptr if at the end of the list
+         */
+        EgcEntity* next(void);
+        /**
+         * @brief hasPassed checks if the cursor has already passed the given entity
+         * @param entity the entity to check
+         * @return true if the entity is in front of the cursor position (has been returned by next), false otherwise
+         */
+        bool hasPassed(EgcEntity* entity) const;
+        /**
+         * @brief moveTo sets the cursor in front of the given entity, so that the next call to next returns the entity
+         * @param entity the entity to move the cursor to
+         * @return true if the entity is in the list, false otherwise (the cursor is not moved then)
+         */
+        bool moveTo(EgcEntity* entity);
+
+private:
+        friend class EgcEntityList;
+        EgcEntityList* m_list;                  ///< the list the cursor operates on (nullptr if the list is gone)
+        int m_pos;                              ///< index of the next entity in the list
+
+        Q_DISABLE_COPY(EgcEntityListCursor)
+};
 
 /**
  * @brief The EgcEntityList class is a list that holds formulas, text and picture items
@@ -50,10 +106,29 @@ public:
         /// sort the list
         void sort(void) override;
         /**
-         * @brief addEntity add a entity (formula, text or picture) to the list. The list takes ownership of the entity
+         * @brief repositionEntity moves the given entity to its new place in the list after its position has changed
+         * @param entity the entity whose position has changed
+         */
+        void repositionEntity(EgcEntity* entity) override;
+        /**
+         * @brief setBulkLoad in bulk load mode entities are only appended (e.g. while loading a document, where the
+         * positions are set after adding the entities). When leaving bulk load mode the list is sorted once.
+         * @param on if true bulk load mode is entered, if false it is left
+         */
+        void setBulkLoad(bool on);
+        /**
+         * @brief addEntity add a entity (formula, text or picture) to the list. The list takes ownership of the entity.
+         * An entity without id or with an id that is already used (e.g. a copy) gets a new id.
          * @param entity a pointer to the entity to add
          */
         void addEntity(EgcEntity* entity);
+        /**
+         * @brief updateId must be called after the id of an entity in the list has been changed (e.g. by
+         * deserializing the entity). If the new id is already used, the entity gets another one.
+         * @param entity the entity whose id has been changed
+         * @param oldId the id the entity had before
+         */
+        void updateId(EgcEntity* entity, quint32 oldId);
         /**
          * @brief deleteEntity removes the given entity from the list and deletes it (since the list has the ownership).
          * @param entity the entity to delete
@@ -99,7 +174,36 @@ public:
         QMutableListIterator<EgcEntity*> getIterator(void);
 
 private:
-        QList<EgcEntity*> m_list;               ///< holds a bunch of entities of a document
+        friend class EgcEntityListCursor;
+        /**
+         * @brief insertSorted inserts the entity at its place in the list (binary search)
+         * @param entity the entity to insert
+         */
+        void insertSorted(EgcEntity* entity);
+        /**
+         * @brief indexOf searches the given entity with binary search, if the position of the entity is not in sync
+         * with the list (it has been moved) a linear search is done.
+         * @param entity the entity to search for
+         * @return the index of the entity or -1 if not found
+         */
+        int indexOf(EgcEntity* entity) const;
+        /**
+         * @brief removeAt removes the entity at the given index from the list and updates all cursors
+         * @param i the index of the entity to remove
+         * @return the entity removed
+         */
+        EgcEntity* removeAt(int i);
+        /**
+         * @brief assignId makes sure the given entity has an id that is unique in this list
+         * @param entity the entity to check
+         */
+        void assignId(EgcEntity* entity);
+
+        QList<EgcEntity*> m_list;               ///< holds a bunch of entities of a document (ordered by position)
+        QList<EgcEntityListCursor*> m_cursors;  ///< all cursors that operate on this list
+        bool m_bulkLoad;                        ///< true if entities are only appended and sorted later
+        QSet<quint32> m_ids;                    ///< ids of the entities in the list
+        quint32 m_nextId;                       ///< next id to assign to an entity without id
         int m_index;
         EgcAbstractEntityList* m_parent;        ///< pointer to the parent containing the this list
 };
@@ -0,0 +1,78 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QBuffer>
+#include "egcentitysnapshot.h"
+#include "egcentity.h"
+#include "document/egcbinarydocument.h"
+
+bool EgcEntitySnapshot::serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties)
+{
+        QByteArray xml;
+        QXmlStreamWriter stream(&xml);
+        serialize(stream, properties);
+        QBuffer buffer(&xml);
+        if (!buffer.open(QIODevice::ReadOnly))
+                return false;
+
+        return document.writeXml(buffer);
+}
+
+EgcXmlSnapshot::EgcXmlSnapshot(const QByteArray& xml) : m_xml{xml}
+{
+}
+
+void EgcXmlSnapshot::serialize(QXmlStreamWriter& stream, SerializerProperties& properties)
+{
+        (void) properties;
+
+        // copy the tokens, so the entity is written like it has been serialized into the stream directly
+        QXmlStreamReader reader(m_xml);
+        while (!reader.atEnd()) {
+                reader.readNext();
+                if (    reader.tokenType() == QXmlStreamReader::StartDocument
+                     || reader.tokenType() == QXmlStreamReader::EndDocument
+                     || reader.tokenType() == QXmlStreamReader::Invalid)
+                        continue;
+                stream.writeCurrentToken(reader);
+        }
+}
+
+bool EgcXmlSnapshot::serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties)
+{
+        (void) properties;
+
+        QBuffer buffer(&m_xml);
+        if (!buffer.open(QIODevice::ReadOnly))
+                return false;
+
+        return document.writeXml(buffer);
+}
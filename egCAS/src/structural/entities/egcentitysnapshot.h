@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCENTITYSNAPSHOT_H
+#define EGCENTITYSNAPSHOT_H
+
+#include <QByteArray>
+
+class QXmlStreamWriter;
+class SerializerProperties;
+class EgcBinaryDocument;
+
+/**
+ * @brief The EgcEntitySnapshot class is the abstract base class for snapshots of entities. A snapshot is taken on the
+ * GUI thread and holds everything needed to serialize the entity, so the entity can be serialized on a worker thread
+ * while the document is edited further.
+ */
+class EgcEntitySnapshot
+{
+public:
+        ///std destructor
+        virtual ~EgcEntitySnapshot() {}
+        /**
+         * @brief serialize serializes the entity as it was when the snapshot was taken
+         * @param stream the stream to use for serializing the entity
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) = 0;
+        /**
+         * @brief serializeBinary writes the entity into the binary document given. The default implementation
+         * serializes the entity as xml and encodes it.
+         * @param document the binary document to write to
+         * @param properties object with all neccessary information for serializing
+         * @return true if everything went well, false otherwise (see EgcBinaryDocument::getErrorString)
+         */
+        virtual bool serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties);
+};
+
+/**
+ * @brief The EgcXmlSnapshot class is a snapshot that holds an entity already serialized. This is used for entities
+ * that are cheap to serialize (e.g. texts).
+ */
+class EgcXmlSnapshot : public EgcEntitySnapshot
+{
+public:
+        /**
+         * @brief EgcXmlSnapshot std constructor
+         * @param xml the serialized entity
+         */
+        EgcXmlSnapshot(const QByteArray& xml);
+        /**
+         * @brief serialize writes the serialized entity to the given stream
+         * @param stream the stream to use for serializing the entity
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) override;
+        /**
+         * @brief serializeBinary encodes the serialized entity into the binary document given
+         * @param document the binary document to write to
+         * @param properties object with all neccessary information for serializing
+         * @return true if everything went well, false otherwise (see EgcBinaryDocument::getErrorString)
+         */
+        virtual bool serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties) override;
+
+private:
+        QByteArray m_xml;               ///< the serialized entity
+};
+
+#endif // EGCENTITYSNAPSHOT_H
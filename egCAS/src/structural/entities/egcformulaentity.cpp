@@ -43,6 +43,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "actions/egcaction.h"
 #include "casKernel/parser/abstractkernelparser.h"
 #include "casKernel/parser/restructparserprovider.h"
+#include "utils/egcperfcounter.h"
+#include "document/egcsessionrecorder.h"
+#include "utils/egcnumberformatter.h"
+#include "casKernel/egcnumericevaluator.h"
+#include "document/egcbinarydocument.h"
 
 quint8 EgcFormulaEntity::s_stdNrSignificantDigits = 0;
 int EgcFormulaEntity::s_fontSize = 20;
@@ -180,16 +185,19 @@ EgcFormulaEntity::~EgcFormulaEntity()
 
 EgcBaseNode& EgcFormulaEntity::getBaseElement(void) const
 {
+        loadTree();
         return const_cast<EgcBaseNode&>(m_data);
 }
 
 EgcNode* EgcFormulaEntity::getRootElement(void) const
 {
+        loadTree();
         return m_data.getChild(0);;
 }
 
 void EgcFormulaEntity::setRootElement(EgcNode* rootElement)
 {
+        m_pending.reset();
         QScopedPointer<EgcNode> tmp(rootElement);
         if (tmp.data()) {
                 m_data.setChild(0, *(tmp.take()));
@@ -198,6 +206,7 @@ void EgcFormulaEntity::setRootElement(EgcNode* rootElement)
 
 QString EgcFormulaEntity::getMathMlCode(void)
 {
+        EGC_PERF_SCOPE(perf, EgcPerfPhase::MathMlGeneration);
         EgcMathMlVisitor mathMlVisitor(*this);
         QString tmp = mathMlVisitor.getResult();
 
@@ -277,16 +286,49 @@ void EgcFormulaEntity::setStdNrSignificantDigis(quint8 digits)
 
 bool EgcFormulaEntity::setResult(EgcNode* result)
 {
-        bool repaint = false;
+        QScopedPointer<EgcNode> res(result);
 
         if (m_mod)
                 return false;
-        
+
         //reset error message of the formula
         if (m_item)
                 m_item->clearErrorMessage();
-        
-        QScopedPointer<EgcNode> res(result);
+
+        if (!isResult() || res.isNull())
+                return false;
+
+        m_kernelResult.reset(res.take());
+
+        return reformatResult();
+}
+
+bool EgcFormulaEntity::reformatResult(void)
+{
+        bool repaint = false;
+
+        if (m_mod)
+                return false;
+        if (m_kernelResult.isNull())
+                return false;
+
+        quint8 digits = getNumberOfSignificantDigits();
+        if (digits == 0)
+                digits = getStdNrSignificantDigis();
+        EgcNumberResultType type = getNumberResultType();
+        QScopedPointer<EgcNode> numeric;
+        EgcNode* source = m_kernelResult.data();
+        if (type != EgcNumberResultType::StandardType) {
+                numeric.reset(numericResult(*m_kernelResult));
+                if (!numeric.isNull())
+                        source = numeric.data();
+        }
+
+        QScopedPointer<EgcNode> res(source->copy());
+        if (res.isNull())
+                return false;
+        formatNumbers(*res, type, digits);
+
         if (isResult()) {
                 bool equal = false;
 
@@ -307,8 +349,78 @@ bool EgcFormulaEntity::setResult(EgcNode* result)
         return repaint;
 }
 
+void EgcFormulaEntity::formatNumbers(EgcNode& node, EgcNumberResultType type, quint8 digits)
+{
+        // the number result types only apply to numbers, other results (e.g. x^2) just get the number of digits
+        EgcNode* number = &node;
+        while (    number->getNodeType() == EgcNodeType::UnaryMinusNode
+                || number->getNodeType() == EgcNodeType::ParenthesisNode) {
+                EgcNode* child = static_cast<EgcContainerNode*>(number)->getChild(0);
+                if (!child)
+                        break;
+                number = child;
+        }
+        if (number->getNodeType() == EgcNodeType::NumberNode) {
+                EgcNumberNode* num = static_cast<EgcNumberNode*>(number);
+                num->setValue(EgcNumberFormatter::format(num->getValue(), type, digits));
+                return;
+        }
+
+        if (node.getNodeType() == EgcNodeType::NumberNode) {
+                EgcNumberNode& num = static_cast<EgcNumberNode&>(node);
+                num.setValue(EgcNumberFormatter::format(num.getValue(), EgcNumberResultType::StandardType, digits));
+        } else if (node.isContainer()) {
+                EgcContainerNode& container = static_cast<EgcContainerNode&>(node);
+                for (quint32 i = 0; i < container.getNumberChildNodes(); i++) {
+                        EgcNode* child = container.getChild(i);
+                        if (child)
+                                formatNumbers(*child, EgcNumberResultType::StandardType, digits);
+                }
+        }
+}
+
+EgcNode* EgcFormulaEntity::numericResult(EgcNode& result)
+{
+        // numbers are formatted directly, so big floats keep all their digits
+        EgcNode* number = &result;
+        while (    number->getNodeType() == EgcNodeType::UnaryMinusNode
+                || number->getNodeType() == EgcNodeType::ParenthesisNode) {
+                EgcNode* child = static_cast<EgcContainerNode*>(number)->getChild(0);
+                if (!child)
+                        break;
+                number = child;
+        }
+        if (number->getNodeType() == EgcNodeType::NumberNode)
+                return nullptr;
+
+        // exact numeric results (e.g. 1/3 or sqrt(2)) are converted to a floating point number
+        EgcNumericEvaluator evaluator;
+        evaluator.setNumeric(true);
+        EgcNumericValue value;
+        if (!evaluator.evaluate(result, value))
+                return nullptr;
+
+        bool negative = value.m_value < 0.0L;
+        if (negative)
+                value.m_value = -value.m_value;
+        QScopedPointer<EgcNode> num(EgcNodeCreator::create(EgcNodeType::NumberNode));
+        if (num.isNull())
+                return nullptr;
+        static_cast<EgcNumberNode*>(num.data())->setValue(EgcNumericEvaluator::toKernelString(value, true));
+        if (!negative)
+                return num.take();
+
+        QScopedPointer<EgcNode> minus(EgcNodeCreator::create(EgcNodeType::UnaryMinusNode));
+        if (minus.isNull())
+                return nullptr;
+        static_cast<EgcUnaryNode*>(minus.data())->setChild(0, *(num.take()));
+
+        return minus.take();
+}
+
 void EgcFormulaEntity::resetResult(void)
 {
+        m_kernelResult.reset();
         if (isResult()) {
                 //don't do anything if the formula is modified at the moment
                 if (m_mod)
@@ -379,12 +491,9 @@ void EgcFormulaEntity::updateView(void)
 void EgcFormulaEntity::itemChanged(EgcItemChangeType changeType)
 {
         if (changeType == EgcItemChangeType::posChanged) {
-                if (m_list)
-                        m_list->sort();
+                EgcSessionRecorder::recordMove(this, getPosition());
+                positionChanged();
                 showCurrentCursor();
-                if (getDocument()) {
-                        getDocument()->restartCalculation();
-                }
         }
 
         if (changeType == EgcItemChangeType::contentChanged) {
@@ -402,6 +511,8 @@ void EgcFormulaEntity::setErrorMessage(QString msg)
 
 void EgcFormulaEntity::handleAction(const EgcAction& action)
 {
+        EgcSessionRecorder::recordAction(this, action);
+
         switch (action.m_op) {
         case EgcOperations::formulaActivated:
                 m_isActive = true;
@@ -413,6 +524,9 @@ void EgcFormulaEntity::handleAction(const EgcAction& action)
                 m_isActive = false;
                 if (m_mod)
                         m_mod.reset();
+                // editing is finished, so this is the point to record the changes of the formula
+                if (getDocument())
+                        getDocument()->entityChanged(this);
                 break;
         case EgcOperations::cursorForward:
                 if (m_mod && m_item)
@@ -555,7 +669,7 @@ bool EgcFormulaEntity::isNodeInFormula(EgcNode& node)
 {
         quint32 index;
 
-        if (m_data.hasSubNode(node, index))
+        if (getBaseElement().hasSubNode(node, index))
                 return true;
 
         return false;
@@ -635,68 +749,288 @@ bool EgcFormulaEntity::isActive() const
 
 void EgcFormulaEntity::serialize(QXmlStreamWriter& stream, SerializerProperties &properties)
 {
+        EgcFormulaSnapshot snapshot(*this, false);
+        snapshot.serialize(stream, properties);
+}
+
+EgcEntitySnapshot* EgcFormulaEntity::takeSnapshot(SerializerProperties& properties)
+{
+        (void) properties;
+
+        QScopedPointer<EgcFormulaSnapshot> snapshot(new (std::nothrow) EgcFormulaSnapshot(*this, true));
+        if (snapshot.isNull() || !snapshot->isValid())
+                return nullptr;
+
+        return snapshot.take();
+}
+
+EgcFormulaSnapshot::EgcFormulaSnapshot(EgcFormulaEntity& formula, bool detach) : m_id{formula.getId()},
+                                                                                  m_pos{formula.getPosition()},
+                                                                                  m_type{formula.getNumberResultType()},
+                                                                                  m_digits{formula.getNumberOfSignificantDigits()},
+                                                                                  m_tree{nullptr}
+{
+        EgcAbstractFormulaItem* item = formula.getItem();
+        if (item)
+                m_size = item->getLayoutSize();
+
+        if (!detach) {
+                m_tree = &formula.getBaseElement();
+                return;
+        }
+
+        // a tree that hasn't been built yet is built when serializing, the document text is shared
+        EgcFormulaEntity::PendingTree pending;
+        if (formula.getPendingTree(pending)) {
+                m_pending.reset(new (std::nothrow) EgcFormulaEntity::PendingTree(pending));
+                return;
+        }
+
+        m_ownTree.reset(new (std::nothrow) EgcBaseNode());
+        if (m_ownTree.isNull())
+                return;
+        EgcNode* root = formula.getRootElement();
+        if (root) {
+                EgcNode* copy = root->copy();
+                if (!copy) {
+                        m_ownTree.reset();
+                        return;
+                }
+                m_ownTree->setChild(0, *copy);
+        }
+        m_tree = m_ownTree.data();
+}
+
+EgcFormulaSnapshot::~EgcFormulaSnapshot()
+{
+}
+
+bool EgcFormulaSnapshot::isValid(void) const
+{
+        return m_tree || !m_pending.isNull();
+}
+
+void EgcFormulaSnapshot::serialize(QXmlStreamWriter& stream, SerializerProperties& properties)
+{
+        EgcBaseNode* tree = getTree();
+
         stream.writeStartElement("formula_entity");
-        stream.writeAttribute("pos_x", QString("%1").arg(getPosition().x()));
-        stream.writeAttribute("pos_y", QString("%1").arg(getPosition().y()));
-        EgcNumberResultType type = getNumberResultType();
-        switch (type) {
+        stream.writeAttributes(getAttributes());
+        if (tree)
+                tree->serialize(stream, properties);
+
+        stream.writeEndElement(); // formula_entity
+}
+
+bool EgcFormulaSnapshot::serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties)
+{
+        (void) properties;
+        EgcBaseNode* tree = getTree();
+
+        document.writeStartElement(QString("formula_entity"), getAttributes());
+        if (tree)
+                tree->serializeBinary(document);
+
+        document.writeEndElement(); // formula_entity
+
+        return true;
+}
+
+QXmlStreamAttributes EgcFormulaSnapshot::getAttributes(void) const
+{
+        QXmlStreamAttributes attr;
+        EgcEntity::writeId(attr, m_id);
+        attr.append("pos_x", QString("%1").arg(m_pos.x()));
+        attr.append("pos_y", QString("%1").arg(m_pos.y()));
+        switch (m_type) {
         case EgcNumberResultType::StandardType:
-                stream.writeAttribute("type", QLatin1String("standard"));
+                attr.append("type", QLatin1String("standard"));
                 break;
         case EgcNumberResultType::IntegerType:
-                stream.writeAttribute("type", QLatin1String("integer"));
+                attr.append("type", QLatin1String("integer"));
                 break;
         case EgcNumberResultType::EngineeringType:
-                stream.writeAttribute("type", QLatin1String("engineering"));
+                attr.append("type", QLatin1String("engineering"));
                 break;
         case EgcNumberResultType::ScientificType:
-                stream.writeAttribute("type", QLatin1String("scientific"));
+                attr.append("type", QLatin1String("scientific"));
                 break;
         }
-        stream.writeAttribute("digits", QString("%1").arg(getNumberOfSignificantDigits()));
+        attr.append("digits", QString("%1").arg(m_digits));
+        if (m_size.isValid()) {
+                // the size allows to place the formula without laying it out when the document is loaded
+                attr.append("width", QString("%1").arg(m_size.width()));
+                attr.append("height", QString("%1").arg(m_size.height()));
+        }
 
-        m_data.serialize(stream, properties);
+        return attr;
+}
 
-        stream.writeEndElement(); // formula_entity
+EgcBaseNode* EgcFormulaSnapshot::getTree(void)
+{
+        if (!m_tree && !m_pending.isNull()) {
+                m_ownTree.reset(EgcFormulaEntity::buildTree(*m_pending));
+                m_tree = m_ownTree.data();
+        }
+
+        return m_tree;
 }
 
 void EgcFormulaEntity::deserialize(QXmlStreamReader& stream, SerializerProperties& properties)
 {
         (void) properties;
+        QSizeF size;
 
         if (stream.name() == QLatin1String("formula_entity")) {
-                QXmlStreamAttributes attr = stream.attributes();
-                if (attr.hasAttribute("type")) {
-                        QString str = attr.value("type").toString();
-                        if (str == QLatin1String("standard"))
-                                setNumberResultType(EgcNumberResultType::StandardType);
-                        if (str == QLatin1String("engineering"))
-                                setNumberResultType(EgcNumberResultType::EngineeringType);
-                        if (str == QLatin1String("integer"))
-                                setNumberResultType(EgcNumberResultType::IntegerType);
-                        if (str == QLatin1String("scientific"))
-                                setNumberResultType(EgcNumberResultType::ScientificType);
-                }
-                if (attr.hasAttribute("pos_x") && attr.hasAttribute("pos_y")) {
-                        qreal x = attr.value("pos_x").toFloat();
-                        qreal y = attr.value("pos_y").toFloat();
-                        setPosition(QPointF(x, y));
-                }
-                if (attr.hasAttribute("digits")) {
-                        quint8 d = static_cast<quint8>(attr.value("digits").toUInt());
-                        setNumberOfSignificantDigits(d);
-                }
+                size = readAttributes(stream.attributes());
 
+                qint64 start = stream.characterOffset();
                 stream.readNextStartElement();
                 if (stream.name() != QLatin1String("basenode"))
                         stream.raiseError();
 
-                m_data.deserialize(stream, properties);
+                if (properties.source && !stream.hasError()) {
+                        // only remember where the tree is, it is built on first access or by the document loader
+                        stream.skipCurrentElement();
+                        m_pending.reset(new PendingTree());
+                        m_pending->m_source = *properties.source;
+                        m_pending->m_start = static_cast<int>(start);
+                        m_pending->m_length = static_cast<int>(stream.characterOffset() - start);
+                        m_pending->m_version = properties.version;
+                } else {
+                        m_pending.reset();
+                        m_data.deserialize(stream, properties);
+                }
                 if (stream.name() == QLatin1String("basenode"))
                         stream.skipCurrentElement();
         }
 
-        updateView();
+        // formulas are laid out when they come near the viewport
+        if (m_item)
+                m_item->updateViewLazy(size);
+}
+
+void EgcFormulaEntity::deserializeBinary(EgcBinaryReader& reader, SerializerProperties& properties)
+{
+        QSizeF size;
+
+        if (reader.name() == QLatin1String("formula_entity")) {
+                size = readAttributes(reader.attributes());
+
+                if (!reader.readNextStartElement() || reader.nodeType() != EgcNodeType::BaseNode)
+                        reader.raiseError();
+
+                if (!reader.hasError()) {
+                        // only remember where the tree is, it is built on first access or by the document loader
+                        quint32 start = reader.offset();
+                        reader.skipCurrentElement();
+                        m_pending.reset(new PendingTree());
+                        m_pending->m_binary = reader.getDocument();
+                        m_pending->m_start = static_cast<int>(start);
+                        m_pending->m_length = static_cast<int>(reader.position() - start);
+                        m_pending->m_version = properties.version;
+                }
+                reader.skipCurrentElement();
+        }
+
+        // formulas are laid out when they come near the viewport
+        if (m_item)
+                m_item->updateViewLazy(size);
+}
+
+QSizeF EgcFormulaEntity::readAttributes(const QXmlStreamAttributes& attr)
+{
+        QSizeF size;
+
+        setId(readId(attr));
+        if (attr.hasAttribute("type")) {
+                QString str = attr.value("type").toString();
+                if (str == QLatin1String("standard"))
+                        setNumberResultType(EgcNumberResultType::StandardType);
+                if (str == QLatin1String("engineering"))
+                        setNumberResultType(EgcNumberResultType::EngineeringType);
+                if (str == QLatin1String("integer"))
+                        setNumberResultType(EgcNumberResultType::IntegerType);
+                if (str == QLatin1String("scientific"))
+                        setNumberResultType(EgcNumberResultType::ScientificType);
+        }
+        if (attr.hasAttribute("pos_x") && attr.hasAttribute("pos_y")) {
+                qreal x = attr.value("pos_x").toFloat();
+                qreal y = attr.value("pos_y").toFloat();
+                setPosition(QPointF(x, y));
+        }
+        if (attr.hasAttribute("digits")) {
+                quint8 d = static_cast<quint8>(attr.value("digits").toUInt());
+                setNumberOfSignificantDigits(d);
+        }
+        if (attr.hasAttribute("width") && attr.hasAttribute("height")) {
+                qreal w = attr.value("width").toFloat();
+                qreal h = attr.value("height").toFloat();
+                size = QSizeF(w, h);
+        }
+
+        return size;
+}
+
+bool EgcFormulaEntity::isTreeLoaded(void) const
+{
+        return m_pending.isNull();
+}
+
+void EgcFormulaEntity::loadTree(void) const
+{
+        if (m_pending.isNull())
+                return;
+
+        const_cast<EgcFormulaEntity*>(this)->attachTree(buildTree(*m_pending));
+}
+
+bool EgcFormulaEntity::getPendingTree(PendingTree& pending) const
+{
+        if (m_pending.isNull())
+                return false;
+
+        pending = *m_pending;
+
+        return true;
+}
+
+EgcBaseNode* EgcFormulaEntity::buildTree(const PendingTree& pending)
+{
+        QScopedPointer<EgcBaseNode> tree(new (std::nothrow) EgcBaseNode());
+        if (tree.isNull())
+                return nullptr;
+
+        if (!pending.m_binary.isNull()) {
+                EgcBinaryReader reader(pending.m_binary, static_cast<quint32>(pending.m_start),
+                                       static_cast<quint32>(pending.m_length));
+                if (reader.readNextStartElement())
+                        tree->deserializeBinary(reader, pending.m_version);
+
+                return tree.take();
+        }
+
+        QXmlStreamReader stream(pending.m_source.mid(pending.m_start, pending.m_length));
+        SerializerProperties properties;
+        properties.version = pending.m_version;
+        if (stream.readNextStartElement())
+                tree->deserialize(stream, properties);
+
+        return tree.take();
+}
+
+void EgcFormulaEntity::attachTree(EgcBaseNode* tree)
+{
+        QScopedPointer<EgcBaseNode> tmp(tree);
+        if (m_pending.isNull())
+                return;
+
+        m_pending.reset();
+        if (tmp.isNull())
+                return;
+        EgcNode* root = tmp->getChild(0);
+        if (root)
+                m_data.setChild(0, *tmp->takeOwnership(*root));
 }
 
 bool EgcFormulaEntity::aboutToBeDeleted() const
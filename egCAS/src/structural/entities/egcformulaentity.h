@@ -31,9 +31,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QString>
 #include <QScopedPointer>
+#include <QPointF>
+#include <QSizeF>
+#include <QSharedPointer>
 #include <structural/specialNodes/egcbasenode.h>
 #include "egcentity.h"
 #include "egcabstractformulaentity.h"
+#include "egcentitysnapshot.h"
 #include <structural/visitor/egcmathmllookup.h>
 #include <structural/entities/formulamodificator.h>
 #include <structural/document/egcabstractdocument.h>
@@ -45,6 +49,8 @@ class EgcAbstractFormulaItem;
 class EgcScreenPos;
 enum class EgcOperations;
 class AbstractKernelParser;
+class EgcBinaryDocument;
+class EgcBinaryReader;
 
 /**
  * @brief The EgcNumberResultType defines different types of number results
@@ -66,6 +72,18 @@ class EgcFormulaEntity : public EgcEntity, public EgcAbstractFormulaEntity
         friend class EgcasTest_AdvancedTreeOps;
 
 public:
+        /**
+         * @brief The PendingTree struct describes where the tree of a formula that hasn't been built yet is found
+         */
+        struct PendingTree
+        {
+                QString m_source;       ///< the document text (shared by all formulas of the document)
+                QSharedPointer<const EgcBinaryDocument> m_binary; ///< the binary document (null for xml documents)
+                int m_start;            ///< start of the tree (basenode element) in the document text or event stream
+                int m_length;           ///< length of the tree in the document text or event stream
+                quint32 m_version;      ///< version of the document
+        };
+
         /**
          * @brief EgcFormulaEntity std constructor
          * @param type the type of the root element of the formula to generate
@@ -119,6 +137,35 @@ public:
          * @param rootElement is a reference to the root Element of the formula tree to be set
          */
         void setRootElement(EgcNode *rootElement);
+        /**
+         * @brief isTreeLoaded checks if the formula tree has been built already. When a document is loaded, the trees
+         * of the formulas are built on first access or by the progressive loading of the document.
+         * @return true if the formula tree is available, false if it is still to be read from the document
+         */
+        bool isTreeLoaded(void) const;
+        /**
+         * @brief loadTree builds the formula tree from the document text if this hasn't been done yet
+         */
+        void loadTree(void) const;
+        /**
+         * @brief getPendingTree returns where the formula tree is found if it hasn't been built yet
+         * @param pending is set to the location of the formula tree
+         * @return true if the tree is still pending, false if it has been built already
+         */
+        bool getPendingTree(PendingTree& pending) const;
+        /**
+         * @brief buildTree builds a formula tree from the given location. This doesn't touch any formula, so it can be
+         * called from worker threads.
+         * @param pending the location of the formula tree
+         * @return the base node of the tree built, the caller takes ownership
+         */
+        static EgcBaseNode* buildTree(const PendingTree& pending);
+        /**
+         * @brief attachTree attaches a tree built with buildTree to this formula. If the tree of the formula has been
+         * built meanwhile, the given tree is discarded.
+         * @param tree the base node of the tree to attach, the formula takes ownership
+         */
+        void attachTree(EgcBaseNode* tree);
         /**
          * @brief getMathMlCode returns the mathMl representation for this formula
          * @return the mathMl representation of this formula as a string
@@ -175,10 +222,18 @@ public:
         /**
          * @brief setResult sets the tree as result of the formula. The formula takes ownership of the result, even if
          * it's not possible to set the result as result of the formula (the result given will be deleted in this case).
+         * The result is kept with full precision and formatted according to the number result type and the number
+         * of significant digits of the formula.
          * @param result the EgcNode tree to to set as result of the formula. Of course the result
          * @return true if formula needs a repaint.
          */
         bool setResult(EgcNode* result);
+        /**
+         * @brief reformatResult formats the result again, e.g. after the number result type or the number of
+         * significant digits changed (no new calculation is needed for this)
+         * @return true if formula needs a repaint.
+         */
+        bool reformatResult(void);
         /**
          * @brief resetResult if the content of the formula is a result, delete the result and set it empty
          */
@@ -329,6 +384,20 @@ public:
          * @param properties object with all neccessary information for deserializing
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;
+        /**
+         * @brief deserializeBinary deserializes the formula directly from a binary document. The tree is only
+         * located and built later on (see loadTree).
+         * @param reader the reader positioned at the formula_entity element
+         * @param properties object with all neccessary information for deserializing
+         */
+        void deserializeBinary(EgcBinaryReader& reader, SerializerProperties& properties);
+        /**
+         * @brief takeSnapshot takes a snapshot of the formula that can be serialized on another thread. The formula
+         * tree is copied (or built on the other thread if it hasn't been built yet).
+         * @param properties object with all neccessary information for serializing
+         * @return the snapshot (the caller takes ownership) or a nullptr if there is not enough memory
+         */
+        virtual EgcEntitySnapshot* takeSnapshot(SerializerProperties& properties) override;
         /**
          * @brief aboutToBeDeleted checks if item is about to be deleted, e.g. if a formula is empty and one hits del
          * key this function will return true, and false otherwise
@@ -338,10 +407,31 @@ public:
 
 
 private:
+        /**
+         * @brief readAttributes reads the attributes of the formula_entity element
+         * @param attr the attributes of the element
+         * @return the layout size saved with the formula (invalid if there is none)
+         */
+        QSizeF readAttributes(const QXmlStreamAttributes& attr);
         /**
          * @brief showCurrentCursor shows the current cursor the iterator points to
          */
         void showCurrentCursor(void);
+        /**
+         * @brief formatNumbers formats all numbers in the given (result) tree
+         * @param node the root of the tree to format
+         * @param type the number result type to use
+         * @param digits the number of significant digits
+         */
+        static void formatNumbers(EgcNode& node, EgcNumberResultType type, quint8 digits);
+        /**
+         * @brief numericResult converts an exact numeric result (e.g. 1/3) into a floating point number for the
+         * integer, scientific and engineering result types
+         * @param result the result of the kernel
+         * @return the floating point number (the caller takes ownership), or a nullptr if the result is already a
+         * number or not numeric at all
+         */
+        static EgcNode* numericResult(EgcNode& result);
 
         static quint8 s_stdNrSignificantDigits; ///< the number of significant digits (in a global mannner (std))
         static int s_fontSize;                  ///< the font size of all formulas
@@ -351,7 +441,65 @@ private:
         EgcAbstractFormulaItem* m_item;         ///< pointer to the formula item interface on the scene
         EgcMathmlLookup m_mathmlLookup;         ///< mathml id lookup table
         QScopedPointer<FormulaModificator> m_mod; ///< formula modificator class
+        QScopedPointer<EgcNode> m_kernelResult; ///< result of the kernel with full precision
         bool m_isActive;                        ///< true if formula is activated, false otherwise
+        mutable QScopedPointer<PendingTree> m_pending; ///< location of the formula tree if it is not loaded yet
+};
+
+/**
+ * @brief The EgcFormulaSnapshot class holds everything needed to serialize a formula
+ */
+class EgcFormulaSnapshot : public EgcEntitySnapshot
+{
+public:
+        /**
+         * @brief EgcFormulaSnapshot std constructor
+         * @param formula the formula to take the snapshot of
+         * @param detach if true the snapshot doesn't reference the formula anymore (the tree is copied), otherwise
+         * the snapshot must be serialized before the formula changes
+         */
+        EgcFormulaSnapshot(EgcFormulaEntity& formula, bool detach);
+        ///std destructor
+        virtual ~EgcFormulaSnapshot();
+        /**
+         * @brief isValid checks if the snapshot has been taken completely
+         * @return true if the snapshot is valid, false if there has not been enough memory to copy the tree
+         */
+        bool isValid(void) const;
+        /**
+         * @brief serialize serializes the formula as it was when the snapshot was taken
+         * @param stream the stream to use for serializing the formula
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) override;
+        /**
+         * @brief serializeBinary writes the formula tree directly into the binary document given
+         * @param document the binary document to write to
+         * @param properties object with all neccessary information for serializing
+         * @return true if everything went well, false otherwise
+         */
+        virtual bool serializeBinary(EgcBinaryDocument& document, SerializerProperties& properties) override;
+
+private:
+        /**
+         * @brief getAttributes returns the attributes of the formula_entity element
+         * @return the attributes of the formula
+         */
+        QXmlStreamAttributes getAttributes(void) const;
+        /**
+         * @brief getTree returns the tree to serialize, a pending tree is built first
+         * @return the tree to serialize or a nullptr if there is not enough memory
+         */
+        EgcBaseNode* getTree(void);
+
+        quint32 m_id;                                   ///< id of the formula entity
+        QPointF m_pos;                                  ///< position of the formula
+        EgcNumberResultType m_type;                     ///< number result type of the formula
+        quint8 m_digits;                                ///< number of significant digits of the formula
+        QSizeF m_size;                                  ///< layout size of the formula (invalid if there is no item)
+        EgcBaseNode* m_tree;                            ///< the tree to serialize
+        QScopedPointer<EgcBaseNode> m_ownTree;          ///< the tree if it is owned by the snapshot
+        QScopedPointer<EgcFormulaEntity::PendingTree> m_pending; ///< location of the tree if it hasn't been built yet
 };
 
 #endif // EGCFORMULAENTITY_H
@@ -26,12 +26,18 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#include <new>
 #include <QFont>
 #include <QSizeF>
 #include <QByteArray>
 #include <QString>
 #include <QBuffer>
 #include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QCryptographicHash>
 #include "egcpixmapentity.h"
 #include "egcabstractpixmapitem.h"
 #include "document/egcabstractdocument.h"
@@ -84,6 +90,10 @@ QString EgcPixmapEntity::getFileType() const
 
 QByteArray EgcPixmapEntity::getB64Encoded(void) const
 {
+        // the original image data is written unchanged, so images aren't compressed again on every save
+        if (!m_encoded.isEmpty())
+                return m_encoded.toBase64();
+
         if (!m_item)
                 return QByteArray();
 
@@ -98,14 +108,54 @@ QByteArray EgcPixmapEntity::getB64Encoded(void) const
 
 bool EgcPixmapEntity::setB64Encoded(QByteArray &bytes)
 {
-        //write pixmap in bytes as png format
-        QByteArray out = QByteArray::fromBase64(bytes);
-        QImage image = QImage::fromData(out, m_fileFormat.toLatin1());
-        m_item->setPixmap(QPixmap::fromImage(image));
+        return setEncoded(QByteArray::fromBase64(bytes));
+}
+
+bool EgcPixmapEntity::setEncoded(const QByteArray& bytes)
+{
+        QByteArray data = bytes;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        QSize size = reader.size();
+        if (!size.isValid())
+                return false;
+
+        m_encoded = bytes;
+        m_hash = QCryptographicHash::hash(m_encoded, QCryptographicHash::Sha1);
+        m_pixelSize = size;
+        QString format = QString::fromLatin1(reader.format()).toUpper();
+        if (!format.isEmpty())
+                setFileType(format);
+        if (m_item)
+                m_item->setPendingPixmap(m_pixelSize);
 
         return true;
 }
 
+QByteArray EgcPixmapEntity::getContentHash(void) const
+{
+        return m_hash;
+}
+
+void EgcPixmapEntity::decodePixmap(void)
+{
+        if (!m_item || m_encoded.isEmpty())
+                return;
+
+        QPixmap pixmap;
+        pixmap.loadFromData(m_encoded);
+        m_item->setPixmap(pixmap);
+}
+
+QString EgcPixmapEntity::getExternalFile(const QString& documentPath, const QByteArray& hash, const QString& format)
+{
+        QFileInfo info(documentPath);
+
+        return info.completeBaseName() + QString("_images/") + QString::fromLatin1(hash.toHex()) + QString(".")
+                        + format.toLower();
+}
+
 QSizeF EgcPixmapEntity::getSize(void) const
 {
         if (!m_item)
@@ -133,6 +183,9 @@ void EgcPixmapEntity::setSize(QSizeF size)
 void EgcPixmapEntity::setItem(EgcAbstractPixmapItem* item)
 {
         m_item = item;
+        // e.g. a copy of an entity gets a new item
+        if (m_item && !m_encoded.isEmpty())
+                m_item->setPendingPixmap(m_pixelSize);
 }
 
 EgcAbstractPixmapItem*EgcPixmapEntity::getItem()
@@ -155,19 +208,21 @@ void EgcPixmapEntity::setFilePath(QString file)
         m_isEmbedded = false;
 
         m_path = file;
-        QPixmap pixmap(file);
+        QFile image(file);
+        if (!image.open(QIODevice::ReadOnly))
+                return;
+        if (!setEncoded(image.readAll()))
+                return;
         EgcAbstractDocument* doc = getDocument();
         if (!doc)
                 return;
         QSizeF size = doc->getMaxItemSize(getPosition());
-        QSize pixSize = pixmap.size();
+        QSize pixSize = m_pixelSize;
         qreal xFactor = pixSize.width() / size.width();
         qreal yFactor = pixSize.height() / size.height();
         qreal factor = qMax(xFactor, yFactor);
         if (factor > 1.0)
                 m_item->setScaleFactor(1.0/factor);
-
-        m_item->setPixmap(pixmap);
 }
 
 void EgcPixmapEntity::setIsEmbedded()
@@ -178,15 +233,49 @@ void EgcPixmapEntity::setIsEmbedded()
 
 void EgcPixmapEntity::itemChanged(EgcItemChangeType changeType)
 {
+        // the picture is only serialized again at the next save, not after every resize
+        if (changeType == EgcItemChangeType::contentChanged)
+                contentModified();
+
+        if (changeType == EgcItemChangeType::posChanged)
+                positionChanged();
 }
 
 void EgcPixmapEntity::serialize(QXmlStreamWriter& stream, SerializerProperties &properties)
+{
+        EgcPixmapSnapshot snapshot(*this);
+        snapshot.serialize(stream, properties);
+}
+
+EgcEntitySnapshot* EgcPixmapEntity::takeSnapshot(SerializerProperties& properties)
+{
+        (void) properties;
+
+        return new (std::nothrow) EgcPixmapSnapshot(*this);
+}
+
+EgcPixmapSnapshot::EgcPixmapSnapshot(const EgcPixmapEntity& pixmap) : m_id{pixmap.getId()},
+                                                                      m_pos{pixmap.getPosition()},
+                                                                      m_size{pixmap.getSize()},
+                                                                      m_isEmbedded{pixmap.m_isEmbedded},
+                                                                      m_path{pixmap.m_path},
+                                                                      m_fileFormat{pixmap.m_fileFormat},
+                                                                      m_encoded{pixmap.m_encoded},
+                                                                      m_hash{pixmap.m_hash}
+{
+        // the pixmap of the item can only be encoded on the GUI thread
+        if (m_isEmbedded && m_encoded.isEmpty())
+                m_b64 = pixmap.getB64Encoded();
+}
+
+void EgcPixmapSnapshot::serialize(QXmlStreamWriter& stream, SerializerProperties& properties)
 {
         stream.writeStartElement("pic_entity");
-        stream.writeAttribute("pos_x", QString("%1").arg(getPosition().x()));
-        stream.writeAttribute("pos_y", QString("%1").arg(getPosition().y()));
-        stream.writeAttribute("width", QString("%1").arg(getSize().width()));
-        stream.writeAttribute("height", QString("%1").arg(getSize().height()));
+        EgcEntity::writeId(stream, m_id);
+        stream.writeAttribute("pos_x", QString("%1").arg(m_pos.x()));
+        stream.writeAttribute("pos_y", QString("%1").arg(m_pos.y()));
+        stream.writeAttribute("width", QString("%1").arg(m_size.width()));
+        stream.writeAttribute("height", QString("%1").arg(m_size.height()));
         stream.writeAttribute("format", m_fileFormat);
         if (!m_isEmbedded) {
                 QFileInfo info(properties.filePath);
@@ -194,18 +283,57 @@ void EgcPixmapEntity::serialize(QXmlStreamWriter& stream, SerializerProperties &
                 QString file = path.relativeFilePath(m_path);
                 stream.writeAttribute("path", file);
 
+        } else if (properties.externalImages && !m_encoded.isEmpty()) {
+                // the files are named by the hash of their contents, so complete files don't need to be written again
+                QString file = EgcPixmapEntity::getExternalFile(properties.filePath, m_hash, m_fileFormat);
+                QDir dir = QFileInfo(properties.filePath).dir();
+                QString path = dir.absoluteFilePath(file);
+                QFileInfo info(path);
+                if (!info.exists() || info.size() != m_encoded.size())
+                        writeExternalFile(dir, file, properties);
+                stream.writeAttribute("data", file);
+        } else if (!m_encoded.isEmpty()) {
+                // the original image data is written unchanged, so images aren't compressed again on every save
+                stream.writeCharacters(m_encoded.toBase64());
         } else {
-                stream.writeCharacters(getB64Encoded());
+                stream.writeCharacters(m_b64);
         }
         stream.writeEndElement(); // document
 }
 
+bool EgcPixmapSnapshot::writeExternalFile(const QDir& dir, const QString& file, SerializerProperties& properties)
+{
+        QString path = dir.absoluteFilePath(file);
+        dir.mkpath(QFileInfo(file).path());
+
+        // the file is replaced only when commit is called, so a failed write never leaves a partial image behind
+        QSaveFile image(path);
+        bool ok = image.open(QIODevice::WriteOnly);
+        if (ok)
+                ok = image.write(m_encoded) == m_encoded.size();
+        if (ok)
+                ok = image.commit();
+        else
+                image.cancelWriting();
+
+        if (!ok && properties.errorMessage.isEmpty()) {
+                QString errMsg(QCoreApplication::translate("EgcPixmapEntity", "Could not write image file:"));
+                errMsg += QString(" ");
+                errMsg += path;
+                errMsg += QString(" (") + image.errorString() + QString(")");
+                properties.errorMessage = errMsg;
+        }
+
+        return ok;
+}
+
 void EgcPixmapEntity::deserialize(QXmlStreamReader& stream, SerializerProperties& properties)
 {
         (void) properties;
 
         if (stream.name() == QLatin1String("pic_entity")) {
                 QXmlStreamAttributes attr = stream.attributes();
+                setId(readId(attr));
                 if (attr.hasAttribute("format")) {
                         setFileType(attr.value("format").toString());
                 }
@@ -226,6 +354,27 @@ void EgcPixmapEntity::deserialize(QXmlStreamReader& stream, SerializerProperties
                         } else {
                                 setFilePath(path);
                         }
+                } else if (attr.hasAttribute("data")) {
+                        QFileInfo info(properties.filePath);
+                        QString path = QDir::cleanPath(info.dir().absoluteFilePath(attr.value("data").toString()));
+                        QFile image(path);
+                        if (!image.open(QIODevice::ReadOnly)) {
+                                QString errMsg(QCoreApplication::translate("EgcPixmapEntity"
+                                                                           , "File not found while loading document:"));
+                                errMsg += QString(" ");
+                                errMsg += path;
+                                properties.warningMessage = errMsg;
+                                stream.skipCurrentElement();
+                                return;
+                        }
+                        if (!setEncoded(image.readAll())) {
+                                QString errMsg(QCoreApplication::translate("EgcPixmapEntity"
+                                                                           , "Invalid image while loading document:"));
+                                errMsg += QString(" ");
+                                errMsg += path;
+                                properties.warningMessage = errMsg;
+                        }
+                        setIsEmbedded();
                 } else {
                         QByteArray in = stream.readElementText().toLatin1();
                         setB64Encoded(in);
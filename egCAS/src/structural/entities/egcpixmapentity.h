@@ -30,13 +30,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCPIXMAPENTITY_H
 
 #include <QString>
+#include <QByteArray>
+#include <QSize>
+#include <QSizeF>
+#include <QPointF>
 #include "egcentity.h"
+#include "egcentitysnapshot.h"
 #include "egcabstractpixmapentity.h"
 
-class QPointF;
 class EgcAbstractPixmapItem;
-class QByteArray;
-class QSizeF;
+class QDir;
 
 
 /**
@@ -44,6 +47,7 @@ class QSizeF;
  */
 class EgcPixmapEntity : public EgcEntity, public EgcAbstractPixmapEntity
 {
+        friend class EgcPixmapSnapshot;
 public:
         /**
          * @brief EgcPixmapEntity std constructor
@@ -101,6 +105,11 @@ public:
          * @return true if the conversion succeeded, false otherwise
          */
         bool setB64Encoded(QByteArray &bytes);
+        /**
+         * @brief getContentHash returns a hash of the encoded image data (the data as read from the image file)
+         * @return the sha1 hash of the image data or an empty array if there is no image
+         */
+        QByteArray getContentHash(void) const;
         /**
          * @brief getSize returns the size of the pixmap
          * @return the size of the pixmap in the document
@@ -121,6 +130,10 @@ public:
          * @param item the item that is associated with this entity (can also be a nullptr)
          */
         virtual EgcAbstractPixmapItem* getItem(void) override;
+        /**
+         * @brief decodePixmap decodes the image data and sets the pixmap of the item
+         */
+        virtual void decodePixmap(void) override;
         /**
          * @brief itemChanged is called when the item that is associated with the enity has changed
          */
@@ -137,13 +150,80 @@ public:
          * @param properties object with all neccessary information for deserializing
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;        
+        /**
+         * @brief takeSnapshot takes a snapshot of the picture that can be serialized on another thread. The image
+         * data is shared with the entity, it is encoded when serializing.
+         * @param properties object with all neccessary information for serializing
+         * @return the snapshot (the caller takes ownership) or a nullptr if there is not enough memory
+         */
+        virtual EgcEntitySnapshot* takeSnapshot(SerializerProperties& properties) override;
 
 
 private:
+        /**
+         * @brief setEncoded sets the encoded image data (e.g. the contents of a png file). Only the header is read,
+         * the image is decoded when it is needed the first time.
+         * @param bytes the encoded image data
+         * @return true if the data contains a supported image, false otherwise
+         */
+        bool setEncoded(const QByteArray& bytes);
+        /**
+         * @brief getExternalFile returns the file name (relative to the document) to store an image in if images
+         * are saved next to the document
+         * @param documentPath the path of the document file
+         * @param hash the hash of the image data
+         * @param format the format of the image (PNG, JPG,...)
+         * @return the relative file name of the image
+         */
+        static QString getExternalFile(const QString& documentPath, const QByteArray& hash, const QString& format);
+
         EgcAbstractPixmapItem *m_item;          ///< pointer to QGraphicsitem hold by scene
         bool m_isEmbedded;                      ///< determines if pixmap is embedded in document, or load by pathname
         QString m_path;                         ///< holds the path to the pixmap if m_isEmbedded is false
         QString m_fileFormat;                   ///< format type of file (PNG, JPG,...)
+        QByteArray m_encoded;                   ///< the encoded image data (written unchanged when saving)
+        QByteArray m_hash;                      ///< sha1 hash of m_encoded
+        QSize m_pixelSize;                      ///< size of the image in m_encoded
+};
+
+/**
+ * @brief The EgcPixmapSnapshot class holds everything needed to serialize a picture
+ */
+class EgcPixmapSnapshot : public EgcEntitySnapshot
+{
+public:
+        /**
+         * @brief EgcPixmapSnapshot std constructor
+         * @param pixmap the picture to take the snapshot of
+         */
+        EgcPixmapSnapshot(const EgcPixmapEntity& pixmap);
+        /**
+         * @brief serialize serializes the picture as it was when the snapshot was taken
+         * @param stream the stream to use for serializing the picture
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) override;
+
+private:
+        /**
+         * @brief writeExternalFile writes the encoded image into the given file next to the document. If this fails,
+         * the error is reported in properties.errorMessage.
+         * @param dir the directory of the document
+         * @param file the file to write (relative to the document directory)
+         * @param properties object with all neccessary information for serializing
+         * @return true if the file has been written completely, false otherwise
+         */
+        bool writeExternalFile(const QDir& dir, const QString& file, SerializerProperties& properties);
+
+        quint32 m_id;                           ///< id of the picture entity
+        QPointF m_pos;                          ///< position of the picture
+        QSizeF m_size;                          ///< size of the picture in the document
+        bool m_isEmbedded;                      ///< determines if the picture is embedded in the document
+        QString m_path;                         ///< the path to the picture if m_isEmbedded is false
+        QString m_fileFormat;                   ///< format type of the picture (PNG, JPG,...)
+        QByteArray m_encoded;                   ///< the encoded image data (shared with the entity)
+        QByteArray m_hash;                      ///< sha1 hash of m_encoded
+        QByteArray m_b64;                       ///< the base64 encoded pixmap if there is no encoded image data
 };
 
 #endif // EGCPIXMAPENTITY_H
@@ -0,0 +1,337 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+#include <QCoreApplication>
+#include "menu/ploteditor.h"
+#include "egcplotentity.h"
+#include "egcabstractplotitem.h"
+#include "casKernel/egcnumericevaluator.h"
+#include "document/egcabstractdocument.h"
+
+EgcPlotEntity::EgcPlotEntity(void) : m_item(nullptr), m_context(new EgcNumericEvaluator()), m_xMin(-10.0),
+        m_xMax(10.0), m_yMin(-10.0), m_yMax(10.0), m_autoScale(true), m_samples(s_defaultSamples)
+{
+}
+
+EgcPlotEntity::EgcPlotEntity(const EgcPlotEntity& orig) : EgcEntity(), m_item(nullptr), m_sampler(orig.m_sampler),
+        m_context(new EgcNumericEvaluator()), m_xMin(orig.m_xMin), m_xMax(orig.m_xMax), m_yMin(orig.m_yMin),
+        m_yMax(orig.m_yMax), m_autoScale(orig.m_autoScale), m_samples(orig.m_samples),
+        m_errorMessage(orig.m_errorMessage)
+{
+        m_context->copySymbols(*orig.m_context);
+}
+
+EgcPlotEntity::~EgcPlotEntity()
+{
+}
+
+EgcEntityType EgcPlotEntity::getEntityType(void) const
+{
+        return EgcEntityType::Plot;
+}
+
+QPointF EgcPlotEntity::getPosition(void) const
+{
+        if (m_item)
+                return m_item->getPosition();
+        else
+                return QPointF(0.0,0.0);
+}
+
+void EgcPlotEntity::setPosition(QPointF pos)
+{
+        if (!m_item)
+                return;
+
+        m_item->setPos(pos);
+}
+
+bool EgcPlotEntity::setExpression(const QString& expression, const QString& variable)
+{
+        return m_sampler.setExpression(expression, variable);
+}
+
+QString EgcPlotEntity::getExpression(void) const
+{
+        return m_sampler.getExpression();
+}
+
+QString EgcPlotEntity::getVariable(void) const
+{
+        return m_sampler.getVariable();
+}
+
+void EgcPlotEntity::setXRange(double xMin, double xMax)
+{
+        if (!(xMax > xMin) || !std::isfinite(xMax - xMin))
+                return;
+
+        m_xMin = xMin;
+        m_xMax = xMax;
+}
+
+double EgcPlotEntity::getXMin(void) const
+{
+        return m_xMin;
+}
+
+double EgcPlotEntity::getXMax(void) const
+{
+        return m_xMax;
+}
+
+void EgcPlotEntity::setYRange(double yMin, double yMax, bool autoScale)
+{
+        m_autoScale = autoScale;
+        if (yMax > yMin && std::isfinite(yMax - yMin)) {
+                m_yMin = yMin;
+                m_yMax = yMax;
+        }
+}
+
+double EgcPlotEntity::getYMin(void) const
+{
+        return m_yMin;
+}
+
+double EgcPlotEntity::getYMax(void) const
+{
+        return m_yMax;
+}
+
+bool EgcPlotEntity::isAutoScale(void) const
+{
+        return m_autoScale;
+}
+
+void EgcPlotEntity::setNumberOfSamples(int samples)
+{
+        if (samples < 2)
+                samples = 2;
+        if (samples > EgcPlotSampler::s_maxSamples)
+                samples = EgcPlotSampler::s_maxSamples;
+
+        m_samples = samples;
+}
+
+int EgcPlotEntity::getNumberOfSamples(void) const
+{
+        return m_samples;
+}
+
+QString EgcPlotEntity::getErrorMessage(void) const
+{
+        return m_errorMessage;
+}
+
+void EgcPlotEntity::setContext(const EgcNumericEvaluator& evaluator)
+{
+        m_context->copySymbols(evaluator);
+        // the definitions may have changed, so no sample can be reused
+        m_sampler.invalidate();
+        resample();
+}
+
+void EgcPlotEntity::resample(void)
+{
+        m_errorMessage.clear();
+        if (!m_sampler.isValid()) {
+                m_errorMessage = m_sampler.getErrorMessage();
+                return;
+        }
+
+        if (!m_sampler.sample(m_xMin, m_xMax, m_samples, *m_context))
+                m_errorMessage = QCoreApplication::translate("EgcPlotEntity",
+                                                             "The expression contains undefined symbols");
+}
+
+void EgcPlotEntity::updateView(void)
+{
+        if (!m_item)
+                return;
+
+        const QVector<double>& x = m_sampler.getX();
+        const QVector<double>& y = m_sampler.getY();
+        double yMin = m_yMin;
+        double yMax = m_yMax;
+        if (m_autoScale) {
+                bool found = false;
+                for (int i = 0; i < x.size(); i++) {
+                        if (x.at(i) < m_xMin || x.at(i) > m_xMax || !std::isfinite(y.at(i)))
+                                continue;
+                        if (!found || y.at(i) < yMin)
+                                yMin = y.at(i);
+                        if (!found || y.at(i) > yMax)
+                                yMax = y.at(i);
+                        found = true;
+                }
+                if (!found) {
+                        yMin = -1.0;
+                        yMax = 1.0;
+                } else if (!(yMax - yMin > 0.0) || !std::isfinite(yMax - yMin)) {
+                        // constant curves (or curves with a range that cannot be represented)
+                        double delta = (std::fabs(yMin) > 1.0) ? std::fabs(yMin) * 0.1 : 1.0;
+                        if (!std::isfinite(yMax - yMin))
+                                delta = 0.0;
+                        yMin -= delta;
+                        yMax += delta;
+                } else {
+                        double margin = (yMax - yMin) * 0.05;
+                        yMin -= margin;
+                        yMax += margin;
+                }
+        }
+
+        QString caption = m_errorMessage;
+        if (caption.isEmpty())
+                caption = getExpression();
+        if (caption.isEmpty())
+                caption = QString("?");
+
+        m_item->setCaption(caption);
+        if (m_errorMessage.isEmpty())
+                m_item->setCurve(x, y, QRectF(m_xMin, yMin, m_xMax - m_xMin, yMax - yMin));
+        else
+                m_item->setCurve(QVector<double>(), QVector<double>(), QRectF(m_xMin, yMin, m_xMax - m_xMin,
+                                                                              yMax - yMin));
+}
+
+void EgcPlotEntity::zoom(qreal factor, qreal center)
+{
+        if (!(factor > 0.0))
+                return;
+
+        double width = (m_xMax - m_xMin) * factor;
+        double anchor = m_xMin + (m_xMax - m_xMin) * center;
+        double xMin = anchor - width * center;
+        double xMax = xMin + width;
+        // don't zoom in further than the resolution of double values
+        if (!(xMax - xMin > 1e-12 * qMax(std::fabs(xMin), std::fabs(xMax))) || !std::isfinite(width))
+                return;
+
+        m_xMin = xMin;
+        m_xMax = xMax;
+        resample();
+        updateView();
+        contentModified();
+}
+
+void EgcPlotEntity::pan(qreal fraction)
+{
+        double shift = (m_xMax - m_xMin) * fraction;
+        if (!std::isfinite(m_xMin + shift) || !std::isfinite(m_xMax + shift))
+                return;
+
+        m_xMin += shift;
+        m_xMax += shift;
+        resample();
+        updateView();
+        contentModified();
+}
+
+void EgcPlotEntity::setItem(EgcAbstractPlotItem* item)
+{
+        m_item = item;
+}
+
+EgcAbstractPlotItem* EgcPlotEntity::getItem(void)
+{
+        return m_item;
+}
+
+void EgcPlotEntity::itemChanged(EgcItemChangeType changeType)
+{
+        if (changeType == EgcItemChangeType::itemEdited) {
+                PlotEditor editor;
+                if (editor.exec(*this)) {
+                        resample();
+                        updateView();
+                        // the definitions known so far are not sufficient, so calculate the document
+                        EgcAbstractDocument* doc = getDocument();
+                        if (doc)
+                                doc->entityChanged(this);
+                        if (doc && !m_errorMessage.isEmpty() && m_sampler.isValid())
+                                doc->startCalulation(nullptr);
+                }
+        }
+
+        if (changeType == EgcItemChangeType::posChanged)
+                positionChanged();
+}
+
+void EgcPlotEntity::serialize(QXmlStreamWriter& stream, SerializerProperties& properties)
+{
+        (void) properties;
+
+        stream.writeStartElement("plot_entity");
+        writeId(stream, getId());
+        stream.writeAttribute("pos_x", QString("%1").arg(getPosition().x()));
+        stream.writeAttribute("pos_y", QString("%1").arg(getPosition().y()));
+        stream.writeAttribute("expression", getExpression());
+        stream.writeAttribute("variable", getVariable());
+        stream.writeAttribute("x_min", QString::number(m_xMin, 'g', 17));
+        stream.writeAttribute("x_max", QString::number(m_xMax, 'g', 17));
+        stream.writeAttribute("y_min", QString::number(m_yMin, 'g', 17));
+        stream.writeAttribute("y_max", QString::number(m_yMax, 'g', 17));
+        stream.writeAttribute("autoscale", m_autoScale ? QString("true") : QString("false"));
+        stream.writeAttribute("samples", QString::number(m_samples));
+        stream.writeEndElement(); // plot_entity
+}
+
+void EgcPlotEntity::deserialize(QXmlStreamReader& stream, SerializerProperties& properties)
+{
+        (void) properties;
+
+        if (stream.name() == QLatin1String("plot_entity")) {
+                QXmlStreamAttributes attr = stream.attributes();
+                setId(readId(attr));
+                if (attr.hasAttribute("x_min") && attr.hasAttribute("x_max"))
+                        setXRange(attr.value("x_min").toDouble(), attr.value("x_max").toDouble());
+                if (attr.hasAttribute("y_min") && attr.hasAttribute("y_max"))
+                        setYRange(attr.value("y_min").toDouble(), attr.value("y_max").toDouble(),
+                                  attr.value("autoscale") != QLatin1String("false"));
+                if (attr.hasAttribute("samples"))
+                        setNumberOfSamples(attr.value("samples").toInt());
+                if (attr.hasAttribute("expression"))
+                        setExpression(attr.value("expression").toString(), attr.value("variable").toString());
+                if (attr.hasAttribute("pos_x") && attr.hasAttribute("pos_y")) {
+                        qreal x = attr.value("pos_x").toFloat();
+                        qreal y = attr.value("pos_y").toFloat();
+                        setPosition(QPointF(x, y));
+                }
+                resample();
+                updateView();
+        }
+
+        if (!stream.isEndElement())
+                stream.skipCurrentElement();
+}
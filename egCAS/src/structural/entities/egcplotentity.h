@@ -0,0 +1,214 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCPLOTENTITY_H
+#define EGCPLOTENTITY_H
+
+#include <QString>
+#include <QScopedPointer>
+#include "egcentity.h"
+#include "egcabstractplotentity.h"
+#include "casKernel/egcplotsampler.h"
+
+class QPointF;
+class EgcAbstractPlotItem;
+class EgcNumericEvaluator;
+
+/**
+ * @brief The EgcPlotEntity class is a plot of an expression of one variable. The plot is sampled natively with the
+ * numeric definitions that are valid at the position of the plot in the document, so zooming and panning never needs
+ * the CAS kernel.
+ */
+class EgcPlotEntity : public EgcEntity, public EgcAbstractPlotEntity
+{
+public:
+        /**
+         * @brief EgcPlotEntity std constructor
+         */
+        EgcPlotEntity(void);
+        /**
+         * @brief EgcPlotEntity copy constructor (the item is not copied)
+         * @param orig the entity to copy
+         */
+        EgcPlotEntity(const EgcPlotEntity& orig);
+        ///std destructor
+        virtual ~EgcPlotEntity();
+        /**
+         * @brief getEntityType returns the entity type of the current class, needs to be reimplemented in a subclass
+         * @return the entity type
+         */
+        virtual enum EgcEntityType getEntityType(void) const override;
+        /**
+         * @brief getPositon returns the position of the current entity
+         * @return the position of the entity in the current worksheet
+         */
+        virtual QPointF getPosition(void) const override;
+        /**
+         * @brief setPosition set the position of a entity
+         * @param pos the position where the entity should be
+         */
+        virtual void setPosition(QPointF pos) override;
+        /**
+         * @brief setExpression set the expression to plot
+         * @param expression the expression (in the syntax of the CAS kernel)
+         * @param variable the variable the expression is plotted over
+         * @return true if the expression can be plotted, false otherwise
+         */
+        bool setExpression(const QString& expression, const QString& variable);
+        /**
+         * @brief getExpression returns the expression that is plotted
+         * @return the expression
+         */
+        QString getExpression(void) const;
+        /**
+         * @brief getVariable returns the variable the expression is plotted over
+         * @return the variable
+         */
+        QString getVariable(void) const;
+        /**
+         * @brief setXRange set the x range of the plot
+         * @param xMin the start of the range
+         * @param xMax the end of the range (must be greater than xMin)
+         */
+        void setXRange(double xMin, double xMax);
+        /**
+         * @brief getXMin returns the start of the x range
+         * @return the start of the x range
+         */
+        double getXMin(void) const;
+        /**
+         * @brief getXMax returns the end of the x range
+         * @return the end of the x range
+         */
+        double getXMax(void) const;
+        /**
+         * @brief setYRange set the y range of the plot
+         * @param yMin the start of the range
+         * @param yMax the end of the range
+         * @param autoScale if true, the y range is adjusted to the values of the curve (yMin and yMax are ignored)
+         */
+        void setYRange(double yMin, double yMax, bool autoScale);
+        /**
+         * @brief getYMin returns the start of the y range that has been set
+         * @return the start of the y range
+         */
+        double getYMin(void) const;
+        /**
+         * @brief getYMax returns the end of the y range that has been set
+         * @return the end of the y range
+         */
+        double getYMax(void) const;
+        /**
+         * @brief isAutoScale checks if the y range is adjusted to the values of the curve
+         * @return true if the y range is adjusted automatically
+         */
+        bool isAutoScale(void) const;
+        /**
+         * @brief setNumberOfSamples set the number of samples in the visible range
+         * @param samples the number of samples (limited to EgcPlotSampler::s_maxSamples)
+         */
+        void setNumberOfSamples(int samples);
+        /**
+         * @brief getNumberOfSamples returns the number of samples in the visible range
+         * @return the number of samples
+         */
+        int getNumberOfSamples(void) const;
+        /**
+         * @brief getErrorMessage returns the error message if the expression cannot be plotted
+         * @return the error message
+         */
+        QString getErrorMessage(void) const;
+        /**
+         * @brief setContext set the numeric definitions that are valid at the position of the plot and samples the
+         * plot again
+         * @param evaluator the evaluator that knows about the numeric definitions of the document
+         */
+        void setContext(const EgcNumericEvaluator& evaluator);
+        /**
+         * @brief resample samples the visible range of the plot (the samples still visible are reused)
+         */
+        void resample(void);
+        /**
+         * @brief updateView updates the view with the current curve
+         */
+        void updateView(void);
+        /**
+         * @brief zoom zooms the x range of the plot
+         * @param factor the factor to scale the range with (< 1 zooms in, > 1 zooms out)
+         * @param center the point that stays at its place, as fraction of the range (0.0 left, 1.0 right)
+         */
+        virtual void zoom(qreal factor, qreal center) override;
+        /**
+         * @brief pan moves the x range of the plot
+         * @param fraction the distance to move as fraction of the range (negative values move to the left)
+         */
+        virtual void pan(qreal fraction) override;
+        /**
+         * @brief setItem set the plot item that is associated with this entity
+         * @param item the item to set (can also be a nullptr)
+         */
+        virtual void setItem(EgcAbstractPlotItem* item) override;
+        /**
+         * @brief getItem get the plot item that is associated with this entity
+         * @return the item that is associated with this entity (can also be a nullptr)
+         */
+        virtual EgcAbstractPlotItem* getItem(void) override;
+        /**
+         * @brief itemChanged is called when the item that is associated with the enity has changed
+         */
+        virtual void itemChanged(EgcItemChangeType changeType) override;
+        /**
+         * @brief interface for serializing a class
+         * @param stream the stream to use for serializing this class
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) override;
+        /**
+         * @brief deserialize interface for deserializing a class
+         * @param stream the stream to use for deserializing this class
+         * @param properties object with all neccessary information for deserializing
+         */
+        virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;
+
+        static const int s_defaultSamples = 1000;       ///< default number of samples in the visible range
+
+private:
+        EgcAbstractPlotItem *m_item;                    ///< pointer to QGraphicsitem hold by scene
+        EgcPlotSampler m_sampler;                       ///< samples the expression of the plot
+        QScopedPointer<EgcNumericEvaluator> m_context;  ///< the numeric definitions valid at the plot position
+        double m_xMin;                                  ///< start of the x range
+        double m_xMax;                                  ///< end of the x range
+        double m_yMin;                                  ///< start of the y range (if not scaled automatically)
+        double m_yMax;                                  ///< end of the y range (if not scaled automatically)
+        bool m_autoScale;                               ///< if true the y range is adjusted to the curve
+        int m_samples;                                  ///< number of samples in the visible range
+        QString m_errorMessage;                         ///< error message if the plot cannot be sampled
+};
+
+#endif // EGCPLOTENTITY_H
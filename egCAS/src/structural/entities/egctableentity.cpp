@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+#include <QCoreApplication>
+#include "menu/tableeditor.h"
+#include "egctableentity.h"
+#include "egcformulaentity.h"
+#include "egcabstracttableitem.h"
+#include "casKernel/egcnumericevaluator.h"
+#include "document/egcabstractdocument.h"
+#include "utils/egcnumberformatter.h"
+
+EgcTableEntity::EgcTableEntity(void) : m_item(nullptr)
+{
+}
+
+EgcTableEntity::EgcTableEntity(const EgcTableEntity& orig) : EgcEntity(), m_item(nullptr), m_sweep(orig.m_sweep),
+        m_errorMessage(orig.m_errorMessage)
+{
+}
+
+EgcTableEntity::~EgcTableEntity()
+{
+}
+
+EgcEntityType EgcTableEntity::getEntityType(void) const
+{
+        return EgcEntityType::Table;
+}
+
+QPointF EgcTableEntity::getPosition(void) const
+{
+        if (m_item)
+                return m_item->getPosition();
+        else
+                return QPointF(0.0,0.0);
+}
+
+void EgcTableEntity::setPosition(QPointF pos)
+{
+        if (!m_item)
+                return;
+
+        m_item->setPos(pos);
+}
+
+EgcParameterSweep& EgcTableEntity::getSweep(void)
+{
+        return m_sweep;
+}
+
+bool EgcTableEntity::calculate(const EgcNumericEvaluator& evaluator)
+{
+        m_errorMessage.clear();
+
+        return m_sweep.evaluate(evaluator);
+}
+
+QString EgcTableEntity::getCASKernelCommand(void) const
+{
+        return m_sweep.getKernelCommand();
+}
+
+void EgcTableEntity::setKernelResult(const QString& result)
+{
+        m_errorMessage.clear();
+        if (!m_sweep.setKernelResult(result))
+                m_errorMessage = QCoreApplication::translate("EgcTableEntity", "Unexpected result: ") + result;
+}
+
+void EgcTableEntity::setErrorMessage(const QString& msg)
+{
+        m_sweep.clearValues();
+        m_errorMessage = msg;
+}
+
+void EgcTableEntity::resetResult(void)
+{
+        m_sweep.clearValues();
+        m_errorMessage.clear();
+}
+
+QString EgcTableEntity::formatValue(const QString& value)
+{
+        quint8 digits = EgcFormulaEntity::getStdNrSignificantDigis();
+
+        return EgcNumberFormatter::format(value, EgcNumberResultType::StandardType, digits);
+}
+
+void EgcTableEntity::updateView(void)
+{
+        if (!m_item)
+                return;
+
+        QVector<QStringList> cells;
+        const EgcSweepRange& rows = m_sweep.getRange(0);
+        const EgcSweepRange& columns = m_sweep.getRange(1);
+        QString expression = m_sweep.getExpression();
+        if (expression.isEmpty())
+                expression = QString("?");
+
+        if (!m_sweep.isValid()) {
+                cells.append(QStringList(expression));
+                QString msg = m_sweep.getErrorMessage();
+                if (msg.isEmpty())
+                        msg = QCoreApplication::translate("EgcTableEntity", "Invalid parameter range");
+                cells.append(QStringList(msg));
+                m_item->setCells(cells);
+                return;
+        }
+
+        // header: the expression (or the values of the second parameter) over the value columns
+        QStringList header;
+        if (m_sweep.getDimension() == 2) {
+                header.append(rows.m_name + QString("\\") + columns.m_name);
+                for (quint32 i = 0; i < m_sweep.getColumns(); i++)
+                        header.append(formatValue(EgcNumericEvaluator::toKernelString(
+                                                          EgcNumericValue(columns.value(i), false), true)));
+        } else {
+                header.append(rows.m_name);
+                header.append(expression);
+        }
+        cells.append(header);
+
+        quint32 nrRows = m_sweep.getRows();
+        if (nrRows > s_maxRows)
+                nrRows = s_maxRows;
+        for (quint32 row = 0; row < nrRows; row++) {
+                QStringList line;
+                line.append(formatValue(EgcNumericEvaluator::toKernelString(EgcNumericValue(rows.value(row), false),
+                                                                            true)));
+                for (quint32 column = 0; column < m_sweep.getColumns(); column++)
+                        line.append(formatValue(m_sweep.getValue(row, column)));
+                cells.append(line);
+        }
+        if (m_sweep.getRows() > nrRows) {
+                QString more = QCoreApplication::translate("EgcTableEntity", "%1 more rows")
+                                                           .arg(m_sweep.getRows() - nrRows);
+                cells.append(QStringList() << QString("...") << more);
+        }
+        if (!m_errorMessage.isEmpty())
+                cells.append(QStringList(m_errorMessage));
+
+        m_item->setCells(cells);
+}
+
+void EgcTableEntity::setItem(EgcAbstractTableItem* item)
+{
+        m_item = item;
+}
+
+EgcAbstractTableItem* EgcTableEntity::getItem(void)
+{
+        return m_item;
+}
+
+void EgcTableEntity::itemChanged(EgcItemChangeType changeType)
+{
+        if (changeType == EgcItemChangeType::itemEdited) {
+                TableEditor editor;
+                if (editor.exec(m_sweep)) {
+                        m_errorMessage.clear();
+                        updateView();
+                        EgcAbstractDocument* doc = getDocument();
+                        if (doc) {
+                                doc->entityChanged(this);
+                                doc->startCalulation(nullptr);
+                        }
+                }
+        }
+
+        if (changeType == EgcItemChangeType::posChanged)
+                positionChanged();
+}
+
+void EgcTableEntity::serialize(QXmlStreamWriter& stream, SerializerProperties& properties)
+{
+        (void) properties;
+
+        stream.writeStartElement("table_entity");
+        writeId(stream, getId());
+        stream.writeAttribute("pos_x", QString("%1").arg(getPosition().x()));
+        stream.writeAttribute("pos_y", QString("%1").arg(getPosition().y()));
+        stream.writeAttribute("expression", m_sweep.getExpression());
+        for (int i = 0; i < 2; i++) {
+                const EgcSweepRange& range = m_sweep.getRange(i);
+                if (range.m_name.isEmpty())
+                        continue;
+                QString nr = QString::number(i + 1);
+                stream.writeAttribute(QString("name") + nr, range.m_name);
+                stream.writeAttribute(QString("from") + nr, QString::number(range.m_from, 'g', 17));
+                stream.writeAttribute(QString("to") + nr, QString::number(range.m_to, 'g', 17));
+                stream.writeAttribute(QString("steps") + nr, QString::number(range.m_steps));
+        }
+        // the values are saved as well, so the table can be shown without calculating the document
+        if (m_sweep.hasValues())
+                stream.writeCharacters(m_sweep.getValues().join(';'));
+        stream.writeEndElement(); // table_entity
+}
+
+void EgcTableEntity::deserialize(QXmlStreamReader& stream, SerializerProperties& properties)
+{
+        (void) properties;
+
+        if (stream.name() == QLatin1String("table_entity")) {
+                QXmlStreamAttributes attr = stream.attributes();
+                setId(readId(attr));
+                for (int i = 0; i < 2; i++) {
+                        QString nr = QString::number(i + 1);
+                        if (!attr.hasAttribute(QString("name") + nr))
+                                continue;
+                        EgcSweepRange range(attr.value(QString("name") + nr).toString(),
+                                            attr.value(QString("from") + nr).toDouble(),
+                                            attr.value(QString("to") + nr).toDouble(),
+                                            attr.value(QString("steps") + nr).toUInt());
+                        m_sweep.setRange(i, range);
+                }
+                if (attr.hasAttribute("expression"))
+                        m_sweep.setExpression(attr.value("expression").toString());
+                if (attr.hasAttribute("pos_x") && attr.hasAttribute("pos_y")) {
+                        qreal x = attr.value("pos_x").toFloat();
+                        qreal y = attr.value("pos_y").toFloat();
+                        setPosition(QPointF(x, y));
+                }
+                QString values = stream.readElementText();
+                if (!values.isEmpty())
+                        m_sweep.setValues(values.split(';'));
+                updateView();
+        }
+
+        if (!stream.isEndElement())
+                stream.skipCurrentElement();
+}
@@ -0,0 +1,151 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCTABLEENTITY_H
+#define EGCTABLEENTITY_H
+
+#include <QString>
+#include "egcentity.h"
+#include "egcabstracttableentity.h"
+#include "casKernel/egcparametersweep.h"
+
+class QPointF;
+class EgcAbstractTableItem;
+class EgcNumericEvaluator;
+
+/**
+ * @brief The EgcTableEntity class is a table with the values of an expression evaluated over one or two parameter
+ * ranges (parameter sweep)
+ */
+class EgcTableEntity : public EgcEntity, public EgcAbstractTableEntity
+{
+public:
+        /**
+         * @brief EgcTableEntity std constructor
+         */
+        EgcTableEntity(void);
+        /**
+         * @brief EgcTableEntity copy constructor (the item is not copied)
+         * @param orig the entity to copy
+         */
+        EgcTableEntity(const EgcTableEntity& orig);
+        ///std destructor
+        virtual ~EgcTableEntity();
+        /**
+         * @brief getEntityType returns the entity type of the current class, needs to be reimplemented in a subclass
+         * @return the entity type
+         */
+        virtual enum EgcEntityType getEntityType(void) const override;
+        /**
+         * @brief getPositon returns the position of the current entity
+         * @return the position of the entity in the current worksheet
+         */
+        virtual QPointF getPosition(void) const override;
+        /**
+         * @brief setPosition set the position of a entity
+         * @param pos the position where the entity should be
+         */
+        virtual void setPosition(QPointF pos) override;
+        /**
+         * @brief getSweep returns the parameter sweep of the table (expression and ranges)
+         * @return the parameter sweep
+         */
+        EgcParameterSweep& getSweep(void);
+        /**
+         * @brief calculate calculates the table natively if the expression is purely numeric
+         * @param evaluator the evaluator that knows about the numeric definitions of the document
+         * @return true if the table could be calculated, false if the kernel must calculate the table
+         */
+        bool calculate(const EgcNumericEvaluator& evaluator);
+        /**
+         * @brief getCASKernelCommand returns the command that calculates the whole table in the kernel at once
+         * @return the kernel command, or an empty string if the table cannot be calculated
+         */
+        QString getCASKernelCommand(void) const;
+        /**
+         * @brief setKernelResult sets the result of the kernel command
+         * @param result the result returned by the kernel
+         */
+        void setKernelResult(const QString& result);
+        /**
+         * @brief setErrorMessage set an error message if the table could not be calculated
+         * @param msg the error message to show
+         */
+        void setErrorMessage(const QString& msg);
+        /**
+         * @brief resetResult removes all calculated values
+         */
+        void resetResult(void);
+        /**
+         * @brief updateView updates the view with the current contents of the table
+         */
+        void updateView(void);
+        /**
+         * @brief setItem set the table item that is associated with this entity
+         * @param item the item to set (can also be a nullptr)
+         */
+        virtual void setItem(EgcAbstractTableItem* item) override;
+        /**
+         * @brief getItem get the table item that is associated with this entity
+         * @return the item that is associated with this entity (can also be a nullptr)
+         */
+        virtual EgcAbstractTableItem* getItem(void) override;
+        /**
+         * @brief itemChanged is called when the item that is associated with the enity has changed
+         */
+        virtual void itemChanged(EgcItemChangeType changeType) override;
+        /**
+         * @brief interface for serializing a class
+         * @param stream the stream to use for serializing this class
+         * @param properties object with all neccessary information for serializing
+         */
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties& properties) override;
+        /**
+         * @brief deserialize interface for deserializing a class
+         * @param stream the stream to use for deserializing this class
+         * @param properties object with all neccessary information for deserializing
+         */
+        virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override;
+
+        static const quint32 s_maxRows = 100;   ///< maximum number of rows shown (all values are kept anyway)
+
+private:
+        /**
+         * @brief formatValue formats the given value for showing it to the user
+         * @param value the value in kernel format
+         * @return the formatted value
+         */
+        static QString formatValue(const QString& value);
+
+        EgcAbstractTableItem *m_item;           ///< pointer to QGraphicsitem hold by scene
+        EgcParameterSweep m_sweep;              ///< the expression and ranges of the table and the calculated values
+        QString m_errorMessage;                 ///< error message if the table could not be calculated
+};
+
+#endif // EGCTABLEENTITY_H
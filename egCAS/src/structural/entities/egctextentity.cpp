@@ -152,13 +152,25 @@ QFont& EgcTextEntity::getGenericFont(void)
 void EgcTextEntity::itemChanged(EgcItemChangeType changeType)
 {
         if (changeType == EgcItemChangeType::itemEdited) {
+                // the text is reported when editing is finished, but the document may be saved before
+                contentModified();
                 if (m_item && m_isHtml) {
                         m_item->setEditMode(false);
 
                         RichTextEditor editor;
                         setHtmlText(editor.exec(getText()));
+                        if (getDocument())
+                                getDocument()->entityChanged(this);
                 }
         }
+
+        if (changeType == EgcItemChangeType::contentChanged) {
+                if (getDocument())
+                        getDocument()->entityChanged(this);
+        }
+
+        if (changeType == EgcItemChangeType::posChanged)
+                positionChanged();
 }
 
 void EgcTextEntity::setEditMode()
@@ -172,6 +184,7 @@ void EgcTextEntity::serialize(QXmlStreamWriter& stream, SerializerProperties &pr
         (void) properties;
 
         stream.writeStartElement("text_entity");
+        writeId(stream, getId());
         if (m_font && !m_isHtml)
                 stream.writeAttribute("font", m_font->toString());
         if (m_isHtml)
@@ -188,6 +201,7 @@ void EgcTextEntity::deserialize(QXmlStreamReader& stream, SerializerProperties&
 
         if (stream.name() == QLatin1String("text_entity")) {
                 QXmlStreamAttributes attr = stream.attributes();
+                setId(readId(attr));
                 if (attr.hasAttribute("font")) {
                         QString font_str = attr.value("font").toString();
                         QFont fnt;
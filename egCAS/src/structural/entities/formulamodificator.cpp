@@ -41,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "casKernel/parser/restructparserprovider.h"
 #include "casKernel/parser/abstractkernelparser.h"
 #include "../concreteNodes/egcalnumnode.h"
+#include "utils/egcperfcounter.h"
 
 const char emptyElement[] = "_empty";
 const char emptyBinElement[] = "_emptybinop";
@@ -846,13 +847,17 @@ bool FormulaModificator::reStructureTree()
 {
         bool retval = true;
 
+        EGC_PERF_SCOPE(perf, EgcPerfPhase::ScrVisitor);
         RestructParserProvider pp;
         FormulaScrVisitor restructVisitor(m_formula, m_iter);
         QString result = restructVisitor.getResult();
         int errCode;
+        EGC_PERF_SWITCH(perf, EgcPerfPhase::Parser);
         EgcNode* tree = pp.getRestructParser()->restructureFormula(result, m_tempIterData, &errCode);
         if (tree) {
+                EGC_PERF_SWITCH(perf, EgcPerfPhase::TreeReplace);
                 m_formula.setRootElement(tree);
+                EGC_PERF_STOP(perf);
                 m_formula.updateView();
         } else {
                 retval = false;
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QLatin1String>
 #include "egccontainernode.h"
 #include "egcbinaryoperator.h"
+#include "document/egcbinarydocument.h"
 
 EgcContainerNode::EgcContainerNode()
 {
@@ -173,7 +174,9 @@ void EgcContainerNode::serialize(QXmlStreamWriter& stream, SerializerProperties
         QLatin1String str = EgcNodeCreator::stringize(getNodeType());
         if (str.size() != 0) {
                 stream.writeStartElement(str);
-                serializeAttributes(stream);
+                QXmlStreamAttributes attr;
+                serializeAttributes(attr);
+                stream.writeAttributes(attr);
         }
 
         for(i = 0; i < n; i++) {
@@ -191,11 +194,13 @@ void EgcContainerNode::deserialize(QXmlStreamReader& stream, SerializerPropertie
 {
         if (stream.name() == EgcNodeCreator::stringize(getNodeType())) {
                 QXmlStreamAttributes attr = stream.attributes();
-                deserializeAttributes(stream, properties.version, attr);
+                deserializeAttributes(properties.version, attr);
                 quint32 i = 0;
                 while (stream.readNextStartElement()) {
-                        QString str(stream.name().toLatin1());
-                        QScopedPointer<EgcNode> node(EgcNodeCreator::create(QLatin1String(str.toLatin1())));
+                        EgcNodeType type = EgcNodeCreator::getType(stream.name());
+                        QScopedPointer<EgcNode> node;
+                        if (type != EgcNodeType::NodeUndefined)
+                                node.reset(EgcNodeCreator::create(type));
                         EgcNode* n = nullptr;
                         if (node.isNull()) {
                                 stream.skipCurrentElement();
@@ -219,14 +224,69 @@ void EgcContainerNode::deserialize(QXmlStreamReader& stream, SerializerPropertie
         }
 }
 
-void EgcContainerNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcContainerNode::serializeBinary(EgcBinaryDocument& document)
 {
-        (void) stream;
+        quint32 i;
+        EgcNode* node;
+        quint32 n = getNumberChildNodes();
+        bool named = EgcNodeCreator::stringize(getNodeType()).size() != 0;
+        if (named) {
+                QXmlStreamAttributes attr;
+                serializeAttributes(attr);
+                document.writeStartElement(getNodeType(), attr);
+        }
+
+        for(i = 0; i < n; i++) {
+                node = getChild(i);
+                if (node)
+                        node->serializeBinary(document);
+        }
+
+        if (named)
+                document.writeEndElement();
+}
+
+void EgcContainerNode::deserializeBinary(EgcBinaryReader& reader, quint32 version)
+{
+        if (reader.nodeType() == getNodeType()) {
+                QXmlStreamAttributes attr = reader.attributes();
+                deserializeAttributes(version, attr);
+                quint32 i = 0;
+                while (reader.readNextStartElement()) {
+                        EgcNodeType type = reader.nodeType();
+                        QScopedPointer<EgcNode> node;
+                        if (type != EgcNodeType::NodeUndefined)
+                                node.reset(EgcNodeCreator::create(type));
+                        EgcNode* n = nullptr;
+                        if (node.isNull()) {
+                                reader.skipCurrentElement();
+                        } else {
+                                if (    (i < getNumberChildNodes())
+                                     || (isFlexNode())) {
+                                        setChild(i, *node.take());
+                                        n = getChild(i);
+                                } else {
+                                        reader.skipCurrentElement();
+                                }
+                        }
+
+                        if (n != nullptr)
+                                n->deserializeBinary(reader, version);
+
+                        i++;
+                }
+        } else {
+                reader.skipCurrentElement();
+        }
+}
+
+void EgcContainerNode::serializeAttributes(QXmlStreamAttributes& attr)
+{
+        (void) attr;
 }
 
-void EgcContainerNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcContainerNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
         (void) attr;
 }
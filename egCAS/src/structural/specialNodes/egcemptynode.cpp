@@ -63,14 +63,13 @@ QString EgcEmptyNode::getEmptyValue()
         return QChar(0x2B1A);
 }
 
-void EgcEmptyNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcEmptyNode::serializeAttributes(QXmlStreamAttributes& attr)
 {
-        (void) stream;
+        (void) attr;
 }
 
-void EgcEmptyNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcEmptyNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
         (void) attr;
 }
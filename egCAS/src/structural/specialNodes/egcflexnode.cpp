@@ -32,12 +32,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "../visitor/egcnodevisitor.h"
 
 
-EgcFlexNode::EgcFlexNode() : m_childs(1)
+EgcFlexNode::EgcFlexNode() : m_childs(1), m_indexHint{0}
 {
 
 }
 
-EgcFlexNode::EgcFlexNode(const EgcFlexNode& orig) : EgcContainerNode(orig)
+EgcFlexNode::EgcFlexNode(const EgcFlexNode& orig) : EgcContainerNode(orig), m_indexHint{0}
 {
         m_childs.clear();
         EgcNode *originalChild;
@@ -62,22 +62,21 @@ EgcFlexNode::EgcFlexNode(const EgcFlexNode& orig) : EgcContainerNode(orig)
         }
 }
 
-EgcFlexNode::EgcFlexNode(EgcFlexNode&& orig) : EgcContainerNode(orig)
+EgcFlexNode::EgcFlexNode(EgcFlexNode&& orig) : EgcContainerNode(orig), m_indexHint{0}
 {
         m_childs.clear();
         EgcNode *originalChild;
         quint32 i;
         quint32 cnt = static_cast<quint32>(orig.m_childs.count());
-        QScopedPointer<EgcNode> child;
+        m_childs.reserve(static_cast<int>(cnt));
         for (i = 0; i < cnt; i++) {
-                originalChild = orig.getChild(i);
-                if (originalChild)
-                        child.reset(orig.takeOwnership(*originalChild));
+                originalChild = orig.m_childs.at(static_cast<int>(i));
+                orig.m_childs[static_cast<int>(i)] = nullptr;
 
                 //set the parent also
-                if(child.data()) {
-                        child->provideParent(this);
-                        m_childs.append(child.take());
+                if(originalChild) {
+                        originalChild->provideParent(this);
+                        m_childs.append(originalChild);
                 }
         }
 
@@ -161,16 +160,15 @@ EgcFlexNode& EgcFlexNode::operator=(EgcFlexNode&& rhs)
                 m_childs.clear();
         }
 
-        //and create a new one
+        //and take over the child pointers of rhs directly (no search for each child, so this is linear for huge lists)
         if (cntRhs != 0) {
+                m_childs.reserve(static_cast<int>(cntRhs));
                 for (i = 0; i < cntRhs; i++) {
-                        child = rhs.getChild(i);
-                        QScopedPointer<EgcNode> childMove;
-                        if (child) {
-                                childMove.reset(rhs.takeOwnership(*child));
+                        child = rhs.m_childs.at(static_cast<int>(i));
+                        rhs.m_childs[static_cast<int>(i)] = nullptr;
+                        if (child)
                                 child->provideParent(this);
-                        }
-                        m_childs.append(childMove.take());
+                        m_childs.append(child);
                 }
         }
 
@@ -216,7 +214,7 @@ EgcNode* EgcFlexNode::takeOwnership(EgcNode &child)
 {
         EgcNode* retval = nullptr;
 
-        int ind = m_childs.indexOf(&child);
+        int ind = indexOfChild(&child);
         if (ind >= 0) {
                 m_childs[ind] = nullptr;
                 child.provideParent(nullptr);
@@ -302,7 +300,7 @@ bool EgcFlexNode::isLastChild(EgcNode &child) const
 EgcNode* EgcFlexNode::incrementToNextChild(EgcNode &previousChild) const
 {
         (void) previousChild;
-        int tempIndex = m_childs.indexOf(&previousChild);
+        int tempIndex = indexOfChild(&previousChild);
         quint32 i;
         quint32 index = static_cast<quint32>(tempIndex);
         quint32 nrChilds = static_cast<quint32>(m_childs.count());
@@ -321,7 +319,7 @@ EgcNode* EgcFlexNode::incrementToNextChild(EgcNode &previousChild) const
 EgcNode* EgcFlexNode::decrementToPrevChild(EgcNode &previousChild) const
 {
         (void) previousChild;
-        int tempIndex = m_childs.indexOf(&previousChild);
+        int tempIndex = indexOfChild(&previousChild);
         quint32 i;
         quint32 index = static_cast<quint32>(tempIndex);
 
@@ -339,7 +337,7 @@ EgcNode* EgcFlexNode::decrementToPrevChild(EgcNode &previousChild) const
 bool EgcFlexNode::getIndexOfChild(EgcNode& child, quint32& index) const
 {
         if (child.getParent() == this) {
-                int ind = m_childs.indexOf(&child);
+                int ind = indexOfChild(&child);
                 if (ind >= 0) {
                         index = static_cast<quint32>(ind);
                         return true;
@@ -418,3 +416,22 @@ bool EgcFlexNode::operator==(const EgcNode& node) const
         return retval;
 
 }
+
+int EgcFlexNode::indexOfChild(const EgcNode* child) const
+{
+        int count = m_childs.count();
+
+        // iterators and visitors mostly ask for the child found last or one of its neighbours, so check them first
+        for (int i = (m_indexHint > 0) ? m_indexHint - 1 : 0; i < count && i <= m_indexHint + 1; i++) {
+                if (m_childs.at(i) == child) {
+                        m_indexHint = i;
+                        return i;
+                }
+        }
+
+        int ind = m_childs.indexOf(const_cast<EgcNode*>(child));
+        if (ind >= 0)
+                m_indexHint = ind;
+
+        return ind;
+}
@@ -174,8 +174,17 @@ protected:
          * @param new_child child pointers of the current object will be adjusted to this child object.
          */
         virtual void adjustChildPointers(EgcNode &old_child, EgcNode &new_child) override;
+        /**
+         * @brief indexOfChild returns the index of the given child. Consecutive lookups of neighbouring childs (as
+         * done by the iterators) are answered in constant time, so that nodes with many childs (lists, matrices) can
+         * be traversed in linear time.
+         * @param child the child to search for
+         * @return the index of the child or -1 if the child is not a child of this node
+         */
+        int indexOfChild(const EgcNode* child) const;
 
         QVector<EgcNode*> m_childs;              //a vector that holds all childs of the FlexNode
+        mutable int m_indexHint;                 ///< index of the child found last by indexOfChild
 };
 
 #endif // EGCFLEXNODE_H
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egcnodecreator.h"
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
+#include "document/egcbinarydocument.h"
 
 
 EgcNode::EgcNode() : m_parent(nullptr)
@@ -111,7 +112,9 @@ void EgcNode::serialize(QXmlStreamWriter& stream, SerializerProperties &properti
         QLatin1String str = EgcNodeCreator::stringize(getNodeType());
         if (str.size() != 0) {
                 stream.writeStartElement(str);
-                serializeAttributes(stream);
+                QXmlStreamAttributes attr;
+                serializeAttributes(attr);
+                stream.writeAttributes(attr);
                 stream.writeEndElement(); // document
         }
 }
@@ -120,20 +123,39 @@ void EgcNode::deserialize(QXmlStreamReader& stream, SerializerProperties &proper
 {
         if (stream.name() == EgcNodeCreator::stringize(getNodeType())) {
                 QXmlStreamAttributes attr = stream.attributes();
-                deserializeAttributes(stream, properties.version, attr);
+                deserializeAttributes(properties.version, attr);
         }
 
         stream.skipCurrentElement();
 }
 
-void EgcNode::serializeAttributes(QXmlStreamWriter& stream)
+void EgcNode::serializeBinary(EgcBinaryDocument& document)
 {
-        (void) stream;
+        if (EgcNodeCreator::stringize(getNodeType()).size() != 0) {
+                QXmlStreamAttributes attr;
+                serializeAttributes(attr);
+                document.writeStartElement(getNodeType(), attr);
+                document.writeEndElement();
+        }
+}
+
+void EgcNode::deserializeBinary(EgcBinaryReader& reader, quint32 version)
+{
+        if (reader.nodeType() == getNodeType()) {
+                QXmlStreamAttributes attr = reader.attributes();
+                deserializeAttributes(version, attr);
+        }
+
+        reader.skipCurrentElement();
+}
+
+void EgcNode::serializeAttributes(QXmlStreamAttributes& attr)
+{
+        (void) attr;
 }
 
-void EgcNode::deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr)
+void EgcNode::deserializeAttributes(quint32 version, QXmlStreamAttributes& attr)
 {
-        (void) stream;
         (void) version;
         (void) attr;
 }
@@ -38,6 +38,8 @@ class QXmlStreamWriter;
 class QXmlStreamReader;
 class QXmlStreamAttributes;
 class SerializerProperties;
+class EgcBinaryDocument;
+class EgcBinaryReader;
 
 /**
  * @brief describes which side of the node is meant 
@@ -152,19 +154,29 @@ public:
          * @param version the version of the stream that is to be deserialized
          */
         virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties);
+        /**
+         * @brief serializeBinary interface for serializing a class directly into a binary document
+         * @param document the binary document to write to
+         */
+        virtual void serializeBinary(EgcBinaryDocument& document);
+        /**
+         * @brief deserializeBinary interface for deserializing a class directly from a binary document
+         * @param reader the reader positioned at the start element of this node
+         * @param version the version of the document that is to be deserialized
+         */
+        virtual void deserializeBinary(EgcBinaryReader& reader, quint32 version);
         /**
          * @brief interface for serializing the attributes of a formula operation
-         * @param stream the stream to use for serializing this class
+         * @param attr the attributes to add the attributes of this node to
          */
-        virtual void serializeAttributes(QXmlStreamWriter& stream) ;
+        virtual void serializeAttributes(QXmlStreamAttributes& attr) ;
 
         /**
          * @brief deserialize interface for deserializing the attributes of a formula operation
-         * @param stream the xml reader stream
          * @param version the version of the stream that is to be deserialized
          * @param attr the xml attributes provided by the parent
          */
-        virtual void deserializeAttributes(QXmlStreamReader& stream, quint32 version, QXmlStreamAttributes& attr);
+        virtual void deserializeAttributes(quint32 version, QXmlStreamAttributes& attr);
 
 protected:
 
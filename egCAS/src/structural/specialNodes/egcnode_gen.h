@@ -31,6 +31,8 @@ FncContainerNode,
 FunctionNode,
 NumberNode,
 DifferentialNode,
+ListNode,
+MatrixNode,
 EmptyNode,
 ArgumentsNode,
 BaseNode,
@@ -38,4 +40,77 @@ NodeUndefined
 //The list is generated automatically. Do NOT change it manually.
 };
 
+/**
+ * @brief The EgcNodeKind enum classifies the node types by the container base class they are derived from
+ */
+enum class EgcNodeKind : unsigned char
+{
+        Leaf = 0,       ///< the node has no childs (e.g. a number)
+        Unary,          ///< the node is derived from EgcUnaryNode
+        Binary,         ///< the node is derived from EgcBinaryNode
+        Flex            ///< the node is derived from EgcFlexNode
+};
+
+/**
+ * @brief The EgcNodeTraits struct holds the properties of a node type that are already known at build time
+ */
+struct EgcNodeTraits
+{
+        const char* m_name;     ///< name of the node type in lowercase, as used for serializing
+        int m_nameLength;       ///< the length of m_name
+        EgcNodeKind m_kind;     ///< the base class kind of the node type
+        int m_arity;            ///< the number of childs, -1 if the number of childs is variable
+};
+
+/**
+ * @brief s_egcNodeTraits holds the traits of all node types, indexed by EgcNodeType
+ *
+ * This list is generated form the cog python code below. Do not change it manually!!!
+ */
+constexpr EgcNodeTraits s_egcNodeTraits[] =
+{
+        {"lognode", 7, EgcNodeKind::Unary, 1},
+        {"rparenthesisnode", 16, EgcNodeKind::Unary, 1},
+        {"definitionnode", 14, EgcNodeKind::Binary, 2},
+        {"lparenthesisnode", 16, EgcNodeKind::Unary, 1},
+        {"equalnode", 9, EgcNodeKind::Binary, 2},
+        {"divisionnode", 12, EgcNodeKind::Binary, 2},
+        {"plusnode", 8, EgcNodeKind::Binary, 2},
+        {"binemptynode", 12, EgcNodeKind::Binary, 2},
+        {"multiplicationnode", 18, EgcNodeKind::Binary, 2},
+        {"natlognode", 10, EgcNodeKind::Unary, 1},
+        {"parenthesisnode", 15, EgcNodeKind::Unary, 1},
+        {"unaryminusnode", 14, EgcNodeKind::Unary, 1},
+        {"variablenode", 12, EgcNodeKind::Leaf, 0},
+        {"rootnode", 8, EgcNodeKind::Binary, 2},
+        {"alnumnode", 9, EgcNodeKind::Leaf, 0},
+        {"minusnode", 9, EgcNodeKind::Binary, 2},
+        {"integralnode", 12, EgcNodeKind::Flex, -1},
+        {"exponentnode", 12, EgcNodeKind::Binary, 2},
+        {"fnccontainernode", 16, EgcNodeKind::Flex, -1},
+        {"functionnode", 12, EgcNodeKind::Flex, -1},
+        {"numbernode", 10, EgcNodeKind::Leaf, 0},
+        {"differentialnode", 16, EgcNodeKind::Flex, -1},
+        {"listnode", 8, EgcNodeKind::Flex, -1},
+        {"matrixnode", 10, EgcNodeKind::Flex, -1},
+        {"emptynode", 9, EgcNodeKind::Leaf, 0},
+        {"argumentsnode", 13, EgcNodeKind::Flex, -1},
+        {"basenode", 8, EgcNodeKind::Unary, 1},
+        {"", 0, EgcNodeKind::Leaf, 0}
+//The list is generated automatically. Do NOT change it manually.
+};
+
+static_assert(sizeof(s_egcNodeTraits) / sizeof(EgcNodeTraits) == static_cast<unsigned int>(EgcNodeType::NodeUndefined) + 1u,
+              "the node traits table is out of sync with EgcNodeType");
+
+/**
+ * @brief egcNodeTraits returns the traits of the given node type
+ * @param type the node type to get the traits for
+ * @return a reference to the traits of the node type
+ */
+constexpr const EgcNodeTraits& egcNodeTraits(EgcNodeType type)
+{
+        return s_egcNodeTraits[static_cast<int>(type)];
+}
+
 #endif //#ifndef EGCNODETYPE_GEN_H
@@ -37,85 +37,87 @@ EgcMathmlLookup::EgcMathmlLookup()
 
 void EgcMathmlLookup::addId(EgcNode& node, quint32 id)
 {
-        m_lookup.insert(&node, id);
+        if (id >= static_cast<quint32>(m_nodes.size()))
+                m_nodes.resize(static_cast<int>(id) + 1);
+        m_nodes[static_cast<int>(id)] = &node;
+
+        EgcMathmlNodeIds& ids = m_lookup[&node];
+        if (ids.m_frameId == 0 || id < ids.m_frameId)
+                ids.m_frameId = id;
+        ids.m_ids.append(id);
 }
 
 void EgcMathmlLookup::clear(void)
 {
         m_lookup.clear();
+        // keep the capacity, since the lookup is rebuilt with every mathml generation
+        m_nodes.resize(0);
 }
 
 quint32 EgcMathmlLookup::getIdFrame(EgcNode& node) const
 {
-        quint32 retval = 0;
-
-        QHash<EgcNode*, quint32>::const_iterator i = m_lookup.find(&node);
-        while (i != m_lookup.end() && i.key() == &node) {
-                quint32 tmp = i.value();
-                if (retval != 0)
-                        retval = qMin(retval, tmp);
-                else
-                        retval = tmp;
-                ++i;
-        }
+        QHash<EgcNode*, EgcMathmlNodeIds>::const_iterator i = m_lookup.constFind(&node);
+        if (i == m_lookup.constEnd())
+                return 0;
 
-        return retval;
+        return i.value().m_frameId;
 }
 
 QList<quint32> EgcMathmlLookup::getIds(EgcNode& node) const
 {
-        return m_lookup.values(&node);
+        QHash<EgcNode*, EgcMathmlNodeIds>::const_iterator i = m_lookup.constFind(&node);
+        if (i == m_lookup.constEnd())
+                return QList<quint32>();
+
+        return i.value().m_ids.toList();
 }
 
 QList<quint32> EgcMathmlLookup::getIdsNonFrame(EgcNode& node) const
 {
-        quint32 id = 0;
         QList<quint32> list;
 
-        QHash<EgcNode*, quint32>::const_iterator i = m_lookup.find(&node);
-        while (i != m_lookup.end() && i.key() == &node) {
-                quint32 tmp = i.value();
-                if (id != 0)
-                        id = qMin(id, tmp);
-                else
-                        id = tmp;
-                list.append(id);
-                ++i;
-        }
+        QHash<EgcNode*, EgcMathmlNodeIds>::const_iterator i = m_lookup.constFind(&node);
+        if (i == m_lookup.constEnd())
+                return list;
 
-        if (!list.empty() && id != 0)
-                list.removeAll(id);
+        const EgcMathmlNodeIds& ids = i.value();
+        foreach (quint32 id, ids.m_ids) {
+                if (id != ids.m_frameId)
+                        list.append(id);
+        }
 
         return list;
 }
 
 int EgcMathmlLookup::getIdCount(EgcNode& node) const
 {
-        return m_lookup.values(&node).size();
+        QHash<EgcNode*, EgcMathmlNodeIds>::const_iterator i = m_lookup.constFind(&node);
+        if (i == m_lookup.constEnd())
+                return 0;
+
+        return i.value().m_ids.size();
 }
 
 EgcNode* EgcMathmlLookup::findNode(quint32 id) const
 {
-        QHash<EgcNode*, quint32>::const_iterator i = m_lookup.begin();
-        while (i != m_lookup.end()) {
-            if (i.value() == id)
-                    return i.key();
-            ++i;
-        }
+        if (id >= static_cast<quint32>(m_nodes.size()))
+                return nullptr;
 
-        return nullptr;
+        return m_nodes.at(static_cast<int>(id));
 }
 
 QList<QPair<EgcNode*, quint32>> EgcMathmlLookup::getList (void) const
 {
         QList<QPair<EgcNode*, quint32>> list;
 
-        QHash<EgcNode*, quint32>::const_iterator i = m_lookup.begin();
-        while (i != m_lookup.end()) {
-                QPair<EgcNode*, quint32> pair;
-                pair.first = i.key();
-                pair.second = i.value();
-                list.append(pair);
+        QHash<EgcNode*, EgcMathmlNodeIds>::const_iterator i = m_lookup.constBegin();
+        while (i != m_lookup.constEnd()) {
+                foreach (quint32 id, i.value().m_ids) {
+                        QPair<EgcNode*, quint32> pair;
+                        pair.first = i.key();
+                        pair.second = id;
+                        list.append(pair);
+                }
                 ++i;
         }
 
@@ -124,5 +126,13 @@ QList<QPair<EgcNode*, quint32>> EgcMathmlLookup::getList (void) const
 
 void EgcMathmlLookup::removeId(EgcNode* node)
 {
-        m_lookup.remove(node);
+        QHash<EgcNode*, EgcMathmlNodeIds>::iterator i = m_lookup.find(node);
+        if (i == m_lookup.end())
+                return;
+
+        foreach (quint32 id, i.value().m_ids) {
+                if (id < static_cast<quint32>(m_nodes.size()) && m_nodes.at(static_cast<int>(id)) == node)
+                        m_nodes[static_cast<int>(id)] = nullptr;
+        }
+        m_lookup.erase(i);
 }
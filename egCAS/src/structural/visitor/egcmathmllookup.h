@@ -30,13 +30,28 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #ifndef EGCMATHMLLOOKUP_H
 #define EGCMATHMLLOOKUP_H
 
-#include <QMultiHash>
+#include <QHash>
+#include <QVector>
 #include <QList>
 #include <QPair>
 
 class EgcNode;
 
+/**
+ * @brief The EgcMathmlNodeIds class holds all mathml id's of a node. The frame id is stored separately.
+ */
+class EgcMathmlNodeIds
+{
+public:
+        EgcMathmlNodeIds() : m_frameId{0} {}
+        quint32 m_frameId;              ///< the id of the frame of the mathml element (the lowest id of the node)
+        QVector<quint32> m_ids;         ///< all id's of the node in the order they have been added
+};
 
+/**
+ * @brief The EgcMathmlLookup class maps the nodes of a formula to the mathml id's (and back). The lookup is built up
+ * while generating the mathml code (see EgcMathMlVisitor).
+ */
 class EgcMathmlLookup
 {
 public:
@@ -70,7 +85,8 @@ public:
          */
         QList<quint32> getIds(EgcNode& node) const;
         /**
-         * @brief getIdsNonFrame returns a list with all mathml id's associated with the given node without the frame id.
+         * @brief getIdsNonFrame returns a list with all mathml id's associated with the given node without the frame id
+         * (in the order they have been added).
          * @param node is the node we want the id's for
          * @return a list with the id's without the frame id of the mathml element. The list can be empty.
          */
@@ -82,7 +98,7 @@ public:
          */
         int getIdCount(EgcNode& node) const;
         /**
-         * @brief findNode returns the node for the given id. Warning: This function can be slow!
+         * @brief findNode returns the node for the given id.
          * @param id the mathml id we want the node for
          * @return the node found for the given id, or nullptr in case when the node has not been found
          */
@@ -93,7 +109,8 @@ public:
          */
         QList<QPair<EgcNode*, quint32> > getList(void) const;
 private:
-        QMultiHash<EgcNode*, quint32> m_lookup;      ///< lookup to be able to make a relation of any mathml id to the nodes of the formula
+        QHash<EgcNode*, EgcMathmlNodeIds> m_lookup;     ///< lookup to be able to make a relation of the nodes of the formula to any mathml id
+        QVector<EgcNode*> m_nodes;                      ///< dense lookup of the nodes, the mathml id is the index
 };
 
 #endif // EGCMATHMLLOOKUP_H
@@ -265,6 +265,25 @@ void EgcMathMlVisitor::visit(EgcFlexNode* node)
                         }
                 }
                 break;
+        case EgcNodeType::ListNode:
+                if (m_state == EgcIteratorState::LeftIteration) {
+                        // don't show the placeholder of an empty list
+                        if (node->getNumberChildNodes() == 1 && !m_formula->isActive())
+                                suppressChildIfChildValue(node, 0, EgcNodeType::EmptyNode, "");
+                } else if (m_state == EgcIteratorState::RightIteration) {
+                        id = getId(node);
+                        assembleResult("<mrow "%id%"><mo" %id%">[</mo><mrow>", "<mo" %id%">,</mo>",
+                                       "</mrow><mo" %id%">]</mo></mrow>", node);
+                }
+                break;
+        case EgcNodeType::MatrixNode:
+                if (m_state == EgcIteratorState::RightIteration) {
+                        id = getId(node);
+                        assembleRows("<mrow "%id%"><mo" %id%">(</mo><mtable>", "<mtr><mtd>", "</mtd><mtd>",
+                                     "</mtd></mtr>", "", "</mtable><mo" %id%">)</mo></mrow>",
+                                     static_cast<EgcMatrixNode*>(node)->getColumns(), node);
+                }
+                break;
         case EgcNodeType::ArgumentsNode:
                 break;
         default:
@@ -82,8 +82,13 @@ void EgcMaximaVisitor::visit(EgcBinaryNode* binary)
                 break;
         }
         case EgcNodeType::DefinitionNode:
-                if (m_state == EgcIteratorState::RightIteration)
-                        assembleResult("%1:%2", binary);
+                if (m_state == EgcIteratorState::RightIteration) {
+                        EgcNode* lhs = binary->getChild(0);
+                        if (lhs && lhs->getNodeType() == EgcNodeType::FunctionNode)
+                                assembleResult("%1:=%2", binary);
+                        else
+                                assembleResult("%1:%2", binary);
+                }
                 break;
         case EgcNodeType::BinEmptyNode:
                 if (m_state == EgcIteratorState::RightIteration)
@@ -144,6 +149,15 @@ void EgcMaximaVisitor::visit(EgcFlexNode* flex)
                                 assembleResult("romberg(%3,%4,%1,%2)", flex);
                 }
                 break;
+        case EgcNodeType::ListNode:
+                if (m_state == EgcIteratorState::RightIteration)
+                        assembleResult("[", ",", "]", flex);
+                break;
+        case EgcNodeType::MatrixNode:
+                if (m_state == EgcIteratorState::RightIteration)
+                        assembleRows("matrix(", "[", ",", "]", ",", ")",
+                                     static_cast<EgcMatrixNode*>(flex)->getColumns(), flex);
+                break;
         case EgcNodeType::DifferentialNode:
                 if (m_state == EgcIteratorState::RightIteration) {
                         EgcDifferentialNode* diff = static_cast<EgcDifferentialNode*>(flex);
@@ -185,35 +199,10 @@ QString EgcMaximaVisitor::getResult(void)
         m_suppressList.clear();
         QString tmp = EgcNodeVisitor::getResult();
 
-        if (m_formula) {
-                quint8 nrDigits = m_formula->getNumberOfSignificantDigits();
-                if (nrDigits == 1 || nrDigits > 16)
-                        nrDigits = 0;
-
-                // use standard digits if nothing is set for the formula
-                if (nrDigits == 0)
-                        nrDigits = EgcFormulaEntity::getStdNrSignificantDigis();
-
-                QString tmpOptions = QString("fpprintprec:%1$").arg(nrDigits);
-
-                switch(m_formula->getNumberResultType()) {
-                case EgcNumberResultType::IntegerType:
-                        tmp = tmpOptions + "round(" + tmp + ")";
-                        tmp += QString(";");
-                        break;
-                case EgcNumberResultType::ScientificType:
-                        tmp = tmpOptions + "float(" + tmp + ")";
-                        tmp += QString(";");
-                        break;
-                case EgcNumberResultType::EngineeringType:
-                        tmp = tmpOptions + "engineering_format_floats:true$float(" + tmp + ");engineering_format_floats:false$";
-                        break;
-                default:
-                        tmp = tmpOptions + tmp;
-                        tmp += QString(";");
-                        break;
-                }
-        }
+        // the result is returned with full precision, the formatting (number of digits, result type) is done
+        // locally, so changing it doesn't need the kernel
+        if (m_formula)
+                tmp += QString(";");
 
 #ifdef DEBUG_KERNEL_COMMAND_GENERATION
         qDebug() << "kernel command output of visitor: " << tmp;
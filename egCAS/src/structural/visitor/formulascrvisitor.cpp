@@ -227,6 +227,29 @@ void FormulaScrVisitor::visit(EgcFlexNode* flex)
                         appendSegmented(")", flex->getChild(flex->getNumberChildNodes() - 1), CursorAdhesion::low, 0, false, flex, 0, false);
                 }
                 break;
+        case EgcNodeType::ListNode:
+                if (m_state == EgcIteratorState::LeftIteration) {
+                        appendSegmented("[", flex, CursorAdhesion::low, 0, true, flex->getChild(0), 0, true);
+                } else if (m_state == EgcIteratorState::MiddleIteration) {
+                        append(",", flex->getChild(m_childIndex), CursorAdhesion::low, 0, false, flex->getChild(m_childIndex + 1), 0, true);
+                } else {
+                        appendSegmented("]", flex->getChild(flex->getNumberChildNodes() - 1), CursorAdhesion::low, 0, false, flex, 0, false);
+                }
+                break;
+        case EgcNodeType::MatrixNode:
+                if (m_state == EgcIteratorState::LeftIteration) {
+                        appendSegmented("matrix([", flex, CursorAdhesion::low, 0, true, flex->getChild(0), 0, true);
+                } else if (m_state == EgcIteratorState::MiddleIteration) {
+                        quint32 columns = static_cast<EgcMatrixNode*>(flex)->getColumns();
+                        // the end of a row is the end of the list of the row (kernel syntax)
+                        if (columns && (m_childIndex + 1) % columns == 0)
+                                appendSegmented("],[", flex->getChild(m_childIndex), CursorAdhesion::low, 0, false, flex->getChild(m_childIndex + 1), 0, true);
+                        else
+                                append(",", flex->getChild(m_childIndex), CursorAdhesion::low, 0, false, flex->getChild(m_childIndex + 1), 0, true);
+                } else {
+                        appendSegmented("])", flex->getChild(flex->getNumberChildNodes() - 1), CursorAdhesion::low, 0, false, flex, 0, false);
+                }
+                break;
         case EgcNodeType::DifferentialNode:
                 if (m_state == EgcIteratorState::LeftIteration) {
                         EgcDifferentialNode &diff = *static_cast<EgcDifferentialNode*>(flex);
@@ -157,6 +157,43 @@ void VisitorHelper::assembleResult(QString startString, QString seperationString
                 m_stack.push(result);
 }
 
+void VisitorHelper::assembleRows(QString startString, QString rowStartString, QString seperationString,
+                                 QString rowEndString, QString rowSeperationString, QString endString,
+                                 quint32 columns, EgcNode* node)
+{
+        QString result = startString;
+        quint32 nrArguments = 0;
+
+        QVector<QString> args = getAssembleArguments(node);
+        nrArguments = static_cast<quint32>(args.size());
+        if (nrArguments == 0)
+                return;
+
+        if (columns == 0)
+                columns = nrArguments;
+
+        for (quint32 i = 0; i < nrArguments; i++) {
+                quint32 column = i % columns;
+                if (column == 0) {
+                        if (i != 0)
+                                result += rowSeperationString;
+                        result += rowStartString;
+                } else {
+                        result += seperationString;
+                }
+                result += args.at(static_cast<int>(i));
+                if (column == columns - 1 || i == nrArguments - 1)
+                        result += rowEndString;
+        }
+
+        result += endString;
+
+        result = modifyNodeString(result, node);
+
+        if (!m_suppressList.contains(node))
+                m_stack.push(result);
+}
+
 void VisitorHelper::deleteFromStack(quint32 nrStackObjects)
 {
         quint32 i;
@@ -77,6 +77,22 @@ protected:
          */
         virtual void assembleResult(QString lStartString, QString rStartString, QString seperationString,
                                             QString endString, EgcNode* node);
+        /**
+         * @brief assembleRows assemble the result string of a node whose childs are arranged in rows (row-major order),
+         * e.g. a matrix. E.g. it can be used with the following maxima matrix:
+         * assembleRows("matrix(", "[", ",", "]", ",", ")", columns, node);
+         * @param startString the start string of the node
+         * @param rowStartString the string that starts each row
+         * @param seperationString the separation string that is used between the childs of a row
+         * @param rowEndString the string that ends each row
+         * @param rowSeperationString the separation string that is used between the rows
+         * @param endString the end string of the node
+         * @param columns the number of childs per row
+         * @param node the node we are currently operating on
+         */
+        virtual void assembleRows(QString startString, QString rowStartString, QString seperationString,
+                                  QString rowEndString, QString rowSeperationString, QString endString,
+                                  quint32 columns, EgcNode* node);
 
         /**
          * @brief pushToStack push results to the stack. This function (and not the QStack push function) must be used
@@ -0,0 +1,212 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QStringBuilder>
+#include "egcnumberformatter.h"
+#include "entities/egcformulaentity.h"
+
+QString EgcNumberFormatter::format(const QString& number, EgcNumberResultType type, quint8 digits)
+{
+        bool negative;
+        QString significant;
+        int exponent;
+        if (!parse(number, negative, significant, exponent))
+                return number;
+
+        // one significant digit is not supported (same as in the precision selection)
+        int prec = digits;
+        if (prec <= 1)
+                prec = 0;
+
+        QString result;
+        switch (type) {
+        case EgcNumberResultType::IntegerType:
+                round(significant, exponent, exponent + 1);
+                result = positional(significant, exponent);
+                break;
+        case EgcNumberResultType::ScientificType:
+        case EgcNumberResultType::EngineeringType:
+                if (prec)
+                        round(significant, exponent, prec);
+                result = exponential(significant, exponent, (type == EgcNumberResultType::ScientificType) ? 1 : 3);
+                break;
+        default:
+                // standard results are only rounded if they are floats and the user requested a number of digits
+                if (!isFloat(number) || !prec)
+                        return number;
+                round(significant, exponent, prec);
+                // same notation as printf with %g
+                if (exponent < -4 || exponent >= prec)
+                        result = exponential(significant, exponent, 1);
+                else
+                        result = trimZeros(positional(significant, exponent));
+                break;
+        }
+
+        if (negative && !significant.isEmpty())
+                result.prepend(QLatin1Char('-'));
+
+        return result;
+}
+
+bool EgcNumberFormatter::isFloat(const QString& number)
+{
+        return    number.contains(QLatin1Char('.')) || number.contains(QLatin1Char('e'))
+               || number.contains(QLatin1Char('E')) || number.contains(QLatin1Char('b'));
+}
+
+bool EgcNumberFormatter::parse(const QString& number, bool& negative, QString& digits, int& exponent)
+{
+        QString str = number.trimmed();
+        int i = 0;
+        int len = str.length();
+
+        negative = false;
+        if (i < len && (str.at(i) == QLatin1Char('-') || str.at(i) == QLatin1Char('+'))) {
+                negative = (str.at(i) == QLatin1Char('-'));
+                i++;
+        }
+
+        // the mantissa with an optional decimal point, the position of the point is counted in intDigits
+        QString mantissa;
+        int intDigits = -1;
+        for (; i < len; i++) {
+                QChar c = str.at(i);
+                if (c.isDigit() && c.unicode() < 128) {
+                        mantissa += c;
+                } else if (c == QLatin1Char('.') && intDigits < 0) {
+                        intDigits = mantissa.length();
+                } else {
+                        break;
+                }
+        }
+        if (mantissa.isEmpty())
+                return false;
+        if (intDigits < 0)
+                intDigits = mantissa.length();
+
+        // the exponent (the kernel marks big floats with a "b" exponent)
+        int exp = 0;
+        if (i < len) {
+                QChar c = str.at(i);
+                if (c != QLatin1Char('e') && c != QLatin1Char('E') && c != QLatin1Char('b') && c != QLatin1Char('B'))
+                        return false;
+                bool ok;
+                exp = str.mid(i + 1).toInt(&ok);
+                if (!ok)
+                        return false;
+        }
+
+        // strip leading and trailing zeros, they are not significant
+        int first = 0;
+        while (first < mantissa.length() && mantissa.at(first) == QLatin1Char('0'))
+                first++;
+        digits = mantissa.mid(first);
+        while (digits.endsWith(QLatin1Char('0')))
+                digits.chop(1);
+        exponent = intDigits - first - 1 + exp;
+
+        return true;
+}
+
+void EgcNumberFormatter::round(QString& digits, int& exponent, int count)
+{
+        if (digits.length() <= count)
+                return;
+
+        if (count < 0) {
+                digits.clear();
+                return;
+        }
+
+        bool up = digits.at(count) >= QLatin1Char('5');
+        digits.truncate(count);
+        if (up) {
+                int i = count - 1;
+                while (i >= 0 && digits.at(i) == QLatin1Char('9')) {
+                        digits[i] = QLatin1Char('0');
+                        i--;
+                }
+                if (i >= 0) {
+                        digits[i] = QChar(digits.at(i).unicode() + 1);
+                } else {
+                        // all digits were 9 (e.g. 9.99 -> 10.0)
+                        digits.prepend(QLatin1Char('1'));
+                        exponent++;
+                }
+        }
+
+        while (digits.endsWith(QLatin1Char('0')))
+                digits.chop(1);
+}
+
+QString EgcNumberFormatter::positional(const QString& digits, int exponent)
+{
+        if (digits.isEmpty())
+                return QString("0");
+
+        if (exponent < 0)
+                return QLatin1String("0.") % QString(-exponent - 1, QLatin1Char('0')) % digits;
+
+        QString integer = digits.left(exponent + 1);
+        if (integer.length() < exponent + 1)
+                integer += QString(exponent + 1 - integer.length(), QLatin1Char('0'));
+        QString decimals = digits.mid(exponent + 1);
+        if (decimals.isEmpty())
+                return integer;
+
+        return integer % QLatin1String(".") % decimals;
+}
+
+QString EgcNumberFormatter::exponential(const QString& digits, int exponent, int step)
+{
+        if (digits.isEmpty())
+                return QString("0.0");
+
+        // round down to a multiple of step (also for negative exponents)
+        int exp = exponent - (((exponent % step) + step) % step);
+        QString result = trimZeros(positional(digits, exponent - exp));
+        if (exp != 0)
+                result += QLatin1String("e") % QString::number(exp);
+
+        return result;
+}
+
+QString EgcNumberFormatter::trimZeros(QString mantissa)
+{
+        if (!mantissa.contains(QLatin1Char('.')))
+                return mantissa + QLatin1String(".0");
+
+        while (mantissa.endsWith(QLatin1Char('0')))
+                mantissa.chop(1);
+        if (mantissa.endsWith(QLatin1Char('.')))
+                mantissa += QLatin1Char('0');
+
+        return mantissa;
+}
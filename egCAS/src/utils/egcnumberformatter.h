@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCNUMBERFORMATTER_H
+#define EGCNUMBERFORMATTER_H
+
+#include <QString>
+
+enum class EgcNumberResultType;
+
+/**
+ * @brief The EgcNumberFormatter class formats the numbers of calculation results for displaying them to the user. The
+ * kernel always returns the results with full precision, so changing the format doesn't need a new calculation.
+ */
+class EgcNumberFormatter {
+public:
+        /**
+         * @brief format formats the given number with the given result type and number of significant digits
+         * @param number the number to format as returned by the kernel (e.g. "31084.81900000001" or "1.5e-7")
+         * @param type the result type to use (standard, integer, scientific, engineering)
+         * @param digits the number of significant digits, 0 for all digits the kernel returned
+         * @return the formatted number, or the number unchanged if it cannot be converted
+         */
+        static QString format(const QString& number, EgcNumberResultType type, quint8 digits);
+        /**
+         * @brief isFloat checks if the given number is a floating point number (and not an integer)
+         * @param number the number to check
+         * @return true if the number is a floating point number, false otherwise
+         */
+        static bool isFloat(const QString& number);
+private:
+        /**
+         * @brief parse splits the given decimal number into its significant digits and the exponent of the first digit,
+         * e.g. "-0.0123" is split into "123" and -2. Nothing is converted to a floating point type, so no digits of
+         * big floats are lost.
+         * @param number the number to parse
+         * @param negative is set to true if the number is negative
+         * @param digits the significant digits without leading and trailing zeros (empty if the number is zero)
+         * @param exponent the decimal exponent of the first significant digit
+         * @return true if the number could be parsed, false otherwise (e.g. if it's no number)
+         */
+        static bool parse(const QString& number, bool& negative, QString& digits, int& exponent);
+        /**
+         * @brief round rounds the digits to the given number of significant digits (round half up)
+         * @param digits the significant digits to round
+         * @param exponent the decimal exponent of the first digit, is incremented if the rounding carries over
+         * @param count the number of significant digits to keep (0 or less if the first digit is already rounded)
+         */
+        static void round(QString& digits, int& exponent, int count);
+        /**
+         * @brief positional writes the digits in positional notation
+         * @param digits the significant digits
+         * @param exponent the decimal exponent of the first digit
+         * @return the digits in positional notation, without decimals if there are none
+         */
+        static QString positional(const QString& digits, int exponent);
+        /**
+         * @brief exponential writes the digits in exponential notation
+         * @param digits the significant digits
+         * @param exponent the decimal exponent of the first digit
+         * @param step the exponent will be a multiple of step (1 for scientific, 3 for engineering notation)
+         * @return the digits in exponential notation
+         */
+        static QString exponential(const QString& digits, int exponent, int step);
+        /**
+         * @brief trimZeros removes trailing zeros of the decimals (but keeps at least one decimal)
+         * @param mantissa the number to trim
+         * @return the trimmed number
+         */
+        static QString trimZeros(QString mantissa);
+};
+
+#endif // EGCNUMBERFORMATTER_H
@@ -0,0 +1,105 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QStringBuilder>
+#include "egcperfcounter.h"
+
+qint64 EgcPerfCounter::s_nsecs[static_cast<int>(EgcPerfPhase::NrPhases)] = {};
+quint64 EgcPerfCounter::s_count[static_cast<int>(EgcPerfPhase::NrPhases)] = {};
+
+void EgcPerfCounter::add(EgcPerfPhase phase, qint64 nsecs)
+{
+        if (phase >= EgcPerfPhase::NrPhases)
+                return;
+
+        s_nsecs[static_cast<int>(phase)] += nsecs;
+        s_count[static_cast<int>(phase)]++;
+}
+
+qint64 EgcPerfCounter::getNsecs(EgcPerfPhase phase)
+{
+        if (phase >= EgcPerfPhase::NrPhases)
+                return 0;
+
+        return s_nsecs[static_cast<int>(phase)];
+}
+
+quint64 EgcPerfCounter::getCount(EgcPerfPhase phase)
+{
+        if (phase >= EgcPerfPhase::NrPhases)
+                return 0;
+
+        return s_count[static_cast<int>(phase)];
+}
+
+void EgcPerfCounter::reset(void)
+{
+        for (int i = 0; i < static_cast<int>(EgcPerfPhase::NrPhases); i++) {
+                s_nsecs[i] = 0;
+                s_count[i] = 0;
+        }
+}
+
+QString EgcPerfCounter::getPhaseName(EgcPerfPhase phase)
+{
+        switch (phase) {
+        case EgcPerfPhase::ScrVisitor:
+                return QString("FormulaScrVisitor");
+        case EgcPerfPhase::Parser:
+                return QString("parser");
+        case EgcPerfPhase::TreeReplace:
+                return QString("tree replacement");
+        case EgcPerfPhase::MathMlGeneration:
+                return QString("mathml generation");
+        case EgcPerfPhase::Layout:
+                return QString("layout");
+        case EgcPerfPhase::Paint:
+                return QString("paint");
+        default:
+                return QString();
+        }
+}
+
+QString EgcPerfCounter::report(void)
+{
+        QString retval;
+
+        for (int i = 0; i < static_cast<int>(EgcPerfPhase::NrPhases); i++) {
+                EgcPerfPhase phase = static_cast<EgcPerfPhase>(i);
+                qint64 avg = 0;
+                if (s_count[i])
+                        avg = s_nsecs[i] / static_cast<qint64>(s_count[i]);
+                retval = retval % getPhaseName(phase).leftJustified(20, ' ') % QString(" calls: ")
+                         % QString::number(s_count[i]).rightJustified(8, ' ') % QString("  total [us]: ")
+                         % QString::number(s_nsecs[i] / 1000).rightJustified(10, ' ') % QString("  avg [us]: ")
+                         % QString::number(avg / 1000).rightJustified(8, ' ') % QString("\n");
+        }
+
+        return retval;
+}
@@ -0,0 +1,130 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCPERFCOUNTER_H
+#define EGCPERFCOUNTER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QElapsedTimer>
+
+/**
+ * @brief The EgcPerfPhase enum lists the phases a keystroke passes through until the formula is painted again
+ */
+enum class EgcPerfPhase
+{
+        ScrVisitor = 0,         ///< serialization of the formula with the FormulaScrVisitor
+        Parser,                 ///< restructuring of the formula string with the kernel parser
+        TreeReplace,            ///< replacing the formula tree with the newly parsed one
+        MathMlGeneration,       ///< generation of the mathml code with the EgcMathMlVisitor
+        Layout,                 ///< setting the mathml content and layouting the formula
+        Paint,                  ///< painting the formula and collecting the rendering positions
+        NrPhases                ///< number of phases, must be the last entry
+};
+
+/**
+ * @brief The EgcPerfCounter class accumulates the time spent in the different phases of the editing pipeline. The
+ * counters are only fed if EGC_PERF_COUNTERS is defined, otherwise the macros below compile to nothing.
+ */
+class EgcPerfCounter
+{
+public:
+        /**
+         * @brief add adds the given time to the accumulated time of a phase
+         * @param phase the phase to add the time to
+         * @param nsecs the time in nanoseconds
+         */
+        static void add(EgcPerfPhase phase, qint64 nsecs);
+        /**
+         * @brief getNsecs returns the accumulated time of a phase
+         * @param phase the phase to return the time of
+         * @return the accumulated time in nanoseconds
+         */
+        static qint64 getNsecs(EgcPerfPhase phase);
+        /**
+         * @brief getCount returns how often the given phase has been passed through
+         * @param phase the phase to return the count of
+         * @return the number of measurements of the given phase
+         */
+        static quint64 getCount(EgcPerfPhase phase);
+        /**
+         * @brief reset resets all counters
+         */
+        static void reset(void);
+        /**
+         * @brief getPhaseName returns a human readable name of the given phase
+         * @param phase the phase to return the name of
+         * @return the name of the phase
+         */
+        static QString getPhaseName(EgcPerfPhase phase);
+        /**
+         * @brief report returns a table with the accumulated times of all phases (used by the benchmarks)
+         * @return a string with one line per phase
+         */
+        static QString report(void);
+private:
+        static qint64 s_nsecs[static_cast<int>(EgcPerfPhase::NrPhases)];        ///< accumulated time per phase
+        static quint64 s_count[static_cast<int>(EgcPerfPhase::NrPhases)];       ///< number of measurements per phase
+};
+
+/**
+ * @brief The EgcPerfScope class measures the time between its construction and destruction (or a call to stop) and
+ * adds it to the given phase
+ */
+class EgcPerfScope
+{
+public:
+        explicit EgcPerfScope(EgcPerfPhase phase) : m_phase{phase}, m_running{true} { m_timer.start(); }
+        ~EgcPerfScope() { stop(); }
+        /**
+         * @brief switchTo finishes the measurement of the current phase and starts measuring the given phase
+         * @param phase the phase to measure next
+         */
+        void switchTo(EgcPerfPhase phase) { stop(); m_phase = phase; m_running = true; m_timer.start(); }
+        /**
+         * @brief stop finishes the measurement of the current phase
+         */
+        void stop(void) { if (m_running) EgcPerfCounter::add(m_phase, m_timer.nsecsElapsed()); m_running = false; }
+private:
+        QElapsedTimer m_timer;          ///< timer for measuring the phase
+        EgcPerfPhase m_phase;           ///< the phase currently measured
+        bool m_running;                 ///< true if a measurement is running
+};
+
+#ifdef EGC_PERF_COUNTERS
+#define EGC_PERF_SCOPE(name, phase) EgcPerfScope name(phase)
+#define EGC_PERF_SWITCH(name, phase) name.switchTo(phase)
+#define EGC_PERF_STOP(name) name.stop()
+#else
+#define EGC_PERF_SCOPE(name, phase)
+#define EGC_PERF_SWITCH(name, phase)
+#define EGC_PERF_STOP(name)
+#endif //#ifdef EGC_PERF_COUNTERS
+
+#endif // EGCPERFCOUNTER_H
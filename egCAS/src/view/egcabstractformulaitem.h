@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QHash>
 #include <QLineF>
+#include <QSizeF>
 #include "egcasiteminterface.h"
 
 class EgcNode;
@@ -48,6 +49,17 @@ public:
          * @brief updateView update the view with the new mathml representation if anything changes
          */
         virtual void updateView(void) = 0;
+        /**
+         * @brief updateViewLazy defers the layout of the formula until it approaches the visible area of the view.
+         * Until then the given size is used as an estimate of the formula dimensions.
+         * @param estimatedSize the estimated (e.g. persisted) size of the formula, an invalid size if unknown
+         */
+        virtual void updateViewLazy(QSizeF estimatedSize) = 0;
+        /**
+         * @brief getLayoutSize returns the size of the formula layout (or the estimate if it is not laid out yet)
+         * @return the size of the formula
+         */
+        virtual QSizeF getLayoutSize(void) const = 0;
         /**
          * @brief paintUnderline paint the underline that marks any mathml node adressed by the mathml id, to be able
          * to show the user the context of his operation (e.g. keystroke).
@@ -66,6 +66,12 @@ public:
          * @return the pixmap of the current item
          */
         virtual QPixmap getPixmap(void) = 0;
+        /**
+         * @brief setPendingPixmap announces a pixmap of the given size that isn't decoded yet. The item asks its entity
+         * to decode the pixmap (see EgcAbstractPixmapEntity::decodePixmap) when it is needed the first time.
+         * @param size the size of the pixmap in pixels
+         */
+        virtual void setPendingPixmap(QSize size) = 0;
 };
 
 #endif // EGCABSTRACTPIXMAPITEM_H
@@ -0,0 +1,59 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCABSTRACTPLOTITEM_H
+#define EGCABSTRACTPLOTITEM_H
+
+#include <QVector>
+#include <QRectF>
+#include <QString>
+#include "egcasiteminterface.h"
+
+class EgcAbstractPlotItem : public EgcasItemInterface
+{
+public:
+        /**
+         * @brief ~EgcAbstractPlotItem virtual destructor in order to be able to delete subclasses
+         */
+        virtual ~EgcAbstractPlotItem() {}
+        /**
+         * @brief setCurve sets the samples of the curve to show
+         * @param x the x values of the samples (ascending)
+         * @param y the y values of the samples (NaN where the curve has a gap)
+         * @param range the range of the plot (left/right are the x range, top/bottom the y range)
+         */
+        virtual void setCurve(const QVector<double>& x, const QVector<double>& y, const QRectF& range) = 0;
+        /**
+         * @brief setCaption sets the text shown above the plot (the expression or an error message)
+         * @param caption the caption to show
+         */
+        virtual void setCaption(const QString& caption) = 0;
+};
+
+#endif // EGCABSTRACTPLOTITEM_H
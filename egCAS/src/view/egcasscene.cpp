@@ -32,20 +32,26 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QGraphicsSceneEvent>
 #include <QKeyEvent>
 #include <QGraphicsView>
+#include <QStyleOptionGraphicsItem>
+#include <QPaintDevice>
 #include "egcasscene.h"
 #include "egctextitem.h"
 #include "egcpixmapitem.h"
+#include "egctableitem.h"
+#include "egcplotitem.h"
 #include "egcformulaitem.h"
 #include "egccrossitem.h"
 #include "actions/egcactionmapper.h"
 #include "egcitemtypes.h"
+#include "document/egcsessionrecorder.h"
 
 
 using namespace egcas;
 
 EgCasScene::EgCasScene(EgcAbstractDocument& doc, QObject *parent) :
         m_grid{*this, QSizeF(29.0, 29.0)}, m_worksheet{*this}, m_document{doc}, QGraphicsScene{parent},
-        m_cursor{addLine(0,0,0,0,QPen(QColor(Qt::red)))}, m_nodeUnderline{addLine(0,0,0,0,QPen(QColor(Qt::red)))}
+        m_cursor{addLine(0,0,0,0,QPen(QColor(Qt::red)))}, m_nodeUnderline{addLine(0,0,0,0,QPen(QColor(Qt::red)))},
+        m_bgTileScale{0.0}
 {        
         m_cursor->setPen(QPen(QBrush(QColor(Qt::red)), 2.0));
         m_nodeUnderline->setPen(QPen(QBrush(QColor(Qt::red)), 2.0));
@@ -74,6 +80,24 @@ void EgCasScene::setGrid(QSizeF grid)
         grid.setHeight(sheetHeight / divisor);
         grid.setWidth(grid.height());
         m_grid.setGrid(grid);
+        invalidateBackground();
+}
+
+void EgCasScene::invalidateBackground(void)
+{
+        m_bgTiles.clear();
+        invalidate(sceneRect(), QGraphicsScene::BackgroundLayer);
+}
+
+void EgCasScene::materializeItems(const QRectF& rect)
+{
+        // all formulas of the area are painted, so none of them may be released while laying out the others
+        EgcFormulaItem::beginMaterializePass();
+        foreach (QGraphicsItem* item, items(rect, Qt::IntersectsItemBoundingRect)) {
+                if (item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType))
+                        static_cast<EgcFormulaItem*>(item)->materialize();
+        }
+        EgcFormulaItem::endMaterializePass();
 }
 
 void EgCasScene::drawHorizontalLines(QPainter*painter, const QRectF& rect, qreal leftX, qreal rightX)
@@ -162,6 +186,13 @@ void EgCasScene::drawBackground(QPainter*painter, const QRectF&rect)
         if (nrPages < 1)
                 return;
 
+        // scrolling only blits the cached tiles, printing still paints the lines directly
+        if (!drawBackgroundTiles(painter, rect, nrPages))
+                paintBackground(painter, rect);
+}
+
+void EgCasScene::paintBackground(QPainter* painter, const QRectF&rect)
+{
         qreal leftX = m_worksheet.getLeftMargin();
         qreal rightX = m_worksheet.getSize().width() - m_worksheet.getRightMargin();
 
@@ -177,6 +208,78 @@ void EgCasScene::drawBackground(QPainter*painter, const QRectF&rect)
         painter->restore();
 }
 
+bool EgCasScene::drawBackgroundTiles(QPainter* painter, const QRectF&rect, int nrPages)
+{
+        QPaintDevice* device = painter->device();
+        if (!device)
+                return false;
+        if (device->devType() == QInternal::Printer || device->devType() == QInternal::Picture)
+                return false;
+
+        qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform())
+                      * device->devicePixelRatioF();
+        if (scale <= 0.0)
+                return false;
+        if (scale != m_bgTileScale || m_bgTiles.size() > s_maxBgTiles) {
+                m_bgTiles.clear();
+                m_bgTileScale = scale;
+        }
+
+        QSizeF pageSize = m_worksheet.getSize();
+        qreal tileSize = s_bgTileSize / scale;          // tile size in scene coordinates
+        int firstPage = qMax(qFloor(rect.top() / pageSize.height()), 0);
+        int lastPage = qMin(qFloor(rect.bottom() / pageSize.height()), nrPages - 1);
+        int lastColumn = qCeil(pageSize.width() / tileSize) - 1;
+        int lastRow = qCeil(pageSize.height() / tileSize) - 1;
+
+        for (int page = firstPage; page <= lastPage; page++) {
+                QPointF pageOrigin(0.0, page * pageSize.height());
+                QRectF pageRect = QRectF(pageOrigin, pageSize).intersected(rect);
+                if (pageRect.isEmpty())
+                        continue;
+                pageRect.translate(-pageOrigin);
+                int colStart = qMax(qFloor(pageRect.left() / tileSize), 0);
+                int colEnd = qMin(qFloor(pageRect.right() / tileSize), lastColumn);
+                int rowStart = qMax(qFloor(pageRect.top() / tileSize), 0);
+                int rowEnd = qMin(qFloor(pageRect.bottom() / tileSize), lastRow);
+                for (int row = rowStart; row <= rowEnd; row++) {
+                        for (int col = colStart; col <= colEnd; col++) {
+                                QRectF tileRect(col * tileSize, row * tileSize, tileSize, tileSize);
+                                QRectF target = tileRect.intersected(pageRect);
+                                if (target.isEmpty())
+                                        continue;
+                                QRectF source((target.topLeft() - tileRect.topLeft()) * scale, target.size() * scale);
+                                painter->drawPixmap(target.translated(pageOrigin), getBackgroundTile(col, row),
+                                                    source);
+                        }
+                }
+        }
+
+        return true;
+}
+
+const QPixmap& EgCasScene::getBackgroundTile(int column, int row)
+{
+        quint32 key = (static_cast<quint32>(row) << 16) | static_cast<quint32>(column);
+        QHash<quint32, QPixmap>::iterator it = m_bgTiles.find(key);
+        if (it != m_bgTiles.end())
+                return it.value();
+
+        qreal tileSize = s_bgTileSize / m_bgTileScale;
+        QRectF tileRect(column * tileSize, row * tileSize, tileSize, tileSize);
+        QPixmap tile(s_bgTileSize, s_bgTileSize);
+        tile.fill(Qt::transparent);
+        QPainter tilePainter(&tile);
+        tilePainter.scale(m_bgTileScale, m_bgTileScale);
+        tilePainter.translate(-tileRect.topLeft());
+        tilePainter.setClipRect(tileRect);
+        // the tile is rendered for the first page, all other pages look the same
+        paintBackground(&tilePainter, tileRect);
+        tilePainter.end();
+
+        return m_bgTiles.insert(key, tile).value();
+}
+
 QGraphicsTextItem * EgCasScene::addText(const QString & text, const QFont & font)
 {
         EgcTextItem *textItem = new (std::nothrow) EgcTextItem(text);
@@ -252,6 +355,36 @@ EgcPixmapItem* EgCasScene::addPixmap(EgcAbstractPixmapEntity& pixmap, QPointF po
         return item.take();
 }
 
+EgcTableItem* EgCasScene::addTable(EgcAbstractTableEntity& table, QPointF point)
+{
+        QScopedPointer<EgcTableItem> item(new EgcTableItem(point));
+        if (item.isNull())
+                return nullptr;
+
+        item->setEntity(&table);
+        table.setItem(item.data());
+
+        addItem(item.data());
+        item->setPos(point);
+
+        return item.take();
+}
+
+EgcPlotItem* EgCasScene::addPlot(EgcAbstractPlotEntity& plot, QPointF point)
+{
+        QScopedPointer<EgcPlotItem> item(new EgcPlotItem(point));
+        if (item.isNull())
+                return nullptr;
+
+        item->setEntity(&plot);
+        plot.setItem(item.data());
+
+        addItem(item.data());
+        item->setPos(point);
+
+        return item.take();
+}
+
 void EgCasScene::setFormulaCursor(const QLineF& line)
 {
         m_cursor->setLine(line);
@@ -274,6 +407,10 @@ void EgCasScene::hideFormulaCursors( void )
 
 void EgCasScene::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
 {
+        // the items of a selection are sorted into the document at once, after all of them have been released
+        bool multiSelection = mouseGrabberItem() && selectedItems().size() > 1;
+        if (multiSelection)
+                m_document.beginGroupMove();
         if (!mouseGrabberItem()) {
                 if (m_cross) {
                         m_cross->setPos(event->scenePos());
@@ -285,6 +422,8 @@ void EgCasScene::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
                         m_cross->setPos(event->scenePos());
         }
         QGraphicsScene::mouseReleaseEvent(event);
+        if (multiSelection)
+                m_document.entitiesMoved();
 }
 
 void EgCasScene::itemYieldsFocus(EgcSceneSnapDirection direction, QGraphicsItem& item)
@@ -338,8 +477,10 @@ void EgCasScene::moveDown(QGraphicsItem* item, bool useItemPos)
                 qreal bm = m_worksheet.getBottomMargin();
                 qreal tm = m_worksheet.getTopMargin();
                 quint32 pageIndex = m_worksheet.pageAtPoint(position);
-                if (m_worksheet.onLastPage(position))
+                if (m_worksheet.onLastPage(position)) {
                         addPage(pageIndex + 1);
+                        m_document.entitiesMoved();
+                }
                 item->moveBy(0.0, grid_h + bm + tm);
         } else {
                 item->moveBy(0.0, grid_h);
@@ -371,8 +512,10 @@ void EgCasScene::moveUp(QGraphicsItem* item, bool useItemPos)
                 item->moveBy(0.0, -(offset + bm + tm));
                 if (m_worksheet.onLastPage(position)) {
                         quint32 pageIndex = m_worksheet.pageAtPoint(position);
-                        if (!anyItemOnPage(pageIndex))
+                        if (!anyItemOnPage(pageIndex)) {
                                 removePage(pageIndex);
+                                m_document.entitiesMoved();
+                        }
                 }
         } else {
                 item->moveBy(0.0, -grid_h);
@@ -390,22 +533,79 @@ bool EgCasScene::anyItemOnPage(quint32 pageIndex) const
 
 void EgCasScene::moveItems(bool moveDwn, QPointF point)
 {
-        QList<QGraphicsItem *> allItems = items();
+        // query only the items below the given point through the scene index
+        QRectF scnRect = sceneRect();
+        QRectF below(scnRect.left(), point.y() - 1.0, scnRect.width(), scnRect.bottom() - point.y() + 1.0);
+        QList<QGraphicsItem *> candidates = items(below, Qt::IntersectsItemBoundingRect);
+        QVector<QPair<QGraphicsItem*, qreal>> moves;
+        moves.reserve(candidates.size());
+
+        qreal grid_h = m_grid.grid().height();
+        qreal bm = m_worksheet.getBottomMargin();
+        qreal tm = m_worksheet.getTopMargin();
+        quint32 lastPage = qMax(m_worksheet.nrPages(), static_cast<quint32>(1)) - 1;
+        bool wrapsLastPage = false;
         QGraphicsItem* item;
 
-        foreach (item, allItems) {
-                if (    item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
-                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
-                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)) {
-                        if (qRound(item->pos().y()) >= qRound(point.y())) {
-                                if (moveDwn) {
-                                        moveDown(item);
-                                } else if (qRound(item->pos().y()) >= qRound(point.y())) {
-                                        moveUp(item);
-                                }
+        // calculate all new positions and page changes in one pass (see moveDown and moveUp)
+        foreach (item, candidates) {
+                if (    item->type() != static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
+                     && item->type() != static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
+                     && item->type() != static_cast<int>(EgcGraphicsItemType::EgcTextItemType)
+                     && item->type() != static_cast<int>(EgcGraphicsItemType::EgcTableItemType)
+                     && item->type() != static_cast<int>(EgcGraphicsItemType::EgcPlotItemType))
+                        continue;
+                if (qRound(item->pos().y()) < qRound(point.y()))
+                        continue;
+
+                QRectF itemRect = item->mapRectToScene(item->boundingRect());
+                qreal dy;
+                if (moveDwn) {
+                        if (m_worksheet.itemWrapsToNewPage(itemRect, grid_h)) {
+                                dy = grid_h + bm + tm;
+                                if (m_worksheet.pageAtPoint(itemRect.topLeft()) == lastPage)
+                                        wrapsLastPage = true;
+                        } else {
+                                dy = grid_h;
+                        }
+                } else {
+                        if (m_worksheet.itemWrapsToNewPage(itemRect, -grid_h)) {
+                                dy = -(itemRect.height() + bm + tm);
+                                if (m_worksheet.pageAtPoint(item->pos()) == lastPage)
+                                        wrapsLastPage = true;
+                        } else {
+                                dy = -grid_h;
                         }
                 }
+                moves.append(qMakePair(item, dy));
         }
+
+        if (moves.isEmpty())
+                return;
+
+        if (moveDwn && wrapsLastPage)
+                addPage(lastPage + 1);
+
+        // rebuilding the index once is cheaper than updating it for every single item
+        ItemIndexMethod indexMethod = itemIndexMethod();
+        bool suspendIndex = indexMethod != NoIndex && moves.size() > s_maxIndexedMoves;
+        if (suspendIndex)
+                setItemIndexMethod(NoIndex);
+
+        QPair<QGraphicsItem*, qreal> move;
+        foreach (move, moves)
+                move.first->moveBy(0.0, move.second);
+
+        if (suspendIndex)
+                setItemIndexMethod(indexMethod);
+
+        if (!moveDwn && wrapsLastPage) {
+                if (!anyItemOnPage(lastPage))
+                        removePage(lastPage);
+        }
+
+        // items that are moved up may pass items above the given point
+        m_document.entitiesMoved();
 }
 
 bool EgCasScene::deleteItem(EgcAbstractFormulaItem* item)
@@ -438,6 +638,26 @@ bool EgCasScene::deleteItem(EgcAbstractTextItem* item)
         return deleteItem(qitem);
 }
 
+bool EgCasScene::deleteItem(EgcAbstractTableItem* item)
+{
+        QGraphicsItem* qitem = dynamic_cast<QGraphicsItem*>(item);
+
+        if (!qitem)
+                return false;
+
+        return deleteItem(qitem);
+}
+
+bool EgCasScene::deleteItem(EgcAbstractPlotItem* item)
+{
+        QGraphicsItem* qitem = dynamic_cast<QGraphicsItem*>(item);
+
+        if (!qitem)
+                return false;
+
+        return deleteItem(qitem);
+}
+
 bool EgCasScene::deleteItem(QGraphicsItem *item)
 {
         if (!item)
@@ -488,7 +708,9 @@ void EgCasScene::keyPressEvent(QKeyEvent* keyEvent)
                         foreach (item, list) {
                                 if (    item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
                                      || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
-                                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)) {
+                                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)
+                                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTableItemType)
+                                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPlotItemType)) {
                                         deleteItem(item);
                                         m_document.itemDeleted(item);
                                         keyEvent->accept();
@@ -505,6 +727,7 @@ void EgCasScene::addPage(quint32 pageIndex)
         QRectF scnRect = sceneRect();
         qreal newHeight = m_worksheet.getSize().height() + scnRect.height();
         setSceneRect(scnRect.x(), scnRect.y(), scnRect.width(), newHeight);
+        invalidateBackground();
 
         //move all items from the sheets behind on page downwards
         QList<QGraphicsItem *> allItems = items();
@@ -515,7 +738,9 @@ void EgCasScene::addPage(quint32 pageIndex)
         foreach (item, allItems) {
                 if (    item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
                      || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
-                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)) {
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTableItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPlotItemType)) {
                         if (item->pos().y() >= startPos) {
                                 item->moveBy(0.0, heightSheet);
                         }
@@ -535,7 +760,9 @@ void EgCasScene::removePage(quint32 pageIndex)
         foreach (item, itemsOnPage) {
                 if (    item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
                      || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
-                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)) {
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTableItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPlotItemType)) {
                         deleteItem(item);
                 }
         }
@@ -544,6 +771,7 @@ void EgCasScene::removePage(quint32 pageIndex)
         QRectF scnRect = sceneRect();
         qreal newHeight = scnRect.height() - m_worksheet.getSize().height();
         setSceneRect(scnRect.x(), scnRect.y(), scnRect.width(), newHeight);
+        invalidateBackground();
 
         //move all items from the sheets behind on page upwards
         QList<QGraphicsItem *> allItems = items();
@@ -553,7 +781,9 @@ void EgCasScene::removePage(quint32 pageIndex)
         foreach (item, allItems) {
                 if (    item->type() == static_cast<int>(EgcGraphicsItemType::EgcFormulaItemType)
                      || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPixmapItemType)
-                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)) {
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTextItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcTableItemType)
+                     || item->type() == static_cast<int>(EgcGraphicsItemType::EgcPlotItemType)) {
                         if (item->pos().y() >= startPos) {
                                 item->moveBy(0.0, -heightSheet);
                         }
@@ -586,11 +816,18 @@ void EgCasScene::routeAction(EgcAction action)
                 if (formula) {
                         EgcAbstractFormulaEntity *entity = formula->getEnity();
                         if (entity)
-                                entity->handleAction(action);
+                                routeToFormula(*entity, action);
                 }
         }
 }
 
+void EgCasScene::routeToFormula(EgcAbstractFormulaEntity& formula, EgcAction action)
+{
+        EgcSessionRecorder::setRouted(true);
+        formula.handleAction(action);
+        EgcSessionRecorder::setRouted(false);
+}
+
 QPointF EgCasScene::getLastCursorPositon(void)
 {
         if (m_cross) {
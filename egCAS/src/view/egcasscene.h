@@ -33,9 +33,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QGraphicsLineItem>
 #include <QScopedPointer>
 #include <QLine>
+#include <QHash>
+#include <QPixmap>
 #include "entities/egcabstractformulaentity.h"
 #include "entities/egcabstractpixmapentity.h"
 #include "entities/egcabstracttextentity.h"
+#include "entities/egcabstracttableentity.h"
+#include "entities/egcabstractplotentity.h"
 #include "document/egcabstractdocument.h"
 #include "egcworksheet.h"
 #include "grid.h"
@@ -43,6 +47,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 class EgcFormulaItem;
 class EgcPixmapItem;
 class EgcTextItem;
+class EgcTableItem;
+class EgcAbstractTableItem;
+class EgcPlotItem;
+class EgcAbstractPlotItem;
 class EgcCrossItem;
 
 /**
@@ -68,6 +76,18 @@ public:
          * @param grid the grid size to be set
          */
         void setGrid(QSizeF grid);
+        /**
+         * @brief invalidateBackground drops the cached background tiles, needs to be called if anything changes that
+         * affects the appearance of the worksheet pages (grid, margins, page size)
+         */
+        void invalidateBackground(void);
+        /**
+         * @brief materializeItems lays out all formulas inside the given area whose layout has been deferred. This must
+         * be called before the area is painted (e.g. by a view or before rendering the scene into an image), since
+         * formulas are never laid out while painting.
+         * @param rect the area of the scene that is going to be painted
+         */
+        void materializeItems(const QRectF& rect);
         /**
          * @brief addText add text to the scene (overrides the standard function)
          * @param text the text to add
@@ -95,6 +115,20 @@ public:
          * @return a pointer to the pixmap added
          */
         EgcPixmapItem* addPixmap(EgcAbstractPixmapEntity& pixmap, QPointF point = QPointF(0.0,0.0));
+        /**
+         * @brief addTable add a table to the graphicsscene
+         * @param table the table entity to be rendered
+         * @param point  the point where (position) to add the table on the scene
+         * @return a pointer to the table added
+         */
+        EgcTableItem* addTable(EgcAbstractTableEntity& table, QPointF point = QPointF(0.0,0.0));
+        /**
+         * @brief addPlot add a plot to the graphicsscene
+         * @param plot the plot entity to be rendered
+         * @param point  the point where (position) to add the plot on the scene
+         * @return a pointer to the plot added
+         */
+        EgcPlotItem* addPlot(EgcAbstractPlotEntity& plot, QPointF point = QPointF(0.0,0.0));
         /**
          * @brief addFormula add a formula to the graphicsscene
          * @param formula the formula to be rendered
@@ -153,6 +187,18 @@ public:
          * @return true if deleting the item was successful, false otherwise
          */
         bool deleteItem(EgcAbstractTextItem* item);
+        /**
+         * @brief deleteItem removes the given item from the scene and deletes it
+         * @param item item to delete
+         * @return true if deleting the item was successful, false otherwise
+         */
+        bool deleteItem(EgcAbstractTableItem* item);
+        /**
+         * @brief deleteItem removes the given item from the scene and deletes it
+         * @param item item to delete
+         * @return true if deleting the item was successful, false otherwise
+         */
+        bool deleteItem(EgcAbstractPlotItem* item);
         /**
          * @brief moveItems moves all following (from the given point onwards) items up or down by the gridsize
          * @param moveDwn if true this moves the items downwards, upwards otherwise
@@ -211,6 +257,12 @@ public:
          * @brief deleteAll removes all items from the scene
          */
         void deleteAll(void);
+        /**
+         * @brief routeToFormula routes the given action to the given formula (as if the formula has the focus)
+         * @param formula the formula to route the action to
+         * @param action the action to route
+         */
+        void routeToFormula(EgcAbstractFormulaEntity& formula, EgcAction action);
 
 public slots:
         /**
@@ -269,6 +321,28 @@ private:
          * @param rect active rectangle of the scene
          */
         void drawActiveAreaBorder(QPainter* painter, const QRectF&rect);
+        /**
+         * @brief paintBackground paints grid lines, margins and active area borders of the given rect directly
+         * @param painter painter of the scene
+         * @param rect active rectangle of the scene
+         */
+        void paintBackground(QPainter* painter, const QRectF&rect);
+        /**
+         * @brief drawBackgroundTiles blits the exposed part of all pages from the cached background tiles
+         * @param painter painter of the scene
+         * @param rect active rectangle of the scene
+         * @param nrPages number of pages of the scene
+         * @return false if the background cannot be cached for the paint device (e.g. printer), true otherwise
+         */
+        bool drawBackgroundTiles(QPainter* painter, const QRectF&rect, int nrPages);
+        /**
+         * @brief getBackgroundTile returns the background tile at the given tile position, the tile is rendered if it
+         * is not in the cache
+         * @param column the column of the tile (on the page)
+         * @param row the row of the tile (on the page)
+         * @return the pixmap of the tile
+         */
+        const QPixmap& getBackgroundTile(int column, int row);
         /**
          * @brief deleteFocusedItem check if focused item shall be deleted
          * @return true if it shall be deleted, false otherwise
@@ -281,6 +355,11 @@ private:
         QGraphicsLineItem* m_nodeUnderline;     ///< node cursor to show user the context of changes in a formula
         EgcCrossItem* m_cross;                  ///< crosshair (cursor) to be able to see enter position
         EgcAbstractDocument& m_document;        ///< reference to document that contains the scene
+        QHash<quint32, QPixmap> m_bgTiles;      ///< background tiles of one page (all pages look the same)
+        qreal m_bgTileScale;                    ///< scale (zoom * device pixel ratio) the tiles are rendered with
+        static const int s_bgTileSize = 256;    ///< size of the background tiles in device pixels
+        static const int s_maxBgTiles = 512;    ///< maximum number of cached background tiles
+        static const int s_maxIndexedMoves = 64;///< above this number of moved items the scene index is rebuilt at once
 };
 
 #endif // EGCASSCENE_H
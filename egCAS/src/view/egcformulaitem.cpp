@@ -30,6 +30,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QKeyEvent>
 #include <libegcas/eg_mml_document.h>
 #include <QRegularExpression>
+#include <QStyleOptionGraphicsItem>
+#include <QPaintDevice>
+#include <QPixmap>
+#include <QMultiMap>
+#include <limits>
 #include "egcformulaitem.h"
 #include "egcasscene.h"
 #include "entities/egcabstractformulaentity.h"
@@ -37,14 +42,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egcscreenpos.h"
 #include "actions/egcactionmapper.h"
 #include "egcitemtypes.h"
+#include "utils/egcperfcounter.h"
 
 quint8 EgcFormulaItem::s_baseFontSize = 20;
 QRegularExpression EgcFormulaItem::s_alnumKeyFilter = QRegularExpression("[._0-9a-zA-ZΆ-ώ]+");
 bool EgcFormulaItem::s_regexInitialized = false;
+QHash<EgcFormulaItem*, quint64> EgcFormulaItem::s_materialized;
+quint64 EgcFormulaItem::s_materializeTick = 0;
+int EgcFormulaItem::s_maxMaterialized = 1000;
+quint64 EgcFormulaItem::s_passStart = std::numeric_limits<quint64>::max();
 
 EgcFormulaItem::EgcFormulaItem(QGraphicsItem *parent) :
-    QGraphicsItem{parent}, m_entity{nullptr}, m_posChanged{false}, m_contentChanged{false},
-    m_startPoint{QPointF(0.0, 0.0)}, m_movePossible{false}, m_editingActivated{false}, m_errMsgItem{nullptr}
+    QGraphicsItem{parent}, m_entity{nullptr}, m_posChanged{false}, m_contentChanged{false}, m_layoutChanged{true},
+    m_layoutFontSize{0.0}, m_contentVersion{0}, m_cacheVersion{0}, m_cacheFontSize{0.0}, m_cacheScale{0.0}, m_cacheSelected{false}, m_materialized{true}, m_startPoint{QPointF(0.0, 0.0)}, m_movePossible{false}, m_editingActivated{false}, m_errMsgItem{nullptr}
 {
         setFlags(ItemIsMovable | ItemClipsToShape | ItemIsSelectable | ItemIsFocusable | ItemSendsScenePositionChanges);
         m_mathMlDoc.reset(new EgMathMLDocument());
@@ -65,7 +75,8 @@ EgcFormulaItem::EgcFormulaItem(QGraphicsItem *parent) :
 
 EgcFormulaItem::~EgcFormulaItem()
 {
-
+        invalidateRenderCache();
+        s_materialized.remove(this);
 }
 
 EgcFormulaItem::EgcFormulaItem(const QString &formula, QPointF point, QGraphicsItem *parent) :
@@ -83,18 +94,38 @@ EgcFormulaItem::EgcFormulaItem(const QPointF point, QGraphicsItem *parent) :
 
 void EgcFormulaItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-        (void) option;
         (void) widget;
 
+        // the layout must not change while painting, the view (or whoever renders the scene) lays out the formulas
+        // before they are painted, see EgCasScene::materializeItems
+        if (!m_materialized)
+                return;
+
+        qreal fontSize;
         if (!m_entity)
-                m_mathMlDoc->setBaseFontPixelSize(static_cast<qreal>(s_baseFontSize));
+                fontSize = static_cast<qreal>(s_baseFontSize);
         else
-                m_mathMlDoc->setBaseFontPixelSize(static_cast<qreal>(m_entity->getFontSize()));
+                fontSize = static_cast<qreal>(m_entity->getFontSize());
+        if (fontSize != m_layoutFontSize) {
+                m_layoutFontSize = fontSize;
+                m_layoutChanged = true;
+        }
+        m_mathMlDoc->setBaseFontPixelSize(fontSize);
 
+        EGC_PERF_SCOPE(perf, EgcPerfPhase::Layout);
         QRectF formulaRect(QPointF(0,0), m_mathMlDoc->size());
-        m_mathMlDoc->paint( painter, formulaRect.topLeft() );
-        QVector<EgRenderingPosition> positions = m_mathMlDoc->getRenderingPositions();
-        m_screenPos->setPositions(positions);
+        EGC_PERF_SWITCH(perf, EgcPerfPhase::Paint);
+        // only the formula under edit and formulas with a new layout (the rendering positions are needed) are rendered
+        // live, all other formulas are painted from the render cache
+        if (hasFocus() || m_layoutChanged || !paintCached(painter, option, formulaRect, fontSize)) {
+                m_mathMlDoc->paint( painter, formulaRect.topLeft() );
+                // the rendering positions only change with the layout, so the index needs no rebuild on every repaint
+                if (m_layoutChanged) {
+                        m_screenPos->setPositions(m_mathMlDoc->getRenderingPositions());
+                        m_layoutChanged = false;
+                }
+        }
+        EGC_PERF_STOP(perf);
 
         if (hasFocus()) {
 #ifdef DEBUG_SCENE_RENDERING_POS
@@ -135,10 +166,64 @@ void EgcFormulaItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
         }
 }
 
+bool EgcFormulaItem::paintCached(QPainter* painter, const QStyleOptionGraphicsItem* option, const QRectF& rect,
+                                 qreal fontSize)
+{
+        QPaintDevice* device = painter->device();
+        if (!device)
+                return false;
+        // print with full quality
+        if (device->devType() == QInternal::Printer || device->devType() == QInternal::Picture)
+                return false;
+
+        qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform())
+                      * device->devicePixelRatioF();
+        QSize pixelSize = QSizeF(rect.size() * scale).toSize() + QSize(1, 1);
+        // don't cache huge renderings (e.g. if zoomed in strongly)
+        if (pixelSize.width() * pixelSize.height() > 4096 * 4096)
+                return false;
+
+        // everything the rendering depends on besides the content (e.g. the color of the pen)
+        bool selected = isSelected() || (option && (option->state & QStyle::State_Selected));
+        QPen pen = painter->pen();
+
+        QPixmap pixmap;
+        if (    m_cacheVersion != m_contentVersion || m_cacheFontSize != fontSize || m_cacheScale != scale
+             || m_cachePen != pen || m_cacheSelected != selected || !QPixmapCache::find(m_cacheKey, &pixmap)) {
+                pixmap = QPixmap(pixelSize);
+                pixmap.fill(Qt::transparent);
+                QPainter pixmapPainter(&pixmap);
+                pixmapPainter.setRenderHints(painter->renderHints());
+                pixmapPainter.setPen(pen);
+                pixmapPainter.scale(scale, scale);
+                m_mathMlDoc->paint(&pixmapPainter, QPointF(0.0, 0.0));
+                pixmapPainter.end();
+
+                invalidateRenderCache();
+                m_cacheKey = QPixmapCache::insert(pixmap);
+                m_cacheVersion = m_contentVersion;
+                m_cacheFontSize = fontSize;
+                m_cacheScale = scale;
+                m_cachePen = pen;
+                m_cacheSelected = selected;
+        }
+
+        pixmap.setDevicePixelRatio(scale);
+        painter->drawPixmap(rect.topLeft(), pixmap);
+
+        return true;
+}
+
+void EgcFormulaItem::invalidateRenderCache(void)
+{
+        QPixmapCache::remove(m_cacheKey);
+        m_cacheKey = QPixmapCache::Key();
+}
+
 QRectF EgcFormulaItem::boundingRect() const
 {
         //the start point is the bottom left point of the formula
-        QRectF bounds(QPointF(0,0), m_mathMlDoc->size());
+        QRectF bounds(QPointF(0,0), getLayoutSize());
 
         return bounds.adjusted(0, -1.0, +1.0, +1.0);
 }
@@ -146,6 +231,8 @@ QRectF EgcFormulaItem::boundingRect() const
 void EgcFormulaItem::setFormulaText(const QString &formula)
 {
         m_mathMlDoc->setContent(formula);
+        m_layoutChanged = true;
+        m_contentVersion++;
 }
 
 void EgcFormulaItem::mousePressEvent(QGraphicsSceneMouseEvent*event)
@@ -282,8 +369,18 @@ void EgcFormulaItem::updateView(void)
                 return;
         
         prepareGeometryChange();
+        m_materialized = true;
+        touchMaterialized();
         m_contentChanged = true;
-        m_mathMlDoc->setContent(m_entity->getMathMlCode());
+        QString mathMlCode = m_entity->getMathMlCode();
+        EGC_PERF_SCOPE(perf, EgcPerfPhase::Layout);
+        // lay out with the font of the formula, so the size is right before the formula is painted the first time
+        m_layoutFontSize = static_cast<qreal>(m_entity->getFontSize());
+        m_mathMlDoc->setBaseFontPixelSize(m_layoutFontSize);
+        m_mathMlDoc->setContent(mathMlCode);
+        m_layoutChanged = true;
+        m_contentVersion++;
+        EGC_PERF_STOP(perf);
         update();
         if (m_errMsgItem) {
                 if (!m_errMsgItem->toHtml().isEmpty()) {
@@ -295,6 +392,113 @@ void EgcFormulaItem::updateView(void)
         }
 }
 
+void EgcFormulaItem::updateViewLazy(QSizeF estimatedSize)
+{
+        if (!m_entity)
+                return;
+
+        // the formula under edit is always needed immediately
+        if (hasFocus() || m_editingActivated) {
+                updateView();
+                return;
+        }
+
+        prepareGeometryChange();
+        dematerialize();
+        if (estimatedSize.isValid() && !estimatedSize.isEmpty()) {
+                m_estimatedSize = estimatedSize;
+        } else {
+                // rough guess of a short formula, the real size is calculated as soon as the formula gets visible
+                qreal fontSize = static_cast<qreal>(m_entity->getFontSize());
+                m_estimatedSize = QSizeF(fontSize * 4.0, fontSize * 1.5);
+        }
+        m_materialized = false;
+        update();
+}
+
+QSizeF EgcFormulaItem::getLayoutSize(void) const
+{
+        if (!m_materialized)
+                return m_estimatedSize;
+
+        return m_mathMlDoc->size();
+}
+
+void EgcFormulaItem::materialize(void)
+{
+        if (m_materialized) {
+                touchMaterialized();
+                return;
+        }
+
+        updateView();
+}
+
+bool EgcFormulaItem::isMaterialized(void) const
+{
+        return m_materialized;
+}
+
+void EgcFormulaItem::setMaxMaterialized(int max)
+{
+        s_maxMaterialized = qMax(max, 1);
+}
+
+void EgcFormulaItem::beginMaterializePass(void)
+{
+        s_passStart = s_materializeTick;
+}
+
+void EgcFormulaItem::endMaterializePass(void)
+{
+        s_passStart = std::numeric_limits<quint64>::max();
+}
+
+void EgcFormulaItem::dematerialize(void)
+{
+        if (!m_materialized || hasFocus() || m_editingActivated)
+                return;
+
+        // the size doesn't change, so the geometry of the item stays the same
+        m_estimatedSize = m_mathMlDoc->size();
+        m_materialized = false;
+        s_materialized.remove(this);
+
+        m_mathMlDoc.reset(new EgMathMLDocument());
+        m_mathMlDoc->setBaseFontPixelSize(s_baseFontSize);
+        m_screenPos->setPositions(QVector<EgRenderingPosition>());
+        invalidateRenderCache();
+        m_layoutChanged = true;
+        m_contentVersion++;
+}
+
+void EgcFormulaItem::touchMaterialized(void)
+{
+        s_materialized.insert(this, ++s_materializeTick);
+        if (s_materialized.size() <= s_maxMaterialized)
+                return;
+
+        // release the least recently used formulas down to 3/4 of the maximum, so this doesn't happen on every call.
+        // Formulas of the current materialize pass are going to be painted, so there may be more than the maximum.
+        QMultiMap<quint64, EgcFormulaItem*> lru;
+        QHashIterator<EgcFormulaItem*, quint64> i(s_materialized);
+        while (i.hasNext()) {
+                i.next();
+                if (i.key() != this && i.value() <= s_passStart)
+                        lru.insert(i.value(), i.key());
+        }
+
+        int toRelease = s_materialized.size() - (s_maxMaterialized * 3) / 4;
+        QMultiMap<quint64, EgcFormulaItem*>::const_iterator it = lru.constBegin();
+        while (toRelease > 0 && it != lru.constEnd()) {
+                EgcFormulaItem* item = it.value();
+                item->dematerialize();
+                if (!item->m_materialized)
+                        toRelease--;
+                ++it;
+        }
+}
+
 EgCasScene* EgcFormulaItem::getEgcScene(void)
 {
         QGraphicsScene *scene = this->scene();
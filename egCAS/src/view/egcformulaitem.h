@@ -31,6 +31,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QGraphicsItem>
 #include <QPainter>
+#include <QPixmapCache>
+#include <QHash>
 #include "egcasiteminterface.h"
 #include "egcabstractformulaitem.h"
 #include "egcabstractitem.h"
@@ -110,6 +112,41 @@ public:
          * @brief updateView update the view with the new mathml representation if anything changes
          */
         virtual void updateView(void) override;
+        /**
+         * @brief updateViewLazy defers the layout of the formula until it approaches the visible area of the view.
+         * Until then the given size is used as an estimate of the formula dimensions.
+         * @param estimatedSize the estimated (e.g. persisted) size of the formula, an invalid size if unknown
+         */
+        virtual void updateViewLazy(QSizeF estimatedSize) override;
+        /**
+         * @brief getLayoutSize returns the size of the formula layout (or the estimate if it is not laid out yet)
+         * @return the size of the formula
+         */
+        virtual QSizeF getLayoutSize(void) const override;
+        /**
+         * @brief materialize lays out the formula if this has been deferred (e.g. the formula approaches the viewport)
+         */
+        void materialize(void);
+        /**
+         * @brief isMaterialized checks if the formula is laid out
+         * @return true if the formula is laid out, false if only the size estimate is available
+         */
+        bool isMaterialized(void) const;
+        /**
+         * @brief setMaxMaterialized set the maximum number of formulas that are kept laid out. If there are more, the
+         * least recently used formulas are released again.
+         * @param max the maximum number of laid out formulas
+         */
+        static void setMaxMaterialized(int max);
+        /**
+         * @brief beginMaterializePass starts laying out all formulas of an area. The formulas laid out until
+         * endMaterializePass is called are not released again, even if there are more than the maximum number.
+         */
+        static void beginMaterializePass(void);
+        /**
+         * @brief endMaterializePass ends laying out the formulas of an area (see beginMaterializePass)
+         */
+        static void endMaterializePass(void);
         /**
          * @brief getScreenPos returns a reference to the object that manages the screen positions of the formula
          * characters
@@ -252,6 +289,28 @@ protected:
          * @param msg the error message to set
          */
         void setErrorMessage(QString msg) override;
+        /**
+         * @brief paintCached paints the formula from the render cache (and renders the cache if it is not valid)
+         * @param painter the painter to paint the formula with
+         * @param option the style options of the item (contains the selection state)
+         * @param rect the rectangle of the formula
+         * @param fontSize the font size the formula is rendered with
+         * @return true if the formula has been painted, false if the formula must be painted live
+         */
+        bool paintCached(QPainter* painter, const QStyleOptionGraphicsItem* option, const QRectF& rect, qreal fontSize);
+        /**
+         * @brief invalidateRenderCache removes the cached rendering of the formula
+         */
+        void invalidateRenderCache(void);
+        /**
+         * @brief dematerialize releases the layout of the formula and keeps only its size as estimate
+         */
+        void dematerialize(void);
+        /**
+         * @brief touchMaterialized marks the formula as recently used in the list of laid out formulas and releases
+         * the least recently used formulas if there are too many
+         */
+        void touchMaterialized(void);
         /**
          * @brief clearErrorMessage clear the error message of the current formula item
          */
@@ -265,6 +324,21 @@ private:
         EgcAbstractFormulaEntity* m_entity;             ///< pointer to formula entity
         bool m_posChanged;                              ///< helper variable indicating that the position has changed
         bool m_contentChanged;                          ///< helper variable indicating that the content of the formula has changed
+        bool m_layoutChanged;                           ///< true if the layout changed and the screen positions must be rebuilt
+        qreal m_layoutFontSize;                         ///< font size the current layout has been created with
+        quint32 m_contentVersion;                       ///< incremented every time the mathml content changes
+        QPixmapCache::Key m_cacheKey;                   ///< key of the cached rendering of the (inactive) formula
+        quint32 m_cacheVersion;                         ///< content version the cached rendering has been created with
+        qreal m_cacheFontSize;                          ///< font size the cached rendering has been created with
+        qreal m_cacheScale;                             ///< scale (zoom * device pixel ratio) of the cached rendering
+        QPen m_cachePen;                                ///< pen (color) the cached rendering has been created with
+        bool m_cacheSelected;                           ///< selection state the cached rendering has been created with
+        bool m_materialized;                            ///< false if the layout is deferred and only m_estimatedSize is valid
+        QSizeF m_estimatedSize;                         ///< estimated size of the formula as long as it is not laid out
+        static QHash<EgcFormulaItem*, quint64> s_materialized; ///< laid out formulas with the tick of their last use
+        static quint64 s_materializeTick;               ///< tick counter for the least recently used order
+        static int s_maxMaterialized;                   ///< maximum number of laid out formulas
+        static quint64 s_passStart;                     ///< last tick before the current materialize pass (max if none)
         QScopedPointer<EgcScreenPos> m_screenPos;       ///< screen positions of the rendered formula characters
         static QRegularExpression s_alnumKeyFilter;     ///< regex for checking if a key is an alnum key
         static bool s_regexInitialized;                 ///< check if regex is already initialized
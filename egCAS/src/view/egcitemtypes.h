@@ -38,7 +38,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 enum class EgcGraphicsItemType {
         EgcFormulaItemType = QGraphicsItem::UserType + 1,
         EgcTextItemType = QGraphicsItem::UserType + 2,
-        EgcPixmapItemType = QGraphicsItem::UserType + 3
+        EgcPixmapItemType = QGraphicsItem::UserType + 3,
+        EgcTableItemType = QGraphicsItem::UserType + 4,
+        EgcPlotItemType = QGraphicsItem::UserType + 5
 };
 
 #endif //#ifndef EGCITEMTYPES_H
@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egcasscene.h"
 #include "resizehandle.h"
 #include "egcitemtypes.h"
+#include "entities/egcabstractpixmapentity.h"
 
 EgcPixmapItem::EgcPixmapItem(QGraphicsItem*parent) : QGraphicsPixmapItem{parent}, m_entity{nullptr}
 {
@@ -75,11 +76,19 @@ QVariant EgcPixmapItem::itemChange(GraphicsItemChange change, const QVariant &va
         return QGraphicsItem::itemChange(change, value);
 }
 
+void EgcPixmapItem::mousePressEvent(QGraphicsSceneMouseEvent*event)
+{
+        m_pressPos = pos();
+        QGraphicsItem::mousePressEvent(event);
+}
+
 void EgcPixmapItem::mouseReleaseEvent(QGraphicsSceneMouseEvent*event)
 {
         QGraphicsItem::mouseReleaseEvent(event);
 
         m_resizeHandle->mouseReleaseEventInfo();
+        if (pos() != m_pressPos && m_entity)
+                m_entity->itemChanged(EgcItemChangeType::posChanged);
 }
 
 void EgcPixmapItem::mouseMoveEvent(QGraphicsSceneMouseEvent*event)
@@ -89,6 +98,12 @@ void EgcPixmapItem::mouseMoveEvent(QGraphicsSceneMouseEvent*event)
         m_resizeHandle->mouseMoveEventInfo();
 }
 
+void EgcPixmapItem::resized(void)
+{
+        if (m_entity)
+                m_entity->itemChanged(EgcItemChangeType::contentChanged);
+}
+
 void EgcPixmapItem::setEntity(EgcAbstractPixmapEntity* entity)
 {
         m_entity = entity;
@@ -121,14 +136,53 @@ QSizeF EgcPixmapItem::getSize(void)
 
 void EgcPixmapItem::setPixmap(QPixmap pixmap)
 {
+        m_pendingSize = QSize();
         QGraphicsPixmapItem::setPixmap(pixmap);
 }
 
 QPixmap EgcPixmapItem::getPixmap(void)
 {
+        if (m_pendingSize.isValid() && m_entity)
+                m_entity->decodePixmap();
+
         return pixmap();
 }
 
+void EgcPixmapItem::setPendingPixmap(QSize size)
+{
+        QGraphicsPixmapItem::setPixmap(QPixmap());
+        prepareGeometryChange();
+        m_pendingSize = size;
+}
+
+QRectF EgcPixmapItem::boundingRect() const
+{
+        if (m_pendingSize.isValid())
+                return QRectF(offset(), QSizeF(m_pendingSize));
+
+        return QGraphicsPixmapItem::boundingRect();
+}
+
+QPainterPath EgcPixmapItem::shape() const
+{
+        if (m_pendingSize.isValid()) {
+                QPainterPath path;
+                path.addRect(boundingRect());
+                return path;
+        }
+
+        return QGraphicsPixmapItem::shape();
+}
+
+void EgcPixmapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+        // images of loaded documents are decoded when they get visible the first time
+        if (m_pendingSize.isValid() && m_entity)
+                m_entity->decodePixmap();
+
+        QGraphicsPixmapItem::paint(painter, option, widget);
+}
+
 EgCasScene* EgcPixmapItem::getEgcScene(void)
 {
         QGraphicsScene *scene = this->scene();
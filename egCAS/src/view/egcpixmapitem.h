@@ -89,11 +89,37 @@ public:
          * @return the pixmap of the current item
          */
         virtual QPixmap getPixmap(void) override;
+        /**
+         * @brief setPendingPixmap announces a pixmap of the given size that is decoded when needed
+         * @param size the size of the pixmap in pixels
+         */
+        virtual void setPendingPixmap(QSize size) override;
+        /**
+         * @brief boundingRect returns the bounding rect of the item (also if the pixmap isn't decoded yet)
+         * @return the bounding rect of the item
+         */
+        virtual QRectF boundingRect() const override;
+        /**
+         * @brief shape returns the shape of the item (also if the pixmap isn't decoded yet)
+         * @return the shape of the item
+         */
+        virtual QPainterPath shape() const override;
+        /**
+         * @brief paint decodes the pixmap if needed and paints it
+         * @param painter the painter to paint with
+         * @param option style options
+         * @param widget the widget that is painted on
+         */
+        virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
         /**
          * @brief type returns the type of the item
          * @return item type
          */
         virtual int type() const override;
+        /**
+         * @brief resized must be called after the user has resized the picture (via the resize handle)
+         */
+        void resized(void);
 
 protected:
         /**
@@ -109,6 +135,11 @@ protected:
          * @return the value that has been adjusted
          */
         QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+        /**
+         * @brief mousePressEvent overrides mousePressEvent from QGraphicsItem
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        void mousePressEvent(QGraphicsSceneMouseEvent *event);
         /**
          * @brief mousePressEvent overrides mouseReleaseEvent from QGraphicsItem
          * @param event pointer to QGraphicsSceneMouseEvent
@@ -149,6 +180,8 @@ private:
         bool m_childSelectionState;
         bool m_resizeHandleAdded;
         EgcAbstractPixmapEntity* m_entity;                      ///< pointer to pixmap entity
+        QSize m_pendingSize;                                    ///< size of the pixmap if it isn't decoded yet
+        QPointF m_pressPos;                                     ///< position of the item when the mouse button has been pressed
 };
 
 #endif // EgcPixmapItem_H
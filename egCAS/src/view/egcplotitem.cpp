@@ -0,0 +1,364 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <cmath>
+#include <QGraphicsSceneMouseEvent>
+#include <QGraphicsSceneWheelEvent>
+#include <QKeyEvent>
+#include <QPainter>
+#include "egcplotitem.h"
+#include "egcasscene.h"
+#include "egcitemtypes.h"
+#include "entities/egcabstractplotentity.h"
+
+const qreal EgcPlotItem::s_width = 320.0;
+const qreal EgcPlotItem::s_height = 240.0;
+const qreal EgcPlotItem::s_margin = 20.0;
+
+EgcPlotItem::EgcPlotItem(QGraphicsItem *parent) : QGraphicsItem{parent}, m_entity{nullptr}
+{
+        setFlags(ItemIsMovable | ItemIsSelectable | ItemIsFocusable | ItemSendsScenePositionChanges);
+        // the painted plot is cached, so moving or scrolling doesn't paint the curve again
+        setCacheMode(DeviceCoordinateCache);
+}
+
+EgcPlotItem::EgcPlotItem(const QPointF point, QGraphicsItem *parent) : EgcPlotItem{parent}
+{
+        QGraphicsItem::setPos(point);
+}
+
+EgcPlotItem::~EgcPlotItem()
+{
+}
+
+void EgcPlotItem::setEntity(EgcAbstractPlotEntity* entity)
+{
+        m_entity = entity;
+}
+
+EgcAbstractPlotEntity* EgcPlotItem::getEntity(void) const
+{
+        return m_entity;
+}
+
+QPointF EgcPlotItem::getPosition( void ) const
+{
+        return pos();
+}
+
+void EgcPlotItem::setPos(const QPointF &point)
+{
+        QGraphicsItem::setPos(snap(point));
+}
+
+void EgcPlotItem::setCurve(const QVector<double>& x, const QVector<double>& y, const QRectF& range)
+{
+        m_range = range;
+        buildPath(x, y);
+        update();
+}
+
+void EgcPlotItem::setCaption(const QString& caption)
+{
+        m_caption = caption;
+        update();
+}
+
+QRectF EgcPlotItem::plotArea(void) const
+{
+        return QRectF(2 * s_margin, s_margin, s_width - 3 * s_margin, s_height - 2 * s_margin);
+}
+
+void EgcPlotItem::buildPath(const QVector<double>& x, const QVector<double>& y)
+{
+        m_path = QPainterPath();
+        if (x.size() != y.size() || !(m_range.width() > 0.0) || !(m_range.height() > 0.0))
+                return;
+
+        QRectF area = plotArea();
+        qreal scaleX = area.width() / m_range.width();
+        qreal scaleY = area.height() / m_range.height();
+        // points far outside the plot area are clipped anyway, but huge coordinates would slow down the painter
+        qreal yLimitLow = area.top() - area.height();
+        qreal yLimitHigh = area.bottom() + area.height();
+
+        bool penDown = false;
+        qint64 column = 0;
+        int points = 0;
+        qreal columnX = 0.0;
+        qreal yMin = 0.0;
+        qreal yMax = 0.0;
+        qreal yLast = 0.0;
+        int size = x.size();
+        for (int i = 0; i <= size; i++) {
+                bool valid = (i < size) && std::isfinite(y.at(i));
+                qreal px = 0.0;
+                qreal py = 0.0;
+                qint64 pixel = 0;
+                if (valid) {
+                        px = area.left() + (x.at(i) - m_range.left()) * scaleX;
+                        py = area.bottom() - (y.at(i) - m_range.top()) * scaleY;
+                        if (py < yLimitLow)
+                                py = yLimitLow;
+                        if (py > yLimitHigh)
+                                py = yLimitHigh;
+                        pixel = static_cast<qint64>(std::floor(px));
+                        if (points > 0 && pixel == column) {
+                                // the sample falls into the current pixel column
+                                if (py < yMin)
+                                        yMin = py;
+                                if (py > yMax)
+                                        yMax = py;
+                                yLast = py;
+                                points++;
+                                continue;
+                        }
+                }
+
+                // finish the current pixel column
+                if (points > 1) {
+                        m_path.lineTo(columnX, yMin);
+                        m_path.lineTo(columnX, yMax);
+                        m_path.lineTo(columnX, yLast);
+                }
+                points = 0;
+
+                if (!valid) {
+                        // a gap in the curve
+                        penDown = false;
+                        continue;
+                }
+
+                if (penDown)
+                        m_path.lineTo(px, py);
+                else
+                        m_path.moveTo(px, py);
+                penDown = true;
+                column = pixel;
+                columnX = px;
+                yMin = py;
+                yMax = py;
+                yLast = py;
+                points = 1;
+        }
+}
+
+QRectF EgcPlotItem::boundingRect() const
+{
+        return QRectF(0.0, 0.0, s_width, s_height);
+}
+
+void EgcPlotItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+        (void) option;
+        (void) widget;
+
+        QRectF area = plotArea();
+        painter->save();
+        painter->setFont(m_font);
+        painter->setPen(QPen(Qt::black, 0));
+        painter->drawRect(area);
+
+        if (m_range.width() > 0.0 && m_range.height() > 0.0) {
+                // axes (if visible)
+                painter->setPen(QPen(Qt::gray, 0, Qt::DashLine));
+                qreal zeroX = area.left() - m_range.left() * area.width() / m_range.width();
+                qreal zeroY = area.bottom() + m_range.top() * area.height() / m_range.height();
+                if (zeroX > area.left() && zeroX < area.right())
+                        painter->drawLine(QPointF(zeroX, area.top()), QPointF(zeroX, area.bottom()));
+                if (zeroY > area.top() && zeroY < area.bottom())
+                        painter->drawLine(QPointF(area.left(), zeroY), QPointF(area.right(), zeroY));
+
+                // labels of the ranges
+                painter->setPen(QPen(Qt::black, 0));
+                QRectF below(area.left(), area.bottom(), area.width(), s_margin);
+                painter->drawText(below, Qt::AlignLeft | Qt::AlignVCenter, QString::number(m_range.left(), 'g', 4));
+                painter->drawText(below, Qt::AlignRight | Qt::AlignVCenter,
+                                  QString::number(m_range.right(), 'g', 4));
+                QRectF left(0.0, area.top(), area.left() - 2.0, area.height());
+                painter->drawText(left, Qt::AlignRight | Qt::AlignTop, QString::number(m_range.bottom(), 'g', 4));
+                painter->drawText(left, Qt::AlignRight | Qt::AlignBottom, QString::number(m_range.top(), 'g', 4));
+
+                // the curve
+                painter->setClipRect(area);
+                painter->setPen(QPen(Qt::blue, 0));
+                painter->drawPath(m_path);
+                painter->setClipping(false);
+        }
+
+        painter->setPen(QPen(Qt::black, 0));
+        painter->drawText(QRectF(area.left(), 0.0, area.width(), s_margin), Qt::AlignCenter, m_caption);
+
+        if (isSelected() || hasFocus())
+                painter->drawRect(boundingRect());
+
+        painter->restore();
+}
+
+QVariant EgcPlotItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+        if (change == ItemPositionChange && scene()) {
+                // value is the new position.
+                QPointF point = value.toPointF();
+                ensureVisibility();
+                return snap(point);
+        }
+
+        return QGraphicsItem::itemChange(change, value);
+}
+
+void EgcPlotItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+        m_pressPos = pos();
+        QGraphicsItem::mousePressEvent(event);
+}
+
+void EgcPlotItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+        QGraphicsItem::mouseReleaseEvent(event);
+        if (pos() != m_pressPos && m_entity)
+                m_entity->itemChanged(EgcItemChangeType::posChanged);
+}
+
+void EgcPlotItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
+{
+        if (m_entity) {
+                event->accept();
+                m_entity->itemChanged(EgcItemChangeType::itemEdited);
+        } else {
+                QGraphicsItem::mouseDoubleClickEvent(event);
+        }
+}
+
+void EgcPlotItem::wheelEvent(QGraphicsSceneWheelEvent *event)
+{
+        // only zoom selected plots, otherwise the wheel scrolls the document
+        if (!m_entity || !isSelected() || event->orientation() != Qt::Vertical) {
+                event->ignore();
+                return;
+        }
+
+        QRectF area = plotArea();
+        qreal center = (event->pos().x() - area.left()) / area.width();
+        if (center < 0.0)
+                center = 0.0;
+        if (center > 1.0)
+                center = 1.0;
+        m_entity->zoom((event->delta() > 0) ? 0.8 : 1.25, center);
+        event->accept();
+}
+
+EgCasScene* EgcPlotItem::getEgcScene(void)
+{
+        QGraphicsScene *scene = this->scene();
+        if (scene) {
+                return static_cast<EgCasScene*>(scene);
+        }
+
+        return nullptr;
+}
+
+void EgcPlotItem::keyPressEvent(QKeyEvent *keyEvent)
+{
+        bool accepted = false;
+        int key = keyEvent->key();
+        bool shift = keyEvent->modifiers().testFlag(Qt::ShiftModifier);
+        EgCasScene* scn = qobject_cast<EgCasScene*>(scene());
+        if (!scn)
+                return;
+
+        switch (key) {
+        case Qt::Key_Left:
+                accepted = true;
+                if (shift && m_entity)
+                        m_entity->pan(-0.1);
+                else
+                        scn->itemYieldsFocus(EgcSceneSnapDirection::left, *this);
+                break;
+        case Qt::Key_Right:
+                accepted = true;
+                if (shift && m_entity)
+                        m_entity->pan(0.1);
+                else
+                        scn->itemYieldsFocus(EgcSceneSnapDirection::right, *this);
+                break;
+        case Qt::Key_Up:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::up, *this);
+                break;
+        case Qt::Key_Down:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::down, *this);
+                break;
+        case Qt::Key_Plus:
+                if (m_entity) {
+                        accepted = true;
+                        m_entity->zoom(0.8, 0.5);
+                }
+                break;
+        case Qt::Key_Minus:
+                if (m_entity) {
+                        accepted = true;
+                        m_entity->zoom(1.25, 0.5);
+                }
+                break;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+                if (m_entity) {
+                        accepted = true;
+                        m_entity->itemChanged(EgcItemChangeType::itemEdited);
+                }
+                break;
+        case Qt::Key_Delete:
+                accepted = true;
+                break;
+        }
+
+        if (accepted) {
+                keyEvent->accept();
+        } else {
+                keyEvent->ignore();
+                QGraphicsItem::keyPressEvent(keyEvent);
+        }
+}
+
+int EgcPlotItem::type() const
+{
+        return static_cast<int>(EgcGraphicsItemType::EgcPlotItemType);
+}
+
+QRectF EgcPlotItem::bRect(void) const
+{
+        return sceneBoundingRect();
+}
+
+QPointF EgcPlotItem::getPos()
+{
+        return pos();
+}
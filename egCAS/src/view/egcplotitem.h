@@ -0,0 +1,180 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCPLOTITEM_H
+#define EGCPLOTITEM_H
+
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <QFont>
+#include "egcabstractplotitem.h"
+#include "egcabstractitem.h"
+
+class EgcAbstractPlotEntity;
+
+/**
+ * @brief The EgcPlotItem class shows the curve of a function. The curve is reduced to at most a few points per pixel
+ * column when the samples change, so even plots with many samples are painted quickly.
+ */
+class EgcPlotItem: public QGraphicsItem, public EgcAbstractPlotItem, public EgcAbstractItem
+{
+public:
+        ///std constructor
+        explicit EgcPlotItem(QGraphicsItem *parent = 0);
+        /// point constructor
+        explicit EgcPlotItem(const QPointF point, QGraphicsItem *parent = 0);
+        ///std destructor
+        virtual ~EgcPlotItem();
+        /**
+         * @brief setEntity set a pointer to the entity that contains the logical structure / frontend for the view
+         * @param entity a pointer to the entity that is associated with this object
+         */
+        void setEntity(EgcAbstractPlotEntity* entity);
+        /**
+         * @brief getEntity returns the entity that is associated with this item
+         * @return the entity associated with this item
+         */
+        EgcAbstractPlotEntity* getEntity(void) const;
+        /**
+         * @brief getPosItemIface needs to be overwritten by subclasses to get the position of the item
+         * @return the Position of the item
+         */
+        virtual QPointF getPosition( void ) const override;
+        /**
+         * @brief setPosItemIface needs to be overwritten by subclasses to set the position of the item
+         * @param point the position to set.
+         */
+        virtual void setPos(const QPointF& point) override;
+        /**
+         * @brief setCurve sets the samples of the curve to show
+         * @param x the x values of the samples (ascending)
+         * @param y the y values of the samples (NaN where the curve has a gap)
+         * @param range the range of the plot (left/right are the x range, top/bottom the y range)
+         */
+        virtual void setCurve(const QVector<double>& x, const QVector<double>& y, const QRectF& range) override;
+        /**
+         * @brief setCaption sets the text shown above the plot (the expression or an error message)
+         * @param caption the caption to show
+         */
+        virtual void setCaption(const QString& caption) override;
+        /**
+         * @brief boundingRect returns the bounding rect of the plot
+         * @return the bounding rect
+         */
+        virtual QRectF boundingRect() const override;
+        /**
+         * @brief paint paints the plot
+         * @param painter the painter to use
+         * @param option style options
+         * @param widget the widget that is painted on
+         */
+        virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0) override;
+        /**
+         * @brief type returns the type of the item
+         * @return item type
+         */
+        virtual int type() const override;
+
+protected:
+        /**
+         * @brief getEgcScene needs to be implemented by the subclasses since we cannot inherit from QGraphicsitem (the
+         * subclasses already inherit from it - and we don't want to make it complicated)
+         * @return pointer to EgCasScene
+         */
+        virtual EgCasScene* getEgcScene(void) override;
+        /**
+         * @brief itemChange reimplements change function of QGraphicsItem to be able to realize a grid
+         * @param change enum that describes state changes that are notified
+         * @param value the value that has changed
+         * @return the value that has been adjusted
+         */
+        QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+        /**
+         * @brief mouseDoubleClickEvent opens the editor of the plot
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief mousePressEvent remembers the position of the item when it is grabbed
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief mouseReleaseEvent informs the entity if the item has been moved, so the document can reorder it
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief wheelEvent zooms the plot around the mouse position if the plot is selected
+         * @param event pointer to QGraphicsSceneWheelEvent
+         */
+        virtual void wheelEvent(QGraphicsSceneWheelEvent *event) override;
+        /**
+         * @brief keyPressEvent overwrites key events
+         * @param keyEvent the key event to react on
+         */
+        virtual void keyPressEvent(QKeyEvent *keyEvent) override;
+        /**
+         * @brief bRect returns the bounding rect of the abstract item (interface to concrete item)
+         * @return bounding rect rectangle
+         */
+        virtual QRectF bRect(void) const override;
+        /**
+         * @brief getPos return the current position of the item
+         * @return the current position of the item
+         */
+        virtual QPointF getPos(void) override;
+
+private:
+        Q_DISABLE_COPY(EgcPlotItem)
+        /**
+         * @brief buildPath builds the path of the curve from the samples. Samples that fall into the same pixel
+         * column are reduced to their minimum, maximum and last value.
+         * @param x the x values of the samples
+         * @param y the y values of the samples
+         */
+        void buildPath(const QVector<double>& x, const QVector<double>& y);
+        /**
+         * @brief plotArea returns the area of the item the curve is drawn into
+         * @return the plot area
+         */
+        QRectF plotArea(void) const;
+
+        EgcAbstractPlotEntity* m_entity;        ///< pointer to plot entity
+        QPointF m_pressPos;                     ///< position of the item when the mouse button has been pressed
+        QPainterPath m_path;                    ///< the curve in item coordinates
+        QRectF m_range;                         ///< the range of the plot (x: left/right, y: top/bottom)
+        QString m_caption;                      ///< the text shown above the plot
+        QFont m_font;                           ///< the font to use for the labels
+        static const qreal s_width;             ///< width of the item
+        static const qreal s_height;            ///< height of the item
+        static const qreal s_margin;            ///< space around the plot area for the labels
+};
+
+#endif // EGCPLOTITEM_H
@@ -27,34 +27,101 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#include <qmath.h>
 #include "egcscreenpos.h"
 #include "specialNodes/egcnode.h"
 #include <libegcas/eg_mml_document.h>
 
-EgcScreenPos::EgcScreenPos()
+EgcScreenPos::EgcScreenPos() : m_columns{0}, m_rows{0}, m_cellWidth{1.0}, m_cellHeight{1.0}
 {
-        m_positions.clear();
 }
 
-void EgcScreenPos::setPositions(QVector<EgRenderingPosition> positions)
+void EgcScreenPos::setPositions(const QVector<EgRenderingPosition>& positions)
 {
-        m_positions.clear();
-        EgRenderingPosition pos;
+        m_positions = positions;
+        m_index.clear();
+        m_index.reserve(positions.size());
+
         quint64 id;
-        foreach(pos, positions) {
+        for (int i = 0; i < m_positions.size(); i++) {
+                const EgRenderingPosition& pos = m_positions.at(i);
                 id = pos.m_nodeId | (static_cast<quint64>(pos.m_subPos) << 32);
-                m_positions.insert(id, pos);
+                // if an id occurs more than once, the last one is used
+                m_index.insert(id, i);
         }
+
+        buildGrid();
+}
+
+void EgcScreenPos::buildGrid(void)
+{
+        m_grid.clear();
+        m_bounds = QRectF();
+        m_columns = 0;
+        m_rows = 0;
+
+        if (m_positions.isEmpty())
+                return;
+
+        foreach (const EgRenderingPosition& pos, m_positions)
+                m_bounds |= pos.m_itemRect;
+
+        int cellsPerSide = qCeil(qSqrt(static_cast<qreal>(m_positions.size())));
+        cellsPerSide = qBound(1, cellsPerSide, s_maxCellsPerSide);
+        m_columns = cellsPerSide;
+        m_rows = cellsPerSide;
+        m_cellWidth = m_bounds.width() / m_columns;
+        m_cellHeight = m_bounds.height() / m_rows;
+        if (m_cellWidth <= 0.0)
+                m_cellWidth = 1.0;
+        if (m_cellHeight <= 0.0)
+                m_cellHeight = 1.0;
+
+        m_grid.resize(m_columns * m_rows);
+
+        quint64 id;
+        for (int i = 0; i < m_positions.size(); i++) {
+                const EgRenderingPosition& pos = m_positions.at(i);
+                id = pos.m_nodeId | (static_cast<quint64>(pos.m_subPos) << 32);
+                if (m_index.value(id) != i)
+                        continue;
+                int colStart = getColumn(pos.m_itemRect.left());
+                int colEnd = getColumn(pos.m_itemRect.right());
+                int rowStart = getRow(pos.m_itemRect.top());
+                int rowEnd = getRow(pos.m_itemRect.bottom());
+                for (int row = rowStart; row <= rowEnd; row++) {
+                        for (int col = colStart; col <= colEnd; col++)
+                                m_grid[row * m_columns + col].append(i);
+                }
+        }
+}
+
+int EgcScreenPos::getColumn(qreal x) const
+{
+        int col = qFloor((x - m_bounds.left()) / m_cellWidth);
+
+        return qBound(0, col, m_columns - 1);
+}
+
+int EgcScreenPos::getRow(qreal y) const
+{
+        int row = qFloor((y - m_bounds.top()) / m_cellHeight);
+
+        return qBound(0, row, m_rows - 1);
 }
 
 EgRenderingPosition EgcScreenPos::getMathmlIdAtPos(const QPointF &pos)
 {
         qreal w = 1.0e+37;      //choose values that are high enough
         qreal h = 1.0e+37;
-        EgRenderingPosition i;
         EgRenderingPosition retval;
 
-        foreach (i, m_positions) {
+        if (m_grid.isEmpty() || !m_bounds.contains(pos))
+                return retval;
+
+        const QVector<int>& cell = m_grid.at(getRow(pos.y()) * m_columns + getColumn(pos.x()));
+        foreach (int index, cell) {
+                const EgRenderingPosition& i = m_positions.at(index);
                 if (i.m_itemRect.contains(pos))
                         if ( (i.m_itemRect.width() + i.m_itemRect.height()) < (w + h) ) {
                                 w = i.m_itemRect.width();
@@ -62,8 +129,7 @@ EgRenderingPosition EgcScreenPos::getMathmlIdAtPos(const QPointF &pos)
                                 retval = i;
                         } else if (retval.m_nodeId == i.m_nodeId && retval.m_subPos == 0 && i.m_subPos != 0) {
                                 //sub positions other than 0 are prefered
-                                if ( (retval.m_subPos == 0) && (i.m_subPos != 0))
-                                        retval = i;
+                                retval = i;
                         }
         }
 
@@ -78,7 +144,9 @@ bool EgcScreenPos::empty(void)
 EgRenderingPosition EgcScreenPos::findRenderingData(quint32 mathmId, quint32 subindex = 0)
 {
         EgRenderingPosition retval;
-        retval = m_positions.value(mathmId | (static_cast<quint64>(subindex) << 32));
+        int index = m_index.value(mathmId | (static_cast<quint64>(subindex) << 32), -1);
+        if (index >= 0)
+                retval = m_positions.at(index);
 
         return retval;
 }
@@ -31,13 +31,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #define EGCSCREENPOS_H
 
 #include <QHash>
+#include <QVector>
 #include <QPointF>
+#include <QRectF>
 
 class EgcNode;
 class EgRenderingPosition;
 
 /**
- * @brief The EgcScreenPos class holds screen positons of the formula chars that were rendered on the screen
+ * @brief The EgcScreenPos class holds screen positons of the formula chars that were rendered on the screen. The
+ * positions are indexed with a uniform grid, so that point queries only need to check the positions of one cell.
  */
 class EgcScreenPos
 {
@@ -45,13 +48,12 @@ public:
         EgcScreenPos();
         /**
          * @brief setPositions set the positions of the characters of the formula that have been calculated during
-         * rendering
+         * rendering. This (re)builds the index and should therefore only be called if the layout has changed.
          * @param positions the positions of the chars, mathml id's and subindexes within the id's
          */
-        void setPositions(QVector<EgRenderingPosition> positions);
+        void setPositions(const QVector<EgRenderingPosition>& positions);
         /**
          * @brief getMathmlIdAtPos returns the mathml id that fits best for the given position
-         * WARNING: This function can be expensive.
          * @param pos the position inside the formula anybody e.g. clicked on
          * @return the mathml id that is picked for the given position
          */
@@ -69,7 +71,33 @@ public:
          */
         EgRenderingPosition findRenderingData(quint32 mathmId, quint32 subindex);
 private:
-        QHash<quint64, EgRenderingPosition> m_positions; ///< the rendering positions of the characters of a formula
+        /**
+         * @brief buildGrid builds the uniform grid for the point queries
+         */
+        void buildGrid(void);
+        /**
+         * @brief getColumn returns the grid column of the given x coordinate (clamped to the grid)
+         * @param x the x coordinate
+         * @return the column in the grid
+         */
+        int getColumn(qreal x) const;
+        /**
+         * @brief getRow returns the grid row of the given y coordinate (clamped to the grid)
+         * @param y the y coordinate
+         * @return the row in the grid
+         */
+        int getRow(qreal y) const;
+
+        static const int s_maxCellsPerSide = 64;        ///< upper limit for the number of cells per side of the grid
+
+        QVector<EgRenderingPosition> m_positions;       ///< the rendering positions of the characters of a formula
+        QHash<quint64, int> m_index;                    ///< maps the mathml id and subindex to the index in m_positions
+        QVector<QVector<int> > m_grid;                  ///< indexes of the positions that overlap a cell (row major)
+        QRectF m_bounds;                                ///< bounding rectangle of all positions
+        int m_columns;                                  ///< number of columns of the grid
+        int m_rows;                                     ///< number of rows of the grid
+        qreal m_cellWidth;                              ///< width of a grid cell
+        qreal m_cellHeight;                             ///< height of a grid cell
 };
 
 #endif // EGCSCREENPOS_H
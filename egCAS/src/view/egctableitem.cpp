@@ -0,0 +1,255 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QGraphicsSceneMouseEvent>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QFontMetricsF>
+#include "egctableitem.h"
+#include "egcasscene.h"
+#include "egcitemtypes.h"
+#include "entities/egcabstracttableentity.h"
+
+const qreal EgcTableItem::s_padding = 3.0;
+
+EgcTableItem::EgcTableItem(QGraphicsItem *parent) : QGraphicsItem{parent}, m_entity{nullptr}, m_rowHeight{0.0}
+{
+        setFlags(ItemIsMovable | ItemIsSelectable | ItemIsFocusable | ItemSendsScenePositionChanges);
+        layoutCells();
+}
+
+EgcTableItem::EgcTableItem(const QPointF point, QGraphicsItem *parent) : EgcTableItem{parent}
+{
+        QGraphicsItem::setPos(point);
+}
+
+EgcTableItem::~EgcTableItem()
+{
+}
+
+void EgcTableItem::setEntity(EgcAbstractTableEntity* entity)
+{
+        m_entity = entity;
+}
+
+EgcAbstractTableEntity* EgcTableItem::getEntity(void) const
+{
+        return m_entity;
+}
+
+QPointF EgcTableItem::getPosition( void ) const
+{
+        return pos();
+}
+
+void EgcTableItem::setPos(const QPointF &point)
+{
+        QGraphicsItem::setPos(snap(point));
+}
+
+void EgcTableItem::setCells(const QVector<QStringList>& cells)
+{
+        prepareGeometryChange();
+        m_cells = cells;
+        layoutCells();
+        update();
+}
+
+void EgcTableItem::layoutCells(void)
+{
+        QFontMetricsF metrics(m_font);
+        m_rowHeight = metrics.height() + 2 * s_padding;
+        m_columnWidths.clear();
+
+        foreach (QStringList row, m_cells) {
+                if (row.size() > m_columnWidths.size())
+                        m_columnWidths.resize(row.size());
+                for (int i = 0; i < row.size(); i++) {
+                        qreal width = metrics.width(row.at(i)) + 2 * s_padding;
+                        if (width > m_columnWidths.at(i))
+                                m_columnWidths[i] = width;
+                }
+        }
+
+        qreal width = 0.0;
+        foreach (qreal w, m_columnWidths)
+                width += w;
+        // an empty table still needs some space to be selectable
+        if (m_cells.isEmpty())
+                m_rect = QRectF(0.0, 0.0, m_rowHeight, m_rowHeight);
+        else
+                m_rect = QRectF(0.0, 0.0, width, m_rowHeight * m_cells.size());
+}
+
+QRectF EgcTableItem::boundingRect() const
+{
+        return m_rect;
+}
+
+void EgcTableItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+        (void) option;
+        (void) widget;
+
+        painter->save();
+        painter->setFont(m_font);
+        painter->setPen(QPen(Qt::black, 0));
+
+        qreal y = 0.0;
+        for (int row = 0; row < m_cells.size(); row++) {
+                const QStringList& cells = m_cells.at(row);
+                qreal x = 0.0;
+                if (row == 0) {
+                        QFont bold = m_font;
+                        bold.setBold(true);
+                        painter->setFont(bold);
+                }
+                for (int column = 0; column < m_columnWidths.size(); column++) {
+                        QRectF cell(x, y, m_columnWidths.at(column), m_rowHeight);
+                        painter->drawRect(cell);
+                        if (column < cells.size())
+                                painter->drawText(cell.adjusted(s_padding, s_padding, -s_padding, -s_padding),
+                                                  Qt::AlignRight | Qt::AlignVCenter, cells.at(column));
+                        x += m_columnWidths.at(column);
+                }
+                if (row == 0)
+                        painter->setFont(m_font);
+                y += m_rowHeight;
+        }
+
+        if (isSelected() || hasFocus())
+                painter->drawRect(m_rect);
+
+        painter->restore();
+}
+
+QVariant EgcTableItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+        if (change == ItemPositionChange && scene()) {
+                // value is the new position.
+                QPointF point = value.toPointF();
+                ensureVisibility();
+                return snap(point);
+        }
+
+        return QGraphicsItem::itemChange(change, value);
+}
+
+void EgcTableItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
+{
+        m_pressPos = pos();
+        QGraphicsItem::mousePressEvent(event);
+}
+
+void EgcTableItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+{
+        QGraphicsItem::mouseReleaseEvent(event);
+        if (pos() != m_pressPos && m_entity)
+                m_entity->itemChanged(EgcItemChangeType::posChanged);
+}
+
+void EgcTableItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
+{
+        if (m_entity) {
+                event->accept();
+                m_entity->itemChanged(EgcItemChangeType::itemEdited);
+        } else {
+                QGraphicsItem::mouseDoubleClickEvent(event);
+        }
+}
+
+EgCasScene* EgcTableItem::getEgcScene(void)
+{
+        QGraphicsScene *scene = this->scene();
+        if (scene) {
+                return static_cast<EgCasScene*>(scene);
+        }
+
+        return nullptr;
+}
+
+void EgcTableItem::keyPressEvent(QKeyEvent *keyEvent)
+{
+        bool accepted = false;
+        int key = keyEvent->key();
+        EgCasScene* scn = qobject_cast<EgCasScene*>(scene());
+        if (!scn)
+                return;
+
+        switch (key) {
+        case Qt::Key_Left:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::left, *this);
+                break;
+        case Qt::Key_Right:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::right, *this);
+                break;
+        case Qt::Key_Up:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::up, *this);
+                break;
+        case Qt::Key_Down:
+                accepted = true;
+                scn->itemYieldsFocus(EgcSceneSnapDirection::down, *this);
+                break;
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+                if (m_entity) {
+                        accepted = true;
+                        m_entity->itemChanged(EgcItemChangeType::itemEdited);
+                }
+                break;
+        case Qt::Key_Delete:
+                accepted = true;
+                break;
+        }
+
+        if (accepted) {
+                keyEvent->accept();
+        } else {
+                keyEvent->ignore();
+                QGraphicsItem::keyPressEvent(keyEvent);
+        }
+}
+
+int EgcTableItem::type() const
+{
+        return static_cast<int>(EgcGraphicsItemType::EgcTableItemType);
+}
+
+QRectF EgcTableItem::bRect(void) const
+{
+        return sceneBoundingRect();
+}
+
+QPointF EgcTableItem::getPos()
+{
+        return pos();
+}
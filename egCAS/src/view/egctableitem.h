@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifndef EGCTABLEITEM_H
+#define EGCTABLEITEM_H
+
+#include <QGraphicsItem>
+#include <QFont>
+#include "egcabstracttableitem.h"
+#include "egcabstractitem.h"
+
+class EgcAbstractTableEntity;
+
+/**
+ * @brief The EgcTableItem class shows the results of a parameter sweep as table
+ */
+class EgcTableItem: public QGraphicsItem, public EgcAbstractTableItem, public EgcAbstractItem
+{
+public:
+        ///std constructor
+        explicit EgcTableItem(QGraphicsItem *parent = 0);
+        /// point constructor
+        explicit EgcTableItem(const QPointF point, QGraphicsItem *parent = 0);
+        ///std destructor
+        virtual ~EgcTableItem();
+        /**
+         * @brief setEntity set a pointer to the entity that contains the logical structure / frontend for the view
+         * @param entity a pointer to the entity that is associated with this object
+         */
+        void setEntity(EgcAbstractTableEntity* entity);
+        /**
+         * @brief getEntity returns the entity that is associated with this item
+         * @return the entity associated with this item
+         */
+        EgcAbstractTableEntity* getEntity(void) const;
+        /**
+         * @brief getPosItemIface needs to be overwritten by subclasses to get the position of the item
+         * @return the Position of the item
+         */
+        virtual QPointF getPosition( void ) const override;
+        /**
+         * @brief setPosItemIface needs to be overwritten by subclasses to set the position of the item
+         * @param point the position to set.
+         */
+        virtual void setPos(const QPointF& point) override;
+        /**
+         * @brief setCells sets the contents of the table to show
+         * @param cells the cells of the table row by row, the first row is the header
+         */
+        virtual void setCells(const QVector<QStringList>& cells) override;
+        /**
+         * @brief boundingRect returns the bounding rect of the table
+         * @return the bounding rect
+         */
+        virtual QRectF boundingRect() const override;
+        /**
+         * @brief paint paints the table
+         * @param painter the painter to use
+         * @param option style options
+         * @param widget the widget that is painted on
+         */
+        virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = 0) override;
+        /**
+         * @brief type returns the type of the item
+         * @return item type
+         */
+        virtual int type() const override;
+
+protected:
+        /**
+         * @brief getEgcScene needs to be implemented by the subclasses since we cannot inherit from QGraphicsitem (the
+         * subclasses already inherit from it - and we don't want to make it complicated)
+         * @return pointer to EgCasScene
+         */
+        virtual EgCasScene* getEgcScene(void) override;
+        /**
+         * @brief itemChange reimplements change function of QGraphicsItem to be able to realize a grid
+         * @param change enum that describes state changes that are notified
+         * @param value the value that has changed
+         * @return the value that has been adjusted
+         */
+        QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+        /**
+         * @brief mouseDoubleClickEvent opens the editor of the table
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief mousePressEvent remembers the position of the item when it is grabbed
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief mouseReleaseEvent informs the entity if the item has been moved, so the document can reorder it
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief keyPressEvent overwrites key events
+         * @param keyEvent the key event to react on
+         */
+        virtual void keyPressEvent(QKeyEvent *keyEvent) override;
+        /**
+         * @brief bRect returns the bounding rect of the abstract item (interface to concrete item)
+         * @return bounding rect rectangle
+         */
+        virtual QRectF bRect(void) const override;
+        /**
+         * @brief getPos return the current position of the item
+         * @return the current position of the item
+         */
+        virtual QPointF getPos(void) override;
+
+private:
+        Q_DISABLE_COPY(EgcTableItem)
+        /**
+         * @brief layoutCells calculates the column widths and the size of the table
+         */
+        void layoutCells(void);
+
+        EgcAbstractTableEntity* m_entity;       ///< pointer to table entity
+        QPointF m_pressPos;                     ///< position of the item when the mouse button has been pressed
+        QVector<QStringList> m_cells;           ///< the cells of the table (first row is the header)
+        QVector<qreal> m_columnWidths;          ///< width of every column
+        qreal m_rowHeight;                      ///< height of a row
+        QRectF m_rect;                          ///< the bounding rect of the table
+        QFont m_font;                           ///< the font to use for the cells
+        static const qreal s_padding;           ///< space between the text and the grid lines
+};
+
+#endif // EGCTABLEITEM_H
@@ -91,6 +91,19 @@ void EgcTextItem::mouseDoubleClickEvent(QGraphicsSceneMouseEvent* event)
         }
 }
 
+void EgcTextItem::mousePressEvent(QGraphicsSceneMouseEvent* event)
+{
+        m_pressPos = pos();
+        QGraphicsTextItem::mousePressEvent(event);
+}
+
+void EgcTextItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
+{
+        QGraphicsTextItem::mouseReleaseEvent(event);
+        if (pos() != m_pressPos && getEnity())
+                getEnity()->itemChanged(EgcItemChangeType::posChanged);
+}
+
 void EgcTextItem::setEditMode(bool activateEditing)
 {
         if (activateEditing) {
@@ -129,6 +142,7 @@ void EgcTextItem::focusInEvent(QFocusEvent* event)
 
 void EgcTextItem::focusOutEvent(QFocusEvent *event)
 {
+        bool edited = m_editingActivated;
         m_editingActivated = false;
         setTextInteractionFlags(Qt::NoTextInteraction);
         setFlag(ItemIsFocusable);
@@ -140,6 +154,8 @@ void EgcTextItem::focusOutEvent(QFocusEvent *event)
         unsetCursor();
 
         QGraphicsTextItem::focusOutEvent(event);
+        if (edited && getEnity())
+                getEnity()->itemChanged(EgcItemChangeType::contentChanged);
 }
 
 void EgcTextItem::setEntity(EgcAbstractTextEntity* entity)
@@ -117,6 +117,16 @@ protected:
          * @param event pointer to QGraphicsSceneMouseEvent
          */
         void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
+        /**
+         * @brief mousePressEvent remembers the position of the item when it is grabbed
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
+        /**
+         * @brief mouseReleaseEvent informs the entity if the item has been moved
+         * @param event pointer to QGraphicsSceneMouseEvent
+         */
+        virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
         /**
          * @brief focusOutEvent overrides
          * @param event
@@ -175,6 +185,7 @@ private:
         Q_DISABLE_COPY(EgcTextItem)
         EgcAbstractTextEntity* m_entity;        ///< pointer to text entity (no ownership)
         bool m_editingActivated;                ///< editing has already been activated
+        QPointF m_pressPos;                     ///< position of the item when the mouse button has been pressed
 };
 
 #endif // EGCTEXTITEM_H
@@ -60,6 +60,7 @@ qreal EgcWorksheet::getLeftMargin(void) const
 void EgcWorksheet::setLeftMargin(qreal margin)
 {
         m_leftMargin = margin;
+        m_scene.invalidateBackground();
 }
 
 qreal EgcWorksheet::getRightMargin(void) const
@@ -70,6 +71,7 @@ qreal EgcWorksheet::getRightMargin(void) const
 void EgcWorksheet::setRightMargin(qreal margin)
 {
         m_rightMargin = margin;
+        m_scene.invalidateBackground();
 }
 
 qreal EgcWorksheet::getTopMargin(void) const
@@ -80,6 +82,7 @@ qreal EgcWorksheet::getTopMargin(void) const
 void EgcWorksheet::setTopMargin(qreal margin)
 {
         m_topMargin = margin;
+        m_scene.invalidateBackground();
 }
 
 qreal EgcWorksheet::getBottomMargin(void) const
@@ -90,6 +93,7 @@ qreal EgcWorksheet::getBottomMargin(void) const
 void EgcWorksheet::setBottomMargin(qreal margin)
 {
         m_bottomMargin = margin;
+        m_scene.invalidateBackground();
 }
 
 QPointF EgcWorksheet::snapWorksheet(const QPointF& point) const
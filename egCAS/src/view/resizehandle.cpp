@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <QGraphicsSceneMouseEvent>
 #include <QtCore/qmath.h>
 #include "resizehandle.h"
+#include "egcpixmapitem.h"
 
 ResizeHandle::ResizeHandle(QGraphicsItem *content, const QSizeF& size) :
         m_resizableContent(content), m_handleSize(size), m_contentStartScale(0.0), m_contentStartDiag(0.0), m_addedToScene(false), m_selectionState(false)
@@ -91,6 +92,11 @@ void ResizeHandle::mouseReleaseEvent(QGraphicsSceneMouseEvent * event)
         QGraphicsItem::mouseReleaseEvent(event);
         m_resizableContent->setFlag(ItemIsMovable, true);
         setPos(mapToScene(mapFromItem(m_resizableContent, m_resizableContent->boundingRect().bottomRight())));
+        if (m_resizableContent->scale() != m_contentStartScale) {
+                EgcPixmapItem* pixmap = dynamic_cast<EgcPixmapItem*>(m_resizableContent);
+                if (pixmap)
+                        pixmap->resized();
+        }
 }
 
 void ResizeHandle::paint(QPainter * painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
@@ -0,0 +1,267 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QString>
+#include <QtTest>
+#include <QImage>
+#include <QPainter>
+#include <QApplication>
+#include <QSignalSpy>
+#include <iostream>
+#include "parser/egckernelparser.h"
+#include "egcnodes.h"
+#include "entities/egcformulaentity.h"
+#include "actions/egcaction.h"
+#include "actions/egcactionmapper.h"
+#include "view/egcformulaitem.h"
+#include "utils/egcperfcounter.h"
+#include "casKernel/egcmaximaconn.h"
+#include "casKernel/egcnumericevaluator.h"
+
+/*
+ * This benchmark uses the real restructuring parser (RestructParserProvider from the egcas_parser library), since the
+ * time spent in the parser is one of the things to measure.
+ */
+
+class EgcasBench_Editing : public QObject
+{
+        Q_OBJECT
+
+public:
+        EgcasBench_Editing() {}
+
+private Q_SLOTS:
+        void keystrokeToPaint_data();
+        void keystrokeToPaint();
+        void definiteIntegral_data();
+        void definiteIntegral();
+        void cleanupTestCase();
+private:
+        /**
+         * @brief getKernel returns the maxima kernel, the kernel is started on first use
+         * @return the kernel or a nullptr if maxima could not be started
+         */
+        EgcMaximaConn* getKernel(void);
+        /**
+         * @brief createFormula creates a formula with the given number of summands
+         * @param summands the number of summands the formula shall have
+         * @return the string of the formula to parse
+         */
+        static QString createFormula(int summands);
+        /**
+         * @brief replay replays the given script on the formula and repaints the formula after every action
+         * @param script the script to replay. Letters and digits are inserted as characters, "+-* /^" as operators,
+         * '<' is backspace, '[' moves the cursor backward and ']' moves it forward.
+         * @param formula the formula to replay the script on
+         * @param item the item the formula is rendered with
+         * @param painter the painter to paint the item with
+         */
+        static void replay(const QString& script, EgcFormulaEntity& formula, EgcFormulaItem& item, QPainter& painter);
+
+        QScopedPointer<EgcMaximaConn> m_kernel; ///< maxima kernel for comparing the native calculations with
+};
+
+QString EgcasBench_Editing::createFormula(int summands)
+{
+        QString formula("x");
+
+        for (int i = 1; i < summands; i++)
+                formula += QString("+x");
+
+        return formula;
+}
+
+void EgcasBench_Editing::replay(const QString& script, EgcFormulaEntity& formula, EgcFormulaItem& item,
+                                QPainter& painter)
+{
+        foreach (QChar ch, script) {
+                EgcAction action;
+                if (ch.isLetterOrNumber()) {
+                        action = EgcAction(EgcOperations::alnumKeyPressed, ch);
+                } else if (ch == '<') {
+                        action.m_op = EgcOperations::backspacePressed;
+                } else if (ch == '[') {
+                        action.m_op = EgcOperations::cursorBackward;
+                } else if (ch == ']') {
+                        action.m_op = EgcOperations::cursorForward;
+                } else {
+                        action = EgcActionMapper::getMathOperationAction(ch);
+                }
+                formula.handleAction(action);
+                item.paint(&painter, nullptr, nullptr);
+        }
+}
+
+void EgcasBench_Editing::keystrokeToPaint_data()
+{
+        QTest::addColumn<int>("summands");
+        QTest::addColumn<QString>("script");
+
+        // every script leaves the formula in the state it was before, so the formula size stays constant
+        QString typing("+ab<<<");
+        QString operators("+2*3^4<<<<<<");
+        QString cursor("[[[[]]]]");
+
+        QList<int> sizes = QList<int>() << 4 << 16 << 64 << 256;
+        foreach (int size, sizes) {
+                QTest::newRow(QString("typing, %1 summands").arg(size).toLatin1().constData()) << size << typing;
+                QTest::newRow(QString("operators, %1 summands").arg(size).toLatin1().constData()) << size << operators;
+                QTest::newRow(QString("cursor, %1 summands").arg(size).toLatin1().constData()) << size << cursor;
+        }
+}
+
+void EgcasBench_Editing::keystrokeToPaint()
+{
+        QFETCH(int, summands);
+        QFETCH(QString, script);
+
+        EgcKernelParser parser;
+        QScopedPointer<EgcNode> tree;
+        tree.reset(parser.parseKernelOutput(createFormula(summands)));
+        if (tree.isNull())
+                std::cout << parser.getErrorMessage().toStdString();
+        QVERIFY(!tree.isNull());
+
+        EgcFormulaItem item;
+        EgcFormulaEntity formula(*tree.take());
+        formula.setItem(&item);
+
+        QImage image(4096, 512, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&image);
+
+        EgcAction action;
+        action.m_op = EgcOperations::formulaActivated;
+        formula.handleAction(action);
+        action.m_op = EgcOperations::endPressed;
+        formula.handleAction(action);
+
+        EgcPerfCounter::reset();
+        QBENCHMARK {
+                replay(script, formula, item, painter);
+        }
+
+        std::cout << QTest::currentDataTag() << " (time per phase call)" << std::endl;
+        std::cout << EgcPerfCounter::report().toStdString() << std::endl;
+}
+
+void EgcasBench_Editing::definiteIntegral_data()
+{
+        QTest::addColumn<QString>("integral");
+        QTest::addColumn<bool>("native");
+
+        // the same integrals are calculated by the native integrator and by maxima (romberg)
+        QStringList integrals = QStringList() << "_integrate(0,3,sin(t^2),t)=0"
+                                              << "_integrate(0,2,exp(-t^2),t)=0"
+                                              << "_integrate(0,1,1/(1+t^2),t)=0"
+                                              << "_integrate(0,20,cos(t)*exp(-t/5),t)=0";
+        foreach (QString integral, integrals) {
+                QTest::newRow(QString("native, %1").arg(integral).toLatin1().constData()) << integral << true;
+                QTest::newRow(QString("romberg, %1").arg(integral).toLatin1().constData()) << integral << false;
+        }
+}
+
+void EgcasBench_Editing::definiteIntegral()
+{
+        QFETCH(QString, integral);
+        QFETCH(bool, native);
+
+        EgcKernelParser parser;
+        QScopedPointer<EgcNode> tree;
+        tree.reset(parser.parseKernelOutput(integral));
+        if (tree.isNull())
+                std::cout << parser.getErrorMessage().toStdString();
+        QVERIFY(!tree.isNull());
+        EgcFormulaEntity formula(*tree.take());
+        QString command = formula.getCASKernelCommand();
+        QVERIFY(command.contains("romberg"));
+
+        EgcNumericEvaluator evaluator;
+        QString nativeResult;
+        if (native) {
+                QBENCHMARK {
+                        QVERIFY(evaluator.calculate(formula, nativeResult));
+                }
+                return;
+        }
+
+        EgcMaximaConn* kernel = getKernel();
+        if (!kernel)
+                QSKIP("maxima could not be started");
+        QSignalSpy results(kernel, SIGNAL(resultReceived(QString)));
+        QBENCHMARK {
+                kernel->sendCommand(command);
+                QVERIFY(results.wait(30000));
+        }
+
+        // both ways calculate the same value (romberg only reaches a relative tolerance of 1e-4)
+        QVERIFY(evaluator.calculate(formula, nativeResult));
+        bool ok;
+        double expected = results.last().at(0).toString().toDouble(&ok);
+        QVERIFY(ok);
+        double value = nativeResult.toDouble(&ok);
+        QVERIFY(ok);
+        QVERIFY(qAbs(value - expected) <= 1e-4 * qAbs(expected));
+}
+
+void EgcasBench_Editing::cleanupTestCase()
+{
+        if (!m_kernel.isNull()) {
+                QSignalSpy terminated(m_kernel.data(), SIGNAL(kernelTerminated()));
+                m_kernel->quit();
+                terminated.wait(5000);
+        }
+}
+
+EgcMaximaConn* EgcasBench_Editing::getKernel(void)
+{
+        if (m_kernel.isNull()) {
+                m_kernel.reset(new (std::nothrow) EgcMaximaConn());
+                if (m_kernel.isNull())
+                        return nullptr;
+                QSignalSpy started(m_kernel.data(), SIGNAL(kernelStarted()));
+                if (!started.wait(30000))
+                        m_kernel.reset();
+        }
+
+        return m_kernel.data();
+}
+
+int main(int argc, char *argv[])
+{
+        // the benchmark shall also run on machines without a display
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+
+        QApplication app(argc, argv);
+        EgcasBench_Editing bench;
+
+        return QTest::qExec(&bench, argc, argv);
+}
+
+#include "tst_egcas_bench_editing.moc"
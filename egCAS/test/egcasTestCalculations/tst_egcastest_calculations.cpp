@@ -39,6 +39,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "visitor/egcmaximavisitor.h"
 #include "visitor/egcmathmlvisitor.h"
 #include "egcmaximaconn.h"
+#include "egcnumericevaluator.h"
+#include "egcnumericprogram.h"
+#include "egcparametersweep.h"
+#include "egcplotsampler.h"
+#include "egcnumericintegrator.h"
+#include "entities/egcentitylist.h"
+#include "document/egccalculation.h"
+#include "egcabstractformulaitem.h"
 #include "casKernel/parser/abstractkernelparser.h"
 #include "casKernel/parser/restructparserprovider.h"
 
@@ -60,7 +68,43 @@ RestructParserProvider::RestructParserProvider()
 RestructParserProvider::~RestructParserProvider() {}
 AbstractKernelParser* RestructParserProvider::getRestructParser(void) { return s_parser;}
 
+//mock kernel connection that only records the commands sent, results are emitted by the tests
+class EgcTestKernelConn : public EgcKernelConn
+{
+public:
+        EgcTestKernelConn() {}
+        virtual ~EgcTestKernelConn() {}
+        virtual void sendCommand(QString cmd) override {m_commands.append(cmd);}
+        virtual void quit(void) override {}
+        virtual void reset() override {}
+        QStringList m_commands;
+protected:
+        virtual void stdOutput(void) override {}
+};
 
+//mock formula item that only holds the position of a formula
+class EgcTestFormulaItem : public EgcAbstractFormulaItem
+{
+public:
+        EgcTestFormulaItem() {}
+        virtual ~EgcTestFormulaItem() {}
+        virtual QPointF getPosition(void) const override {return m_pos;}
+        virtual void setPos(const QPointF& point) override {m_pos = point;}
+        virtual void updateView(void) override {}
+        virtual void updateViewLazy(QSizeF estimatedSize) override {(void) estimatedSize;}
+        virtual QSizeF getLayoutSize(void) const override {return QSizeF();}
+        virtual void showUnderline(quint32 mathmlId) override {(void) mathmlId;}
+        virtual void showLeftCursor(quint32 mathmlId, quint32 subindex) override {(void) mathmlId; (void) subindex;}
+        virtual void showRightCursor(quint32 mathmlId, quint32 subindex) override {(void) mathmlId; (void) subindex;}
+        virtual QRectF getElementRect(quint32 mathmlId, quint32 subindex) override
+        {(void) mathmlId; (void) subindex; return QRectF();}
+        virtual void showCursor(QLineF cursor) override {(void) cursor;}
+        virtual void hideCursors(void) override {}
+        virtual void selectFormula(bool selected) override {(void) selected;}
+        virtual void setErrorMessage(QString msg) override {(void) msg;}
+        virtual void clearErrorMessage(void) override {}
+        QPointF m_pos;
+};
 
 class EgcasTest_Calculation : public QObject
 {
@@ -73,10 +117,20 @@ public Q_SLOTS:
         void kernelStarted();
 private Q_SLOTS:
         void basicTestCalculation();
+        void testNumericEvaluator();
+        void testNumericProgram();
+        void testReformatResult();
+        void testParameterSweep();
+        void testPlotSampler();
+        void testNumericIntegrator();
+        void testDeleteWhileCalculating();
+        void testMoveChangesOrder();
 private:
         EgcNode* getTree(QString formula);
+        QString getResult(EgcFormulaEntity& result);
         QScopedPointer<EgcMaximaConn> conn;
         EgcFormulaEntity formula;
+        EgcParameterSweep sweep;
         EgcKernelParser parser;
         bool hasEnded;
 };
@@ -91,6 +145,16 @@ EgcNode* EgcasTest_Calculation::getTree(QString formula)
         return tree.take();
 }
 
+QString EgcasTest_Calculation::getResult(EgcFormulaEntity& result)
+{
+        EgcBinaryNode* root = static_cast<EgcBinaryNode*>(result.getRootElement());
+        EgcNode* value = root->getChild(1);
+        if (!value || value->getNodeType() != EgcNodeType::NumberNode)
+                return QString();
+
+        return static_cast<EgcNumberNode*>(value)->getValue();
+}
+
 void EgcasTest_Calculation::basicTestCalculation()
 {                
         conn.reset(new (std::nothrow) EgcMaximaConn(this));
@@ -129,16 +193,549 @@ void EgcasTest_Calculation::evaluateResult(QString result)
                 form_res.setRootElement(getTree("y=3"));
                 QVERIFY(form_res.setResult(getTree(result)) == true);
                 QVERIFY(form_res.getMathMlCode() == "<math><mrow  id=\"3\" ><mi mathvariant=\"normal\"  id=\"1\" >y</mi><mo id=\"4\" >=</mo><mn id=\"2\" >31084.81900000001</mn></mrow></math>");
+
+                //cross check the native numeric evaluation with the kernel result
+                EgcNumericEvaluator evaluator;
+                EgcFormulaEntity definition;
+                definition.setRootElement(getTree("x:33.1"));
+                QVERIFY(evaluator.define(definition));
+                QScopedPointer<EgcNode> tree(getTree("x^3+36-8*651.984"));
+                EgcNumericValue value;
+                QVERIFY(evaluator.evaluate(*tree, value));
+                QVERIFY(!value.m_exact);
+                QVERIFY(qAbs(static_cast<double>(value.m_value) - result.toDouble()) <= 1e-12 * qAbs(result.toDouble()));
+
+                formula.setRootElement(getTree("sqrt(2.0)*exp(1.5)/3-2^10+abs(-7)=0"));
+                conn->sendCommand(formula.getCASKernelCommand());
+        } else if (i == 2) {
+                EgcNumericEvaluator evaluator;
+                QString native;
+                QVERIFY(evaluator.calculate(formula, native));
+                //the kernel command of a result formula is not wrapped into any formatting, e.g. -1014.0
+                QVERIFY(!formula.getCASKernelCommand().contains("float("));
+                bool ok;
+                double expected = result.toDouble(&ok);
+                QVERIFY(ok);
+                QVERIFY(qAbs(native.toDouble() - expected) <= 1e-12 * qAbs(expected));
+
+                //the whole parameter sweep is calculated with one kernel command
+                QVERIFY(sweep.setExpression("x^2*y+sin(x)"));
+                sweep.setRange(0, EgcSweepRange("x", 0.0, 1.0, 5));
+                sweep.setRange(1, EgcSweepRange("y", 1.0, 3.0, 3));
+                conn->sendCommand(sweep.getKernelCommand());
+        } else if (i == 3) {
+                //cross check the native sweep with the kernel result
+                QVERIFY(sweep.setKernelResult(result));
+                QStringList kernelRes = sweep.getValues();
+                EgcNumericEvaluator evaluator;
+                QVERIFY(sweep.evaluate(evaluator));
+                QStringList nativeRes = sweep.getValues();
+                QVERIFY(kernelRes.size() == 15 && nativeRes.size() == 15);
+                for (int j = 0; j < 15; j++) {
+                        double expected = kernelRes.at(j).toDouble();
+                        QVERIFY(qAbs(nativeRes.at(j).toDouble() - expected) <= 1e-12 * qMax(qAbs(expected), 1.0));
+                }
+
+                //an oscillating integral, calculated with romberg by the kernel
+                formula.setRootElement(getTree("_integrate(0,3,sin(t^2),t)=0"));
+                QVERIFY(formula.getCASKernelCommand().contains("romberg"));
+                conn->sendCommand(formula.getCASKernelCommand());
+        } else if (i == 4) {
+                //compare the accuracy of the native integrator with romberg
+                EgcNumericEvaluator evaluator;
+                QString native;
+                QVERIFY(evaluator.calculate(formula, native));
+                bool ok;
+                double expected = result.toDouble(&ok);
+                QVERIFY(ok);
+                double value = native.toDouble(&ok);
+                QVERIFY(ok);
+                //romberg only reaches a relative tolerance of 1e-4 (rombergtol)
+                QVERIFY(qAbs(value - expected) <= 1e-4 * qAbs(expected));
+
+                //definitions with integrals are calculated natively, the kernel only gets the value (no romberg)
+                EgcFormulaEntity definition;
+                definition.setRootElement(getTree("y:_integrate(0,3,sin(t^2),t)"));
+                QVERIFY(definition.getCASKernelCommand().contains("romberg"));
+                QVERIFY(evaluator.define(definition));
+                QString command;
+                QVERIFY(evaluator.getDefinitionCommand(definition, command));
+                QVERIFY(!command.contains("romberg"));
+                QVERIFY(command.startsWith("y:"));
                 hasEnded = true;
         }
 
         i++;
 }
 
+void EgcasTest_Calculation::testNumericEvaluator()
+{
+        EgcNumericEvaluator evaluator;
+        EgcFormulaEntity definition;
+        EgcFormulaEntity result;
+        QString res;
+
+        //exact integer arithmetic stays exact
+        result.setRootElement(getTree("(3+4)*2^5-6/3=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "222");
+
+        //floats are contagious
+        result.setRootElement(getTree("1.5*4-8=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "-2.0");
+
+        //rational and irrational exact results are left to the kernel
+        result.setRootElement(getTree("1/3=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        result.setRootElement(getTree("sqrt(2)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        result.setRootElement(getTree("sqrt(16)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "4");
+        //huge indices don't take long
+        result.setRootElement(getTree("_root(1000000000000000,0)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "0");
+        result.setRootElement(getTree("_root(1000000000000000,1)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "1");
+        result.setRootElement(getTree("_root(1000000000000000,5)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        result.setRootElement(getTree("_root(3,27)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "3");
+
+        //undefined symbols are left to the kernel
+        result.setRootElement(getTree("a*2.0=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        definition.setRootElement(getTree("a:2.5e3"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "5000.0");
+        evaluator.undefine("a");
+        QVERIFY(!evaluator.calculate(result, res));
+
+        //a symbolic definition hides a previous numeric one
+        QVERIFY(evaluator.define(definition));
+        definition.setRootElement(getTree("a:b+1"));
+        QVERIFY(!evaluator.define(definition));
+        QVERIFY(!evaluator.calculate(result, res));
+
+        //big numbers use the exponent notation of the kernel
+        EgcNumericValue value(1.5e20L, false);
+        QVERIFY(EgcNumericEvaluator::toKernelString(value) == "1.5e+20");
+        value = EgcNumericValue(2.5e-7L, false);
+        QVERIFY(EgcNumericEvaluator::toKernelString(value) == "2.5e-7");
+}
+
+
+void EgcasTest_Calculation::testNumericProgram()
+{
+        EgcNumericEvaluator evaluator;
+        EgcFormulaEntity definition;
+        EgcFormulaEntity result;
+        QString res;
+
+        //constant parts of the body are folded
+        definition.setRootElement(getTree("f(x):x^2+2*x+(3*4-2)"));
+        EgcBinaryNode* root = static_cast<EgcBinaryNode*>(definition.getRootElement());
+        EgcNumericProgram program;
+        QVERIFY(program.compile(*root->getChild(0), root->getChild(1)));
+        QVERIFY(program.getNumberOfArguments() == 1);
+        QVERIFY(program.getSize() == 9);
+        QVERIFY(definition.getCASKernelCommand().contains(":="));
 
+        //calls with exact and float arguments
+        QVERIFY(evaluator.define(definition));
+        result.setRootElement(getTree("f(3)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "25");
+        result.setRootElement(getTree("f(0.5)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "11.25");
 
+        //global variables are looked up when the function is called
+        definition.setRootElement(getTree("g(x):a*f(x)"));
+        QVERIFY(evaluator.define(definition));
+        result.setRootElement(getTree("g(1.0)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        definition.setRootElement(getTree("a:2"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(res == "26.0");
 
+        //parameter sweeps call the compiled function directly
+        QVector<EgcNumericValue> args(1);
+        EgcNumericValue value;
+        for (int i = 0; i < 1000; i++) {
+                args[0] = EgcNumericValue(i * 0.5L, false);
+                QVERIFY(evaluator.callFunction("f", args, value));
+                QVERIFY(qAbs(static_cast<double>(value.m_value) - (i * 0.5 + 1.0) * (i * 0.5 + 1.0) - 9.0) < 1e-9);
+        }
+
+        //rational results stay in the kernel, float results don't
+        definition.setRootElement(getTree("h(x):x/3"));
+        QVERIFY(evaluator.define(definition));
+        result.setRootElement(getTree("h(2)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+        result.setRootElement(getTree("h(2.0)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+
+        //bodies with constant rationals can only be calculated by the kernel
+        definition.setRootElement(getTree("k(x):x+1/3"));
+        QVERIFY(!evaluator.define(definition));
+        result.setRootElement(getTree("k(1.0)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+
+        //recursive functions are stopped
+        definition.setRootElement(getTree("r(x):r(x)+1"));
+        QVERIFY(evaluator.define(definition));
+        result.setRootElement(getTree("r(1.0)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+
+        //a function that has been removed is left to the kernel
+        evaluator.undefine("f");
+        result.setRootElement(getTree("f(3)=0"));
+        QVERIFY(!evaluator.calculate(result, res));
+}
+
+
+
+
+void EgcasTest_Calculation::testReformatResult()
+{
+        EgcFormulaEntity result;
+
+        //exact rationals of the kernel are converted to floats for the number result types
+        result.setRootElement(getTree("x=0"));
+        result.setNumberResultType(EgcNumberResultType::ScientificType);
+        result.setNumberOfSignificantDigits(3);
+        QVERIFY(result.setResult(getTree("1/3")));
+        QCOMPARE(getResult(result), QString("3.33e-1"));
+        result.setNumberResultType(EgcNumberResultType::EngineeringType);
+        (void) result.reformatResult();
+        QCOMPARE(getResult(result), QString("333.0e-3"));
+        result.setNumberResultType(EgcNumberResultType::IntegerType);
+        QVERIFY(result.setResult(getTree("7/2")));
+        QCOMPARE(getResult(result), QString("4"));
+
+        //irrational exact values too
+        result.setNumberResultType(EgcNumberResultType::ScientificType);
+        result.setNumberOfSignificantDigits(4);
+        QVERIFY(result.setResult(getTree("sqrt(2)")));
+        QCOMPARE(getResult(result), QString("1.414"));
+        result.setNumberResultType(EgcNumberResultType::IntegerType);
+        QVERIFY(result.setResult(getTree("sqrt(2)")));
+        QCOMPARE(getResult(result), QString("1"));
+
+        //the standard type keeps the exact result of the kernel
+        result.setNumberResultType(EgcNumberResultType::StandardType);
+        QVERIFY(result.setResult(getTree("1/3")));
+        QVERIFY(getResult(result).isEmpty());
+}
+
+void EgcasTest_Calculation::testParameterSweep()
+{
+        EgcParameterSweep sweep;
+        EgcNumericEvaluator evaluator;
+        EgcFormulaEntity definition;
 
+        //one parameter
+        QVERIFY(sweep.setExpression("2*x+1"));
+        sweep.setRange(0, EgcSweepRange("x", 0.0, 1.0, 3));
+        QVERIFY(sweep.getDimension() == 1);
+        QVERIFY(sweep.getRows() == 3 && sweep.getColumns() == 1);
+        QVERIFY(sweep.getKernelCommand() == "float(makelist((((2)*(x))+(1)),x,[0.0,0.5,1.0]));");
+        QVERIFY(sweep.evaluate(evaluator));
+        QVERIFY(sweep.getValues() == QStringList() << "1.0" << "2.0" << "3.0");
+
+        //two parameters, the values are stored row by row
+        QVERIFY(sweep.setExpression("x*y"));
+        sweep.setRange(1, EgcSweepRange("y", 1.0, 2.0, 2));
+        QVERIFY(sweep.getDimension() == 2);
+        QVERIFY(sweep.getKernelCommand() == "float(makelist(makelist(((x)*(y)),y,[1.0,2.0]),x,[0.0,0.5,1.0]));");
+        QVERIFY(sweep.evaluate(evaluator));
+        QVERIFY(sweep.getValue(2, 1) == "2.0");
+        QVERIFY(sweep.getValue(1, 0) == "0.5");
+        QVERIFY(sweep.getValue(3, 0).isEmpty());
+
+        //kernel results must have the shape of the sweep
+        QVERIFY(sweep.setKernelResult("[[0.0,0.0],[0.5,1.0],[1.0,2.0]]"));
+        QVERIFY(sweep.getValue(1, 1) == "1.0");
+        QVERIFY(!sweep.setKernelResult("[[0.0,0.0],[0.5,1.0]]"));
+        QVERIFY(!sweep.hasValues());
+        QVERIFY(!sweep.setKernelResult("x*y"));
+
+        //symbols of the document are looked up, symbolic expressions are left to the kernel
+        QVERIFY(sweep.setExpression("a*x"));
+        sweep.setRange(1, EgcSweepRange());
+        QVERIFY(!sweep.evaluate(evaluator));
+        definition.setRootElement(getTree("a:4"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(sweep.evaluate(evaluator));
+        QVERIFY(sweep.getValue(1, 0) == "2.0");
+
+        //invalid ranges
+        sweep.setRange(0, EgcSweepRange("1x", 0.0, 1.0, 3));
+        QVERIFY(!sweep.isValid());
+        QVERIFY(sweep.getKernelCommand().isEmpty());
+        sweep.setRange(0, EgcSweepRange("x", 0.0, 1.0, 0));
+        QVERIFY(!sweep.isValid());
+        sweep.setRange(0, EgcSweepRange("x", 0.0, 1.0, 1000));
+        sweep.setRange(1, EgcSweepRange("x", 0.0, 1.0, 10));
+        QVERIFY(!sweep.isValid());
+        sweep.setRange(1, EgcSweepRange("y", 0.0, 1.0, 1000));
+        QVERIFY(!sweep.isValid());
+
+        //lists are split at the top level only
+        QStringList elements;
+        QVERIFY(EgcParameterSweep::splitList("[f(1,2), [3,4] ,5]", elements));
+        QVERIFY(elements == QStringList() << "f(1,2)" << "[3,4]" << "5");
+        QVERIFY(EgcParameterSweep::splitList("[]", elements));
+        QVERIFY(elements.isEmpty());
+        QVERIFY(!EgcParameterSweep::splitList("[1,2", elements));
+}
+
+void EgcasTest_Calculation::testPlotSampler()
+{
+        EgcPlotSampler sampler;
+        EgcNumericEvaluator evaluator;
+        EgcFormulaEntity definition;
+
+        //the batch results are the same as the ones of the scalar calls
+        definition.setRootElement(getTree("f(x):x^2-3*x+sin(x)"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(sampler.setExpression("f(x)/2", "x"));
+        //the samples span the whole range, the grid may extend it by less than one step
+        auto spans = [&sampler](double xMin, double xMax, int count) {
+                double step = (xMax - xMin) / (count - 1);
+                const QVector<double>& x = sampler.getX();
+                return    !x.isEmpty()
+                       && x.first() <= xMin + 1e-9 && x.first() > xMin - step - 1e-9
+                       && x.last() >= xMax - 1e-9 && x.last() < xMax + step + 1e-9;
+        };
+        QVERIFY(sampler.sample(-5.0, 5.0, 1001, evaluator));
+        QVERIFY(spans(-5.0, 5.0, 1001));
+        QVERIFY(sampler.getX().size() == sampler.getY().size());
+        QVERIFY(sampler.getX().size() >= 1001);
+        QVERIFY(sampler.getNumberOfEvaluations() == sampler.getX().size());
+        QVector<EgcNumericValue> args(1);
+        EgcNumericValue value;
+        for (int i = 0; i < sampler.getX().size(); i++) {
+                args[0] = EgcNumericValue(sampler.getX().at(i), false);
+                QVERIFY(evaluator.callFunction("f", args, value));
+                QVERIFY(qAbs(static_cast<double>(value.m_value) / 2.0 - sampler.getY().at(i)) < 1e-9);
+        }
+
+        //panning only calculates the samples that are new
+        QVERIFY(sampler.sample(-4.0, 6.0, 1001, evaluator));
+        QVERIFY(spans(-4.0, 6.0, 1001));
+        QVERIFY(sampler.getNumberOfEvaluations() <= 110);
+        for (int i = 0; i < sampler.getX().size(); i += 50) {
+                args[0] = EgcNumericValue(sampler.getX().at(i), false);
+                QVERIFY(evaluator.callFunction("f", args, value));
+                QVERIFY(qAbs(static_cast<double>(value.m_value) / 2.0 - sampler.getY().at(i)) < 1e-9);
+        }
+
+        //zooming calculates all samples again
+        QVERIFY(sampler.sample(-2.0, 2.0, 1001, evaluator));
+        QVERIFY(spans(-2.0, 2.0, 1001));
+        QVERIFY(sampler.getNumberOfEvaluations() == sampler.getX().size());
+
+        //the first sampling after a calculation uses the new step as well
+        sampler.invalidate();
+        QVERIFY(sampler.sample(-3.0, 3.0, 601, evaluator));
+        QVERIFY(spans(-3.0, 3.0, 601));
+        QVERIFY(sampler.getX().at(1) > sampler.getX().at(0));
+
+        //samples where the expression is not defined are gaps
+        QVERIFY(sampler.setExpression("sqrt(x)", "x"));
+        QVERIFY(sampler.sample(-1.0, 1.0, 201, evaluator));
+        for (int i = 0; i < sampler.getX().size(); i++) {
+                if (sampler.getX().at(i) < 0.0)
+                        QVERIFY(qIsNaN(sampler.getY().at(i)));
+                else
+                        QVERIFY(qAbs(sampler.getY().at(i) - qSqrt(sampler.getX().at(i))) < 1e-12);
+        }
+
+        //the number of samples is limited
+        QVERIFY(sampler.sample(0.0, 1.0, 1000000, evaluator));
+        QVERIFY(sampler.getX().size() <= EgcPlotSampler::s_maxSamples);
+
+        //undefined symbols and expressions that cannot be calculated natively
+        QVERIFY(sampler.setExpression("b*x", "x"));
+        QVERIFY(!sampler.sample(-1.0, 1.0, 100, evaluator));
+        QVERIFY(!sampler.setExpression("x+1/3", "x"));
+        QVERIFY(!sampler.sample(-1.0, 1.0, 100, evaluator));
+}
+
+void EgcasTest_Calculation::testNumericIntegrator()
+{
+        EgcNumericEvaluator evaluator;
+        EgcFormulaEntity definition;
+        EgcFormulaEntity result;
+        QString res;
+        EgcNumericValue value;
+
+        //definite integrals are calculated natively and are never exact
+        QScopedPointer<EgcNode> tree(getTree("_integrate(0,1,t^2,t)"));
+        QVERIFY(evaluator.evaluate(*tree, value));
+        QVERIFY(!value.m_exact);
+        QVERIFY(qAbs(static_cast<double>(value.m_value) - 1.0 / 3.0) < 1e-12);
+        tree.reset(getTree("_integrate(1,0,t^2,t)"));
+        QVERIFY(evaluator.evaluate(*tree, value));
+        QVERIFY(qAbs(static_cast<double>(value.m_value) + 1.0 / 3.0) < 1e-12);
+        result.setRootElement(getTree("_integrate(0,20,cos(5*t),t)=0"));
+        QVERIFY(evaluator.calculate(result, res));
+        QVERIFY(qAbs(res.mid(1, res.length() - 2).split(",").at(1).toDouble() - qSin(100.0) / 5.0) < 1e-10);
+
+        //global variables and user functions can be used in the integrand and the bounds
+        definition.setRootElement(getTree("a:2"));
+        QVERIFY(evaluator.define(definition));
+        definition.setRootElement(getTree("f(t):t^3"));
+        QVERIFY(evaluator.define(definition));
+        tree.reset(getTree("_integrate(0,a,a*f(t),t)"));
+        QVERIFY(evaluator.evaluate(*tree, value));
+        QVERIFY(qAbs(static_cast<double>(value.m_value) - 8.0) < 1e-12);
+
+        //definitions with integrals are passed to the kernel as value
+        definition.setRootElement(getTree("c:_integrate(0,1,t^2,t)"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(evaluator.getDefinitionCommand(definition, res));
+        QVERIFY(res.startsWith("c:0.333333333333") && res.endsWith(";"));
+        definition.setRootElement(getTree("d:3"));
+        QVERIFY(evaluator.define(definition));
+        QVERIFY(!evaluator.getDefinitionCommand(definition, res));
+
+        //indefinite integrals, symbolic integrands and singularities are left to the kernel
+        tree.reset(getTree("_integrate(t^2,t)"));
+        QVERIFY(!evaluator.evaluate(*tree, value));
+        tree.reset(getTree("_integrate(0,1,b*t,t)"));
+        QVERIFY(!evaluator.evaluate(*tree, value));
+        tree.reset(getTree("_integrate(-1,1,1/t,t)"));
+        QVERIFY(!evaluator.evaluate(*tree, value));
+
+        //the integrator reports the error estimate
+        tree.reset(getTree("sin(t)^2"));
+        QVector<QString> parameters;
+        parameters.append("t");
+        EgcNumericProgram program;
+        QVERIFY(program.compile(parameters, tree.data()));
+        EgcNumericIntegrator integrator;
+        double integral;
+        QVERIFY(integrator.integrate(program, 0.0, 10.0 * M_PI, evaluator, integral));
+        QVERIFY(qAbs(integral - 5.0 * M_PI) < 1e-9);
+        QVERIFY(integrator.getErrorEstimate() <= 1e-10 * integral);
+        QVERIFY(integrator.getNumberOfEvaluations() >= 15);
+}
+
+void EgcasTest_Calculation::testDeleteWhileCalculating()
+{
+        EgcTestKernelConn* kernel = new EgcTestKernelConn();
+        EgcEntityList list;
+        list.setBulkLoad(true);
+        EgcFormulaEntity* defA = new EgcFormulaEntity();
+        defA->setRootElement(getTree("a:2"));
+        list.addEntity(defA);
+        EgcFormulaEntity* defB = new EgcFormulaEntity();
+        defB->setRootElement(getTree("b:a*x"));
+        list.addEntity(defB);
+        EgcFormulaEntity* resB = new EgcFormulaEntity();
+        resB->setRootElement(getTree("b=0"));
+        list.addEntity(resB);
+        QString commandB = defB->getCASKernelCommand();
+        QString commandResB = resB->getCASKernelCommand();
+
+        EgcCalculation calc(kernel);
+        emit kernel->kernelStarted();
+        QVERIFY(calc.calculate(list));
+        QCOMPARE(kernel->m_commands.size(), 1);
+        emit kernel->resultReceived("2");
+        QCOMPARE(kernel->m_commands.size(), 2);
+        QCOMPARE(kernel->m_commands.last(), commandB);
+
+        //the kernel is still calculating b, so deleting the definition of a must not send anything
+        calc.startDeletingEntity(defA);
+        QVERIFY(list.deleteEntity(defA));
+        QCOMPARE(kernel->m_commands.size(), 2);
+
+        //the pending result is not mixed up with the kill, which is sent together with the next command
+        emit kernel->resultReceived("2*x");
+        QCOMPARE(kernel->m_commands.size(), 3);
+        QCOMPARE(kernel->m_commands.last(), QString("kill(a)$") + commandB);
+        emit kernel->resultReceived("a*x");
+        QCOMPARE(kernel->m_commands.size(), 4);
+        QCOMPARE(kernel->m_commands.last(), commandResB);
+}
+
+/**
+ * @brief moveCheck moves the formula to the given position and checks if this changes the evaluation order. The formula
+ * is moved back afterwards, so the list stays in the order of the positions.
+ */
+static bool moveCheck(EgcCalculation& calc, EgcEntityList& list, EgcFormulaEntity& formula, QPointF pos)
+{
+        QPointF old = formula.getPosition();
+        formula.setPosition(pos);
+        bool changed = calc.moveChangesOrder(list, formula);
+        formula.setPosition(old);
+
+        return changed;
+}
+
+void EgcasTest_Calculation::testMoveChangesOrder()
+{
+        EgcTestKernelConn* kernel = new EgcTestKernelConn();
+        QList<QSharedPointer<EgcTestFormulaItem> > items;
+        EgcEntityList list;
+        QStringList formulas = QStringList() << "a:2" << "a=0" << "b:3" << "b=0";
+        QList<EgcFormulaEntity*> entities;
+        for (int i = 0; i < formulas.size(); i++) {
+                QSharedPointer<EgcTestFormulaItem> item(new EgcTestFormulaItem());
+                items.append(item);
+                EgcFormulaEntity* entity = new EgcFormulaEntity();
+                entity->setRootElement(getTree(formulas.at(i)));
+                entity->setItem(item.data());
+                entity->setPosition(QPointF(0.0, 10.0 * (i + 1)));
+                list.addEntity(entity);
+                entities.append(entity);
+        }
+        EgcFormulaEntity* defA = entities.at(0);
+        EgcFormulaEntity* resA = entities.at(1);
+        EgcFormulaEntity* defB = entities.at(2);
+        EgcFormulaEntity* resB = entities.at(3);
+        EgcCalculation calc(kernel);
+
+        //moves that don't cross a dependency
+        QVERIFY(!moveCheck(calc, list, *defB, QPointF(0.0, 5.0)));
+        QVERIFY(!moveCheck(calc, list, *resA, QPointF(0.0, 50.0)));
+        QVERIFY(!moveCheck(calc, list, *resA, QPointF(5.0, 10.0)));
+        //a moved formula is placed behind all formulas at the same position
+        QVERIFY(!moveCheck(calc, list, *resB, QPointF(0.0, 30.0)));
+
+        //moves that cross a dependency
+        QVERIFY(moveCheck(calc, list, *resA, QPointF(0.0, 5.0)));
+        QVERIFY(moveCheck(calc, list, *defA, QPointF(0.0, 25.0)));
+        QVERIFY(moveCheck(calc, list, *defB, QPointF(0.0, 40.0)));
+
+        //the definition of a has been sent to the kernel, the calculation is waiting for the result
+        emit kernel->kernelStarted();
+        QVERIFY(calc.calculate(list));
+        QCOMPARE(kernel->m_commands.size(), 1);
+        //a formula that moves in front of the running calculation would never be calculated
+        QVERIFY(moveCheck(calc, list, *resB, QPointF(0.0, 5.0)));
+        //moves behind the running calculation are calculated in the new order anyway
+        QVERIFY(!moveCheck(calc, list, *defB, QPointF(0.0, 35.0)));
+        QVERIFY(!moveCheck(calc, list, *resA, QPointF(0.0, 50.0)));
+
+        //the list follows the new position of a formula
+        defB->setPosition(QPointF(0.0, 5.0));
+        QVERIFY(calc.moveChangesOrder(list, *defB));
+        list.repositionEntity(defB);
+        EgcEntityListCursor cursor(list);
+        QVERIFY(cursor.next() == defB);
+        QVERIFY(cursor.next() == defA);
+}
 
 QTEST_MAIN(EgcasTest_Calculation)
 
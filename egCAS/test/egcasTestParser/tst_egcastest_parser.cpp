@@ -74,6 +74,7 @@ private Q_SLOTS:
         void fncTreeTestParser();
         void fncOperations1TestParser();
         void fncOperations2TestParser();
+        void matrixListTestParser();
 private:
 };
 
@@ -293,6 +294,64 @@ void EgcasTest_Parser::fncOperations2TestParser()
         QVERIFY(formula.getCASKernelCommand().contains("ost:((rn)^(45.8))+((a)/(3))") == true);
 }
 
+void EgcasTest_Parser::matrixListTestParser()
+{
+        EgcKernelParser parser;
+        QScopedPointer<EgcNode> tree;
+
+        // lists
+        tree.reset(parser.parseKernelOutput("[1,x,3]"));
+        QVERIFY(!tree.isNull());
+        QVERIFY(tree->getNodeType() == EgcNodeType::ListNode);
+        QCOMPARE(static_cast<EgcListNode*>(tree.data())->getNumberChildNodes(), 3U);
+        EgcFormulaEntity list(*tree.take());
+        QVERIFY(list.getCASKernelCommand().contains("[1,x,3]"));
+
+        // matrices
+        tree.reset(parser.parseKernelOutput("matrix([1,2],[3,4])"));
+        QVERIFY(!tree.isNull());
+        QVERIFY(tree->getNodeType() == EgcNodeType::MatrixNode);
+        EgcMatrixNode* matrix = static_cast<EgcMatrixNode*>(tree.data());
+        QCOMPARE(matrix->getRows(), 2U);
+        QCOMPARE(matrix->getColumns(), 2U);
+        QCOMPARE(matrix->getNumberChildNodes(), 4U);
+        QVERIFY(matrix->valid());
+        QCOMPARE(static_cast<EgcNumberNode*>(matrix->getElement(1, 0))->getValue(), QString("3"));
+        EgcFormulaEntity formula(*tree.take());
+        QVERIFY(formula.getCASKernelCommand().contains("matrix([1,2],[3,4])"));
+        QVERIFY(formula.getMathMlCode().contains("<mtable><mtr><mtd>"));
+
+        // rows of different length are no matrix
+        tree.reset(parser.parseKernelOutput("matrix([1,2],[3])"));
+        QVERIFY(!tree.isNull());
+        QVERIFY(tree->getNodeType() == EgcNodeType::FunctionNode);
+
+        // a big matrix is flat and can be copied and compared
+        QString big("matrix(");
+        for (int i = 0; i < 100; i++) {
+                if (i)
+                        big += ",";
+                big += "[";
+                for (int j = 0; j < 100; j++) {
+                        if (j)
+                                big += ",";
+                        big += QString::number(i * 100 + j);
+                }
+                big += "]";
+        }
+        big += ")";
+        tree.reset(parser.parseKernelOutput(big));
+        QVERIFY(!tree.isNull());
+        QVERIFY(tree->getNodeType() == EgcNodeType::MatrixNode);
+        matrix = static_cast<EgcMatrixNode*>(tree.data());
+        QCOMPARE(matrix->getNumberChildNodes(), 10000U);
+        QCOMPARE(static_cast<EgcNumberNode*>(matrix->getElement(99, 42))->getValue(), QString("9942"));
+        QScopedPointer<EgcNode> copy(tree->copy());
+        QVERIFY(*copy == *tree);
+        EgcFormulaEntity bigFormula(*tree.take());
+        QVERIFY(bigFormula.getCASKernelCommand().contains(big));
+}
+
 
 QTEST_MAIN(EgcasTest_Parser)
 
@@ -0,0 +1,269 @@
+/*
+Copyright (c) 2017, Johannes Maier <maier_jo@gmx.de>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the egCAS nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#include <QString>
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QGraphicsItem>
+#include "document/egcdocument.h"
+#include "document/egcsessionrecorder.h"
+#include "document/egcsessionreplayer.h"
+#include "entities/egcentitylist.h"
+#include "entities/egcformulaentity.h"
+#include "entities/egctextentity.h"
+#include "actions/egcaction.h"
+#include "actions/egcactionmapper.h"
+#include "view/egcasscene.h"
+#include "egcabstractformulaitem.h"
+#include "casKernel/parser/egckernelparser.h"
+
+class EgcasTest_Session : public QObject
+{
+        Q_OBJECT
+
+public:
+        EgcasTest_Session() {}
+private Q_SLOTS:
+        void testRecordReplay();
+        void testGroupMove();
+private:
+        /**
+         * @brief type types the given characters into the formula like the user would do
+         * @param formula the formula to type into
+         * @param input letters and digits are inserted as characters, all others as math operators
+         */
+        static void type(EgcFormulaEntity& formula, const QString& input);
+        /**
+         * @brief serialize serializes the given document to xml
+         * @param document the document to serialize
+         * @return the xml of the document
+         */
+        static QByteArray serialize(EgcDocument& document);
+        /**
+         * @brief countEntities counts the entities of the given document
+         * @param document the document to count the entities of
+         * @return the number of entities in the document
+         */
+        static int countEntities(EgcDocument& document);
+        /**
+         * @brief entities returns the entities of the given document in the order of the entity list
+         * @param document the document to get the entities of
+         * @return the entities of the document
+         */
+        static QList<EgcEntity*> entities(EgcDocument& document);
+        /**
+         * @brief xmlEvents returns all events of a xml document as strings, so two documents can be compared
+         * @param xml the xml document
+         * @return the events of the xml document
+         */
+        static QStringList xmlEvents(const QByteArray& xml);
+};
+
+void EgcasTest_Session::type(EgcFormulaEntity& formula, const QString& input)
+{
+        EgcAction action;
+        action.m_op = EgcOperations::formulaActivated;
+        formula.handleAction(action);
+
+        foreach (QChar ch, input) {
+                if (ch.isLetterOrNumber())
+                        formula.handleAction(EgcAction(EgcOperations::alnumKeyPressed, ch));
+                else
+                        formula.handleAction(EgcActionMapper::getMathOperationAction(ch));
+        }
+
+        action.m_op = EgcOperations::formulaDeactivated;
+        formula.handleAction(action);
+}
+
+QByteArray EgcasTest_Session::serialize(EgcDocument& document)
+{
+        QByteArray xml;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        QXmlStreamWriter stream(&buffer);
+        SerializerProperties properties;
+        document.serialize(stream, properties);
+        buffer.close();
+
+        return xml;
+}
+
+int EgcasTest_Session::countEntities(EgcDocument& document)
+{
+        int count = 0;
+        QMutableListIterator<EgcEntity*> iter = document.getEntityList()->getIterator();
+        while (iter.hasNext()) {
+                iter.next();
+                count++;
+        }
+
+        return count;
+}
+
+QList<EgcEntity*> EgcasTest_Session::entities(EgcDocument& document)
+{
+        QList<EgcEntity*> list;
+        QMutableListIterator<EgcEntity*> iter = document.getEntityList()->getIterator();
+        while (iter.hasNext())
+                list.append(iter.next());
+
+        return list;
+}
+
+QStringList EgcasTest_Session::xmlEvents(const QByteArray& xml)
+{
+        QStringList events;
+        QXmlStreamReader reader(xml);
+        while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement: {
+                        QString event = "start " + reader.name().toString();
+                        QXmlStreamAttributes attr = reader.attributes();
+                        for (int i = 0; i < attr.size(); i++)
+                                event += " " + attr.at(i).name().toString() + "=" + attr.at(i).value().toString();
+                        events.append(event);
+                        break;
+                }
+                case QXmlStreamReader::EndElement:
+                        events.append("end " + reader.name().toString());
+                        break;
+                case QXmlStreamReader::Characters:
+                        events.append("text " + reader.text().toString());
+                        break;
+                default:
+                        break;
+                }
+        }
+        if (reader.hasError())
+                events.append("error");
+
+        return events;
+}
+
+void EgcasTest_Session::testRecordReplay()
+{
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString logFile = dir.filePath("session.egs");
+
+        EgcDocument document(new EgcReplayKernelConn());
+        document.setAutoCalculation(false);
+
+        // content that exists before recording is started is part of the snapshot at the start of the log
+        EgcTextEntity* text = static_cast<EgcTextEntity*>(document.createEntity(EgcEntityType::Text,
+                                                                                   QPointF(40.0, 20.0)));
+        QVERIFY(text);
+        text->setText("session test");
+
+        QVERIFY(document.startSessionRecording(logFile));
+        QVERIFY(EgcSessionRecorder::isRecording());
+
+        EgcFormulaEntity* first = static_cast<EgcFormulaEntity*>(document.createEntity(EgcEntityType::Formula,
+                                                                                          QPointF(40.0, 100.0)));
+        QVERIFY(first);
+        type(*first, "a:2");
+        EgcFormulaEntity* second = static_cast<EgcFormulaEntity*>(document.createEntity(EgcEntityType::Formula,
+                                                                                           QPointF(40.0, 200.0)));
+        QVERIFY(second);
+        type(*second, "a+3");
+        // the equal sign is added via the menu, so it is routed through the scene
+        EgcAction action;
+        action.m_op = EgcOperations::formulaActivated;
+        second->handleAction(action);
+        document.getScene()->routeToFormula(*second, EgcActionMapper::getMathOperationAction(QChar('=')));
+        action.m_op = EgcOperations::formulaDeactivated;
+        second->handleAction(action);
+
+        // the kernel is simulated, the replayer feeds the recorded result into the formula again
+        EgcKernelParser parser;
+        EgcSessionRecorder::recordKernelResult(second, "5");
+        second->setResult(parser.parseKernelOutput("5"));
+
+        // move the first formula behind the second one like the user would do with the mouse
+        first->setPosition(QPointF(40.0, 300.0));
+        first->itemChanged(EgcItemChangeType::posChanged);
+
+        EgcFormulaEntity* clone = static_cast<EgcFormulaEntity*>(document.cloneEntity(*second));
+        QVERIFY(clone);
+        EgcAbstractFormulaItem* item = clone->getItem();
+        QGraphicsItem* qItem = dynamic_cast<QGraphicsItem*>(item);
+        QVERIFY(qItem);
+        document.getScene()->deleteItem(item);
+        document.itemDeleted(qItem);
+
+        document.stopSessionRecording();
+        QVERIFY(!EgcSessionRecorder::isRecording());
+
+        EgcDocument replayed(new EgcReplayKernelConn());
+        replayed.setAutoCalculation(false);
+        EgcSessionReplayer replayer(replayed);
+        replayer.setRendering(false);
+        QVERIFY2(replayer.replay(logFile), replayer.getErrorMessage().toLatin1().constData());
+
+        // the text and both formulas must be there, the deleted clone must be gone
+        QCOMPARE(countEntities(replayed), 3);
+        QCOMPARE(countEntities(document), 3);
+        QCOMPARE(xmlEvents(serialize(replayed)), xmlEvents(serialize(document)));
+}
+
+void EgcasTest_Session::testGroupMove()
+{
+        EgcDocument document(new EgcReplayKernelConn());
+        document.setAutoCalculation(false);
+
+        EgcFormulaEntity* first = static_cast<EgcFormulaEntity*>(document.createEntity(EgcEntityType::Formula,
+                                                                                          QPointF(40.0, 100.0)));
+        EgcFormulaEntity* second = static_cast<EgcFormulaEntity*>(document.createEntity(EgcEntityType::Formula,
+                                                                                           QPointF(40.0, 200.0)));
+        EgcFormulaEntity* third = static_cast<EgcFormulaEntity*>(document.createEntity(EgcEntityType::Formula,
+                                                                                          QPointF(40.0, 300.0)));
+        QVERIFY(first && second && third);
+
+        // a selection is dragged at once, but only the grabbed item reports its move
+        document.beginGroupMove();
+        first->setPosition(QPointF(40.0, 400.0));
+        second->setPosition(QPointF(40.0, 350.0));
+        first->itemChanged(EgcItemChangeType::posChanged);
+        QCOMPARE(entities(document), QList<EgcEntity*>() << first << second << third);
+        document.entitiesMoved();
+        QCOMPARE(entities(document), QList<EgcEntity*>() << third << second << first);
+
+        // single moves are sorted in again after the group move has been finished
+        third->setPosition(QPointF(40.0, 500.0));
+        third->itemChanged(EgcItemChangeType::posChanged);
+        QCOMPARE(entities(document), QList<EgcEntity*>() << second << first << third);
+}
+
+QTEST_MAIN(EgcasTest_Session)
+
+#include "tst_egcastest_session.moc"
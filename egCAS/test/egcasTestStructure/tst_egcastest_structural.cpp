@@ -28,9 +28,24 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QString>
 #include <QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QXmlStreamReader>
 #include "tst_egcastest_structural.h"
 #include "casKernel/parser/abstractkernelparser.h"
 #include "casKernel/parser/restructparserprovider.h"
+#include "utils/egcnumberformatter.h"
+#include "document/egcbinarydocument.h"
+#include "document/egcformulaloader.h"
+#include "document/egcdocumentjournal.h"
+#include "document/egcdocumentsaver.h"
+#include "entities/egcentitysnapshot.h"
+#include "entities/egcpixmapentity.h"
+#include "entities/egctableentity.h"
+#include "entities/egcplotentity.h"
+#include "casKernel/egcnumericevaluator.h"
 
 //implementation of some mock classes for restruct parser
 class EgcTestKernelParser : public AbstractKernelParser
@@ -67,6 +82,18 @@ private Q_SLOTS:
         void testVisitors();
         void testFlexNode();
         void testFlexNodeVisitors();
+        void testEntityList();
+        void testNumberFormatter();
+        void testBinaryDocument();
+        void testBinaryFormulaTree();
+        void testLazyFormulaTree();
+        void testFormulaLoader();
+        void testDocumentJournal();
+        void testDocumentSaver();
+        void testPixmapRoundTrip();
+        void testTableRoundTrip();
+        void testPlotRoundTrip();
+        void testNodeTraits();
 private:
         EgcNode* addChild(EgcNode&parent, EgcNodeType type, QString number = "0");
         EgcNode* addLeftChild(EgcNode&parent, EgcNodeType type, QString number = "0");
@@ -1211,14 +1238,14 @@ void EgcasTest_Structural::testVisitors()
         //test maxima visitor
         EgcMaximaVisitor maximaVisitor(formula4);
         QString result(maximaVisitor.getResult());
-        QVERIFY(result == QString("fpprintprec:0$((30.452)+(3))+(2);"));
-        QVERIFY(formula4.getCASKernelCommand() == QString("fpprintprec:0$((30.452)+(3))+(2);"));
+        QVERIFY(result == QString("((30.452)+(3))+(2);"));
+        QVERIFY(formula4.getCASKernelCommand() == QString("((30.452)+(3))+(2);"));
 
         //test maxima visitor with copied formula
         EgcMaximaVisitor maximaVisitor2(formula5);
         QString result2(maximaVisitor2.getResult());
-        QVERIFY(result2 == QString("fpprintprec:0$((30.452)+(3))+(2);"));
-        QVERIFY(formula5.getCASKernelCommand() == QString("fpprintprec:0$((30.452)+(3))+(2);"));
+        QVERIFY(result2 == QString("((30.452)+(3))+(2);"));
+        QVERIFY(formula5.getCASKernelCommand() == QString("((30.452)+(3))+(2);"));
 
         //test math ml visitor
         EgcMathMlVisitor mathMlVisitor(formula4);
@@ -1421,7 +1448,7 @@ void EgcasTest_Structural::testFlexNodeVisitors()
         static_cast<EgcFunctionNode*>(node2)->setName("testFunction");
 
         //test maxima visitor
-        QVERIFY(formula5.getCASKernelCommand() == QString("fpprintprec:0$(testFunction(3,(5),6,7))+(8);"));
+        QVERIFY(formula5.getCASKernelCommand() == QString("(testFunction(3,(5),6,7))+(8);"));
 
         //test math ml visitor
         QVERIFY(formula5.getMathMlCode() == QString("<math><mrow  id=\"8\" ><mrow  id=\"6\" ><mi  mathvariant=\"italic\" "
@@ -1513,6 +1540,795 @@ EgcNode* EgcasTest_Structural::addRightChild(EgcNode& parent, EgcNodeType type,
         return nullptr;
 }
 
+void EgcasTest_Structural::testEntityList()
+{
+        EgcEntityList list;
+        EgcEntityTest* e1 = new EgcEntityTest(QPointF(10.0, 100.0));
+        EgcEntityTest* e2 = new EgcEntityTest(QPointF(50.0, 10.0));
+        EgcEntityTest* e3 = new EgcEntityTest(QPointF(20.0, 300.0));
+        EgcEntityTest* e4 = new EgcEntityTest(QPointF(5.0, 100.0));
+
+        //entities are ordered by position
+        list.addEntity(e1);
+        list.addEntity(e2);
+        list.addEntity(e3);
+        list.addEntity(e4);
+        EgcEntityListCursor cursor(list);
+        QVERIFY(cursor.next() == e2);
+        QVERIFY(cursor.next() == e4);
+        QVERIFY(cursor.peekNext() == e1);
+
+        //the cursor stays at its entity if entities are inserted or deleted in front of it
+        EgcEntityTest* e5 = new EgcEntityTest(QPointF(0.0, 0.0));
+        list.addEntity(e5);
+        QVERIFY(cursor.peekNext() == e1);
+        list.deleteEntity(e2);
+        QVERIFY(cursor.peekNext() == e1);
+
+        //moving an entity behind the cursor
+        e5->setPosition(QPointF(0.0, 200.0));
+        list.repositionEntity(e5);
+        QVERIFY(cursor.next() == e1);
+        QVERIFY(cursor.next() == e5);
+        QVERIFY(cursor.next() == e3);
+        QVERIFY(cursor.hasNext() == false);
+
+        //deleting the next entity
+        cursor.toFront();
+        QVERIFY(cursor.next() == e4);
+        list.deleteEntity(e1);
+        QVERIFY(cursor.next() == e5);
+
+        //bulk load mode sorts once when left, the cursor still points to the same entity
+        list.setBulkLoad(true);
+        EgcEntityTest* e6 = new EgcEntityTest(QPointF(0.0, 0.0));
+        list.addEntity(e6);
+        e6->setPosition(QPointF(0.0, 250.0));
+        list.setBulkLoad(false);
+        QVERIFY(cursor.next() == e3);
+        QVERIFY(cursor.next() == nullptr);
+        cursor.toFront();
+        QVERIFY(cursor.next() == e4);
+        QVERIFY(cursor.next() == e5);
+        QVERIFY(cursor.next() == e6);
+        QVERIFY(cursor.next() == e3);
+
+        //the ordering is strict, entities at the same position are not less than each other
+        EgcEntityTest a(QPointF(1.0, 1.0));
+        EgcEntityTest b(QPointF(1.0, 1.0));
+        QVERIFY(!(a < b) && !(b < a));
+        QVERIFY(!EgcEntity::lessThan(&a, &b));
+        b.setPosition(QPointF(2.0, 1.0));
+        QVERIFY(a < b && !(b < a));
+
+        //an entity added at the position of another one is inserted behind it
+        EgcEntityTest* e7 = new EgcEntityTest(e3->getPosition());
+        list.addEntity(e7);
+        cursor.toFront();
+        QVERIFY(cursor.next() == e4);
+        QVERIFY(cursor.next() == e5);
+        QVERIFY(cursor.next() == e6);
+        QVERIFY(cursor.next() == e3);
+        QVERIFY(cursor.next() == e7);
+        list.deleteEntity(e7);
+
+        //an entity that has been moved reports it to its list
+        e4->moveTo(QPointF(0.0, 400.0));
+        cursor.toFront();
+        QVERIFY(cursor.next() == e5);
+        QVERIFY(cursor.next() == e6);
+        QVERIFY(cursor.next() == e3);
+        QVERIFY(cursor.next() == e4);
+
+        //several entities moved at once are sorted once
+        e5->setPosition(QPointF(0.0, 500.0));
+        e3->setPosition(QPointF(0.0, 5.0));
+        list.sort();
+        cursor.toFront();
+        QVERIFY(cursor.next() == e3);
+        QVERIFY(cursor.next() == e6);
+        QVERIFY(cursor.next() == e4);
+        QVERIFY(cursor.next() == e5);
+}
+
+void EgcasTest_Structural::testNumberFormatter()
+{
+        //standard results only round floats
+        QVERIFY(EgcNumberFormatter::format("1.23456", EgcNumberResultType::StandardType, 3) == QString("1.23"));
+        QVERIFY(EgcNumberFormatter::format("1.23456", EgcNumberResultType::StandardType, 0) == QString("1.23456"));
+        QVERIFY(EgcNumberFormatter::format("2", EgcNumberResultType::StandardType, 3) == QString("2"));
+        QVERIFY(EgcNumberFormatter::format("31084.819", EgcNumberResultType::StandardType, 4) == QString("3.108e4"));
+
+        //integer, scientific and engineering results
+        QVERIFY(EgcNumberFormatter::format("2.5", EgcNumberResultType::IntegerType, 0) == QString("3"));
+        QVERIFY(EgcNumberFormatter::format("-7.2", EgcNumberResultType::IntegerType, 4) == QString("-7"));
+        QVERIFY(EgcNumberFormatter::format("0.00123", EgcNumberResultType::ScientificType, 3) == QString("1.23e-3"));
+        QVERIFY(EgcNumberFormatter::format("1.5b7", EgcNumberResultType::ScientificType, 0) == QString("1.5e7"));
+        QVERIFY(EgcNumberFormatter::format("12346.0", EgcNumberResultType::EngineeringType, 4) == QString("12.35e3"));
+        QVERIFY(EgcNumberFormatter::format("9.99", EgcNumberResultType::ScientificType, 2) == QString("1.0e1"));
+        QVERIFY(EgcNumberFormatter::format("5", EgcNumberResultType::ScientificType, 3) == QString("5.0"));
+
+        QVERIFY(EgcNumberFormatter::format("-0.6", EgcNumberResultType::IntegerType, 0) == QString("-1"));
+        QVERIFY(EgcNumberFormatter::format("0.4", EgcNumberResultType::IntegerType, 0) == QString("0"));
+        QVERIFY(EgcNumberFormatter::format("0.0", EgcNumberResultType::ScientificType, 3) == QString("0.0"));
+        QVERIFY(EgcNumberFormatter::format("-1.0e-7", EgcNumberResultType::EngineeringType, 3) == QString("-100.0e-9"));
+        QVERIFY(EgcNumberFormatter::format("1.0e-7", EgcNumberResultType::StandardType, 3) == QString("1.0e-7"));
+
+        //big floats keep all their digits, they are never converted to a double
+        QString bigfloat("3.14159265358979323846264338327950288b0");
+        QVERIFY(EgcNumberFormatter::format(bigfloat, EgcNumberResultType::StandardType, 0) == bigfloat);
+        QVERIFY(EgcNumberFormatter::format(bigfloat, EgcNumberResultType::ScientificType, 0)
+                == QString("3.14159265358979323846264338327950288"));
+        QVERIFY(EgcNumberFormatter::format(bigfloat, EgcNumberResultType::StandardType, 30)
+                == QString("3.14159265358979323846264338328"));
+        QVERIFY(EgcNumberFormatter::format("1.2345678901234567890123b25", EgcNumberResultType::IntegerType, 0)
+                == QString("12345678901234567890123000"));
+        QVERIFY(EgcNumberFormatter::format("1.99999999999999999999b-30", EgcNumberResultType::EngineeringType, 20)
+                == QString("2.0e-30"));
+
+        //things that are no numbers stay unchanged
+        QVERIFY(EgcNumberFormatter::format("x", EgcNumberResultType::EngineeringType, 3) == QString("x"));
+        QVERIFY(EgcNumberFormatter::format("1.5x", EgcNumberResultType::ScientificType, 3) == QString("1.5x"));
+        QVERIFY(EgcNumberFormatter::format("1e", EgcNumberResultType::ScientificType, 3) == QString("1e"));
+}
+
+/**
+ * @brief xmlEvents returns all events of a xml document as strings, so two documents can be compared
+ */
+static QStringList xmlEvents(const QByteArray& xml)
+{
+        QStringList events;
+        QXmlStreamReader reader(xml);
+        while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement: {
+                        QString event = "start " + reader.name().toString();
+                        QXmlStreamAttributes attr = reader.attributes();
+                        for (int i = 0; i < attr.size(); i++)
+                                event += " " + attr.at(i).name().toString() + "=" + attr.at(i).value().toString();
+                        events.append(event);
+                        break;
+                }
+                case QXmlStreamReader::EndElement:
+                        events.append("end " + reader.name().toString());
+                        break;
+                case QXmlStreamReader::Characters:
+                        events.append("text " + reader.text().toString());
+                        break;
+                default:
+                        break;
+                }
+        }
+        if (reader.hasError())
+                events.append("error");
+
+        return events;
+}
+
+void EgcasTest_Structural::testBinaryDocument()
+{
+        QByteArray xml("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<document width=\"2100\" height=\"2900\">\n");
+        for (int i = 0; i < 200; i++) {
+                xml += "    <formula_entity pos_x=\"20\" pos_y=\"" + QByteArray::number(i * 20) + "\">\n"
+                       "        <plusnode><variablenode value=\"x\" subscript=\"\"/><numbernode value=\"1\"/></plusnode>\n"
+                       "    </formula_entity>\n";
+        }
+        xml += "    <text_entity pos_x=\"10\" pos_y=\"10\">a &lt;b&gt; &amp; &#xe4; " + QByteArray(100, 'x') + "</text_entity>\n";
+        xml += "    <text_entity pos_x=\"10\" pos_y=\"30\"><![CDATA[<raw>]]></text_entity>\n";
+        xml += "</document>\n";
+
+        QBuffer source(&xml);
+        source.open(QIODevice::ReadOnly);
+        QBuffer binary;
+        binary.open(QIODevice::ReadWrite);
+        EgcBinaryDocument encoder;
+        QVERIFY(encoder.encode(source, binary));
+        QVERIFY(EgcBinaryDocument::isBinary(binary.data()));
+        QVERIFY(!EgcBinaryDocument::isBinary(xml));
+        QVERIFY(binary.data().size() < xml.size() / 3);
+
+        // the section index contains every entity
+        QCOMPARE(encoder.getSections().size(), 202);
+        QCOMPARE(encoder.getString(encoder.getSections().at(0).m_name), QString("formula_entity"));
+        QCOMPARE(encoder.getString(encoder.getSections().at(201).m_name), QString("text_entity"));
+
+        // the conversion back to xml is lossless
+        QBuffer result;
+        result.open(QIODevice::ReadWrite);
+        EgcBinaryDocument decoder;
+        QVERIFY(decoder.decode(binary.data(), result));
+        QCOMPARE(xmlEvents(result.data()), xmlEvents(xml));
+        QCOMPARE(decoder.getSections().size(), 202);
+        QCOMPARE(decoder.getSections().at(5).m_offset, encoder.getSections().at(5).m_offset);
+
+        // the root element and single sections can be read without decoding the whole document
+        EgcBinaryDocument reader;
+        QVERIFY(reader.open(binary.data()));
+        QString name;
+        QXmlStreamAttributes attr;
+        QVERIFY(reader.readRootElement(name, attr));
+        QCOMPARE(name, QString("document"));
+        QCOMPARE(attr.value("width").toString(), QString("2100"));
+        QCOMPARE(attr.value("height").toString(), QString("2900"));
+        QString section;
+        QVERIFY(reader.decodeSection(3, section));
+        QCOMPARE(xmlEvents(section.toUtf8()), xmlEvents("<formula_entity pos_x=\"20\" pos_y=\"60\">\n"
+                         "        <plusnode><variablenode value=\"x\" subscript=\"\"/><numbernode value=\"1\"/></plusnode>\n"
+                         "    </formula_entity>"));
+        section.clear();
+        QVERIFY(reader.decodeSection(201, section));
+        QCOMPARE(xmlEvents(section.toUtf8()), xmlEvents("<text_entity pos_x=\"10\" pos_y=\"30\"><![CDATA[<raw>]]></text_entity>"));
+        QVERIFY(!reader.decodeSection(202, section));
+
+        // corrupted documents are detected
+        QBuffer corrupted;
+        corrupted.open(QIODevice::ReadWrite);
+        QVERIFY(!decoder.decode(binary.data().left(binary.data().size() / 2), corrupted));
+        QVERIFY(!decoder.getErrorString().isEmpty());
+}
+
+void EgcasTest_Structural::testBinaryFormulaTree()
+{
+        QString text("<formula_entity pos_x=\"5\" pos_y=\"7\" digits=\"4\"><basenode><equalnode><plusnode>"
+                     "<variablenode subscript=\"1\">x</variablenode><numbernode>2.5</numbernode></plusnode>"
+                     "<emptynode/></equalnode></basenode></formula_entity>");
+        QXmlStreamReader reader(text);
+        SerializerProperties properties;
+        properties.version = 3;
+        QVERIFY(reader.readNextStartElement());
+        EgcFormulaEntity formula;
+        formula.deserialize(reader, properties);
+        QVERIFY(formula.getRootElement() != nullptr);
+
+        // the formula is written directly from its tree, the text entity is encoded from its xml
+        EgcBinaryDocument encoder;
+        encoder.startEncoding();
+        encoder.writeStartElement(QString("document"));
+        EgcFormulaSnapshot formulaSnapshot(formula, false);
+        QVERIFY(formulaSnapshot.serializeBinary(encoder, properties));
+        EgcXmlSnapshot textSnapshot(QByteArray("<text_entity pos_x=\"1\" pos_y=\"2\">abc</text_entity>"));
+        QVERIFY(textSnapshot.serializeBinary(encoder, properties));
+        encoder.writeEndElement();
+        QBuffer binary;
+        binary.open(QIODevice::ReadWrite);
+        QVERIFY(encoder.finishEncoding(binary));
+        QCOMPARE(encoder.getSections().size(), 2);
+
+        // both ways of writing the formula result in the same document
+        QString xml;
+        QXmlStreamWriter writer(&xml);
+        formula.serialize(writer, properties);
+        QSharedPointer<EgcBinaryDocument> document(new EgcBinaryDocument());
+        QVERIFY(document->open(binary.data()));
+        QString section;
+        QVERIFY(document->decodeSection(0, section));
+        QCOMPARE(xmlEvents(section.toUtf8()), xmlEvents(xml.toUtf8()));
+
+        // the formula is read without xml text, the tree is built from the event stream on first access
+        const EgcBinarySection& formulaSection = document->getSections().at(0);
+        EgcBinaryReader binaryReader(document, formulaSection.m_offset, formulaSection.m_length);
+        QVERIFY(binaryReader.readNextStartElement());
+        QCOMPARE(binaryReader.name(), QString("formula_entity"));
+        EgcFormulaEntity loaded;
+        loaded.deserializeBinary(binaryReader, properties);
+        QVERIFY(!binaryReader.hasError());
+        QCOMPARE(loaded.getPosition(), QPointF(5.0, 7.0));
+        QCOMPARE(loaded.getNumberOfSignificantDigits(), static_cast<quint8>(4));
+        QVERIFY(!loaded.isTreeLoaded());
+        QVERIFY(loaded.getRootElement() != nullptr);
+        QVERIFY(loaded.isTreeLoaded());
+        QVERIFY(*loaded.getRootElement() == *formula.getRootElement());
+
+        // event ranges outside of the document are rejected
+        EgcBinaryReader corrupted(document, 0, static_cast<quint32>(binary.data().size()));
+        QVERIFY(corrupted.hasError());
+        QVERIFY(!corrupted.readNextStartElement());
+}
+
+void EgcasTest_Structural::testLazyFormulaTree()
+{
+        EgcFormulaEntity formula(EgcNodeType::PlusNode);
+        EgcNumberNode* number = new EgcNumberNode();
+        number->setValue("2.5");
+        static_cast<EgcBinaryNode*>(formula.getRootElement())->setChild(0, *number);
+
+        QString text;
+        QXmlStreamWriter writer(&text);
+        SerializerProperties properties;
+        formula.serialize(writer, properties);
+
+        // with the document text given, the tree is only built on first access
+        QXmlStreamReader reader(text);
+        properties.version = 3;
+        properties.source = &text;
+        QVERIFY(reader.readNextStartElement());
+        EgcFormulaEntity lazy;
+        lazy.deserialize(reader, properties);
+        QVERIFY(!reader.hasError());
+        QVERIFY(!lazy.isTreeLoaded());
+        QVERIFY(lazy.getRootElement() != nullptr);
+        QVERIFY(lazy.isTreeLoaded());
+        QVERIFY(*lazy.getRootElement() == *formula.getRootElement());
+
+        // without the document text, the tree is built immediately
+        QXmlStreamReader reader2(text);
+        properties.source = nullptr;
+        QVERIFY(reader2.readNextStartElement());
+        EgcFormulaEntity direct;
+        direct.deserialize(reader2, properties);
+        QVERIFY(direct.isTreeLoaded());
+        QVERIFY(*direct.getRootElement() == *formula.getRootElement());
+}
+
+void EgcasTest_Structural::testFormulaLoader()
+{
+        QString text("<document>");
+        for (int i = 0; i < 500; i++) {
+                text += "<formula_entity><basenode><plusnode><variablenode subscript=\"1\">x</variablenode>"
+                        "<numbernode>" + QString::number(i) + "</numbernode></plusnode></basenode></formula_entity>";
+        }
+        text += "</document>";
+
+        // read the formulas like the document does, so all trees are pending
+        QXmlStreamReader reader(text);
+        SerializerProperties properties;
+        properties.version = 3;
+        properties.source = &text;
+        QVERIFY(reader.readNextStartElement());
+        QList<EgcFormulaEntity*> formulas;
+        while (reader.readNextStartElement()) {
+                formulas.append(new EgcFormulaEntity());
+                formulas.last()->deserialize(reader, properties);
+        }
+        QCOMPARE(formulas.size(), 500);
+        QVERIFY(!formulas.at(10)->isTreeLoaded());
+
+        // one formula is needed before its tree has been attached, another one is deleted while loading
+        EgcFormulaLoader loader;
+        loader.start(formulas, QRectF());
+        QCOMPARE(loader.getTotal(), 500);
+        QVERIFY(formulas.at(7)->getRootElement() != nullptr);
+        loader.remove(formulas.at(8));
+        delete formulas.takeAt(8);
+
+        while (!loader.isFinished())
+                loader.attachFinished(15);
+        QCOMPARE(loader.getAttached(), 500);
+
+        for (int i = 0; i < formulas.size(); i++) {
+                EgcFormulaEntity* formula = formulas.at(i);
+                QVERIFY(formula->isTreeLoaded());
+                EgcNode* root = formula->getRootElement();
+                QVERIFY(root != nullptr);
+                QVERIFY(root->getNodeType() == EgcNodeType::PlusNode);
+                EgcNode* number = static_cast<EgcBinaryNode*>(root)->getChild(1);
+                QVERIFY(number->getNodeType() == EgcNodeType::NumberNode);
+                QCOMPARE(static_cast<EgcNumberNode*>(number)->getValue(), QString::number(i < 8 ? i : i + 1));
+        }
+        qDeleteAll(formulas);
+}
+
+void EgcasTest_Structural::testDocumentJournal()
+{
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString document = dir.filePath("journal.egc");
+        QFile file(document);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("<document/>");
+        file.close();
+
+        EgcFormulaEntity first;
+        EgcFormulaEntity second;
+        EgcFormulaEntity created;
+        // the ids are assigned by the entity list of a document usually
+        first.setId(1);
+        second.setId(2);
+        created.setId(3);
+        QList<EgcEntity*> entities;
+        entities << &first << &second;
+
+        // one saved change, one saved deletion and a creation that hasn't been saved
+        EgcDocumentJournal journal;
+        QVERIFY(journal.start(document, entities));
+        journal.recordChange(&second);
+        journal.recordDeletion(&first);
+        QVERIFY(journal.commit());
+        journal.recordCreation(&created);
+        journal.recordMove(&created, QPointF(10.0, 20.0));
+        journal.stop();
+
+        // a record that has only partly been written is ignored
+        QFile journalFile(EgcDocumentJournal::getJournalFile(document));
+        QVERIFY(journalFile.open(QIODevice::Append));
+        journalFile.write("\x00\x00\x01", 3);
+        journalFile.close();
+
+        QVERIFY(journal.open(document, entities));
+        QCOMPARE(journal.getSavedRecords().size(), 2);
+        QVERIFY(journal.getSavedRecords().at(0).m_type == EgcJournalRecordType::EntityChanged);
+        QCOMPARE(journal.getSavedRecords().at(0).m_id, static_cast<quint32>(2));
+        QVERIFY(journal.getSavedRecords().at(0).m_xml.contains("formula_entity"));
+        QVERIFY(journal.getSavedRecords().at(0).m_xml.contains("id=\"2\""));
+        QVERIFY(journal.getSavedRecords().at(1).m_type == EgcJournalRecordType::EntityDeleted);
+        QCOMPARE(journal.getSavedRecords().at(1).m_id, static_cast<quint32>(1));
+        QCOMPARE(journal.getUnsavedRecords().size(), 2);
+        QVERIFY(journal.getUnsavedRecords().at(0).m_type == EgcJournalRecordType::EntityCreated);
+        QCOMPARE(journal.getUnsavedRecords().at(0).m_id, static_cast<quint32>(3));
+        QVERIFY(journal.getUnsavedRecords().at(1).m_type == EgcJournalRecordType::EntityMoved);
+        QCOMPARE(journal.getUnsavedRecords().at(1).m_pos, QPointF(10.0, 20.0));
+
+        // discarding the unsaved records keeps the saved ones only
+        journal.discardUnsaved();
+        journal.stop();
+        QVERIFY(journal.open(document, entities));
+        QCOMPARE(journal.getSavedRecords().size(), 2);
+        QVERIFY(journal.getUnsavedRecords().isEmpty());
+        QVERIFY(!journal.needsCompaction());
+        journal.stop();
+
+        // a journal doesn't belong to a document file that has been written again
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("<document></document>");
+        file.close();
+        QVERIFY(!journal.open(document, entities));
+
+        // changes made while the document is written in the background are kept for the new journal
+        QVERIFY(journal.start(document, entities));
+        journal.prepareRestart();
+        journal.recordDeletion(&first);
+        journal.recordCreation(&created);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("<document>  </document>");
+        file.close();
+        QVERIFY(journal.finishRestart(document));
+        journal.stop();
+        QVERIFY(journal.open(document, entities));
+        QVERIFY(journal.getSavedRecords().isEmpty());
+        QCOMPARE(journal.getUnsavedRecords().size(), 2);
+        QVERIFY(journal.getUnsavedRecords().at(0).m_type == EgcJournalRecordType::EntityDeleted);
+        QCOMPARE(journal.getUnsavedRecords().at(0).m_id, static_cast<quint32>(1));
+        QVERIFY(journal.getUnsavedRecords().at(1).m_type == EgcJournalRecordType::EntityCreated);
+        QCOMPARE(journal.getUnsavedRecords().at(1).m_id, static_cast<quint32>(3));
+        journal.stop();
+
+        // moves that haven't been reported are recorded before committing, unchanged positions are not
+        EgcEntityTest reported(QPointF(0.0, 0.0));
+        EgcEntityTest unreported(QPointF(0.0, 10.0));
+        reported.setId(1);
+        unreported.setId(2);
+        QList<EgcEntity*> moved;
+        moved << &reported << &unreported;
+        QVERIFY(journal.start(document, moved));
+        unreported.setPosition(QPointF(5.0, 50.0));
+        journal.recordPositions(moved);
+        reported.setPosition(QPointF(1.0, 2.0));
+        journal.recordMove(&reported, QPointF(1.0, 2.0));
+        journal.recordPositions(moved);
+        QVERIFY(journal.commit());
+        journal.stop();
+        QVERIFY(journal.open(document, moved));
+        QCOMPARE(journal.getSavedRecords().size(), 2);
+        QVERIFY(journal.getSavedRecords().at(0).m_type == EgcJournalRecordType::EntityMoved);
+        QCOMPARE(journal.getSavedRecords().at(0).m_id, static_cast<quint32>(2));
+        QCOMPARE(journal.getSavedRecords().at(0).m_pos, QPointF(5.0, 50.0));
+        QCOMPARE(journal.getSavedRecords().at(1).m_id, static_cast<quint32>(1));
+        journal.stop();
+
+        // entities marked as modified are recorded before committing, but only if they have changed since
+        QVERIFY(journal.start(document, moved));
+        journal.markDirty(&unreported);
+        journal.recordDirty();
+        journal.recordDirty();
+        journal.markDirty(&unreported);
+        journal.recordDirty();
+        QVERIFY(journal.commit());
+        journal.stop();
+        QVERIFY(journal.open(document, moved));
+        QCOMPARE(journal.getSavedRecords().size(), 1);
+        QVERIFY(journal.getSavedRecords().at(0).m_type == EgcJournalRecordType::EntityChanged);
+        QCOMPARE(journal.getSavedRecords().at(0).m_id, static_cast<quint32>(2));
+        journal.stop();
+
+        // the entity list keeps unique ids, copies and entities without id get new ones
+        EgcEntityList list;
+        EgcFormulaEntity* loaded = new EgcFormulaEntity();
+        loaded->setId(7);
+        EgcFormulaEntity* copy = new EgcFormulaEntity();
+        copy->setId(7);
+        EgcFormulaEntity* fresh = new EgcFormulaEntity();
+        list.addEntity(loaded);
+        list.addEntity(copy);
+        list.addEntity(fresh);
+        QCOMPARE(loaded->getId(), static_cast<quint32>(7));
+        QCOMPARE(copy->getId(), static_cast<quint32>(8));
+        QCOMPARE(fresh->getId(), static_cast<quint32>(9));
+        // the id read when deserializing replaces the one assigned, a missing id keeps the assigned one
+        fresh->setId(3);
+        list.updateId(fresh, 9);
+        QCOMPARE(fresh->getId(), static_cast<quint32>(3));
+        copy->setId(0);
+        list.updateId(copy, 8);
+        QCOMPARE(copy->getId(), static_cast<quint32>(8));
+        fresh->setId(7);
+        list.updateId(fresh, 3);
+        QVERIFY(fresh->getId() != 7 && fresh->getId() != 8);
+}
+
+void EgcasTest_Structural::testDocumentSaver()
+{
+        QString text("<document>");
+        for (int i = 0; i < 3; i++) {
+                text += "<formula_entity><basenode><plusnode><variablenode subscript=\"1\">x</variablenode>"
+                        "<numbernode>" + QString::number(i) + "</numbernode></plusnode></basenode></formula_entity>";
+        }
+        text += "</document>";
+
+        QXmlStreamReader reader(text);
+        SerializerProperties properties;
+        properties.version = 3;
+        properties.source = &text;
+        QVERIFY(reader.readNextStartElement());
+        QList<EgcFormulaEntity*> formulas;
+        while (reader.readNextStartElement()) {
+                formulas.append(new EgcFormulaEntity());
+                formulas.last()->deserialize(reader, properties);
+        }
+        QCOMPARE(formulas.size(), 3);
+        // the first tree is copied into the snapshot, the others are built by the saver thread
+        QVERIFY(formulas.at(0)->getRootElement() != nullptr);
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        SerializerProperties saveProperties;
+        saveProperties.filePath = dir.filePath("saver.egc");
+        QList<EgcEntitySnapshot*> snapshots;
+        foreach (EgcFormulaEntity* formula, formulas) {
+                snapshots.append(formula->takeSnapshot(saveProperties));
+                QVERIFY(snapshots.last() != nullptr);
+        }
+        // the snapshot doesn't depend on the formulas anymore
+        qDeleteAll(formulas);
+
+        EgcDocumentSaver saver;
+        QVERIFY(saver.save(saveProperties.filePath, false, saveProperties, 100.0, 200.0, QString(), snapshots));
+        QVERIFY(saver.wait(10000));
+        QVERIFY(saver.isSaved());
+
+        QFile file(saveProperties.filePath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QXmlStreamReader saved(&file);
+        QVERIFY(saved.readNextStartElement());
+        QCOMPARE(saved.name().toString(), QString("document"));
+        QCOMPARE(saved.attributes().value("height").toString(), QString("200"));
+        QStringList numbers;
+        while (!saved.atEnd()) {
+                if (saved.readNext() == QXmlStreamReader::StartElement && saved.name() == QLatin1String("numbernode"))
+                        numbers.append(saved.readElementText());
+        }
+        QVERIFY(!saved.hasError());
+        QCOMPARE(numbers, QStringList() << "0" << "1" << "2");
+        file.close();
+
+        // a document that can't be written is reported and the saver can be used again
+        QVERIFY(saver.save(dir.filePath("missing/saver.egc"), false, saveProperties, 100.0, 200.0, QString(),
+                           QList<EgcEntitySnapshot*>()));
+        QVERIFY(saver.wait(10000));
+        QVERIFY(!saver.isSaved());
+        QVERIFY(!saver.getErrorString().isEmpty());
+}
+
+void EgcasTest_Structural::testNodeTraits()
+{
+        for (int i = 0; i < static_cast<int>(EgcNodeType::NodeUndefined); i++) {
+                EgcNodeType type = static_cast<EgcNodeType>(i);
+                QLatin1String name = EgcNodeCreator::stringize(type);
+                QVERIFY(name.size() != 0);
+                QString nameStr = QString(name);
+                QCOMPARE(EgcNodeCreator::getType(QStringRef(&nameStr)), type);
+
+                QScopedPointer<EgcNode> node(EgcNodeCreator::create(name));
+                QVERIFY(!node.isNull());
+                QCOMPARE(node->getNodeType(), type);
+                const EgcNodeTraits& traits = egcNodeTraits(type);
+                QCOMPARE(traits.m_kind == EgcNodeKind::Unary, node->isUnaryNode());
+                QCOMPARE(traits.m_kind == EgcNodeKind::Binary, node->isBinaryNode());
+                QCOMPARE(traits.m_kind == EgcNodeKind::Flex, node->isFlexNode());
+                QCOMPARE(traits.m_kind != EgcNodeKind::Leaf, node->isContainer());
+        }
+
+        QCOMPARE(EgcNodeCreator::stringize(EgcNodeType::NodeUndefined).size(), 0);
+        QString unknown("plusnod");
+        QCOMPARE(EgcNodeCreator::getType(QStringRef(&unknown)), EgcNodeType::NodeUndefined);
+        unknown = "Plusnode";
+        QCOMPARE(EgcNodeCreator::getType(QStringRef(&unknown)), EgcNodeType::NodeUndefined);
+        QVERIFY(EgcNodeCreator::create(QLatin1String("node")) == nullptr);
+}
+
+/**
+ * @brief roundTrip serializes the entity and reads it back into a new entity
+ */
+static bool roundTrip(EgcEntity& entity, SerializerProperties& properties, EgcEntity& loaded)
+{
+        QByteArray xml;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        QXmlStreamWriter writer(&buffer);
+        entity.serialize(writer, properties);
+        buffer.close();
+
+        QXmlStreamReader reader(xml);
+        if (!reader.readNextStartElement())
+                return false;
+        SerializerProperties loadProperties;
+        loadProperties.filePath = properties.filePath;
+        loaded.deserialize(reader, loadProperties);
+
+        return loadProperties.warningMessage.isEmpty() && !reader.hasError();
+}
+
+void EgcasTest_Structural::testPixmapRoundTrip()
+{
+        QImage image(7, 5, QImage::Format_RGB32);
+        image.fill(Qt::darkCyan);
+        QByteArray png;
+        QBuffer pngBuffer(&png);
+        pngBuffer.open(QIODevice::WriteOnly);
+        QVERIFY(image.save(&pngBuffer, "PNG"));
+        pngBuffer.close();
+
+        EgcPixmapEntity pixmap;
+        QVERIFY(pixmap.setEncoded(png));
+        pixmap.setIsEmbedded();
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        //embedded image
+        SerializerProperties properties;
+        properties.filePath = dir.filePath("pictures.egc");
+        EgcPixmapEntity embedded;
+        QVERIFY(roundTrip(pixmap, properties, embedded));
+        QVERIFY(properties.errorMessage.isEmpty());
+        QCOMPARE(embedded.getContentHash(), pixmap.getContentHash());
+        QCOMPARE(embedded.getFileType(), QString("PNG"));
+
+        //image in a file next to the document
+        properties.externalImages = true;
+        QString imageFile = dir.filePath(EgcPixmapEntity::getExternalFile(properties.filePath,
+                                                                           pixmap.getContentHash(), "PNG"));
+        EgcPixmapEntity external;
+        QVERIFY(roundTrip(pixmap, properties, external));
+        QVERIFY(properties.errorMessage.isEmpty());
+        QCOMPARE(external.getContentHash(), pixmap.getContentHash());
+        QFile file(imageFile);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), png);
+        file.close();
+
+        //a partially written image file is written again
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(png.left(png.size() / 2));
+        file.close();
+        EgcPixmapEntity repaired;
+        QVERIFY(roundTrip(pixmap, properties, repaired));
+        QCOMPARE(repaired.getContentHash(), pixmap.getContentHash());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), png);
+        file.close();
+
+        //an image file that can't be written is reported
+        QFile blocker(dir.filePath("blocked_images"));
+        QVERIFY(blocker.open(QIODevice::WriteOnly));
+        blocker.close();
+        SerializerProperties blocked;
+        blocked.filePath = dir.filePath("blocked.egc");
+        blocked.externalImages = true;
+        EgcPixmapEntity missing;
+        QVERIFY(!roundTrip(pixmap, blocked, missing));
+        QVERIFY(!blocked.errorMessage.isEmpty());
+
+        //the saver doesn't consider the document as saved then
+        QList<EgcEntitySnapshot*> snapshots;
+        snapshots.append(pixmap.takeSnapshot(blocked));
+        QVERIFY(snapshots.last() != nullptr);
+        blocked.errorMessage.clear();
+        EgcDocumentSaver saver;
+        QVERIFY(saver.save(blocked.filePath, false, blocked, 100.0, 200.0, QString(), snapshots));
+        QVERIFY(saver.wait(10000));
+        QVERIFY(!saver.isSaved());
+        QVERIFY(!saver.getErrorString().isEmpty());
+        QVERIFY(!QFileInfo::exists(blocked.filePath));
+}
+
+void EgcasTest_Structural::testTableRoundTrip()
+{
+        EgcTableItemTest item;
+        EgcTableEntity table;
+        table.setItem(&item);
+        table.setPosition(QPointF(40.0, 60.0));
+        EgcParameterSweep& sweep = table.getSweep();
+        QVERIFY(sweep.setExpression("x*y+1"));
+        sweep.setRange(0, EgcSweepRange("x", 0.0, 1.0, 3));
+        sweep.setRange(1, EgcSweepRange("y", -0.1, 2.0, 2));
+        EgcNumericEvaluator evaluator;
+        QVERIFY(table.calculate(evaluator));
+        table.updateView();
+        QCOMPARE(item.m_cells.size(), 4);
+
+        SerializerProperties properties;
+        EgcTableItemTest loadedItem;
+        EgcTableEntity loaded;
+        loaded.setItem(&loadedItem);
+        QVERIFY(roundTrip(table, properties, loaded));
+        QCOMPARE(loaded.getPosition(), QPointF(40.0, 60.0));
+        EgcParameterSweep& loadedSweep = loaded.getSweep();
+        QCOMPARE(loadedSweep.getExpression(), QString("x*y+1"));
+        QCOMPARE(loadedSweep.getDimension(), 2);
+        for (int i = 0; i < 2; i++) {
+                QCOMPARE(loadedSweep.getRange(i).m_name, sweep.getRange(i).m_name);
+                QCOMPARE(loadedSweep.getRange(i).m_from, sweep.getRange(i).m_from);
+                QCOMPARE(loadedSweep.getRange(i).m_to, sweep.getRange(i).m_to);
+                QCOMPARE(loadedSweep.getRange(i).m_steps, sweep.getRange(i).m_steps);
+        }
+        //the values are loaded as well, so the table can be shown without calculating
+        QCOMPARE(loadedSweep.getValues(), sweep.getValues());
+        QCOMPARE(loadedItem.m_cells, item.m_cells);
+        QCOMPARE(loaded.getCASKernelCommand(), table.getCASKernelCommand());
+
+        //a table that hasn't been calculated has no values after loading
+        sweep.clearValues();
+        EgcTableEntity empty;
+        QVERIFY(roundTrip(table, properties, empty));
+        QVERIFY(!empty.getSweep().hasValues());
+        QVERIFY(empty.getSweep().isValid());
+}
+
+void EgcasTest_Structural::testPlotRoundTrip()
+{
+        EgcPlotItemTest item;
+        EgcPlotEntity plot;
+        plot.setItem(&item);
+        plot.setPosition(QPointF(80.0, 120.0));
+        QVERIFY(plot.setExpression("t^2-1", "t"));
+        plot.setXRange(-2.5, 3.0);
+        plot.setYRange(-1.5, 8.25, false);
+        plot.setNumberOfSamples(51);
+        plot.resample();
+        plot.updateView();
+        QVERIFY(plot.getErrorMessage().isEmpty());
+        QVERIFY(item.m_x.size() >= 51);
+
+        SerializerProperties properties;
+        EgcPlotItemTest loadedItem;
+        EgcPlotEntity loaded;
+        loaded.setItem(&loadedItem);
+        QVERIFY(roundTrip(plot, properties, loaded));
+        QCOMPARE(loaded.getPosition(), QPointF(80.0, 120.0));
+        QCOMPARE(loaded.getExpression(), QString("t^2-1"));
+        QCOMPARE(loaded.getVariable(), QString("t"));
+        QCOMPARE(loaded.getXMin(), -2.5);
+        QCOMPARE(loaded.getXMax(), 3.0);
+        QCOMPARE(loaded.getYMin(), -1.5);
+        QCOMPARE(loaded.getYMax(), 8.25);
+        QVERIFY(!loaded.isAutoScale());
+        QCOMPARE(loaded.getNumberOfSamples(), 51);
+
+        //the loaded plot is sampled on the same grid
+        QCOMPARE(loadedItem.m_x, item.m_x);
+        QCOMPARE(loadedItem.m_y, item.m_y);
+        QCOMPARE(loadedItem.m_range, item.m_range);
+        QVERIFY(loadedItem.m_x.first() <= -2.5 && loadedItem.m_x.last() >= 3.0);
+
+        //the defaults are kept if the plot is scaled automatically
+        EgcPlotEntity autoScaled;
+        QVERIFY(autoScaled.setExpression("t", "t"));
+        EgcPlotEntity loadedAutoScaled;
+        QVERIFY(roundTrip(autoScaled, properties, loadedAutoScaled));
+        QVERIFY(loadedAutoScaled.isAutoScale());
+        QCOMPARE(loadedAutoScaled.getNumberOfSamples(), static_cast<int>(EgcPlotEntity::s_defaultSamples));
+        QCOMPARE(loadedAutoScaled.getXMin(), -10.0);
+        QCOMPARE(loadedAutoScaled.getXMax(), 10.0);
+}
 
 QTEST_MAIN(EgcasTest_Structural)
 
@@ -32,10 +32,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "egcnodes.h"
 #include "iterator/egcnodeiterator.h"
 #include "entities/egcformulaentity.h"
+#include "entities/egcentitylist.h"
 #include "egcnodecreator.h"
 #include "visitor/egcnodevisitor.h"
 #include "visitor/egcmaximavisitor.h"
 #include "visitor/egcmathmlvisitor.h"
+#include "egcabstracttableitem.h"
+#include "egcabstractplotitem.h"
 
 class EgcUnaryNodeTestChild : public EgcUnaryNode
 {
@@ -75,4 +78,47 @@ class EgcBinaryNodeTest : public EgcBinaryNode
 {
 };
 
+class EgcEntityTest : public EgcEntity
+{
+public:
+        ///std constructor
+        EgcEntityTest(QPointF pos) : m_pos{pos} {}
+        virtual EgcEntityType getEntityType(void) const override {return EgcEntityType::Text;}
+        virtual QPointF getPosition(void) const override {return m_pos;}
+        virtual void setPosition(QPointF pos) override {m_pos = pos;}
+        virtual void serialize(QXmlStreamWriter& stream, SerializerProperties &properties) override
+        {(void) stream; (void) properties;}
+        virtual void deserialize(QXmlStreamReader& stream, SerializerProperties &properties) override
+        {(void) stream; (void) properties;}
+        void moveTo(QPointF pos) {m_pos = pos; positionChanged();}
+        QPointF m_pos;
+};
+
+//mock table item that holds the position and the cells of a table
+class EgcTableItemTest : public EgcAbstractTableItem
+{
+public:
+        virtual QPointF getPosition(void) const override {return m_pos;}
+        virtual void setPos(const QPointF& point) override {m_pos = point;}
+        virtual void setCells(const QVector<QStringList>& cells) override {m_cells = cells;}
+        QPointF m_pos;
+        QVector<QStringList> m_cells;
+};
+
+//mock plot item that holds the position and the curve of a plot
+class EgcPlotItemTest : public EgcAbstractPlotItem
+{
+public:
+        virtual QPointF getPosition(void) const override {return m_pos;}
+        virtual void setPos(const QPointF& point) override {m_pos = point;}
+        virtual void setCurve(const QVector<double>& x, const QVector<double>& y, const QRectF& range) override
+        {m_x = x; m_y = y; m_range = range;}
+        virtual void setCaption(const QString& caption) override {m_caption = caption;}
+        QPointF m_pos;
+        QVector<double> m_x;
+        QVector<double> m_y;
+        QRectF m_range;
+        QString m_caption;
+};
+
 #endif // TST_EGCASTEST_STRUCTURAL_H
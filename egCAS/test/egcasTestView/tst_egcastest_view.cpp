@@ -28,7 +28,33 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <QString>
 #include <QtTest>
+#include <QStyleOptionGraphicsItem>
+#include <libegcas/eg_mml_document.h>
 #include "../../src/view/egcformulaitem.h"
+#include "../../src/view/egcscreenpos.h"
+#include "../../src/structural/entities/egcabstractformulaentity.h"
+
+/**
+ * @brief The EgcTestFormulaEntity class is a minimal formula entity that delivers a constant formula to an item
+ */
+class EgcTestFormulaEntity : public EgcAbstractFormulaEntity
+{
+public:
+        EgcTestFormulaEntity() : m_item{nullptr} {}
+        virtual QString getMathMlCode(void) override {return QString("<math><mn>42</mn></math>");}
+        virtual void setItem(EgcAbstractFormulaItem* item) override {m_item = item;}
+        virtual EgcAbstractFormulaItem* getItem(void) override {return m_item;}
+        virtual void handleAction(const EgcAction& action) override {(void) action;}
+        virtual bool cursorAtBegin(void) override {return true;}
+        virtual bool cursorAtEnd(void) override {return true;}
+        virtual void setCursorPos(quint32 nodeId, quint32 subPos, bool rightSide) override
+        {(void) nodeId; (void) subPos; (void) rightSide;}
+        virtual int getFontSize(void) const override {return 20;}
+        virtual bool aboutToBeDeleted(void) const override {return false;}
+        virtual void itemChanged(EgcItemChangeType changeType) override {(void) changeType;}
+private:
+        EgcAbstractFormulaItem* m_item;
+};
 
 class EgcasTest_View : public QObject
 {
@@ -39,6 +65,13 @@ public:
 
 private Q_SLOTS:
         void testSceneItemSorting();
+        void testScreenPosHitTesting();
+        void testLazyLayout();
+        void testMaterializedCache();
+        void testRenderCache();
+private:
+        static QImage paintItem(EgcFormulaItem& item, QColor color);
+        static EgRenderingPosition renderingPos(quint32 id, quint32 subPos, QRectF rect);
 };
 
 EgcasTest_View::EgcasTest_View()
@@ -69,6 +102,168 @@ void EgcasTest_View::testSceneItemSorting()
         delete(item2);
 }
 
+void EgcasTest_View::testLazyLayout()
+{
+        EgcTestFormulaEntity entity;
+        EgcFormulaItem item(QPointF(0.0, 0.0));
+        item.setEntity(&entity);
+
+        //a deferred formula reports the estimated size until it gets laid out
+        item.updateViewLazy(QSizeF(80.0, 30.0));
+        QVERIFY(!item.isMaterialized());
+        QCOMPARE(item.getLayoutSize(), QSizeF(80.0, 30.0));
+
+        //painting must not lay out the formula
+        QImage image(200, 100, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        QStyleOptionGraphicsItem option;
+        item.paint(&painter, &option, nullptr);
+        painter.end();
+        QVERIFY(!item.isMaterialized());
+        QCOMPARE(item.getLayoutSize(), QSizeF(80.0, 30.0));
+
+        item.materialize();
+        QVERIFY(item.isMaterialized());
+        QVERIFY(item.getLayoutSize() != QSizeF(80.0, 30.0));
+        QVERIFY(!item.getLayoutSize().isEmpty());
+}
+
+void EgcasTest_View::testMaterializedCache()
+{
+        EgcTestFormulaEntity entity;
+        QList<EgcFormulaItem*> items;
+
+        EgcFormulaItem::setMaxMaterialized(4);
+        for (int i = 0; i < 8; i++) {
+                EgcFormulaItem* item = new EgcFormulaItem(QPointF(0.0, i * 50.0));
+                item->setEntity(&entity);
+                item->updateView();
+                items.append(item);
+        }
+
+        //the least recently used formulas are released as soon as there are too many
+        int materialized = 0;
+        foreach (EgcFormulaItem* item, items) {
+                if (item->isMaterialized())
+                        materialized++;
+        }
+        QVERIFY(materialized <= 4);
+        QVERIFY(items.last()->isMaterialized());
+        QVERIFY(!items.first()->isMaterialized());
+        //a released formula keeps its size, so the geometry of the scene doesn't change
+        QCOMPARE(items.first()->getLayoutSize(), items.last()->getLayoutSize());
+
+        //using a released formula again lays it out and releases others
+        items.first()->materialize();
+        QVERIFY(items.first()->isMaterialized());
+
+        //all formulas of a materialize pass are going to be painted, so none of them is released during the pass
+        EgcFormulaItem::beginMaterializePass();
+        foreach (EgcFormulaItem* item, items)
+                item->materialize();
+        EgcFormulaItem::endMaterializePass();
+        foreach (EgcFormulaItem* item, items)
+                QVERIFY(item->isMaterialized());
+
+        //outside of a pass the maximum applies again
+        EgcFormulaItem* item = new EgcFormulaItem(QPointF(0.0, 400.0));
+        item->setEntity(&entity);
+        item->updateView();
+        items.append(item);
+        QVERIFY(item->isMaterialized());
+        QVERIFY(!items.first()->isMaterialized());
+
+        qDeleteAll(items);
+        EgcFormulaItem::setMaxMaterialized(1000);
+}
+
+QImage EgcasTest_View::paintItem(EgcFormulaItem& item, QColor color)
+{
+        QImage image(200, 100, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        painter.setPen(QPen(color));
+        QStyleOptionGraphicsItem option;
+        item.paint(&painter, &option, nullptr);
+        painter.end();
+
+        return image;
+}
+
+void EgcasTest_View::testRenderCache()
+{
+        EgcTestFormulaEntity entity;
+        EgcFormulaItem item(QPointF(0.0, 0.0));
+        EgcFormulaItem reference(QPointF(0.0, 0.0));
+        item.setEntity(&entity);
+        reference.setEntity(&entity);
+        item.updateView();
+        reference.updateView();
+
+        //the first rendering is done live (the layout changed), afterwards the render cache is used
+        paintItem(item, Qt::black);
+        paintItem(reference, Qt::black);
+        QImage black = paintItem(item, Qt::black);
+        QVERIFY(black == paintItem(item, Qt::black));
+
+        //a cached rendering with another pen must not be reused
+        paintItem(reference, Qt::red);
+        QImage red = paintItem(reference, Qt::red);
+        QVERIFY(paintItem(item, Qt::red) == red);
+        QVERIFY(paintItem(item, Qt::black) == black);
+}
+
 QTEST_MAIN(EgcasTest_View)
 
+EgRenderingPosition EgcasTest_View::renderingPos(quint32 id, quint32 subPos, QRectF rect)
+{
+        EgRenderingPosition pos;
+        pos.m_nodeId = id;
+        pos.m_subPos = subPos;
+        pos.m_itemRect = rect;
+
+        return pos;
+}
+
+void EgcasTest_View::testScreenPosHitTesting()
+{
+        EgcScreenPos screenPos;
+        QVector<EgRenderingPosition> positions;
+
+        QVERIFY(screenPos.empty());
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(1.0, 1.0)).m_nodeId, static_cast<quint32>(0));
+
+        //a frame with two glyphs inside
+        positions.append(renderingPos(1, 0, QRectF(0.0, 0.0, 100.0, 20.0)));
+        positions.append(renderingPos(2, 0, QRectF(0.0, 0.0, 10.0, 20.0)));
+        positions.append(renderingPos(2, 1, QRectF(0.0, 0.0, 10.0, 20.0)));
+        positions.append(renderingPos(3, 0, QRectF(10.0, 0.0, 5.0, 20.0)));
+        //many glyphs in a row to get a grid with more than one cell
+        for (quint32 i = 0; i < 200; i++)
+                positions.append(renderingPos(100 + i, 0, QRectF(i * 10.0, 30.0, 10.0, 20.0)));
+        screenPos.setPositions(positions);
+
+        QVERIFY(!screenPos.empty());
+        //the smallest rectangle containing the point wins, sub positions other than 0 are preferred
+        EgRenderingPosition hit = screenPos.getMathmlIdAtPos(QPointF(2.0, 5.0));
+        QCOMPARE(hit.m_nodeId, static_cast<quint32>(2));
+        QCOMPARE(hit.m_subPos, static_cast<quint32>(1));
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(12.0, 5.0)).m_nodeId, static_cast<quint32>(3));
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(50.0, 5.0)).m_nodeId, static_cast<quint32>(1));
+        for (quint32 i = 0; i < 200; i++)
+                QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(i * 10.0 + 5.0, 40.0)).m_nodeId, 100 + i);
+        //outside of all positions
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(500.0, 25.0)).m_nodeId, static_cast<quint32>(0));
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(-1.0, 5.0)).m_nodeId, static_cast<quint32>(0));
+
+        QCOMPARE(screenPos.findRenderingData(3, 0).m_itemRect, QRectF(10.0, 0.0, 5.0, 20.0));
+        QCOMPARE(screenPos.findRenderingData(2, 1).m_subPos, static_cast<quint32>(1));
+        QCOMPARE(screenPos.findRenderingData(4, 0).m_nodeId, static_cast<quint32>(0));
+
+        screenPos.setPositions(QVector<EgRenderingPosition>());
+        QVERIFY(screenPos.empty());
+        QCOMPARE(screenPos.getMathmlIdAtPos(QPointF(2.0, 5.0)).m_nodeId, static_cast<quint32>(0));
+}
+
 #include "tst_egcastest_view.moc"
@@ -50,3 +50,56 @@ def flatten(param):
         el = flatten(param[1:])
         first_el.extend(el)
         return first_el
+
+
+def find_bases_in_dir(base_path, sub_path):
+    bases = dict()
+    regex = re.compile("^class[\s]+([a-zA-Z0-9_]+)[\s]*:[\s]*public[\s]+([a-zA-Z0-9_]+)", re.MULTILINE)
+    dir_complete = os.path.join(base_path, sub_path)
+    for root, directories, filenames in os.walk(dir_complete):
+        for filename in filenames:
+            if filename.endswith(".h") or filename.endswith(".H"):
+                with open(os.path.join(root, filename), "r") as f:
+                    for result in regex.findall(f.read()):
+                        bases[result[0]] = result[1]
+    return bases
+
+
+def node_kind(class_name, bases):
+    kinds = {"EgcUnaryNode": "Unary", "EgcBinaryNode": "Binary", "EgcFlexNode": "Flex", "EgcNode": "Leaf"}
+    while class_name not in kinds:
+        if class_name not in bases:
+            raise Exception("The node class \"%s\" is not derived from a known node base class" % class_name)
+        class_name = bases[class_name]
+    return kinds[class_name]
+
+
+def node_arity(kind):
+    arities = {"Leaf": 0, "Unary": 1, "Binary": 2, "Flex": -1}
+    return arities[kind]
+
+
+def node_name_hash(name, seed):
+    # FNV-1a with the seed as offset basis, must be kept in sync with lookupType in egcnodecreator.cpp.in
+    hash_value = seed
+    for character in name:
+        hash_value = ((hash_value ^ ord(character)) * 16777619) & 0xFFFFFFFF
+    # the low bits of FNV-1a are mixed poorly, so fold the upper half into them
+    return hash_value ^ (hash_value >> 16)
+
+
+def find_perfect_hash(names):
+    size = 1
+    while size < 2 * len(names):
+        size *= 2
+    while True:
+        for seed in range(1, 1 << 16):
+            slots = set()
+            for name in names:
+                slot = node_name_hash(name, seed) & (size - 1)
+                if slot in slots:
+                    break
+                slots.add(slot)
+            else:
+                return seed, size
+        size *= 2